@@ -42,6 +42,7 @@ int main() {
     printf("%-15s", "Runtime (ms)");
     printf("%-11s", "VirtMem");
     printf("%-11s", "PhysMem");
+    printf("%-8s", "Shared");
     printf("%-6s",  "Flags");
 
     for (auto i = 0u; i < sz; ++i) {
@@ -55,6 +56,7 @@ int main() {
         printf("%-15lld", process.runtime);
         printf("%-11.10lu", process.vmspace);
         printf("%-11.10lu", process.pmspace);
+        printf("%-8lu", process.sharedpages);
         printf("%5s", process.flags.system ? "S" : "-");
     }
 
@@ -0,0 +1,134 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/ioctl.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+static syscall_stats_t gTable[256];
+
+void usage(int ec = 0) {
+    printf("sysstat [-n <count>] [-p] [-t <pid>]\n");
+    printf("lists the system calls that took the most time in total, with their latency\n");
+    printf("-n limits the list to the top count entries (default 10);\n");
+    printf("-p shows only the calls made by the process being tracked;\n");
+    printf("-t starts tracking the process pid from now on, or stops tracking with 0\n");
+    exit(ec);
+}
+
+// with the TSC uncalibrated, cycles are shown as they are
+static uint64_t toMicros(uint64_t cycles) {
+    auto kd = (const kernel_data_t*)kernel_data_t::gAddress;
+    auto perms = kd->tsc.ticksPerMs;
+    if (perms == 0) return cycles;
+    return cycles * 1000 / perms;
+}
+
+// the smallest number of cycles that at least pct% of calls took no longer than, as far as buckets can tell
+static uint64_t percentile(const syscall_stats_t& s, uint32_t pct) {
+    uint64_t want = (s.calls - s.insecure) * pct / 100;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < syscall_stats_t::gNumBuckets; ++i) {
+        seen += s.buckets[i];
+        if (seen >= want && seen > 0) {
+            uint64_t upper = (2ull << i) - 1;
+            return upper < s.maxcycles ? upper : s.maxcycles;
+        }
+    }
+    return s.maxcycles;
+}
+
+static int bytotal(const void* a, const void* b) {
+    auto sa = (const syscall_stats_t*)a;
+    auto sb = (const syscall_stats_t*)b;
+    if (sa->cycles == sb->cycles) return 0;
+    return (sa->cycles < sb->cycles) ? 1 : -1;
+}
+
+int main(int argc, char* const* argv) {
+    size_t count = 10;
+    bool process = false;
+    bool track = false;
+    kpid_t pid = 0;
+    int c;
+
+    opterr = 0;
+
+    while ((c = getopt (argc, argv, "n:pt:")) != -1) {
+        switch (c) {
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 'p':
+                process = true;
+                break;
+            case 't':
+                track = true;
+                pid = atoi(optarg);
+                break;
+            default:
+                usage(1);
+                break;
+        }
+    }
+
+    if (track) {
+        FILE* f = fopen("/devices/syscalls/process", "r");
+        if (f == nullptr || 1 != ioctl(fileno(f), syscall_stats_t::IOCTL_TRACK_PROCESS, pid)) {
+            printf("%s: can't track process %u\n", argv[0], pid);
+            exit(1);
+        }
+        fclose(f);
+        if (pid) printf("tracking system calls of process %u\n", pid);
+        return 0;
+    }
+
+    const char* path = process ? "/devices/syscalls/process" : "/devices/syscalls/all";
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) {
+        printf("%s: can't open %s\n", argv[0], path);
+        exit(1);
+    }
+    if (process) {
+        int tracked = ioctl(fileno(f), syscall_stats_t::IOCTL_TRACKED_PROCESS, 0);
+        if (tracked <= 0) {
+            printf("%s: no process is being tracked; use -t <pid> first\n", argv[0]);
+            exit(1);
+        }
+        printf("system calls of process %d\n", tracked);
+    }
+    size_t n = fread(gTable, sizeof(syscall_stats_t), 256, f);
+    fclose(f);
+
+    qsort(gTable, n, sizeof(syscall_stats_t), bytotal);
+
+    printf("%-16s %10s %12s %10s %10s %10s %10s\n", "name", "calls", "total us", "avg us", "p50 us", "p99 us", "max us");
+    for (size_t i = 0; i < n && i < count; ++i) {
+        const auto& s(gTable[i]);
+        if (s.calls == 0) break;
+        auto timed = s.calls - s.insecure;
+        printf("%-16s %10llu %12llu %10llu %10llu %10llu %10llu\n", s.name, s.calls,
+            toMicros(s.cycles), timed ? toMicros(s.cycles / timed) : 0,
+            toMicros(percentile(s, 50)), toMicros(percentile(s, 99)), toMicros(s.maxcycles));
+    }
+
+    return 0;
+}
@@ -46,6 +46,11 @@ int main(int argc, char** argv) {
             printf("                       which makes for a cache hit ratio of: %.2f%%\n", ratio);
         }
         printf("Total sectors written: %llu\n", stats.sectors_written);
+        printf("Cache size:            %u of %u blocks in use, %u dirty\n", stats.cache_resident, stats.cache_capacity, stats.cache_dirty);
+        printf("Cache misses:          %llu\n", stats.cache_misses);
+        printf("Cache evictions:       %llu\n", stats.cache_evictions);
+        printf("Sectors written back:  %llu\n", stats.cache_writebacks);
+        printf("Sectors bypassing:     %llu\n", stats.cache_bypassed);
     } else {
         printf("error: file may not be a valid volume.\n");
         exit(3);
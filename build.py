@@ -259,9 +259,10 @@ class _BuildCpp(object):
 THE_POOL = Pool(5)
 
 class Project(object):
-    def __init__(self, name, srcdir, cflags=None, cppflags=None, asmflags=None, ldflags=None, ipaths=None, assembler="nasm", linkerdeps=None, outwhere="out", gcc="i686-elf-gcc", announce=True):
+    def __init__(self, name, srcdir, cflags=None, cppflags=None, asmflags=None, ldflags=None, ipaths=None, assembler="nasm", linkerdeps=None, outwhere="out", gcc="i686-elf-gcc", announce=True, exclude=None):
         self.name = name
         self.srcdir = srcdir
+        self.exclude = set(exclude) if exclude else set()
         self.cflags = ' '.join(cflags if cflags else BASIC_CFLAGS)
         self.cppflags = ' '.join(cppflags if cppflags else (BASIC_CFLAGS + BASIC_CPPFLAGS))
         self.asmflags = ' '.join(asmflags if asmflags else BASIC_ASFLAGS)
@@ -276,13 +277,13 @@ class Project(object):
         self.gcc = gcc if gcc else "i686-elf-gcc"
 
     def findCFiles(self):
-        return findAll(self.srcdir, "c")
+        return findAll(self.srcdir, "c") - self.exclude
 
     def findCPPFiles(self):
-        return findAll(self.srcdir, "cpp")
+        return findAll(self.srcdir, "cpp") - self.exclude
 
     def findSFiles(self):
-        return findAll(self.srcdir, "s")
+        return findAll(self.srcdir, "s") - self.exclude
 
     def buildCFiles(self):
         return THE_POOL.map(_BuildC(self.gcc, self.cflags), self.findCFiles())
@@ -590,7 +591,8 @@ if BUILD_CORE:
             asmflags = asmflags,
             ldflags = ldflags,
             ipaths = ipaths,
-            linkerdeps = linkerdeps)
+            linkerdeps = linkerdeps,
+            exclude = core_project.get('exclude', None))
 
         linklogic = core_project.get('linkLogic', 'ar')
         if linklogic == 'ar':
@@ -19,7 +19,7 @@ import json, os, subprocess, time, sys, tempfile
 def getCmdline(ramMB):
     return 'qemu-system-i386 -drive format=raw,media=disk,file=out/os.img -display none -serial file:out/kernel.log -d guest_errors ' + \
         '-rtc base=utc -monitor stdio -smbios type=0,vendor="Puppy" -smbios type=1,manufacturer="Puppy",product="Puppy System",serial="P0PP1" ' + \
-        '-k en-us -cpu n270 -m %s' % ramMB
+        '-k en-us -cpu n270 -smp 2 -m %s' % ramMB
 
 MAX_TEST_LEN = 0
 MAX_TEST_WAIT = 0
@@ -35,9 +35,27 @@ class APIC : NOCOPY {
 
         void tickEvery(uint32_t ms);
 
+        // arms the timer to interrupt once, after the given number of microseconds; 0 stops the timer
+        void oneShot(uint64_t micros);
+
         uint32_t getTimerCurrent() const;
+
+        // TSC ticks per ms, as measured alongside the APIC timer by calibrate()
+        uint64_t getTSCTicksPerMs() const;
+
+        // the local APIC ID of the CPU this runs on
+        uint8_t id() const;
+
+        void sendIPI(uint8_t apicid, uint8_t vector);
+        void sendINIT(uint8_t apicid);
+        // the processor starts running in real mode at page * 4KB
+        void sendSIPI(uint8_t apicid, uint8_t page);
+
+        // sets up the local APIC of an application processor like the boot CPU's
+        void setupAP();
     private:
-        void configure(uint32_t ticks);
+        void configure(uint32_t ticks, bool periodic = true);
+        void sendICR(uint8_t apicid, uint32_t command);
 
         // Intel docs give offsets in bytes - but we use uint32_t* to enable proper access size, so divide accordingly
         static constexpr uint32_t gSpuriousInterruptRegister = 0xF0 / sizeof(uint32_t);
@@ -46,9 +64,14 @@ class APIC : NOCOPY {
         static constexpr uint32_t gTimerInitialCount = 0x380 / sizeof(uint32_t);
         static constexpr uint32_t gTimerCurrentCount = 0x390 / sizeof(uint32_t);
         static constexpr uint32_t gEOIRegister = 0xB0 / sizeof(uint32_t);
+        static constexpr uint32_t gIDRegister = 0x20 / sizeof(uint32_t);
+        static constexpr uint32_t gICRLowRegister = 0x300 / sizeof(uint32_t);
+        static constexpr uint32_t gICRHighRegister = 0x310 / sizeof(uint32_t);
 
         uint32_t *mAPICRegisters;
         uint32_t mTicksPerMs;
+        uint64_t mTSCTicksPerMs;
+        bool mOneShot;
 
         APIC();
 };
@@ -42,6 +42,7 @@ class PCIBus {
         // the configuration space is 256 byte, split in 32-bit words
         // word is expressed in term of 32-bit word indices, not bytes
         static uint32_t readword(const endpoint_t&, uint8_t word);
+        static void writeword(const endpoint_t&, uint8_t word, uint32_t value);
 
         // the common portion of a PCI config space
         struct ident_t {
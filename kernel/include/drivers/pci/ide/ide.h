@@ -21,6 +21,8 @@
 #include <kernel/sys/nocopy.h>
 #include <kernel/sys/stdint.h>
 #include <kernel/fs/vol/diskctrl.h>
+#include <kernel/synch/waitqueue.h>
+#include <kernel/i386/cpustate.h>
 
 class IDEController : public PCIBus::PCIDevice, public DiskController {
     public:
@@ -78,6 +80,8 @@ class IDEController : public PCIBus::PCIDevice, public DiskController {
                     sata,
                 } kind;
                 uint8_t modes;
+                uint8_t mwdmamodes;
+                uint8_t udmamodes;
                 uint8_t serial[21];
                 uint16_t signature;
                 uint16_t features;
@@ -87,11 +91,54 @@ class IDEController : public PCIBus::PCIDevice, public DiskController {
             } devices[2];
         };
 
+        // a physical region descriptor; the bus master walks a table of these, stopping at the
+        // entry marked as the end of the table
+        struct prd_t {
+            uint32_t base;
+            uint16_t size; // 0 means 64KB
+            uint16_t flags;
+        } __attribute__((packed));
+
+        // bus master state for one channel; DMA goes through a physically contiguous bounce buffer,
+        // since the caller's buffer may be in userspace, and need not even be mapped once the process
+        // that issued the request goes to sleep waiting for the IRQ
+        struct dma_channel_t {
+            bool enabled;
+            uint8_t irq;
+            uint16_t iobase;
+            uint16_t master;
+
+            uintptr_t prdtphys;
+            prd_t* prdt;
+            uintptr_t bufferphys;
+            unsigned char* buffer;
+
+            volatile bool done;
+            volatile uint8_t status;
+            WaitQueue irqwq;
+
+            // requests on a channel have to be serialized now that a request can sleep
+            bool busy;
+            WaitQueue lockwq;
+        };
+
         channel_t mChannel[2];
+        dma_channel_t mDMA[2];
 
         size_t configurepio();
+        size_t configuredma();
         void sendDisksToManager();
 
+        bool usedma(const disk_t&) const;
+        void lock(channelid_t);
+        void unlock(channelid_t);
+
+        bool transfer(const disk_t& disk, uint32_t sec0, uint16_t num, unsigned char* buffer, bool towrite);
+        bool dodma(const disk_t& disk, uint32_t sec0, uint8_t num, unsigned char* buffer, bool towrite);
+        void waitdma(channelid_t);
+        static void completedma(dma_channel_t*, uint8_t bmstatus);
+        static uint32_t onIRQ(GPR&, InterruptStack&, void*);
+
         bool preparepio(const disk_t&, const pio_op_params_t&);
 
         bool doread(const disk_t& disk, uint32_t sec0, uint8_t num, unsigned char *buffer);
@@ -38,6 +38,7 @@ class FATFileSystem : public Filesystem {
         void doClose(FilesystemObject*) override;
 
         bool fillInfo(filesystem_info_t*) override;
+        bool absent(const char* path) override;
 
     private:
         FATFS mFatFS;
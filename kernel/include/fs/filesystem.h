@@ -24,6 +24,8 @@
 #include <kernel/sys/nocopy.h>
 #include <kernel/synch/waitobj.h>
 
+struct pagecache_file_t;
+
 class Filesystem : NOCOPY {
     public:
         class FilesystemObject : NOCOPY {
@@ -58,14 +60,34 @@ class Filesystem : NOCOPY {
                 virtual size_t write(size_t, char*) = 0;
 
                 virtual WaitableObject* waitable();
+
+                // what can be waited on for this file to become ready, if anything; by default, the
+                // waitable. ready() returns the poll_event_t bits that hold right now, and a file that
+                // has nothing to wait on is always ready to be read and written
+                virtual Pollable* pollable();
+                virtual uint32_t ready();
                 virtual uintptr_t ioctl(uintptr_t, uintptr_t);
 
                 static bool classof(const FilesystemObject*);
 
-                virtual ~File() = default;
+                // files whose contents can only change through this kernel can be kept in the page cache
+                virtual bool cacheable() const;
+                pagecache_file_t* pagecache() const;
+                void pagecache(pagecache_file_t*);
+
+                // files whose pages are mapped as they are into every process that mmap()s them, rather
+                // than read in as private copies; sharedPage() returns the physical page behind offset,
+                // or 0 if offset is past the end of the file
+                virtual bool sharedMemory() const;
+                virtual uintptr_t sharedPage(size_t offset);
+
+                virtual ~File();
 
             protected:
                 File();
+
+            private:
+                pagecache_file_t* mPageCache;
         };
 
         class Directory : public FilesystemObject {
@@ -97,6 +119,12 @@ class Filesystem : NOCOPY {
 
         virtual bool fillInfo(filesystem_info_t*) { return false; }
 
+        // true only if nothing exists at path, and something can only come to exist there by way of
+        // an open(), mkdir() or del() that goes through the VFS; the VFS then remembers the answer
+        // until one of those calls touches path. Filesystems whose contents change by other means keep
+        // the default, and every lookup reaches them
+        virtual bool absent(const char*) { return false; }
+
         uint32_t refcount() const;
         uint32_t incref();
         uint32_t decref();
@@ -66,6 +66,7 @@ class Initrd : public Filesystem {
         void doClose(FilesystemObject*) override;
 
         bool fillInfo(filesystem_info_t*) override;
+        bool absent(const char* path) override;
 };
 
 #endif
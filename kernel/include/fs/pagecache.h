@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FS_PAGECACHE
+#define FS_PAGECACHE
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+#include <kernel/libc/slist.h>
+#include <kernel/fs/filesystem.h>
+
+struct pagecache_page_t;
+
+// the cached state of one file, keyed by filesystem and path; it is shared by every
+// open handle to the file, and it goes stale (and stops being used) once the file is written to
+struct pagecache_file_t {
+    Filesystem* fs;
+    char* path;
+    uint32_t size; /** size of the file when it was first opened */
+    uint64_t time; /** modification time of the file when it was first opened */
+    size_t numpages;
+    pagecache_page_t** pages; /** resident page for each page of the file, nullptr if not cached */
+    size_t resident;
+    uint32_t refcount; /** open files attached to this entry, plus one while the cache holds it */
+    bool stale;
+};
+
+// a page-granular cache of file contents; read(), mmap() faults and the ELF loader all go
+// through it, so that a page of a file is read from disk once and can be mapped by any number
+// of processes. Pages are evicted in LRU order when physical memory runs low
+class PageCache : NOCOPY {
+    public:
+        // how many cached files with no open handle are kept around
+        static constexpr size_t gMaxIdleFiles = 64;
+
+        static PageCache& get();
+
+        // attach a newly opened file to the cache entry for path on fs; files open for writing
+        // are attached to a stale entry, so that their writes can invalidate the cached contents
+        void attach(Filesystem* fs, const char* path, Filesystem::File* file, bool writable);
+        void release(pagecache_file_t*);
+
+        // the file at path on fs has changed; drop the cached contents
+        void invalidate(Filesystem* fs, const char* path);
+        void written(Filesystem::File*);
+
+        // reads from the current position of file, going through the cache if file is attached to it
+        size_t read(Filesystem::File* file, size_t len, char* dest);
+
+        // returns the entry for file, or nullptr if file is not cached
+        pagecache_file_t* entry(Filesystem::File* file) const;
+
+        // returns the physical page holding the page at offset in the file, or 0 if it is not cached;
+        // if found, a reference to the physical page is taken on behalf of the caller
+        uintptr_t lookup(pagecache_file_t*, size_t offset);
+
+        // the page at offset in the file has been read into phys; the cache takes its own reference
+        void insert(pagecache_file_t*, size_t offset, uintptr_t phys);
+
+        // is the page at offset in the cache?
+        bool contains(pagecache_file_t*, size_t offset) const;
+
+        // is phys the cached copy of the page at offset?
+        bool isShared(pagecache_file_t*, size_t offset, uintptr_t phys) const;
+
+        // evict up to npages pages that no process has mapped; returns the number of pages freed
+        size_t reclaim(size_t npages);
+
+        size_t numFiles() const;
+        size_t residentPages() const;
+        uint64_t hits() const;
+        uint64_t misses() const;
+        uint64_t evictions() const;
+
+    private:
+        PageCache();
+
+        pagecache_file_t* acquire(Filesystem* fs, const char* path, const file_stat_t& stat);
+        void destroy(pagecache_file_t*);
+        void evict(pagecache_page_t*);
+        void trim();
+        void lowMemoryCheck();
+
+        void lruAppend(pagecache_page_t*);
+        void lruRemove(pagecache_page_t*);
+
+        slist<pagecache_file_t*> mFiles; /** least recently opened first */
+        pagecache_page_t* mLRUHead; /** least recently used page */
+        pagecache_page_t* mLRUTail; /** most recently used page */
+        pagecache_page_t* mFreeNodes; /** so that eviction never needs to free() */
+        size_t mResident;
+        uint64_t mHits;
+        uint64_t mMisses;
+        uint64_t mEvictions;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FS_PATHCACHE
+#define FS_PATHCACHE
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+#include <kernel/fs/filesystem.h>
+
+// remembers which filesystem a path lives on, where the part of the path that filesystem sees
+// begins and whether the filesystem said the path does not exist (see Filesystem::absent).
+// A leading / is ignored; entries are direct-mapped by a hash of the whole path, so a lookup is
+// one probe and one comparison, and a path that collides with a cached one takes its place
+class PathCache : NOCOPY {
+    public:
+        static constexpr size_t gNumEntries = 256;
+
+        struct resolution_t {
+            Filesystem* fs;
+            size_t offset; /** where the filesystem-relative path begins */
+            bool absent; /** nothing exists at this path */
+        };
+
+        static uint32_t hash(const char* s, size_t len);
+
+        PathCache();
+
+        bool find(const char* path, resolution_t* res);
+        void insert(const char* path, const resolution_t& res);
+
+        // nothing exists at path, which must be in the cache already
+        void missing(const char* path);
+        // a lookup was answered from a missing() entry without asking the filesystem
+        void absent();
+
+        // forget every path on fs that is at, or below, path (relative to fs)
+        void invalidate(Filesystem* fs, const char* path);
+        // forget every path; needed whenever the set of mounted filesystems changes
+        void flush();
+
+        uint64_t hits() const;
+        uint64_t misses() const;
+        uint64_t absences() const;
+        uint64_t invalidations() const;
+        size_t count() const;
+
+    private:
+        struct entry_t {
+            char* path; /** nullptr if the entry is empty */
+            size_t len;
+            uint32_t hash;
+            resolution_t res;
+        };
+
+        entry_t* lookup(const char* path);
+        void drop(entry_t&);
+
+        entry_t mEntries[gNumEntries];
+        size_t mCount;
+        uint64_t mHits;
+        uint64_t mMisses;
+        uint64_t mAbsences;
+        uint64_t mInvalidations;
+};
+
+#endif
@@ -21,9 +21,12 @@
 #include <kernel/sys/nocopy.h>
 #include <kernel/fs/filesystem.h>
 #include <kernel/libc/slist.h>
+#include <kernel/libc/hash.h>
 #include <kernel/fs/vol/volume.h>
 #include <kernel/libc/pair.h>
 #include <kernel/fs/fsidents.h>
+#include <kernel/fs/pathcache.h>
+#include <kernel/syscalls/types.h>
 
 class VFS : NOCOPY {
     public:
@@ -58,6 +61,8 @@ class VFS : NOCOPY {
         filehandle_t opendir(const char* path);
 
         static bool isAbsolutePath(const char* path);
+
+        void cacheStats(vfs_cache_stats_t*);
     private:
         struct mount_t {
             const char* path;
@@ -65,13 +70,31 @@ class VFS : NOCOPY {
             Volume *volume;
             Filesystem* fs;
         };
-        slist<mount_t> mMounts;
+
+        // a mount point is a single path component; names point into the paths owned by mMounts
+        struct mount_name_t {
+            const char* name;
+            size_t len;
+        };
+        struct mount_name_helper {
+            static size_t index(const mount_name_t& n);
+            static bool eq(const mount_name_t& n1, const mount_name_t& n2);
+        };
+        static constexpr size_t gMountBuckets = 31;
+
+        slist<mount_t> mMounts; /** in the order they were mounted, which is how / lists them */
+        hash<mount_name_t, mount_t, mount_name_helper, mount_name_helper, gMountBuckets> mMountTable;
+        size_t mNumMounts;
+        PathCache mPaths;
         VFS();
 
+        void addMount(const mount_t&);
+        bool findMount(const char* name, size_t len, mount_t* m);
         mount_t findMountInfo(Volume*);
         fs_ident_t::mount_result_t doMountVolume(Volume* vol, const char* where);
 
-        pair<Filesystem*, const char*> getfs(const char* root);
+        // if absent is given, it is set to whether the path is known not to exist
+        pair<Filesystem*, const char*> getfs(const char* root, bool* absent = nullptr);
 
         friend class RootDirectory;
 };
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FS_VOL_BLOCKCACHE
+#define FS_VOL_BLOCKCACHE
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+
+class Volume;
+
+// a cache of fixed-size blocks of a volume; blocks are found through an open-addressed hash table
+// and kept in LRU order on an intrusive doubly-linked list, so that a hit, a miss and an eviction
+// all take constant time. In write-back mode a write only dirties the cached block, and dirty
+// sectors reach the disk when their block is evicted or the cache is flushed
+class BlockCache : NOCOPY {
+    public:
+        static constexpr size_t gBlockSize = 4096;
+        static constexpr size_t gMaxSectorsPerBlock = 8; // one bit per sector in block_t::valid and block_t::dirty
+
+        struct stats_t {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+            uint64_t writebacks; /** sectors written to disk by a flush or an eviction */
+            uint64_t bypassed; /** sectors moved by requests large enough to skip the cache */
+            size_t dirty; /** blocks holding sectors not yet written to disk */
+            size_t resident;
+            size_t capacity;
+        };
+
+        explicit BlockCache(Volume* vol);
+        ~BlockCache();
+
+        // serve cached sectors from memory, and read each run of uncached ones with a single
+        // request to the volume; requests of at least the bypass size go straight to the volume
+        bool read(uint32_t sector, uint32_t count, unsigned char* buffer);
+
+        // in write-through mode, and for requests of at least the bypass size, the volume is
+        // written with a single request before returning; otherwise the sectors are only dirtied
+        bool write(uint32_t sector, uint32_t count, unsigned char* buffer);
+
+        // write every dirty sector back to disk
+        bool flush();
+
+        const stats_t& stats() const;
+
+    private:
+        static constexpr uint32_t gNone = 0xFFFFFFFF;
+
+        struct block_t {
+            uint32_t id; /** first sector in the block divided by the number of sectors per block */
+            uint32_t prev;
+            uint32_t next;
+            uint8_t valid;
+            uint8_t dirty;
+        };
+
+        // the sector size is not known until the volume is fully constructed, so set up on first use
+        bool configure();
+
+        unsigned char* data(uint32_t idx, uint32_t sector = 0);
+        uint32_t home(uint32_t id) const;
+        uint32_t find(uint32_t id) const;
+        void hashInsert(uint32_t id, uint32_t idx);
+        void hashErase(uint32_t id);
+
+        void lruRemove(uint32_t idx);
+        void lruPush(uint32_t idx);
+
+        // returns a block for id, evicting the least recently used one if the cache is full
+        uint32_t allocate(uint32_t id);
+        void discard(uint32_t idx);
+        bool writeback(uint32_t idx);
+        void touch(uint32_t idx);
+
+        bool contains(uint32_t sector) const;
+        bool bypass(uint32_t count) const;
+
+        // copy sector to buffer if it is cached
+        bool hit(uint32_t sector, unsigned char* buffer);
+        // read an uncached sector into the cache, along with the rest of its block if that is new
+        bool fetch(uint32_t sector, unsigned char* buffer);
+        // buffer now matches what the volume holds; update the cached copy, and add it if add is true
+        void fill(uint32_t sector, uint32_t count, const unsigned char* buffer, bool add);
+        // copy dirty sectors over data that was read from the volume without going through the cache
+        void overlay(uint32_t sector, uint32_t count, unsigned char* buffer);
+
+        Volume* mVolume;
+        bool mConfigured;
+        bool mWriteBack;
+        uint32_t mSectorSize;
+        uint32_t mSectorsPerBlock;
+        uint32_t mBypassSectors;
+        uint32_t mHashMask;
+
+        block_t* mBlocks;
+        unsigned char* mData;
+        uint32_t* mHash; /** block index for each slot, or gNone */
+
+        uint32_t mHead; /** most recently used */
+        uint32_t mTail; /** least recently used */
+        uint32_t mFree; /** unused blocks, linked through block_t::next */
+
+        stats_t mStats;
+};
+
+#endif
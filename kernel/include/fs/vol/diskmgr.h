@@ -36,6 +36,9 @@ class DiskManager : NOCOPY {
         iterable_vector_view<DiskController*> controllers();
         iterable_vector_view<Disk*> disks();
         iterable_vector_view<Volume*> volumes();
+
+        // write back the cached sectors of every volume; returns false if any of them failed
+        bool flush();
     private:
         DiskManager();
 
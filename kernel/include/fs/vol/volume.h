@@ -19,7 +19,7 @@
 
 #include <kernel/sys/stdint.h>
 #include <kernel/sys/nocopy.h>
-#include <kernel/fs/vol/lru.h>
+#include <kernel/fs/vol/blockcache.h>
 #include <kernel/libc/str.h>
 #include <kernel/fs/memfs/memfs.h>
 #include <kernel/libc/buffer.h>
@@ -45,6 +45,9 @@ class Volume : NOCOPY {
         virtual size_t numsectors() const = 0;
         virtual size_t sectorsize() const { return 512; }
 
+        // write back any sectors that the cache is holding on to
+        bool flush();
+
         virtual uintptr_t ioctl(uintptr_t, uintptr_t);
 
         virtual MemFS::File* file();
@@ -57,17 +60,11 @@ class Volume : NOCOPY {
         Disk *mDisk;
         string mId;
 
-        // TODO: the sector size is not always a compile-time constant value of 512
-        LRUCache<> mCache;
+        BlockCache mCache;
 
         uint64_t mNumSectorsRead;
         uint64_t mNumSectorsWritten;
 
-        uint64_t mNumSectorCacheHits;
-
-        bool tryReadSector(uint32_t sector, unsigned char* buffer, bool tryReadCache = true, bool updateCache = true);
-        bool tryWriteSector(uint32_t sector, unsigned char* buffer, bool updateCache = true);
-
         void readAccounting(uint16_t sectors);
         void writeAccounting(uint16_t sectors);
 };
@@ -47,6 +47,7 @@ public:
 		void* payload;
 		WaitQueue* wq;
 		uint64_t count;
+		bool lockless; /** runs without taking the big kernel lock - must not touch shared kernel state */
 		explicit operator bool();
 		handler_t();
 	};
@@ -60,11 +61,14 @@ public:
 
 	bool enabled();
 	
+	// how many hardware interrupt handlers the current CPU is nested inside; system calls and
+	// exceptions run on behalf of the process that raised them, which may sleep, so they don't count
 	uint32_t irqDepth() const;
 
 	void sethandler(uint8_t irq, const char* name, handler_t::irq_handler_f = nullptr, void* = nullptr, WaitQueue* wq = nullptr);
 	void setWakeQueue(uint8_t irq, WaitQueue* = nullptr);
 	void setFlags(uint8_t irq, bool userspace, bool mask);
+	void setLockless(uint8_t irq, bool lockless = true);
 
 	uint64_t getNumOccurrences(uint8_t irq);
 	const char* getName(uint8_t irq);
@@ -106,8 +106,13 @@ void writetaskreg(uint16_t seg);
 extern "C"
 uint16_t readtaskreg();
 
+// saves the running kernel context and stores its stack pointer in *from, then resumes the context saved at to
 extern "C"
-void ctxswitch();
+void ctxswitch(uintptr_t* from, uintptr_t to);
+
+// first code to run in a context built by ProcessManager; pops the entry point, enables IRQs and jumps there
+extern "C"
+void ctxstart();
 
 extern "C"
 void iowait();
@@ -154,6 +159,9 @@ void writemsr(uint32_t reg, uint64_t value);
 extern "C"
 void haltforever();
 
+extern "C"
+void waitforirq();
+
 extern "C"
 uint32_t readfpsw();
 
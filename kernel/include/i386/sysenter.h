@@ -0,0 +1,43 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef I386_SYSENTER
+#define I386_SYSENTER
+
+#include <kernel/sys/stdint.h>
+
+struct cpu_t;
+
+// sysenter/sysexit is a cheaper way into and out of the kernel than int 0x80; it lands in
+// sysenter_entry (see sysenter.s), which builds the same frame the syscall IRQ would, so
+// system calls are dispatched by the same handler table whichever way they come in
+namespace Sysenter {
+    // an error code no real int 0x80 frame carries; it tells the syscall handler
+    // that eip still has to be fetched from the user stack
+    static constexpr uint32_t gFrameMarker = 0x5E;
+
+    static constexpr uint32_t gMSRCodeSegment = 0x174;
+    static constexpr uint32_t gMSRStack = 0x175;
+    static constexpr uint32_t gMSREntryPoint = 0x176;
+
+    // whether this machine supports sysenter; some early processors report the feature without having it
+    bool supported();
+
+    // programs the MSRs of the CPU this runs on; cpu must be that same CPU
+    bool setup(cpu_t& cpu);
+}
+
+#endif
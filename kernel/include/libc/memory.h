@@ -34,6 +34,16 @@ void* calloc(size_t num, size_t len);
 extern "C"
 void* realloc(void *ptr, size_t new_size);
 
+struct malloc_large_stats_t {
+    size_t reserved; // bytes obtained from the kernel heap for large allocations
+    size_t inuse; // bytes currently handed out to large allocations
+    uint64_t allocs;
+    uint64_t frees;
+};
+
+// statistics for allocations too large to be served by a slab cache
+void malloc_large_stats(malloc_large_stats_t*);
+
 template <typename T>
 void* operator new(size_t, T* ptr) { return ptr; }
 
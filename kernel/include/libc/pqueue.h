@@ -92,6 +92,26 @@ private:
         down(0);
         return t;
     }
+
+    // drops every entry for which pred returns true, then rebuilds the heap; O(n)
+    template<typename Predicate>
+    size_t remove(Predicate pred) {
+        size_t removed = 0;
+        idx_t idx = 0;
+        while (idx < size()) {
+            if (pred(at(idx))) {
+                at(idx) = mData.back();
+                mData.pop_back();
+                ++removed;
+            } else {
+                ++idx;
+            }
+        }
+        if (removed) {
+            for (idx = size() / 2; idx > 0; --idx) down(idx - 1);
+        }
+        return removed;
+    }
 };
 
 #endif
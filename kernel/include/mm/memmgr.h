@@ -34,7 +34,8 @@ class MemoryManager : NOCOPY {
             permission_t permission;
             struct {
                 VFS::filehandle_t fhandle;
-                size_t size;
+                size_t size; /** number of bytes of the file mapped, starting at from */
+                size_t offset; /** offset in the file that is mapped at from */
             } mmap_data;
 
             region_t (uintptr_t = 0, uintptr_t = 0, permission_t = permission_t::kernel());
@@ -66,6 +67,10 @@ class MemoryManager : NOCOPY {
         // here lie dragons - these calls always assume that the mapping is sane and do no checking
         region_t addMappedRegion(uintptr_t from, uintptr_t to);
         region_t addUnmappedRegion(uintptr_t from, uintptr_t to);
+        region_t addZeroPageRegion(uintptr_t from, uintptr_t to, const VirtualPageManager::map_options_t&);
+        // size bytes of the file, starting at offset, are read in at from on first access;
+        // the rest of the region is zero-filled
+        region_t addFileMapRegion(uintptr_t from, uintptr_t to, VFS::filehandle_t, size_t offset, size_t size, const VirtualPageManager::map_options_t&);
 
         // remove this region - and unmap all pages of it
         void removeRegion(region_t region);
@@ -75,6 +80,10 @@ class MemoryManager : NOCOPY {
         // to let go of mmap() files
         void cleanupAllRegions();
 
+        // puts pages of shared memory files back to the zero page, so that they are faulted in again;
+        // done before cloning the address space, which would otherwise make them copy-on-write
+        void releaseSharedPages();
+
         uintptr_t getTotalRegionsSize() const;
 
         void clone(MemoryManager*) const;
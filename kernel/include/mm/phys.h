@@ -42,9 +42,19 @@ public:
 
 	// allocate "num" contiguous pages of physical memory; return true if found and
 	// *base == initial allocated byte (so it's [base, base+num*gPageSize-1])
-	// if false, nothing was allocated
+	// if false, nothing was allocated; power-of-two runs of up to 32 pages are naturally aligned
 	bool allocContiguousPages(size_t num, uintptr_t *base);
 
+	// fill counts[k] with the number of free, naturally aligned, blocks of 2^k pages that
+	// free memory decomposes into (larger blocks are counted as multiple gMaxBlockOrder blocks)
+	static constexpr size_t gMaxBlockOrder = 10;
+	void freeblocks(size_t *counts);
+
+	// called when alloc() finds no free page, to give caches a chance to let go of some memory;
+	// returns how many pages it was able to free
+	using reclaimer_f = size_t(*)(size_t npages);
+	void reclaimer(reclaimer_f);
+
 	size_t gettotalpages() const;
 	size_t getfreepages() const;
 	
@@ -63,12 +73,39 @@ private:
 		ref decref();
 	};
 	PhysicalPageManager();
+
+	// free pages are tracked by a hierarchical bitmap; a bit at level N+1 is set iff the
+	// corresponding word at level N has at least one bit set, so finding a free page takes
+	// one bit scan per level, and freeing or allocating a page only touches the levels above
+	// it when a word transitions between empty and non-empty
+	static constexpr size_t gBitsPerWord = 32;
+	static constexpr size_t gBitmapLevels = 4;
+	static constexpr size_t gNumL0Words = gNumPages / gBitsPerWord;
+	static constexpr size_t gNumL1Words = gNumL0Words / gBitsPerWord;
+	static constexpr size_t gNumL2Words = gNumL1Words / gBitsPerWord;
+	static_assert(gNumL2Words <= gBitsPerWord, "top level of the bitmap must fit in one word");
+
+	uint32_t* bitmap(size_t level);
+	void markFree(size_t idx);
+	void markUsed(size_t idx);
+	bool findFree(size_t *idx);
+	bool findRunInWord(size_t num, size_t *idx);
+	bool findRunOfWords(size_t num, size_t *idx);
+
 	phys_page_t mPages[gNumPages];
-	size_t mLastChecked;
+	uint32_t mBitmapL0[gNumL0Words];
+	uint32_t mBitmapL1[gNumL1Words];
+	uint32_t mBitmapL2[gNumL2Words];
+	uint32_t mBitmapL3;
+	// bit set iff the corresponding L0 word is entirely free, i.e. 32 free contiguous pages
+	uint32_t mFullWords[gNumL1Words];
 	size_t mTotalPages;
 	size_t mLowestPage; // lowest page index that exists
 	size_t mHighestPage; // highest page index that exists
 	atomic<size_t> mFreePages;
+
+	reclaimer_f mReclaimer;
+	bool mReclaiming;
 };
 
 #endif
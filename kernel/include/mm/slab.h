@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MM_SLAB
+#define MM_SLAB
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+#include <kernel/mm/virt.h>
+
+// a size-class allocator for small kernel objects; every slab is one page of kernel heap
+// carved into objects of the same size. Slab metadata is kept out-of-line (indexed by heap page)
+// so that objects can use the entire page and free() can find the owning slab in O(1)
+class SlabAllocator : NOCOPY {
+    public:
+        static constexpr size_t gMinObjectSize = 16;
+        static constexpr size_t gMaxObjectSize = 2048;
+        static constexpr size_t gNumCaches = 8; // 16, 32, 64, ..., 2048
+
+        // how many fully empty slabs a cache holds on to before giving them back to the shared pool
+        static constexpr size_t gMaxEmptySlabsPerCache = 1;
+
+        struct cache_stats_t {
+            size_t objsize;
+            size_t slabs;
+            size_t emptyslabs;
+            size_t capacity;
+            size_t inuse;
+            uint64_t allocs;
+            uint64_t frees;
+        };
+
+        static SlabAllocator& get();
+
+        // returns nullptr if size is larger than gMaxObjectSize
+        void* alloc(size_t size);
+
+        // returns false if ptr was not allocated by a slab, so the caller can release it elsewhere
+        bool free(void* ptr);
+
+        // returns the usable size of the object at ptr, or 0 if ptr was not allocated by a slab
+        size_t usableSize(void* ptr);
+
+        bool stats(size_t cache, cache_stats_t* stats);
+        size_t pooledPages() const;
+
+    private:
+        static constexpr size_t gNumHeapPages = VirtualPageManager::gKernelHeapSize / VirtualPageManager::gPageSize;
+        static constexpr uint16_t gNoSlab = 0xFFFF;
+        static_assert(gNumHeapPages < gNoSlab, "heap page indices must fit in 16 bits");
+
+        struct slab_t {
+            void* freelist;
+            uint16_t prev;
+            uint16_t next;
+            uint16_t inuse;
+            uint8_t cache; // 1-based; 0 means this page is not a slab
+        };
+
+        struct cache_t {
+            size_t objsize;
+            size_t perslab;
+            uint16_t partial; // slabs with some objects in use and some free
+            uint16_t empty; // slabs with no objects in use
+            size_t numslabs;
+            size_t numempty;
+            size_t inuse;
+            uint64_t allocs;
+            uint64_t frees;
+        };
+
+        SlabAllocator();
+
+        uint16_t index(uintptr_t page) const;
+        uintptr_t address(uint16_t idx) const;
+        bool owned(void* ptr, uint16_t* idx) const;
+
+        void link(uint16_t* head, uint16_t idx);
+        void unlink(uint16_t* head, uint16_t idx);
+
+        uint16_t newslab(uint8_t cacheid);
+        void releaseslab(uint16_t idx);
+
+        uintptr_t mHeapBase;
+        cache_t mCaches[gNumCaches];
+        slab_t mSlabs[gNumHeapPages];
+        uint16_t mPool; // free pages previously used as slabs, linked through slab_t::next
+        size_t mPoolSize;
+};
+
+#endif
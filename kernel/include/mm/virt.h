@@ -44,6 +44,7 @@ public:
 		DECLARE_OPTION(bool, cow);
 		DECLARE_OPTION(bool, cached);
 		DECLARE_OPTION(bool, global);
+		DECLARE_OPTION(bool, zeroed); // the physical page is known to be all zeros already, so clear() is free
 
 		#undef DECLARE_OPTION
 
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MM_ZEROPOOL
+#define MM_ZEROPOOL
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+
+// a stash of physical pages that are known to contain only zeros; the zeroer task fills it
+// in the background, so that mappings which ask for a cleared page don't need to bzero() it
+class ZeroPagePool : NOCOPY {
+    public:
+        static constexpr size_t gMaxPages = 1024;
+
+        static ZeroPagePool& get();
+
+        // the pool can be used before the kernel command line is parsed, but it will stay
+        // empty until this call reads the watermarks from the kernel configuration
+        void configure();
+
+        // returns true and a zeroed physical page (refcount 1) if one is available
+        bool take(uintptr_t *phys);
+
+        // zero one more page and add it to the pool; returns false if the pool is full
+        // or there is not enough free physical memory to spare for the pool
+        bool fillOne();
+
+        bool belowLowWatermark() const;
+        bool belowHighWatermark() const;
+
+        size_t size() const;
+        size_t low() const;
+        size_t high() const;
+        uint64_t hits() const;
+        uint64_t misses() const;
+
+    private:
+        ZeroPagePool();
+
+        uintptr_t mPages[gMaxPages];
+        size_t mSize;
+        size_t mLowWatermark;
+        size_t mHighWatermark;
+        uint64_t mHits;
+        uint64_t mMisses;
+};
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PROCESS_CPU
+#define PROCESS_CPU
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+#include <kernel/i386/tss.h>
+
+struct process_t;
+
+// the kernel's view of one processor; the boot CPU is always index 0
+struct cpu_t {
+    uint8_t index;
+    uint8_t apicid;
+    bool online;
+    process_t* current; /** the process running on this CPU - gCurrentProcess refers to this field */
+    process_t* idle; /** what this CPU runs when it has nothing ready and nothing to steal */
+    TaskStateSegment tss;
+    volatile uintptr_t shootdown; /** a page this CPU was asked to invalidate, or CPUs::gNoShootdown */
+    uint32_t irqdepth; /** how many hardware interrupt handlers this CPU is nested inside */
+    uint64_t lastcharge; /** uptime, in milliseconds, up to which runtime has been charged on this CPU */
+    struct {
+        uint64_t busy; /** milliseconds spent running processes */
+        uint64_t idle; /** milliseconds spent in the idle process */
+        uint64_t steals; /** processes taken from another CPU's ready queue */
+    } stats;
+};
+
+class CPUs : NOCOPY {
+    public:
+        static constexpr size_t gMaxCPUs = 8;
+        // each CPU has its own TSS descriptor, in GDT order - see loader.s
+        static constexpr size_t gFirstTSSIndex = 5;
+        // page addresses are aligned, so this can never be one
+        static constexpr uintptr_t gNoShootdown = 1;
+
+        static constexpr uint8_t gRescheduleIRQ = 0xA1;
+        static constexpr uint8_t gShootdownIRQ = 0xA2;
+
+        static CPUs& get();
+
+        // each CPU loads its own TSS selector in the task register, so reading that back is a cheap way
+        // to know which CPU is running; before the boot CPU loads its TSS, this reads as 0
+        static size_t currentIndex() {
+            uint16_t tr;
+            __asm__ volatile("str %0" : "=r"(tr));
+            tr >>= 3;
+            return tr < gFirstTSSIndex ? 0 : tr - gFirstTSSIndex;
+        }
+
+        static cpu_t& current() {
+            return gCPUs[currentIndex()];
+        }
+
+        cpu_t& cpu(size_t index);
+
+        // CPUs that have been added - including the boot CPU - whether or not they made it online
+        size_t count() const;
+        size_t online() const;
+
+        // claims the next free slot for the processor with the given local APIC ID; nullptr if all are taken
+        cpu_t* add(uint8_t apicid);
+        void setOnline(cpu_t&);
+
+        // makes sure no CPU other than this one holds a stale TLB entry for virt, waiting until they all
+        // have dropped it; CPUs that are spinning on the big kernel lock serve the request from there
+        void shootdown(uintptr_t virt);
+        void serviceShootdown();
+
+        // kicks an idle CPU into looking at its ready queue
+        void reschedule(cpu_t&);
+
+    private:
+        CPUs();
+
+        static cpu_t gCPUs[gMaxCPUs];
+
+        size_t mCount;
+        size_t mOnline;
+};
+
+#endif
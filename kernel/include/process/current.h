@@ -2,7 +2,9 @@
 #define PROCESS_CURRENT
 
 #include <kernel/process/process.h>
+#include <kernel/process/cpu.h>
 
-extern process_t *gCurrentProcess;
+// each CPU runs its own process; this names the one running on the CPU that evaluates it
+#define gCurrentProcess (CPUs::current().current)
 
 #endif
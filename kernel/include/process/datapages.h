@@ -0,0 +1,47 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PROCESS_DATAPAGES
+#define PROCESS_DATAPAGES
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+#include <kernel/syscalls/types.h>
+
+// keeps kernel_data_t up to date, and maps it along with a process_data_t into userspace processes
+class DataPages : NOCOPY {
+    public:
+        static DataPages& get();
+
+        // maps both pages in the current address space, right before it first runs userspace code;
+        // a clone starts out with its parent's process page, and gets one of its own here
+        void attach();
+
+        void publishUptime(uint64_t millis);
+        void publishUNIXtime(uint64_t seconds, uint64_t micros);
+        void publishTSC(uint64_t ticksPerMs, uint64_t base, uint64_t baseMicros);
+
+    private:
+        DataPages();
+
+        void beginUpdate();
+        void endUpdate();
+
+        uintptr_t mPhysical;
+        kernel_data_t* mData;
+};
+
+#endif
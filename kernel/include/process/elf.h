@@ -67,12 +67,12 @@ struct elf_load_result_t {
 };
 
 extern "C" bool elf_can_load(uintptr_t load0);
-extern "C" process_loadinfo_t elf_do_load(uintptr_t load0, size_t stacksize);
+extern "C" process_loadinfo_t elf_do_load(uintptr_t load0, VFS::filehandle_t fhandle, size_t stacksize);
 
-elf_load_result_t load_elf_image(elf_header_t* header);
+elf_load_result_t load_elf_image(elf_header_t* header, VFS::filehandle_t fhandle);
 
 extern "C"
-process_loadinfo_t load_main_binary(elf_header_t* header, size_t stacksize);
+process_loadinfo_t load_main_binary(elf_header_t* header, VFS::filehandle_t fhandle, size_t stacksize);
 
 struct elf_program_t {
     uint32_t type;
@@ -18,6 +18,7 @@
 #define PROCESS_FILELOADER
 
 #include <kernel/sys/stdint.h>
+#include <kernel/fs/vfs.h>
 
 struct process_loadinfo_t {
     uintptr_t eip;
@@ -30,9 +31,13 @@ void fileloader(uintptr_t argument);
 extern "C"
 process_loadinfo_t load_binary(const char* path);
 
+// load_binary() only reads this many bytes from the start of the executable;
+// loaders are given the file itself to map or read anything else they need
+static constexpr size_t gExecHeaderSize = 4096;
+
 struct exec_format_loader_t {
     bool (*can_handle_f)(uintptr_t load0);
-    process_loadinfo_t (*load_f)(uintptr_t load0, size_t stack);
+    process_loadinfo_t (*load_f)(uintptr_t load0, VFS::filehandle_t fhandle, size_t stack);
 };
 
 extern exec_format_loader_t gExecutableLoaders[];
@@ -18,7 +18,6 @@
 #define PROCESS_MANAGER
 
 #include <kernel/sys/stdint.h>
-#include <kernel/i386/tss.h>
 #include <kernel/syscalls/types.h>
 #include <kernel/synch/semaphore.h>
 #include <kernel/libc/slist.h>
@@ -27,6 +26,7 @@
 #include <kernel/process/process.h>
 #include <kernel/sys/nocopy.h>
 #include <kernel/process/table.h>
+#include <kernel/process/readyqueue.h>
 #include <kernel/process/bitmap.h>
 #include <kernel/libc/pqueue.h>
 #include <kernel/libc/pair.h>
@@ -47,7 +47,6 @@ extern "C" process_t *gParentProcess();
 
 class ProcessManager : NOCOPY {
     public:
-        // this is tied to the size of the GDT table prepared in loader.s
         static constexpr size_t gNumProcesses = 2000;
 
         static exec_priority_t gDefaultBasePriority;
@@ -77,6 +76,7 @@ class ProcessManager : NOCOPY {
             bool schedulable; /** should this process be scheduled */
             bool system; /** is this a system process */
             bool clone; /** is this process a clone of its parent */
+            bool thread; /** is this process a thread sharing its creator's address space */
         };
 
         process_t *spawn(const spawninfo_t&);
@@ -87,18 +87,24 @@ class ProcessManager : NOCOPY {
         void tickForMetrics();
         void tickForSchedule(bool can_yield, bool* will_yield);
 
+        // switches from the current process to task; returns when the current process is next scheduled
         static void ctxswitch(process_t* task);
 
-        void resumeat(process_t* task, uintptr_t eip, uintptr_t esp, uint16_t cs, uint16_t ss);
+        void resumeat(process_t* task, uintptr_t eip, uintptr_t esp);
 
         kpid_t getpid();
         void yield(bool bytimer=false);
+
+        // sets up the idle process and TSS of a CPU other than the boot one, before it is started
+        void prepareCPU(cpu_t&);
+        // the idle loop of the calling CPU; never returns
+        void idle() __attribute__((noreturn));
         void sleep(uint32_t durationMs);
+        void usleep(uint64_t durationUs);
         void exit(process_exit_status_t);
         bool kill(kpid_t);
 
         kpid_t initpid();
-        kpid_t schedulerpid();
 
         process_t* getprocess(kpid_t pid);
 
@@ -111,14 +117,18 @@ class ProcessManager : NOCOPY {
         void wake(process_t*);
 
         void deschedule(process_t*, process_t::State, void* waitable);
+        // call after changing priority.scheduling.current, so that the scheduler sees the new ticket count
+        void reprioritize(process_t*);
         void enqueueForDeath(process_t*);
 
         PM_GLOBAL(ProcessBitmap<ProcessManager::gNumProcesses>, gPidBitmap);
-        PM_GLOBAL(ProcessBitmap<ProcessManager::gNumProcesses>, gGDTBitmap);
         PM_GLOBAL(ProcessTable<ProcessManager::gNumProcesses>, gProcessTable);
         PM_GLOBAL(ProcessTable<ProcessManager::gNumProcesses>, gExitedProcesses);
         PM_GLOBAL(slist<process_t*>, gCollectedProcessList);
-        PM_GLOBAL(vector<process_t*>, gReadyQueue);
+
+        // each CPU schedules from its own ready queue; the no-argument form is the current CPU's
+        static ReadyQueue<ProcessManager::gNumProcesses>& gReadyQueue();
+        static ReadyQueue<ProcessManager::gNumProcesses>& gReadyQueue(size_t cpu);
 
         class sleep_queue_helper {
             public:
@@ -134,6 +144,12 @@ class ProcessManager : NOCOPY {
 
         process_t* cloneProcess(uintptr_t eip, exec_fileop_t* fileops);
 
+        // starts a new thread in the current process, running eip(arg) on a stack of its own
+        process_t* cloneThread(uintptr_t eip, uintptr_t arg);
+        // ends the calling thread; a detached thread is handed to the collector instead of waiting
+        // to be joined. Called by a leader, waits for all other threads and then exits the process
+        void exitThread(bool detached);
+
         size_t numProcesses();
         void foreach(function<bool(const process_t*)>);
 
@@ -143,12 +159,15 @@ class ProcessManager : NOCOPY {
         ProcessManager();
 
         void reschedule(process_t*);
-        uint64_t fillGDT(process_t*);
         void forwardTTY(process_t*);
         void execFileops(process_t* parent, process_t *child, exec_fileop_t *fops);
 
-        void switchtoscheduler();
         void exit(process_t*, process_exit_status_t);
+        void exitThread(process_t*, process_exit_status_t);
+        bool kill(process_t*, process_exit_status_t);
+        void wakeCollectors(process_t* parent);
+        void armTimer(process_t* running);
+        bool steal(cpu_t& thief);
         
         uintptr_t mProcessPagesLow;
         uintptr_t mProcessPagesHigh;
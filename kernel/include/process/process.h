@@ -19,7 +19,6 @@
 
 #include <kernel/libc/bytesizes.h>
 #include <kernel/sys/stdint.h>
-#include <kernel/i386/tss.h>
 #include <kernel/tty/tty.h>
 #include <kernel/tty/file.h>
 #include <kernel/fs/handletable.h>
@@ -34,11 +33,15 @@
 
 struct process_t {
     static constexpr size_t gDefaultStackSize = 4_MB;
+    static constexpr size_t gDefaultThreadStackSize = 1_MB;
     using State = process_state_t;
 
-    TaskStateSegment tss;
-    size_t gdtidx;
-    uintptr_t cr0;
+    // all other registers live on the kernel stack while the process is switched out
+    struct context_t {
+        uintptr_t esp; /** kernel stack pointer saved by the last ctxswitch() away from this process */
+        uintptr_t esp0; /** stack the CPU switches to when this process enters the kernel from ring 3 */
+        uintptr_t cr3; /** the root of the address space */
+    } ctx;
     kpid_t pid;
     kpid_t ppid;
     const char* path;
@@ -69,9 +72,35 @@ struct process_t {
             uint64_t current;
         } scheduling;
     } priority;
-    uint8_t usedticks;
+    uint64_t quantumend; /** uptime, in microseconds, at which the current quantum runs out; 0 if it never does */
+    // links for ProcessManager's ready queue - only ReadyQueue should touch these
+    struct {
+        process_t* prev;
+        process_t* next;
+        uint64_t tickets; /** the tickets this process holds in the ready queue's lottery */
+        bool queued;
+    } ready;
     uint8_t fpstate[512] __attribute__((aligned(16))); // TODO: FPU state takes 108 bytes - could we dynamically shrink this?
-    Handletable<VFS::filehandle_t, 64> fds;
+    using fdtable_t = Handletable<VFS::filehandle_t, 64>;
+    fdtable_t filetable; /** the files opened by this process - unused by threads */
+    fdtable_t* fds; /** the file table in use: a process' own, or a thread's leader's */
+
+    /* threads share the address space, memory regions and open files of their leader;
+     * a process that is not a thread is its own leader */
+    process_t* leader;
+    struct {
+        uint16_t count; /** for a leader, how many threads share its address space */
+        uintptr_t stack; /** for a thread, the base of its user stack region */
+        uintptr_t arg; /** for a thread, the argument its entry point is called with */
+    } thread;
+
+    struct {
+        syscall_ring_t* ring; /** for a leader, the ring registered by ringsetup, if any */
+        uint32_t entries; /** the size of the ring at registration, as userspace could change it later */
+        process_t* poller; /** the kernel thread that drains the ring in POLL mode */
+        bool draining; /** some thread is running submissions, and no other one may start */
+        bool stopping; /** the poller is to exit, as the main thread is waiting for all others to be done */
+    } sysring;
 
     // initial values for esp0 and esp that were setup by the kernel
     // at initialization time - we need to free them when we're tearing down
@@ -95,6 +124,9 @@ struct process_t {
         uint32_t available; /** size of all regions mapped by this process */
         uint32_t allocated; /** size of all memory allocated by this process */
         uint32_t pagefaults; /** number of page faults triggered by this process */
+        uint32_t demandfaults; /** number of page faults resolved by mapping in the faulting page */
+        uint32_t faultaround; /** number of pages mapped in by fault-around ahead of being accessed */
+        uint32_t sharedpages; /** number of pages mapped from the page cache */
     } memstats;
 
     struct iostats_t {
@@ -107,9 +139,16 @@ struct process_t {
         uint64_t ctxswitches; /** number of times this process has been context switched */
     } runtimestats;
 
-    /* the system uptime that this process wants to sleep until */
+    /* the system uptime, in microseconds, that this process wants to sleep until */
     uint64_t sleeptill;
 
+    /* the CPU whose ready queue this process is in, or was last in */
+    uint8_t cpu;
+
+    /* how many kernel locks this process holds across sleeps (the FatFs grant, an IDE channel);
+     * killing it while any are held would abandon them, so the kill waits for the last release */
+    uint32_t heldlocks;
+
     /* each time a process sleeps or waits on something, this counter's value
      * gets associated to the wait event; when the wait ends, this counter is
      * increased. if someone tries to wake a process but the wait token they
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PROCESS_READYQUEUE
+#define PROCESS_READYQUEUE
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+#include <kernel/panic/panic.h>
+#include <kernel/process/process.h>
+#include <muzzle/string.h>
+
+// the set of processes that can be scheduled. Membership is an intrusive doubly-linked list threaded
+// through process_t::ready, so that insertion and removal never scan; alongside it, a Fenwick tree
+// indexed by pid keeps running totals of each process' tickets (priority.scheduling.current), so that
+// finding the holder of any given lottery ticket takes O(log n) instead of a walk of the whole queue
+template<size_t NumProcesses, typename PidType = kpid_t>
+class ReadyQueue : NOCOPY {
+    public:
+        ReadyQueue() {
+            bzero((uint8_t*)&mTree[0], sizeof(mTree));
+            bzero((uint8_t*)&mSlots[0], sizeof(mSlots));
+            mHead = mTail = nullptr;
+            mSize = 0;
+            mTickets = 0;
+        }
+
+        bool contains(const process_t* proc) const {
+            return proc->ready.queued;
+        }
+
+        // adds proc at the back of the queue; a process that is already queued is left where it is
+        void push(process_t* proc) {
+            if (proc->ready.queued) return;
+
+            proc->ready.queued = true;
+            proc->ready.next = nullptr;
+            proc->ready.prev = mTail;
+            if (mTail) mTail->ready.next = proc;
+            else mHead = proc;
+            mTail = proc;
+            ++mSize;
+
+            mSlots[proc->pid] = proc;
+            proc->ready.tickets = proc->priority.scheduling.current;
+            add(proc->pid, proc->ready.tickets);
+        }
+
+        void remove(process_t* proc) {
+            if (!proc->ready.queued) return;
+
+            if (proc->ready.prev) proc->ready.prev->ready.next = proc->ready.next;
+            else mHead = proc->ready.next;
+            if (proc->ready.next) proc->ready.next->ready.prev = proc->ready.prev;
+            else mTail = proc->ready.prev;
+            proc->ready.prev = proc->ready.next = nullptr;
+            proc->ready.queued = false;
+            --mSize;
+
+            // the tree is updated modulo 2^64, so "adding" the two's complement subtracts
+            add(proc->pid, -proc->ready.tickets);
+            proc->ready.tickets = 0;
+            mSlots[proc->pid] = nullptr;
+        }
+
+        // must be called whenever priority.scheduling.current changes for a queued process
+        void update(process_t* proc) {
+            if (!proc->ready.queued) return;
+
+            auto tickets = proc->priority.scheduling.current;
+            add(proc->pid, tickets - proc->ready.tickets);
+            proc->ready.tickets = tickets;
+        }
+
+        // moves proc to the back of the queue
+        void rotate(process_t* proc) {
+            if (!proc->ready.queued || proc == mTail) return;
+
+            if (proc->ready.prev) proc->ready.prev->ready.next = proc->ready.next;
+            else mHead = proc->ready.next;
+            proc->ready.next->ready.prev = proc->ready.prev;
+
+            proc->ready.next = nullptr;
+            proc->ready.prev = mTail;
+            mTail->ready.next = proc;
+            mTail = proc;
+        }
+
+        // returns the process that holds the n-th ticket, counting from zero in pid order;
+        // n must be less than tickets()
+        process_t* find(uint64_t n) const {
+            size_t pos = 0;
+            for (size_t step = gTopStep; step > 0; step >>= 1) {
+                auto next = pos + step;
+                if (next <= NumProcesses && mTree[next] <= n) {
+                    pos = next;
+                    n -= mTree[next];
+                }
+            }
+            // pos is now the number of leading slots whose tickets total at most the original n,
+            // so the winner is the slot right after them (tree index pos + 1, i.e. pid pos)
+            if (pos >= NumProcesses) return nullptr;
+            return mSlots[pos];
+        }
+
+        process_t* front() const {
+            return mHead;
+        }
+
+        // returns the first process, in queue order, for which pred returns true; nullptr if there is none
+        template<typename Predicate>
+        process_t* findFirst(Predicate pred) const {
+            for (auto proc = mHead; proc != nullptr; proc = proc->ready.next) {
+                if (pred(proc)) return proc;
+            }
+            return nullptr;
+        }
+
+        size_t size() const {
+            return mSize;
+        }
+
+        bool empty() const {
+            return mSize == 0;
+        }
+
+        uint64_t tickets() const {
+            return mTickets;
+        }
+
+    private:
+        static constexpr size_t topStep(size_t n) {
+            return (n & (n - 1)) == 0 ? n : topStep(n & (n - 1));
+        }
+        static constexpr size_t gTopStep = topStep(NumProcesses);
+
+        // the tree is 1-based: process with pid p lives at index p + 1
+        void add(PidType pid, uint64_t delta) {
+            mTickets += delta;
+            for (size_t i = pid + 1; i <= NumProcesses; i += (i & -i)) {
+                mTree[i] += delta;
+            }
+        }
+
+        uint64_t mTree[NumProcesses + 1];
+        process_t* mSlots[NumProcesses];
+        process_t* mHead;
+        process_t* mTail;
+        size_t mSize;
+        uint64_t mTickets;
+};
+
+#endif
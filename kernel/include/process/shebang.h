@@ -21,6 +21,6 @@
 #include <kernel/process/fileloader.h>
 
 extern "C" bool shebang_can_load(uintptr_t load0);
-extern "C" process_loadinfo_t shebang_do_load(uintptr_t load0, size_t stacksize);
+extern "C" process_loadinfo_t shebang_do_load(uintptr_t load0, VFS::filehandle_t fhandle, size_t stacksize);
 
 #endif
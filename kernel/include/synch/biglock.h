@@ -0,0 +1,43 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SYNCH_BIGLOCK
+#define SYNCH_BIGLOCK
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+
+// only one CPU at a time runs kernel code; the lock belongs to a CPU rather than to a process,
+// so a context switch hands it over to the incoming process as-is. It is taken on the way in from
+// userspace (or out of the idle loop) and dropped on the way back out
+class BigKernelLock : NOCOPY {
+    public:
+        static BigKernelLock& get();
+
+        // true if the calling CPU holds the lock
+        bool held() const;
+
+        void lock();
+        void unlock();
+
+    private:
+        BigKernelLock();
+
+        volatile uint32_t mOwner; // CPU index + 1, or 0 if nobody holds the lock
+};
+
+#endif
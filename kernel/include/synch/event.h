@@ -31,6 +31,8 @@ class Event : public WaitableObject {
         bool raised() const;
 
         bool wait(uint32_t) override;
+        // only a raised event is ready; a pulse wakes pollers, but they will find nothing there
+        uint32_t ready() override;
 
         ~Event();
 
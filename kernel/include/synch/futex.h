@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYNCH_FUTEX
+#define SYNCH_FUTEX
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+#include <kernel/synch/waitqueue.h>
+#include <kernel/libc/hash.h>
+
+// a futex is a wait queue for a word of user memory; userspace only calls into the kernel to sleep
+// on a word it found contended, or to wake sleepers after changing it. Words are known by their
+// physical address, so that threads of a process and processes sharing a page agree on the queue
+class Futexes : NOCOPY {
+    public:
+        // these values are what the futexwait system call reports
+        enum class wait_result_t : uint32_t {
+            woken = 0,
+            changed = 1, // the word did not hold the expected value, so there was no waiting
+            timeout = 2,
+        };
+
+        static Futexes& get();
+
+        // word must be a writable, 4-byte aligned user address of the current process; 0 == no timeout
+        wait_result_t wait(uint32_t* word, uint32_t expected, uint32_t timeout);
+
+        // returns how many processes were woken, at most count
+        uint32_t wake(uint32_t* word, uint32_t count);
+
+        // how many words currently have a process sleeping on them
+        size_t active() const;
+
+    private:
+        static constexpr size_t gNumBuckets = 64;
+
+        struct futex_t {
+            uintptr_t key;
+            uint32_t waiters;
+            WaitQueue wq;
+        };
+
+        struct helper {
+            static size_t index(uintptr_t key) {
+                // words are 4-byte aligned, and the low bits would all collide
+                return key >> 2;
+            }
+            static bool eq(uintptr_t k1, uintptr_t k2) {
+                return k1 == k2;
+            }
+        };
+
+        Futexes();
+
+        static uintptr_t key(uint32_t* word);
+
+        hash<uintptr_t, futex_t*, helper, helper, gNumBuckets> mFutexes;
+        size_t mActive;
+};
+
+#endif
@@ -21,12 +21,13 @@
 #include <kernel/syscalls/types.h>
 #include <kernel/fs/filesystem.h>
 #include <kernel/synch/waitqueue.h>
+#include <kernel/synch/pollable.h>
 #include <kernel/libc/str.h>
 #include <kernel/mm/memmgr.h>
 #include <kernel/mm/virt.h>
 #include <kernel/libc/keyedstore.h>
 
-class MessageQueueBuffer {
+class MessageQueueBuffer : public Pollable {
     public:
         MessageQueueBuffer(const char* name, size_t numMessages);
         ~MessageQueueBuffer();
@@ -34,11 +35,17 @@ class MessageQueueBuffer {
         size_t read(size_t, char*, bool);
         size_t write(size_t, char*, bool);
 
+        // like write(), but moves a whole page to the reader instead of copying it, when it can
+        msgqueue_send_t::path_t send(const void*, size_t, bool);
+
         size_t numReaders() const;
         size_t numWriters() const;
 
         size_t size() const;
 
+        // POLL_IN if there is a message, POLL_OUT if there is room for one; each file only reports its own side
+        uint32_t ready() override;
+
         void openWriter();
         void openReader();
         void closeWriter();
@@ -57,9 +64,15 @@ class MessageQueueBuffer {
         size_t mNumReaders;
         size_t mNumWriters;
 
-        bool tryWrite(const message_t& msg);
+        bool waitForSpace(bool allowBlock);
+        void push(const message_t::header_t&, const void* payload);
         bool tryRead(message_t* msg);
 
+        // can the page at this address of the current process be given away? if so, returns its physical address
+        static uintptr_t transferable(uintptr_t address, MemoryManager::region_t*);
+        // maps a page given away by a sender into the current process, and returns its address there
+        static uintptr_t receive(uintptr_t phys);
+
         WaitQueue mFullWQ;
         WaitQueue mEmptyWQ;
 
@@ -81,6 +94,8 @@ class MessageQueueFile : public Filesystem::File {
         const char* name() const;
         MessageQueueBuffer* buffer() const;
 
+        Pollable* pollable() override { return mBuffer; }
+
         // subclasses must override one of these
         size_t read(size_t, char*) override { return 0; }
         size_t write(size_t, char*) override { return 0; }
@@ -95,6 +110,7 @@ class MessageQueueReadFile : public MessageQueueFile {
     public:
         MessageQueueReadFile(MessageQueueBuffer*);
         size_t read(size_t, char*) override;
+        uint32_t ready() override;
         bool isReader() const override { return true; }
         uintptr_t ioctl(uintptr_t, uintptr_t) override;
 
@@ -108,6 +124,7 @@ class MessageQueueWriteFile : public MessageQueueFile {
     public:
         MessageQueueWriteFile(MessageQueueBuffer*);
         size_t write(size_t, char*) override;
+        uint32_t ready() override;
         bool isReader() const override { return false; }
         uintptr_t ioctl(uintptr_t, uintptr_t) override;
 
@@ -33,6 +33,7 @@ class Mutex : public WaitableObject {
         void unlock();
 
         bool wait(uint32_t) override;
+        uint32_t ready() override;
 
         ~Mutex();
 
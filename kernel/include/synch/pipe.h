@@ -21,17 +21,30 @@
 #include <kernel/libc/bytesizes.h>
 #include <kernel/fs/filesystem.h>
 #include <kernel/synch/waitqueue.h>
+#include <kernel/synch/pollable.h>
 #include <kernel/libc/pair.h>
 
-class PipeBuffer {
+// a pipe is a ring buffer; reads and writes copy as much as they can in (at most) two memcpy calls, one up to
+// the end of the buffer and one from its start, and only ever wake one waiter on the other side. A writer
+// blocked on a full pipe is not woken until at least a quarter of it is free, so that reader and writer do
+// not take turns moving a few bytes each
+class PipeBuffer : public Pollable {
     public:
         static constexpr size_t gBufferSize = 4_KB;
+        static constexpr size_t gMaxBufferSize = 256_KB;
 
-        PipeBuffer();
+        // capacity is rounded up to a multiple of gBufferSize, and capped at gMaxBufferSize; 0 == gBufferSize
+        explicit PipeBuffer(size_t capacity = 0);
+        ~PipeBuffer();
 
         size_t read(size_t, char*);
         size_t write(size_t, char*);
 
+        size_t capacity() const;
+
+        // POLL_IN if there is data, POLL_OUT if there is space; each file only reports its own side
+        uint32_t ready() override;
+
         void closeReadFile();
         bool isReadFileOpen() const;
 
@@ -39,13 +52,12 @@ class PipeBuffer {
         bool isWriteFileOpen() const;
 
     private:
-        char mBuffer[gBufferSize];
+        char *mBuffer;
+        size_t mCapacity;
         size_t mReadPointer;
         size_t mWritePointer;
         size_t mFreeSpace;
-
-        bool tryPutchar(char c);
-        bool tryGetchar(char& c);
+        size_t mLowWatermark; /** how much space must be free before a blocked writer is woken */
 
         WaitQueue mFullWQ;
         WaitQueue mEmptyWQ;
@@ -74,6 +86,7 @@ class PipeManager : public Filesystem {
                 size_t write(size_t, char*) override;
 
                 PipeBuffer* buffer() const { return mBuffer; }
+                Pollable* pollable() override { return mBuffer; }
                 virtual bool isReadFile() const = 0;
                 virtual bool isWriteFile() const { return !isReadFile(); }
 
@@ -87,16 +100,19 @@ class PipeManager : public Filesystem {
             public:
                 ReadFile(PipeBuffer*);
                 size_t read(size_t, char*) override;
+                uint32_t ready() override;
                 bool isReadFile() const override { return true; }
         };
         class WriteFile : public PipeFile {
             public:
                 WriteFile(PipeBuffer*);
                 size_t write(size_t, char*) override;
+                uint32_t ready() override;
                 bool isReadFile() const override { return false; }
         };
 
-        pair<ReadFile*, WriteFile*> pipe();
+        // see PipeBuffer for how capacity is interpreted
+        pair<ReadFile*, WriteFile*> pipe(size_t capacity = 0);
 
     private:
         PipeManager();
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYNCH_POLLABLE
+#define SYNCH_POLLABLE
+
+#include <kernel/sys/stdint.h>
+#include <kernel/libc/slist.h>
+#include <kernel/synch/waitqueue.h>
+
+// told whenever something it watches may have become ready; see PollSet
+class PollWatcher {
+    public:
+        // must not block; cookie is whatever the watcher passed to Pollable::watch()
+        virtual void changed(uintptr_t cookie) = 0;
+    protected:
+        ~PollWatcher() = default;
+};
+
+// anything whose readiness (in poll_event_t terms) can be waited on at the same time as other things;
+// whoever changes what ready() would return calls notify(), which wakes anyone polling on it and tells
+// any watchers, so that a poll set only ever looks at the objects that actually changed
+class Pollable {
+    public:
+        virtual uint32_t ready() = 0;
+
+        // processes waiting on more than one object at once sit in each object's poll queue
+        WaitQueue* pollqueue();
+
+        void watch(PollWatcher*, uintptr_t cookie);
+        void unwatch(PollWatcher*, uintptr_t cookie);
+
+        void notify();
+
+    protected:
+        Pollable();
+        virtual ~Pollable();
+
+    private:
+        struct watcher_t {
+            PollWatcher* watcher;
+            uintptr_t cookie;
+
+            bool operator==(const watcher_t& w) const {
+                return watcher == w.watcher && cookie == w.cookie;
+            }
+        };
+
+        slist<watcher_t> mWatchers;
+        WaitQueue mPollWQ;
+};
+
+#endif
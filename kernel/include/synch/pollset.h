@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYNCH_POLLSET
+#define SYNCH_POLLSET
+
+#include <kernel/sys/stdint.h>
+#include <kernel/fs/filesystem.h>
+#include <kernel/fs/vfs.h>
+#include <kernel/libc/slist.h>
+#include <kernel/synch/pollable.h>
+#include <kernel/synch/waitqueue.h>
+#include <kernel/syscalls/types.h>
+
+// a persistent set of files to wait on; each file is registered once, and from then on its Pollable tells
+// the set when it changes, so that a wait only looks at the files that may have become ready rather
+// than at every file in the set. Readiness is level-triggered: a file that is still ready after a wait
+// is reported again by the next one
+class PollSet : public Filesystem::File, public PollWatcher {
+    public:
+        PollSet();
+        ~PollSet();
+
+        bool doStat(stat_t&) override;
+        bool seek(size_t) override;
+        bool tell(size_t*) override;
+        size_t read(size_t, char*) override;
+        size_t write(size_t, char*) override;
+
+        // starts watching fd in the current process for events, or changes the events it is watched for;
+        // events == 0 stops watching it
+        bool control(int32_t fd, uint32_t events);
+
+        // fills in up to n ready entries, waiting up to timeout ms for at least one to become ready;
+        // timeout == 0 does not wait, timeout == poll_entry_t::gForever waits for as long as it takes
+        size_t wait(poll_entry_t* entries, size_t n, uint32_t timeout);
+
+        void changed(uintptr_t cookie) override;
+
+        static bool classof(const FilesystemObject*);
+
+    private:
+        struct entry_t {
+            int32_t fd;
+            uint32_t events;
+            VFS::filehandle_t handle;
+            Filesystem::File* file;
+            Pollable* source; /** nullptr for files that are always ready */
+            bool queued;
+        };
+
+        entry_t* find(int32_t fd);
+        void enqueue(entry_t*);
+        void forget(entry_t*);
+
+        slist<entry_t*> mEntries;
+        slist<entry_t*> mCandidates; /** entries that may be ready; the only ones wait() looks at */
+        WaitQueue mWQ;
+};
+
+class PollSets : public Filesystem {
+    public:
+        static PollSets* get();
+
+        File* doOpen(const char*, uint32_t) override { return nullptr; }
+        bool del(const char*) override { return false; }
+        Directory* doOpendir(const char*) override { return nullptr; }
+        bool mkdir(const char*) override { return false; }
+        void doClose(FilesystemObject* object) override;
+
+        PollSet* make();
+
+    private:
+        PollSets();
+};
+
+#endif
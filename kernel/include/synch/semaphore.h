@@ -28,6 +28,7 @@ class Semaphore : public WaitableObject {
     public:
         Semaphore(const char* name, uint32_t initial, uint32_t max);
         bool wait(uint32_t) override;
+        uint32_t ready() override;
         void signal();
 
         ~Semaphore();
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYNCH_SHMFS
+#define SYNCH_SHMFS
+
+#include <stdint.h>
+#include <kernel/syscalls/types.h>
+#include <kernel/fs/filesystem.h>
+#include <kernel/libc/slist.h>
+#include <kernel/libc/str.h>
+#include <kernel/libc/vec.h>
+#include <kernel/sys/nocopy.h>
+
+// a named run of physical pages; every process that maps it sees the very same pages, each mapping
+// holding a reference to them through the PhysicalPageManager, so that a page outlives the object
+// for as long as someone still has it mapped
+class SharedMemory : NOCOPY {
+    public:
+        // the page table costs the kernel heap 4 bytes per page, so objects can't be made arbitrarily large
+        static constexpr size_t gMaxSize = 256 * 1024 * 1024;
+
+        SharedMemory(const char* name);
+        ~SharedMemory();
+
+        const char* name() const;
+
+        bool linked() const;
+        void unlink();
+
+        size_t size() const;
+        // false if size is more than gMaxSize
+        bool resize(size_t);
+
+        // the physical page behind offset, which is allocated (and zeroed) on first use; 0 if past the end
+        uintptr_t page(size_t offset);
+
+        size_t read(size_t offset, size_t n, char* dest);
+        size_t write(size_t offset, size_t n, const char* src);
+
+        uint32_t handles() const;
+        uint32_t incref();
+        uint32_t decref();
+
+        void info(shm_info_t*);
+
+    private:
+        string mName;
+        bool mLinked;
+        size_t mSize;
+        vector<uintptr_t> mPages; /** 0 for pages that were never touched */
+        uint32_t mHandles;
+};
+
+class ShmFS : public Filesystem {
+    public:
+        static ShmFS* get();
+
+        File* doOpen(const char*, uint32_t) override;
+        bool del(const char*) override;
+        Directory* doOpendir(const char*) override { return nullptr; }
+        bool mkdir(const char*) override { return false; }
+        void doClose(FilesystemObject* object) override;
+
+        // fills in up to n entries, and returns how many objects there are
+        size_t info(shm_info_t*, size_t n);
+
+    private:
+        ShmFS();
+
+        SharedMemory* find(const char* name);
+        void release(SharedMemory*);
+
+        // unlinked objects stay on here until the last of their users lets go
+        slist<SharedMemory*> mObjects;
+};
+
+#endif
@@ -18,10 +18,12 @@
 #define SYNCH_WAITOBJ
 
 #include <kernel/synch/waitqueue.h>
+#include <kernel/synch/pollable.h>
 
 struct process_t;
 
-class WaitableObject {
+// waiting on one object goes through wait(); waiting on it along with others goes through Pollable
+class WaitableObject : public Pollable {
     public:
         enum class Kind {
             Kind_Event,
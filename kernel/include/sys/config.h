@@ -54,6 +54,60 @@ struct kernel_config_t : NOCOPY {
         uint16_t value;
     } logsize;
 
+    /**
+     * Watermarks, in pages, for the pool of pre-zeroed physical pages
+     * e.g. zeropool_low=64 zeropool_high=256
+     * The zeroing task refills the pool to the high watermark whenever it drops below the low one
+     */
+    struct config_zeropool {
+        uint16_t low;
+        uint16_t high;
+    } zeropool;
+
+    /**
+     * The size, in pages, of the window that a single page fault populates in anonymous
+     * and memory-mapped regions; the window is aligned and contains the faulting page
+     * e.g. faultaround=16
+     * The default value is 16 pages; 1 disables fault-around
+     */
+    struct config_faultaround {
+        uint16_t value;
+        static constexpr uint16_t gMaxWindow = 256;
+    } faultaround;
+
+    /**
+     * The page cache gives back unmapped pages, least recently used first, whenever
+     * allocating a new cached page would leave fewer than this many free pages
+     * e.g. pagecache_minfree=256
+     */
+    struct config_pagecache {
+        uint32_t minfree;
+    } pagecache;
+
+    /**
+     * The number of 4KB blocks that each volume caches, whether writes are held
+     * in the cache until the block is evicted or the filesystem syncs, and the size in blocks
+     * from which a single request skips the cache and goes straight to the disk
+     * e.g. blockcache_blocks=128 blockcache_writeback=1 blockcache_bypass=32
+     * The default is 64 blocks, written through, bypassed by requests of 16 blocks or more;
+     * 0 blocks disables the cache, and a bypass of 0 never skips it
+     */
+    struct config_blockcache {
+        uint32_t blocks;
+        bool writeback;
+        uint32_t bypass;
+    } blockcache;
+
+    /**
+     * Whether the APIC timer is programmed one-shot for the next deadline (sleeping process or
+     * end of the running process' quantum) instead of interrupting every millisecond
+     * e.g. tickless=0
+     * The default is 1; it only takes effect when the TSC could be calibrated
+     */
+    struct config_tickless {
+        bool value;
+    } tickless;
+
     kernel_config_t();
 };
 
@@ -19,6 +19,7 @@
 
 #include <kernel/sys/stdint.h>
 #include <kernel/sys/nocopy.h>
+#include <kernel/syscalls/types.h>
 
 typedef uint32_t syscall_response_t;
 
@@ -71,12 +72,30 @@ class SyscallManager : NOCOPY {
 
         static SyscallManager& get();
 
+        // runs one system call on behalf of the current process, as if it had trapped into the kernel;
+        // the handler may update eip and eflags in the request for the caller to apply; a batched call
+        // comes from a syscall ring rather than a trap, and is refused for handlers marked unbatched
+        syscall_response_t execute(Request&, bool batched = false);
+
+        // system-wide numbers for one system call; false if there is no such system call
+        bool stats(uint8_t code, syscall_stats_t*);
+        // the same, but only counting calls made by the process being tracked, since tracking began
+        bool processStats(uint8_t code, syscall_stats_t*);
+
+        // picks the process whose calls are also counted on their own; 0 stops tracking;
+        // false if there is no memory to count them in
+        bool track(kpid_t pid);
+        kpid_t tracked() const;
+        // called as a process exits, so its pid isn't tracked once reused; the counts stay readable
+        void untrack(kpid_t pid);
+
     private:
         SyscallManager();
 
         void sethandlers();
 
-        void handle(uint8_t code, Handler handler, bool systemOnly);
+        void handle(uint8_t code, const char* name, Handler handler, bool systemOnly);
+        void unbatched(uint8_t code);
 };
 
 #endif
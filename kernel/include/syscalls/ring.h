@@ -0,0 +1,57 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSCALLS_RING
+#define SYSCALLS_RING
+
+#include <kernel/sys/stdint.h>
+#include <kernel/sys/nocopy.h>
+
+struct process_t;
+
+// runs the system calls that a process queued on its syscall ring (see syscall_ring_t), either when one
+// of its threads asks with ringenter, or from a kernel thread of the process that keeps polling the ring
+class SyscallRings : NOCOPY {
+    public:
+        struct stats_t {
+            uint64_t batches; /** how many times a non-empty ring was drained */
+            uint64_t submissions; /** how many system calls were run off of rings */
+        };
+
+        static SyscallRings& get();
+
+        // runs up to max queued submissions of the process led by leader, posting a completion for each;
+        // returns how many ran, which is less than max when the submission queue empties or the completion
+        // queue fills up, and 0 if another thread of the process is already draining the ring
+        uint32_t drain(process_t* leader, uint32_t max);
+
+        // starts a kernel thread in the process that drains its ring without being asked
+        bool startPoller(process_t* leader);
+
+        stats_t stats() const;
+
+    private:
+        SyscallRings();
+
+        // the ring lives in user memory, which the process may have unmapped since registering it
+        static bool mapped(process_t* leader);
+
+        static void poll(uintptr_t leader);
+
+        stats_t mStats;
+};
+
+#endif
@@ -21,6 +21,8 @@
 #include <kernel/sys/stdint.h>
 using syscall_response_t = uint32_t;
 
+#define SYSINFO_MAX_CPUS 8
+
 struct sysinfo_t {
     struct {
         uint64_t uptime; /** uptime of the system */
@@ -33,13 +35,24 @@ struct sysinfo_t {
         uint32_t allocated; /** amount of memory allocated to this process */
         uint32_t committed; /** amount of actual RAM given to this process */
         uint32_t pagefaults; /** number of page faults that this process caused */
+        uint32_t demandfaults; /** number of page faults resolved by mapping in the faulting page */
+        uint32_t faultaround; /** number of pages mapped in by fault-around instead of by their own fault */
         uint64_t ctxswitches; /** number of times this process has been context switched */
     } local;
+    struct {
+        uint32_t count; /** number of CPUs that are online */
+        struct {
+            uint64_t busy; /** milliseconds this CPU spent running processes */
+            uint64_t idle; /** milliseconds this CPU spent with nothing to run */
+            uint64_t steals; /** processes this CPU took from another CPU's ready queue */
+        } cpu[SYSINFO_MAX_CPUS];
+    } cpus;
 };
 
 enum {
     INCLUDE_GLOBAL_INFO = 1,
     INCLUDE_LOCAL_INFO = 2,
+    INCLUDE_CPU_INFO = 4,
 };
 
 enum {
@@ -90,6 +103,13 @@ struct blockdevice_usage_stats_t {
     uint64_t sectors_read;
     uint64_t cache_hits;
     uint64_t sectors_written;
+    uint64_t cache_misses;
+    uint64_t cache_evictions;
+    uint64_t cache_writebacks; // sectors written to disk from dirty cache blocks
+    uint64_t cache_bypassed; // sectors transferred by requests large enough to skip the cache
+    uint32_t cache_dirty; // blocks of the cache holding unwritten data
+    uint32_t cache_resident;
+    uint32_t cache_capacity;
 };
 
 // IOCTL operations that one can run on a block device file
@@ -125,6 +145,22 @@ enum msgqueue_ioctl_t {
     IOCTL_GET_QUEUE_SIZE = 1, // a2 = reserved, return size of queue
     IOCTL_BLOCK_ON_EMPTY = 2, // a2 = bool; should a read block if the queue is empty
     IOCTL_BLOCK_ON_FULL = 3, // a2 = bool; should a write block if the queue is full
+    IOCTL_SEND_MESSAGE = 4, // a2 = pointer to msgqueue_send_t; returns 1 if the message was sent
+};
+
+// a message sent with IOCTL_SEND_MESSAGE; a payload that is exactly one page-aligned page of ordinary
+// memory is moved to the reader rather than copied, which leaves the sender with a page of zeros in its
+// place. Anything else that fits in a message is copied, just like a write() would
+struct msgqueue_send_t {
+    enum class path_t : uint32_t {
+        failed = 0,
+        copied = 1,
+        transferred = 2,
+    };
+
+    const void* data;
+    size_t size;
+    path_t path; /** set by the kernel */
 };
 
 // IOCTL operations that can run on a semaphore
@@ -153,6 +189,41 @@ enum mutex_ioctl_t {
     IOCTL_MUTEX_TRYLOCK  = 0x561410C9, // returns 1 if the mutex was locked properly
 };
 
+// IOCTL operations that can run on a shared memory object
+enum shm_ioctl_t {
+    IOCTL_SHM_RESIZE     = 0x5A4E0001, // a2 = new size in bytes; pages past the end are let go of; 0 if too large
+    IOCTL_SHM_GET_SIZE   = 0x5A4E0002, // returns the size of the object in bytes
+};
+
+// /devices/shm/objects has one entry for each shared memory object that is still alive, whether it
+// still has a name under /shm or not
+struct shm_info_t {
+    char name[32];
+    bool linked; /** false once the name was deleted, and the object only lives on for those using it */
+    uint32_t size; /** in bytes */
+    uint32_t pages; /** pages in the object, whether they were touched yet or not */
+    uint32_t resident; /** pages that have been touched, and have physical memory behind them */
+    uint32_t mappings; /** pages mapped into some process, counting each process separately */
+    uint32_t handles; /** open files on the object, including those held by mmap() */
+};
+
+// what a file can be waited for with poll or a poll set; the values match those of <poll.h>
+enum poll_event_t : uint32_t {
+    POLL_IN = 0x1, /** a read would not block */
+    POLL_OUT = 0x4, /** a write would not block */
+    POLL_ERR = 0x8, /** the other end is gone, and writes go nowhere; always reported */
+    POLL_HUP = 0x10, /** the other end is gone, and nothing more will arrive; always reported */
+    POLL_NVAL = 0x20, /** not an open file; always reported */
+};
+
+struct poll_entry_t {
+    static constexpr uint32_t gForever = 0xFFFFFFFF; /** a timeout that never expires */
+
+    int32_t fd;
+    uint32_t events; /** poll_event_t bits to wait for */
+    uint32_t revents; /** poll_event_t bits that are true right now, filled in by the kernel */
+};
+
 enum class process_state_t : uint8_t {
     NEW, /** created and not schedulable */
     AVAILABLE, /** ready to be scheduled (or running, we don't distinguish yet) */
@@ -208,6 +279,8 @@ struct process_info_t {
 
     uintptr_t vmspace;
     uintptr_t pmspace;
+    uint32_t sharedpages; /** pages shared with other processes running the same executable */
+    uint32_t privatepages; /** pages owned by this process alone */
     uint64_t runtime;
 
     uint64_t diskReadBytes;
@@ -264,10 +337,17 @@ struct exec_fileop_t {
 
 struct message_t {
     static constexpr size_t gTotalSize = 4096; // TODO: expose the size of a page globally
+
+    // the payload is not in the message, but in the page at header.page, which now belongs to the reader
+    // (who should unmapregion() it when done); see msgqueue_send_t
+    static constexpr uint32_t gPageTransfer = 1;
+
     struct header_t {
         kpid_t sender;
         uint64_t timestamp;
         size_t payload_size;
+        uint32_t flags;
+        uintptr_t page;
     } header;
     static constexpr size_t gBodySize = gTotalSize - sizeof(header_t);
     uint8_t payload[gBodySize];
@@ -313,6 +393,104 @@ struct irq_info_t {
     uint64_t count;
 };
 
+// how long system calls take, in TSC cycles from entering the handler to leaving it (which includes any
+// time spent blocked); /devices/syscalls/all has one entry for each system call the kernel knows of, and
+// /devices/syscalls/process the same for the process chosen with IOCTL_TRACK_PROCESS on that file
+struct syscall_stats_t {
+    static constexpr uint32_t gNumBuckets = 32;
+
+    enum ioctl_t : uintptr_t {
+        IOCTL_TRACK_PROCESS = 0x5C570001, // (a=IOCTL_, b=pid or 0 to stop), starts counting afresh for that process; 0 if out of memory
+        IOCTL_TRACKED_PROCESS = 0x5C570002, // (a=IOCTL_, b=0), returns the pid being tracked, or 0
+    };
+
+    uint8_t id;
+    char name[16];
+    uint64_t calls;
+    uint64_t insecure; /** calls refused because the system call is reserved to the system */
+    uint64_t cycles; /** all calls together */
+    uint64_t maxcycles;
+    uint64_t buckets[gNumBuckets]; /** buckets[i] counts calls that took [2^i, 2^(i+1)) cycles; the last one has no upper bound */
+};
+
+// how path lookups in the VFS went since boot, as read from /devices/vfs/cache
+struct vfs_cache_stats_t {
+    uint64_t hits; /** paths whose filesystem was found in the path cache */
+    uint64_t misses; /** paths that had to be looked up in the mount table */
+    uint64_t absent; /** opens refused because the path was known not to exist, without asking the filesystem */
+    uint64_t invalidations; /** cached paths dropped by del, mkdir, mount, unmount or opens that may create a file */
+    uint32_t entries; /** paths cached right now */
+    uint32_t capacity;
+    uint32_t mounts;
+};
+
 typedef uint64_t feature_id_t;
 
+// a batch of system calls: userspace queues submissions at sqtail, the kernel consumes them from sqhead and
+// posts one completion per submission at cqtail, for userspace to consume from cqhead. Each side only writes
+// its own indices; they grow forever and wrap around the queues, whose size is a power of two
+struct syscall_ring_t {
+    static constexpr uint32_t gMaxEntries = 256;
+
+    enum {
+        POLL = 1, // the kernel drains the submission queue on its own, without waiting for ringenter
+    };
+
+    struct submission_t {
+        uint32_t userdata; /** copied to the completion, to tell which submission it is for */
+        uint8_t code; /** the system call to make, as in syscalls.tbl */
+        uint32_t args[5];
+    };
+
+    struct completion_t {
+        uint32_t userdata;
+        syscall_response_t result; /** what the system call would have returned */
+    };
+
+    uint32_t entries;
+    uint32_t flags;
+    uint32_t sqhead;
+    uint32_t sqtail;
+    uint32_t cqhead;
+    uint32_t cqtail;
+
+    submission_t* submissions() {
+        return (submission_t*)(this + 1);
+    }
+    completion_t* completions() {
+        return (completion_t*)(submissions() + entries);
+    }
+
+    // the bytes needed for a ring of n entries, including both queues
+    static constexpr uint32_t size(uint32_t n) {
+        return sizeof(syscall_ring_t) + n * (sizeof(submission_t) + sizeof(completion_t));
+    }
+};
+
+// the kernel maps these two pages read-only at the very top of every process' address space,
+// so that userspace can tell the time and its own pid without a system call
+
+// shared by every process; seq is odd while the kernel is updating the page, so a reader copies
+// the fields out and tries again unless seq was even and did not change while it was copying
+struct kernel_data_t {
+    static constexpr uintptr_t gAddress = 0xBFFFE000;
+
+    uint32_t seq;
+    uint64_t uptime; /** milliseconds since boot, as of the last timer interrupt */
+    uint64_t now; /** UNIX time, in seconds */
+    uint64_t nowMicros; /** uptime, in microseconds, when now last changed */
+    struct {
+        uint64_t ticksPerMs; /** 0 unless the TSC is the system clock */
+        uint64_t base; /** TSC value at calibration */
+        uint64_t baseMicros; /** uptime, in microseconds, at calibration */
+    } tsc;
+};
+
+// one per address space, so threads see the pid of the process they belong to
+struct process_data_t {
+    static constexpr uintptr_t gAddress = kernel_data_t::gAddress + 4096;
+
+    uint32_t pid;
+};
+
 #endif
@@ -17,11 +17,15 @@
 
 #include <kernel/tasks/task.h>
 #include <kernel/tty/keyevent.h>
+#include <kernel/synch/pollable.h>
 
 KERNEL_TASK_NAMESPACE(keybqueue)
 
 namespace tasks::keybqueue {
     key_event_t readKey();
+
+    // POLL_IN whenever there are key events waiting to be read
+    Pollable* pollable();
 }
 
 #endif
@@ -15,8 +15,12 @@
 #ifndef TASKS_SCHEDULER
 #define TASKS_SCHEDULER
 
-#include <kernel/tasks/task.h>
+struct process_t;
 
-KERNEL_TASK_NAMESPACE(scheduler)
+// the scheduler is not a task of its own: ProcessManager::yield() calls next() on the
+// yielding process' kernel stack and switches straight to the winner
+namespace tasks::scheduler {
+    process_t *next();
+}
 
 #endif
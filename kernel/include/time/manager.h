@@ -27,11 +27,29 @@ class TimeManager : NOCOPY {
     public:
         static TimeManager& get();
 
+        // a timer that can be armed to interrupt once, the given number of microseconds from now
+        using clockevent_f = void(*)(uint64_t);
+
         void registerTimeSource(const char*, uint32_t);
 
-        time_tick_callback_t::yield_vote_t tick(InterruptStack&);
+        // once the TSC frequency is known, uptime is read from the TSC rather than counted in ticks
+        void registerTSC(uint64_t ticksPerMs);
+
+        // switches to tickless operation: instead of a periodic tick, the timer is programmed
+        // to fire at whatever deadline was last passed to setDeadline()
+        void registerClockEvent(const char*, clockevent_f);
+        bool tickless() const;
+
+        // asks for a timer interrupt at the given uptime (in microseconds); 0 means no interrupt is needed.
+        // Has no effect unless a clock event is registered
+        void setDeadline(uint64_t micros);
+
+        // every CPU's timer ticks, but only one of them should advance a periodic uptime count
+        time_tick_callback_t::yield_vote_t tick(InterruptStack&, bool advance = true);
 
         uint64_t millisUptime();
+        uint64_t microsUptime();
+        uint64_t tscTicksPerMs() const;
 
         uint64_t millisPerTick();
 
@@ -68,6 +86,17 @@ class TimeManager : NOCOPY {
             uint32_t millisPerTick;
         } mTimeSource;
 
+        struct {
+            uint64_t ticksPerMs; // 0 until calibrated
+            uint64_t base; // TSC value at the time of calibration
+            uint64_t baseMicros; // uptime at the time of calibration
+        } mTSC;
+
+        struct {
+            const char* name;
+            clockevent_f arm; // nullptr when running off a periodic tick
+        } mClockEvent;
+
         TimeManager();
 };
 
@@ -33,6 +33,10 @@ class TTYFile : public Filesystem::File {
         bool doStat(stat_t&) override;
         uintptr_t ioctl(uintptr_t, uintptr_t) override;
 
+        // input is ready as soon as there are key events, even if in canonical mode they do not make up a line yet
+        Pollable* pollable() override;
+        uint32_t ready() override;
+
         static bool classof(const FilesystemObject*);
 
     private:
@@ -69,6 +69,10 @@ namespace boot {
         uint32_t init();
         bool fail(uint32_t);
     }
+    namespace smp {
+        uint32_t init();
+        bool fail(uint32_t);
+    }
     namespace vfs {
         uint32_t init();
         bool fail(uint32_t);
@@ -97,6 +101,10 @@ namespace boot {
         uint32_t init();
         bool fail(uint32_t);
     }
+    namespace syscallstats {
+        uint32_t init();
+        bool fail(uint32_t);
+    }
     namespace time_files {
         uint32_t init();
     }
@@ -116,6 +124,10 @@ namespace boot {
         uint32_t init();
         bool fail(uint32_t);
     }
+    namespace shmfs {
+        uint32_t init();
+        bool fail(uint32_t);
+    }
     namespace fb_file {
         uint32_t init();
     }
@@ -192,6 +204,14 @@ __attribute__((constructor)) void loadBootPhases() {
         onFailure : boot::mutexfs::fail
     });
 
+    registerBootPhase(bootphase_t{
+        description : "Prepare shared memory support",
+        visible : false,
+        operation : boot::shmfs::init,
+        onSuccess : nullptr,
+        onFailure : boot::shmfs::fail
+    });
+
     registerBootPhase(bootphase_t{
         description : "Create initial process",
         visible : false,
@@ -296,6 +316,14 @@ __attribute__((constructor)) void loadBootPhases() {
         onFailure : boot::irqcount::fail
     });
 
+    registerBootPhase(bootphase_t{
+        description : "Forward system call statistics to userspace",
+        visible : false,
+        operation : boot::syscallstats::init,
+        onSuccess : nullptr,
+        onFailure : boot::syscallstats::fail
+    });
+
     registerBootPhase(bootphase_t{
         description : "Forward date/time to userspace",
         visible : false,
@@ -375,4 +403,12 @@ __attribute__((constructor)) void loadBootPhases() {
         onSuccess : nullptr,
         onFailure : boot::scheduler_tick::fail
     });
+
+    registerBootPhase(bootphase_t{
+        description : "Start application processors",
+        visible : false,
+        operation : boot::smp::init,
+        onSuccess : nullptr,
+        onFailure : boot::smp::fail
+    });
 }
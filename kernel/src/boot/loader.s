@@ -75,7 +75,7 @@ __bootpagedir:
 
 ; change this value here if system entries are added to the GDT
 __numsysgdtentries:
-    dd 6
+    dd 13
 align 0x1000
 __gdt: ; refer to tools/make_gdt_descriptor.cpp
     ; null descriptor [0]
@@ -98,12 +98,8 @@ __gdt: ; refer to tools/make_gdt_descriptor.cpp
 	dd 0xFFFF
 	dd 0xCFF200
 
-    ; task switching gate 0x28 [5]
-	dd 0x280000
-	dd 0x8500
-
-    ; task segments [6...]
-	times 2000 dq 0
+    ; one TSS per CPU, 0x28 [5] to 0x60 [12] - filled in by ProcessManager; see CPUs::gMaxCPUs
+	times 16 dd 0x0
 
 __gdtinfo:
 	dw __gdtinfo - __gdt - 1
@@ -0,0 +1,107 @@
+; Copyright 2018 Google LLC
+;
+; Licensed under the Apache License, Version 2.0 (the "License");
+; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;      http://www.apache.org/licenses/LICENSE-2.0
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS,
+; WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+; See the License for the specific language governing permissions and
+; limitations under the License.
+
+; application processors start out in real mode at a page-aligned address below 1MB;
+; this code is copied there by boot::smp::init(), which also fills in the parameters
+; at the end, and takes the processor to protected mode with paging on, and from there
+; to smp_ap_main() in the higher half
+TRAMPOLINE_BASE equ 0x8000
+%define TRAMPOLINE(label) (label - smp_trampoline_start + TRAMPOLINE_BASE)
+
+extern __gdtinfo
+extern smp_ap_main
+
+global smp_trampoline_start
+global smp_trampoline_params
+global smp_trampoline_end
+
+section .text
+bits 16
+smp_trampoline_start:
+	cli
+	cld
+	xor ax, ax
+	mov ds, ax
+	lgdt [TRAMPOLINE(trampoline_gdtinfo)]
+	mov eax, cr0
+	or eax, 1
+	mov cr0, eax
+	jmp dword 0x8:TRAMPOLINE(trampoline32)
+
+bits 32
+trampoline32:
+	mov ax, 0x10
+	mov ds, ax
+	mov es, ax
+	mov fs, ax
+	mov gs, ax
+	mov ss, ax
+
+	; same paging setup as the boot CPU - global pages can only be enabled once paging is on
+	mov eax, [TRAMPOLINE(smp_trampoline_params.cr4)]
+	and eax, ~0x80
+	mov cr4, eax
+	mov eax, [TRAMPOLINE(smp_trampoline_params.cr3)]
+	mov cr3, eax
+	mov eax, [TRAMPOLINE(smp_trampoline_params.cr0)]
+	mov cr0, eax
+	mov eax, [TRAMPOLINE(smp_trampoline_params.cr4)]
+	mov cr4, eax
+
+	mov esp, [TRAMPOLINE(smp_trampoline_params.stack)]
+	push dword [TRAMPOLINE(smp_trampoline_params.cpu)]
+	lea ecx, [smp_ap_start]
+	jmp ecx ; NOTE: Must be absolute jump!
+
+align 8
+trampoline_gdt:
+	; null descriptor
+	dd 0x0
+	dd 0x0
+	; flat code 0x8 - matches the kernel's own GDT
+	dd 0xFFFF
+	dd 0xCF9A00
+	; flat data 0x10 - matches the kernel's own GDT
+	dd 0xFFFF
+	dd 0xCF9200
+trampoline_gdtinfo:
+	dw trampoline_gdtinfo - trampoline_gdt - 1
+	dd TRAMPOLINE(trampoline_gdt)
+
+align 4
+smp_trampoline_params: ; must match trampoline_params_t in drivers/apic/smp.cpp
+.cr3:	dd 0
+.cr0:	dd 0
+.cr4:	dd 0
+.stack:	dd 0
+.cpu:	dd 0
+smp_trampoline_end:
+
+; runs in the higher half, so the identity mapping of the trampoline is no longer needed
+smp_ap_start:
+	lgdt [__gdtinfo]
+	jmp 0x8:.segments
+.segments:
+	mov ecx, 0x10
+	mov ds, ecx
+	mov es, ecx
+	mov fs, ecx
+	mov gs, ecx
+	mov ss, ecx
+	xor ebp, ebp
+	call smp_ap_main ; takes the CPU index pushed above, and never returns
+.hang:
+	cli
+	hlt
+	jmp .hang
@@ -25,25 +25,37 @@
 #include <kernel/time/manager.h>
 #include <kernel/drivers/pit/pit.h>
 #include <kernel/time/callback.h>
+#include <kernel/sys/config.h>
+#include <kernel/process/cpu.h>
 
 static uint32_t timer(GPR&, InterruptStack& stack, void*) {
     APIC::get().EOI();
-    auto decision = TimeManager::get().tick(stack);
+    auto decision = TimeManager::get().tick(stack, CPUs::currentIndex() == 0);
     if (decision == time_tick_callback_t::yield) return IRQ_RESPONSE_YIELD;
     else return IRQ_RESPONSE_NONE;
 }
 
-namespace boot::apic {
-        // TODO: should this be a configuration parameter?
-        static constexpr uint32_t gMillisPerTick = 1;
+static void arm(uint64_t micros) {
+    APIC::get().oneShot(micros);
+}
 
+// TODO: should this be a configuration parameter?
+static constexpr uint32_t gMillisPerTick = 1;
+
+namespace boot::apic {
         uint32_t init() {
             auto& apic(APIC::get());
+            auto& tmgr(TimeManager::get());
             LOG_DEBUG("APIC calibration: %u", apic.calibrate());
             Interrupts::get().sethandler(APIC::gAPICTimerIRQ, "APIC", timer);
             PIT::get().disable();
-            TimeManager::get().registerTimeSource("APIC", gMillisPerTick);
-            apic.tickEvery(gMillisPerTick);
+            tmgr.registerTimeSource("APIC", gMillisPerTick);
+            tmgr.registerTSC(apic.getTSCTicksPerMs());
+            if (gKernelConfiguration()->tickless.value && tmgr.tscTicksPerMs() != 0) {
+                tmgr.registerClockEvent("APIC", arm);
+            } else {
+                apic.tickEvery(gMillisPerTick);
+            }
             return 0;
         }
 
@@ -67,17 +79,72 @@ uint32_t APIC::getTimerCurrent() const {
     return mAPICRegisters[gTimerCurrentCount];
 }
 
+uint64_t APIC::getTSCTicksPerMs() const {
+    return mTSCTicksPerMs;
+}
+
+uint8_t APIC::id() const {
+    return mAPICRegisters[gIDRegister] >> 24;
+}
+
+void APIC::sendICR(uint8_t apicid, uint32_t command) {
+    // wait for any previous IPI to be accepted before reusing the register
+    while (mAPICRegisters[gICRLowRegister] & (1 << 12)) {
+        __asm__ volatile("pause");
+    }
+    mAPICRegisters[gICRHighRegister] = (uint32_t)apicid << 24;
+    mAPICRegisters[gICRLowRegister] = command;
+}
+
+void APIC::sendIPI(uint8_t apicid, uint8_t vector) {
+    sendICR(apicid, 0x4000 | vector); // fixed delivery, assert
+}
+
+void APIC::sendINIT(uint8_t apicid) {
+    sendICR(apicid, 0x4500); // INIT delivery, assert
+}
+
+void APIC::sendSIPI(uint8_t apicid, uint8_t page) {
+    sendICR(apicid, 0x4600 | page); // start-up delivery, assert
+}
+
+void APIC::setupAP() {
+    mAPICRegisters[gSpuriousInterruptRegister] = 0x1FF;
+    // in tickless mode the timer stays quiet until the scheduler arms it for a deadline
+    if (TimeManager::get().tickless()) configure(0, false);
+    else configure(mTicksPerMs * gMillisPerTick);
+}
+
 void APIC::tickEvery(uint32_t ms) {
+    mOneShot = false;
     configure(mTicksPerMs * ms);
 }
 
-void APIC::configure(uint32_t ticks) {
+void APIC::oneShot(uint64_t micros) {
+    uint64_t ticks = 0;
+    if (micros) {
+        ticks = (mTicksPerMs * micros) / 1000;
+        if (ticks == 0) ticks = 1;
+        // a deadline beyond what the counter can hold just gets an early interrupt, and is re-armed from there
+        if (ticks > 0xFFFFFFFFULL) ticks = 0xFFFFFFFFULL;
+    }
+
+    if (mOneShot) {
+        // the timer is already in one-shot mode, so only the count needs writing; 0 stops it
+        mAPICRegisters[gTimerInitialCount] = (uint32_t)ticks;
+    } else {
+        mOneShot = true;
+        configure((uint32_t)ticks, false);
+    }
+}
+
+void APIC::configure(uint32_t ticks, bool periodic) {
     auto reg = &mAPICRegisters[gTimerDivideRegister];
     *reg = 0b111; // divide by 1
     LOG_DEBUG("timer divide register is 0x%p - value is 0x%p", reg, *reg);
 
     reg = &mAPICRegisters[gTimerRegister];
-    *reg = 0x20000 | gAPICTimerIRQ; // deliver IRQ periodically
+    *reg = (periodic ? 0x20000 : 0) | gAPICTimerIRQ; // deliver IRQ periodically, or once
     LOG_DEBUG("timer register is 0x%p - value is 0x%p", reg, *reg);
 
     reg = &mAPICRegisters[gTimerInitialCount];
@@ -88,7 +155,7 @@ void APIC::configure(uint32_t ticks) {
     // assume APIC is counting down and sending interrupts from here...
 }
 
-APIC::APIC() : mAPICRegisters(nullptr), mTicksPerMs(0) {
+APIC::APIC() : mAPICRegisters(nullptr), mTicksPerMs(0), mTSCTicksPerMs(0), mOneShot(false) {
     if (CPUID::get().getFeatures().apic == false) {
         PANIC("system does not support APIC");
     } else {
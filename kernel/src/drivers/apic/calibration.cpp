@@ -18,23 +18,30 @@
 #include <kernel/drivers/pit/pit.h>
 #include <kernel/log/log.h>
 #include <kernel/i386/idt.h>
+#include <kernel/i386/primitives.h>
 
 static constexpr uint8_t gWantedCycles = 10;
 static_assert(gWantedCycles > 2, "at least 3 cycles required for calibration");
 
 static volatile uint8_t gNumCycles = 0;
 static uint32_t gCyclesDelta[gWantedCycles + 1] = {0};
+static uint64_t gTSCDelta[gWantedCycles + 1] = {0};
 static uint32_t gTime = 0;
+static uint64_t gTSC = 0;
 
 static bool pit_timer_helper(uint64_t) {
     auto apic_now = APIC::get().getTimerCurrent();
+    auto tsc_now = readtsc();
 
     if (gTime == 0) {
         gTime = apic_now;
+        gTSC = tsc_now;
     } else {
         gCyclesDelta[gNumCycles] = (gTime - apic_now);
+        gTSCDelta[gNumCycles] = (tsc_now - gTSC);
         ++gNumCycles;
         gTime = apic_now;
+        gTSC = tsc_now;
     }
 
     return (gNumCycles != gWantedCycles);
@@ -73,5 +80,22 @@ uint32_t APIC::calibrate() {
 
     LOG_DEBUG("cycles per 10ms = %u, per ms will be 1/10th that", cycles_per_10ms_avg);
 
+    // the TSC was sampled on the same PIT interrupts, so it gets the same treatment
+    uint64_t tsc_per_10ms_avg = 0;
+    uint64_t max_tsc = 0;
+    uint64_t min_tsc = 0xFFFFFFFFFFFFFFFFULL;
+    for (auto i = 0u; i < gWantedCycles; ++i) {
+        auto tsc = gTSCDelta[i];
+        if (tsc > max_tsc) max_tsc = tsc;
+        if (tsc < min_tsc) min_tsc = tsc;
+        tsc_per_10ms_avg += tsc;
+    }
+    tsc_per_10ms_avg -= max_tsc;
+    tsc_per_10ms_avg -= min_tsc;
+    tsc_per_10ms_avg = tsc_per_10ms_avg / (gWantedCycles - 2);
+    mTSCTicksPerMs = tsc_per_10ms_avg / 10;
+
+    LOG_DEBUG("TSC ticks per 10ms = %llu", tsc_per_10ms_avg);
+
     return (mTicksPerMs = cycles_per_10ms_avg / 10);
 }
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <kernel/drivers/apic/apic.h>
+#include <kernel/drivers/acpi/acpica/acpica.h>
+#include <kernel/boot/phase.h>
+#include <kernel/i386/idt.h>
+#include <kernel/i386/primitives.h>
+#include <kernel/i386/sysenter.h>
+#include <kernel/libc/memory.h>
+#include <kernel/libc/string.h>
+#include <kernel/log/log.h>
+#include <kernel/mm/virt.h>
+#include <kernel/process/cpu.h>
+#include <kernel/process/manager.h>
+#include <kernel/synch/biglock.h>
+#include <kernel/time/manager.h>
+
+LOG_TAG(SMP, 1);
+
+// see trampoline.s
+extern "C" uint8_t smp_trampoline_start;
+extern "C" uint8_t smp_trampoline_params;
+extern "C" uint8_t smp_trampoline_end;
+
+struct trampoline_params_t {
+    uint32_t cr3;
+    uint32_t cr0;
+    uint32_t cr4;
+    uint32_t stack;
+    uint32_t cpu;
+} __attribute__((packed));
+
+static constexpr uintptr_t gTrampolineAddress = 0x8000;
+static constexpr size_t gAPStackSize = 4 * VirtualPageManager::gPageSize;
+
+static uint32_t reschedule(GPR&, InterruptStack&, void*) {
+    // nothing to do here - the idle loop looks at its ready queue as soon as the CPU wakes up,
+    // and a pending kill is handled on the way out of the interrupt
+    APIC::get().EOI();
+    return IRQ_RESPONSE_NONE;
+}
+
+static uint32_t shootdown(GPR&, InterruptStack&, void*) {
+    CPUs::get().serviceShootdown();
+    APIC::get().EOI();
+    return IRQ_RESPONSE_NONE;
+}
+
+// only used at boot, when there is nothing else for this CPU to do while it waits
+static void delay(uint64_t micros) {
+    auto& tmgr(TimeManager::get());
+    const auto end = tmgr.microsUptime() + micros;
+    while (tmgr.microsUptime() < end) {
+        __asm__ volatile("pause");
+    }
+}
+
+static bool startAP(cpu_t& cpu) {
+    auto& apic(APIC::get());
+
+    apic.sendINIT(cpu.apicid);
+    delay(10000);
+    // per the MP specification, a second SIPI is only sent if the first one did not take
+    for (auto i = 0; i < 2; ++i) {
+        apic.sendSIPI(cpu.apicid, gTrampolineAddress / VirtualPageManager::gPageSize);
+        delay(200);
+        if (__atomic_load_n(&cpu.online, __ATOMIC_SEQ_CST)) return true;
+    }
+
+    auto& tmgr(TimeManager::get());
+    const auto end = tmgr.microsUptime() + 100000;
+    while (tmgr.microsUptime() < end) {
+        if (__atomic_load_n(&cpu.online, __ATOMIC_SEQ_CST)) return true;
+        __asm__ volatile("pause");
+    }
+    return false;
+}
+
+// the MADT lists one local APIC entry per processor the firmware knows about
+static void discoverCPUs(uint8_t bspid) {
+    ACPI_TABLE_HEADER* tbl;
+    if (AE_OK != AcpiGetTable((char*)ACPI_SIG_MADT, 0, &tbl)) {
+        TAG_INFO(SMP, "no MADT found; running on the boot CPU only");
+        return;
+    }
+
+    auto& cpus(CPUs::get());
+    auto ptr = (uint8_t*)tbl + sizeof(ACPI_TABLE_MADT);
+    auto end = (uint8_t*)tbl + tbl->Length;
+    while (ptr < end) {
+        auto sub = (ACPI_SUBTABLE_HEADER*)ptr;
+        if (sub->Length == 0) break;
+        if (sub->Type == ACPI_MADT_TYPE_LOCAL_APIC) {
+            auto lapic = (ACPI_MADT_LOCAL_APIC*)ptr;
+            if ((lapic->LapicFlags & ACPI_MADT_ENABLED) && lapic->Id != bspid) {
+                if (cpus.add(lapic->Id) == nullptr) {
+                    TAG_INFO(SMP, "more than %u CPUs present; ignoring APIC ID %u", CPUs::gMaxCPUs, lapic->Id);
+                } else {
+                    TAG_DEBUG(SMP, "found CPU with APIC ID %u", lapic->Id);
+                }
+            }
+        }
+        ptr += sub->Length;
+    }
+
+    AcpiPutTable(tbl);
+}
+
+namespace boot::smp {
+    uint32_t init() {
+        auto& apic(APIC::get());
+        auto& cpus(CPUs::get());
+        auto& irqs(Interrupts::get());
+
+        // held until task0() is ready to idle; the other CPUs wait on it as soon as they are up
+        BigKernelLock::get().lock();
+
+        cpus.cpu(0).apicid = apic.id();
+
+        irqs.sethandler(CPUs::gRescheduleIRQ, "reschedule", reschedule);
+        irqs.sethandler(CPUs::gShootdownIRQ, "shootdown", shootdown);
+        irqs.setLockless(CPUs::gShootdownIRQ);
+
+        discoverCPUs(cpus.cpu(0).apicid);
+        if (cpus.count() == 1) return 0;
+
+        auto& vmm(VirtualPageManager::get());
+        const bool mapped = vmm.mapped(gTrampolineAddress);
+        if (!mapped) vmm.map(gTrampolineAddress, gTrampolineAddress, VirtualPageManager::map_options_t::kernel());
+
+        memcpy((void*)gTrampolineAddress, &smp_trampoline_start, &smp_trampoline_end - &smp_trampoline_start);
+        auto params = (trampoline_params_t*)(gTrampolineAddress + (&smp_trampoline_params - &smp_trampoline_start));
+        params->cr3 = readcr3();
+        // the idle process has no FPU state of its own, so start with TS set like every other switch does
+        params->cr0 = readcr0() | 0x8;
+        params->cr4 = readcr4();
+
+        auto& pmm(ProcessManager::get());
+        for (auto i = 1u; i < cpus.count(); ++i) {
+            auto& cpu(cpus.cpu(i));
+            pmm.prepareCPU(cpu);
+            params->stack = (uintptr_t)malloc(gAPStackSize) + gAPStackSize;
+            params->cpu = cpu.index;
+            if (startAP(cpu)) {
+                TAG_INFO(SMP, "CPU %u (APIC ID %u) is online", cpu.index, cpu.apicid);
+            } else {
+                // a late start would find parameters meant for another CPU, so do not try any more of them
+                LOG_ERROR("CPU %u (APIC ID %u) did not start", cpu.index, cpu.apicid);
+                break;
+            }
+        }
+
+        if (!mapped) vmm.unmap(gTrampolineAddress);
+
+        bootphase_t::printf("%u of %u CPUs online\n", cpus.online(), cpus.count());
+        return 0;
+    }
+
+    bool fail(uint32_t) {
+        return bootphase_t::gContinueBoot;
+    }
+}
+
+extern "C"
+void smp_ap_main(uint32_t index) {
+    // loading the task register first is what makes CPUs::current() work on this CPU
+    writetaskreg((CPUs::gFirstTSSIndex + index) * 8);
+    Interrupts::get().install();
+    APIC::get().setupAP();
+
+    auto& cpus(CPUs::get());
+    Sysenter::setup(cpus.cpu(index));
+    cpus.setOnline(cpus.cpu(index));
+
+    ProcessManager::get().idle();
+}
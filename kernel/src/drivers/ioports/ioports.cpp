@@ -139,7 +139,7 @@ namespace {
                         fh.filesystem = mFilesystem.newObject();
                         fh.object = file;
                         size_t descriptor = 0;
-                        if (false == gCurrentProcess->fds.set(fh, descriptor)) return -1;
+                        if (false == gCurrentProcess->fds->set(fh, descriptor)) return -1;
                         return descriptor;
                     }
                     default:
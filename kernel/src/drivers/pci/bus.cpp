@@ -186,6 +186,12 @@ uint32_t PCIBus::readword(const PCIBus::endpoint_t& endpoint, uint8_t word) {
     return inl(gConfigData);
 }
 
+void PCIBus::writeword(const PCIBus::endpoint_t& endpoint, uint8_t word, uint32_t value) {
+    auto addr = endpoint.address( )| (word << 2);
+    outl(gConfigAddress, addr);
+    outl(gConfigData, value);
+}
+
 PCIBus::ident_t PCIBus::identify(const endpoint_t& endpoint) {
     uint32_t word0 = readword(endpoint, 0);
     uint32_t word1 = readword(endpoint, 1);
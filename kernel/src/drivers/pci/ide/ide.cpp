@@ -26,6 +26,14 @@
 #include <kernel/fs/vol/disk.h>
 #include <kernel/fs/vol/partition.h>
 #include <kernel/libc/buffer.h>
+#include <kernel/libc/string.h>
+#include <kernel/mm/phys.h>
+#include <kernel/mm/virt.h>
+#include <kernel/i386/idt.h>
+#include <kernel/drivers/pic/pic.h>
+#include <kernel/process/current.h>
+#include <kernel/process/manager.h>
+#include <kernel/process/process.h>
 
 LOG_TAG(DISKACCESS, 2);
 
@@ -52,12 +60,18 @@ static constexpr uint8_t gReadPIOCommand = 0x20;
 static constexpr uint8_t gReadLBA48PIOCommand = 0x24;
 static constexpr uint8_t gWritePIOCommand = 0x30;
 static constexpr uint8_t gWriteLBA48PIOCommand = 0x34;
+static constexpr uint8_t gReadDMACommand = 0xC8;
+static constexpr uint8_t gReadLBA48DMACommand = 0x25;
+static constexpr uint8_t gWriteDMACommand = 0xCA;
+static constexpr uint8_t gWriteLBA48DMACommand = 0x35;
 static constexpr uint8_t gIdentifyCommand = 0xEC;
 static constexpr uint8_t gIdentifyPacket = 0xA1;
 static constexpr uint8_t gFlushCommand = 0xE7;
 static constexpr uint8_t gFlush48Command = 0xEA;
 static constexpr uint8_t gSetFeaturesCommand = 0xEF;
     static constexpr uint8_t gSetFeatures_TransferMode = 0x3;
+    static constexpr uint8_t gTransferMode_MWDMA = 0x20;
+    static constexpr uint8_t gTransferMode_UDMA = 0x40;
 
 static constexpr uint8_t gStatusError = 0x01;
 static constexpr uint8_t gStatusRequestReady = 0x08;
@@ -67,6 +81,29 @@ static constexpr uint8_t gStatusBusy = 0x80;
 
 static constexpr uint32_t g48BitAddressing = 1 << 26;
 static constexpr uint32_t g28BitAddressing = 1 << 9;
+static constexpr uint32_t gDMASupported = 1 << 8;
+
+// bus master registers, relative to the channel's bus master I/O base
+static constexpr uint8_t gBusMasterCommand = 0x00;
+static constexpr uint8_t gBusMasterStatus = 0x02;
+static constexpr uint8_t gBusMasterPRDT = 0x04;
+
+static constexpr uint8_t gBusMasterStart = 0x01;
+static constexpr uint8_t gBusMasterToMemory = 0x08;
+
+static constexpr uint8_t gBusMasterActive = 0x01;
+static constexpr uint8_t gBusMasterError = 0x02;
+static constexpr uint8_t gBusMasterInterrupt = 0x04;
+
+static constexpr uint16_t gPRDEndOfTable = 0x8000;
+
+static constexpr uint8_t gProgIfBusMaster = 0x80;
+static constexpr uint16_t gPCICommandBusMaster = 0x04;
+
+// the bounce buffer bounds how many sectors a single DMA command can move
+static constexpr size_t gDMABufferPages = 16;
+static constexpr size_t gDMAMaxSectors = gDMABufferPages * VirtualPageManager::gPageSize / 512;
+static_assert(gDMAMaxSectors <= 255, "DMA commands are limited to 255 sectors");
 
 static constexpr size_t gIdentityDeviceType = 0x00;
 static constexpr size_t gIdentityCylinders = 0x02;
@@ -75,6 +112,8 @@ static constexpr size_t gIdentitySectors = 0x0C;
 static constexpr size_t gIdentitySerial = 0x14;
 static constexpr size_t gIdentityModel = 0x36;
 static constexpr size_t gIdentityPIOModes = 0x40;
+static constexpr size_t gIdentityMWDMAModes = 0x7E;
+static constexpr size_t gIdentityUDMAModes = 0xB0;
 static constexpr size_t gIdentityCapabilities = 0x62;
 static constexpr size_t gIdentityFieldValid = 0x6A;
 static constexpr size_t gIdentityMaxLBA = 0x78;
@@ -209,41 +248,162 @@ bool IDEController::preparepio(const disk_t& disk, const pio_op_params_t& params
 }
 
 bool IDEController::read(const disk_t& disk, uint32_t sec0, uint16_t num, unsigned char *buffer) {
-    constexpr uint8_t implseclimit = 255;
-    constexpr size_t implsizelimit = implseclimit * 512;
+    lock(disk.chan);
+    bool ok = transfer(disk, sec0, num, buffer, false);
+    unlock(disk.chan);
+    return ok;
+}
+
+bool IDEController::write(const disk_t& disk, uint32_t sec0, uint16_t num, unsigned char* buffer) {
+    lock(disk.chan);
+    bool ok = transfer(disk, sec0, num, buffer, true);
+    unlock(disk.chan);
+    return ok;
+}
 
-    while (num > implseclimit) {
-        auto ok = doread(disk, sec0, implseclimit, buffer);
+bool IDEController::transfer(const disk_t& disk, uint32_t sec0, uint16_t num, unsigned char* buffer, bool towrite) {
+    const bool dma = usedma(disk);
+    const uint8_t implseclimit = dma ? gDMAMaxSectors : 255;
+
+    while (num != 0) {
+        const uint8_t count = (num > implseclimit) ? implseclimit : (uint8_t)num;
+        bool ok;
+        if (dma) ok = dodma(disk, sec0, count, buffer, towrite);
+        else if (towrite) ok = dowrite(disk, sec0, count, buffer);
+        else ok = doread(disk, sec0, count, buffer);
         if (!ok) return false;
-        buffer += implsizelimit;
-        num -= implseclimit;
-        sec0 += implseclimit;
+        buffer += count * 512;
+        num -= count;
+        sec0 += count;
     }
 
-    if (num != 0) {
-        return doread(disk, sec0, (uint8_t)num, buffer);
+    return true;
+}
+
+bool IDEController::usedma(const disk_t& disk) const {
+    auto&& dma = mDMA[(uint8_t)disk.chan];
+    auto&& device = mChannel[(uint8_t)disk.chan].devices[(uint8_t)disk.bus];
+    return dma.enabled && (device.features & gDMASupported);
+}
+
+void IDEController::lock(channelid_t ch) {
+    auto& dma = mDMA[(uint8_t)ch];
+    while (dma.busy) dma.lockwq.yield(gCurrentProcess, 0);
+    dma.busy = true;
+    if (gCurrentProcess) ++gCurrentProcess->heldlocks;
+}
+
+void IDEController::unlock(channelid_t ch) {
+    auto& dma = mDMA[(uint8_t)ch];
+    dma.busy = false;
+    if (gCurrentProcess) --gCurrentProcess->heldlocks;
+    dma.lockwq.wakeone();
+}
+
+void IDEController::completedma(dma_channel_t* dma, uint8_t bmstatus) {
+    // writing the interrupt and error bits back clears them; reading the status register
+    // acknowledges the interrupt on the drive's side
+    outb(dma->master + gBusMasterStatus, bmstatus | gBusMasterInterrupt | gBusMasterError);
+    inb(dma->iobase + gStatusRegister);
+    dma->status = bmstatus;
+    dma->done = true;
+}
+
+uint32_t IDEController::onIRQ(GPR&, InterruptStack&, void* payload) {
+    auto dma = (dma_channel_t*)payload;
+    bool wake = false;
+
+    auto bmstatus = inb(dma->master + gBusMasterStatus);
+    if ((bmstatus & gBusMasterInterrupt) && !dma->done) {
+        completedma(dma, bmstatus);
+        wake = true;
     } else {
-        return true;
+        // PIO commands and flushes interrupt too; just acknowledge them
+        inb(dma->iobase + gStatusRegister);
     }
+
+    PIC::eoi(dma->irq);
+    return wake ? IRQ_RESPONSE_WAKE : IRQ_RESPONSE_NONE;
 }
 
-bool IDEController::write(const disk_t& disk, uint32_t sec0, uint16_t num, unsigned char* buffer) {
-    constexpr uint8_t implseclimit = 255;
-    constexpr size_t implsizelimit = implseclimit * 512;
+void IDEController::waitdma(channelid_t ch) {
+    auto& dma = mDMA[(uint8_t)ch];
+
+    // during boot there is nothing else to run, and nowhere to return to from a sleep
+    const bool cansleep = gCurrentProcess && (gCurrentProcess->pid != 0) && (Interrupts::get().irqDepth() == 0);
+
+    while (!dma.done) {
+        if (cansleep) {
+            // the IRQ must not come in between checking for completion and joining the queue
+            auto& irqs(Interrupts::get());
+            const bool enabled = irqs.enabled();
+            if (enabled) irqs.disable();
+            const bool waiting = !dma.done;
+            if (waiting) dma.irqwq.wait(gCurrentProcess);
+            if (enabled) irqs.enable();
+            if (waiting) ProcessManager::get().yield();
+        } else {
+            auto bmstatus = inb(dma.master + gBusMasterStatus);
+            if (bmstatus & (gBusMasterInterrupt | gBusMasterError)) completedma(&dma, bmstatus);
+        }
+    }
+}
 
-    while (num > implseclimit) {
-        auto ok = dowrite(disk, sec0, implseclimit, buffer);
-        if (!ok) return false;
-        buffer += implsizelimit;
-        num -= implseclimit;
-        sec0 += implseclimit;
+bool IDEController::dodma(const disk_t& disk, uint32_t sector, uint8_t num, unsigned char* buffer, bool towrite) {
+    auto& dma = mDMA[(uint8_t)disk.chan];
+    const size_t len = num * 512;
+    if (towrite) memcpy(dma.buffer, buffer, len);
+
+    // one descriptor per page, which keeps every descriptor clear of 64KB boundaries
+    size_t n = 0;
+    for (size_t done = 0; done < len; done += VirtualPageManager::gPageSize, ++n) {
+        size_t chunk = len - done;
+        if (chunk > VirtualPageManager::gPageSize) chunk = VirtualPageManager::gPageSize;
+        dma.prdt[n] = prd_t{(uint32_t)(dma.bufferphys + done), (uint16_t)chunk, 0};
+    }
+    dma.prdt[n - 1].flags = gPRDEndOfTable;
+
+    const uint8_t direction = towrite ? 0 : gBusMasterToMemory;
+    outb(dma.master + gBusMasterCommand, 0);
+    outl(dma.master + gBusMasterPRDT, dma.prdtphys);
+    outb(dma.master + gBusMasterStatus, inb(dma.master + gBusMasterStatus) | gBusMasterInterrupt | gBusMasterError);
+    outb(dma.master + gBusMasterCommand, direction);
+
+    pio_op_params_t params{disk, sector, num};
+    if (towrite) params.command = params.lba48 ? gWriteLBA48DMACommand : gWriteDMACommand;
+    else params.command = params.lba48 ? gReadLBA48DMACommand : gReadDMACommand;
+
+    TAG_DEBUG(DISKACCESS, "attempting DMA %s disk %u-%u:%u - count: %u",
+        towrite ? "to" : "from", disk.chan, disk.bus, sector, params.count);
+
+    dma.done = false;
+    if (!preparepio(disk, params)) {
+        TAG_ERROR(DISKACCESS, "DMA failed - disk had error");
+        return false;
     }
+    outb(dma.master + gBusMasterCommand, direction | gBusMasterStart);
 
-    if (num != 0) {
-        return dowrite(disk, sec0, (uint8_t)num, buffer);
+    waitdma(disk.chan);
+    outb(dma.master + gBusMasterCommand, 0);
+
+    auto status = read(disk.chan, gStatusRegister);
+    if ((dma.status & gBusMasterError) || (status & gStatusError) || (status & gStatusDeviceFault)) {
+        TAG_ERROR(DISKACCESS, "DMA failed - bus master status: 0x%x status register: 0x%x", dma.status, status);
+        return false;
+    }
+
+    if (towrite) {
+        write(disk.chan, gCommandRegister, params.flushcmd);
+        if (!poll(disk.chan, false)) {
+            TAG_ERROR(DISKACCESS, "DMA write failed - flush error");
+            return false;
+        }
     } else {
-        return true;
+        memcpy(buffer, dma.buffer, len);
     }
+
+    TAG_DEBUG(DISKACCESS, "DMA operation completed");
+    return true;
 }
 
 bool IDEController::doread(const disk_t& disk, uint32_t sector, uint8_t num, unsigned char *buffer) {
@@ -380,6 +540,95 @@ size_t IDEController::configurepio() {
     return count;
 }
 
+size_t IDEController::configuredma() {
+    // without a bus master I/O range there is no way to program DMA
+    if (0 == (mInfo.ident.progif & gProgIfBusMaster) || mInfo.bar4 == 0) {
+        LOG_INFO("IDE controller %s does not support bus mastering; using PIO", id());
+        return 0;
+    }
+
+    auto ep = mInfo.endpoint;
+    auto cmd = PCIBus::readword(ep, 1) & 0xFFFF;
+    PCIBus::writeword(ep, 1, cmd | gPCICommandBusMaster);
+
+    auto&& pmm(PhysicalPageManager::get());
+    auto&& vmm(VirtualPageManager::get());
+    size_t count = 0;
+
+    for (size_t c = 0; c < 2; ++c) {
+        channelid_t ch = (channelid_t)c;
+        auto& channel = mChannel[c];
+        auto& dma = mDMA[c];
+
+        bool any = false;
+        for (size_t d = 0; d < 2; ++d) {
+            auto& dev = channel.devices[d];
+            if (!dev.present || 0 == (dev.features & gDMASupported)) continue;
+            any = true;
+
+            // modes beyond UDMA2 need the cable to be checked first, so don't go there
+            uint8_t mode = 0;
+            if (dev.udmamodes & 0x7) mode = gTransferMode_UDMA | (31 - __builtin_clz(dev.udmamodes & 0x7));
+            else if (dev.mwdmamodes) mode = gTransferMode_MWDMA | (31 - __builtin_clz(dev.mwdmamodes));
+            if (mode == 0) continue;
+
+            write(ch, gDiskSelectorRegister, 0xA0 | (d << 4));
+            wait400(ch);
+            write(ch, gFeatureRegister, gSetFeatures_TransferMode);
+            write(ch, gSectorCountRegister, mode);
+            write(ch, gCommandRegister, gSetFeaturesCommand);
+            wait400(ch);
+            if (!poll(ch, true, false, true)) {
+                LOG_ERROR("c=%u d=%u failed to set DMA mode 0x%x - will use HW default", c, d, mode);
+            }
+        }
+        if (!any) continue;
+
+        interval_t rgn;
+        if (!pmm.allocContiguousPages(1, &dma.prdtphys)) {
+            LOG_ERROR("c=%u cannot allocate DMA memory; using PIO", c);
+            continue;
+        }
+        if (!pmm.allocContiguousPages(gDMABufferPages, &dma.bufferphys)) {
+            LOG_ERROR("c=%u cannot allocate DMA memory; using PIO", c);
+            pmm.dealloc(dma.prdtphys);
+            continue;
+        }
+        if (!vmm.findKernelRegion((gDMABufferPages + 1) * VirtualPageManager::gPageSize, rgn)) {
+            LOG_ERROR("c=%u cannot map DMA memory; using PIO", c);
+            pmm.dealloc(dma.prdtphys);
+            for (size_t i = 0; i < gDMABufferPages; ++i) {
+                pmm.dealloc(dma.bufferphys + i * VirtualPageManager::gPageSize);
+            }
+            continue;
+        }
+        vmm.addKernelRegion(rgn.from, rgn.to);
+        vmm.map(dma.prdtphys, rgn.from, VirtualPageManager::map_options_t::kernel().cached(false));
+        vmm.maprange(dma.bufferphys, dma.bufferphys + gDMABufferPages * VirtualPageManager::gPageSize - 1,
+            rgn.from + VirtualPageManager::gPageSize, VirtualPageManager::map_options_t::kernel());
+        dma.prdt = (prd_t*)rgn.from;
+        dma.buffer = (unsigned char*)(rgn.from + VirtualPageManager::gPageSize);
+
+        // channels in native mode use the PCI interrupt line; compatibility mode uses the legacy IRQs
+        const uint8_t nativebit = (c == 0) ? 0x01 : 0x04;
+        dma.irq = (mInfo.ident.progif & nativebit) ? mInfo.irql : (c == 0 ? 14 : 15);
+        dma.iobase = channel.iobase;
+        dma.master = channel.master;
+        Interrupts::get().sethandler(PIC::gIRQNumber(dma.irq), c == 0 ? "IDE0" : "IDE1", onIRQ, &dma, &dma.irqwq);
+        PIC::get().accept(dma.irq);
+
+        // let the drives raise interrupts on this channel
+        channel.irqoff = 0;
+        write(ch, gControlRegister, 0);
+
+        dma.enabled = true;
+        ++count;
+        LOG_INFO("IDE controller %s channel %u uses DMA on IRQ %u", id(), c, dma.irq);
+    }
+
+    return count;
+}
+
 IDEController::IDEController(const PCIBus::pci_hdr_0& info) : DiskController(nullptr), mInfo(info) {
     static size_t gIdeControllerCount = 0;
     buffer nameBuf(22);
@@ -444,6 +693,8 @@ IDEController::IDEController(const PCIBus::pci_hdr_0& info) : DiskController(nul
                 present : false,
                 kind : channel_t::device_t::kind_t::ata,
                 modes : 0,
+                mwdmamodes : 0,
+                udmamodes : 0,
                 serial : {0},
                 signature : 0,
                 features : 0,
@@ -455,6 +706,8 @@ IDEController::IDEController(const PCIBus::pci_hdr_0& info) : DiskController(nul
                 present : false,
                 kind : channel_t::device_t::kind_t::ata,
                 modes : 0,
+                mwdmamodes : 0,
+                udmamodes : 0,
                 serial : {0}, 
                 signature : 0,
                 features : 0,
@@ -475,6 +728,8 @@ IDEController::IDEController(const PCIBus::pci_hdr_0& info) : DiskController(nul
                 present : false,
                 kind : channel_t::device_t::kind_t::ata,
                 modes : 0,
+                mwdmamodes : 0,
+                udmamodes : 0,
                 serial : {0}, 
                 signature : 0,
                 features : 0,
@@ -486,6 +741,8 @@ IDEController::IDEController(const PCIBus::pci_hdr_0& info) : DiskController(nul
                 present : false,
                 kind : channel_t::device_t::kind_t::ata,
                 modes : 0,
+                mwdmamodes : 0,
+                udmamodes : 0,
                 serial : {0}, 
                 signature : 0,
                 features : 0,
@@ -496,6 +753,16 @@ IDEController::IDEController(const PCIBus::pci_hdr_0& info) : DiskController(nul
         }
     };
 
+    for (auto& dma : mDMA) {
+        dma.enabled = dma.busy = dma.done = false;
+        dma.irq = 0;
+        dma.iobase = dma.master = 0;
+        dma.prdtphys = dma.bufferphys = 0;
+        dma.prdt = nullptr;
+        dma.buffer = nullptr;
+        dma.status = 0;
+    }
+
     write(channel0, gControlRegister, 2);
     write(channel1, gControlRegister, 2);
 
@@ -569,6 +836,8 @@ IDEController::IDEController(const PCIBus::pci_hdr_0& info) : DiskController(nul
             device.features = buf.word[gIdentityCapabilities / 2];
             device.cmdsets = buf.dword[gIdentityCommandSets / 4];
             device.modes = buf.word[gIdentityPIOModes];
+            device.mwdmamodes = buf.word[gIdentityMWDMAModes / 2] & 0x7;
+            device.udmamodes = buf.word[gIdentityUDMAModes / 2] & 0x7F;
 
             if (device.cmdsets & g48BitAddressing) {
                 device.sectors = buf.dword[gIdentityMaxLBAExt / 4];
@@ -602,6 +871,7 @@ IDEController::IDEController(const PCIBus::pci_hdr_0& info) : DiskController(nul
     }
 
     configurepio();
+    configuredma();
     sendDisksToManager();
 }
 
@@ -17,6 +17,9 @@
 #include <kernel/drivers/ram/ram.h>
 #include <kernel/fs/devfs/devfs.h>
 #include <kernel/mm/phys.h>
+#include <kernel/mm/slab.h>
+#include <kernel/mm/zeropool.h>
+#include <kernel/fs/pagecache.h>
 #include <kernel/libc/buffer.h>
 #include <kernel/libc/sprint.h>
 
@@ -39,6 +42,86 @@ RAM_FILE(free, getfreemem);
 
 #undef RAM_FILE
 
+namespace {
+    class SlabCacheFile : public MemFS::File {
+        public:
+            SlabCacheFile(size_t cache, const char* name) : MemFS::File(name), mCache(cache) {}
+
+            delete_ptr<MemFS::FileBuffer> content() override {
+                SlabAllocator::cache_stats_t stats;
+                if (!SlabAllocator::get().stats(mCache, &stats)) return nullptr;
+
+                // fragmentation is the percentage of slab capacity that is not currently in use
+                size_t frag = stats.capacity ? (100 * (stats.capacity - stats.inuse)) / stats.capacity : 0;
+                buffer b(512);
+                b.printf("objsize: %u\nslabs: %u\nempty slabs: %u\ncapacity: %u\nin use: %u\nallocs: %llu\nfrees: %llu\nfragmentation: %u%%\n",
+                    stats.objsize, stats.slabs, stats.emptyslabs, stats.capacity, stats.inuse, stats.allocs, stats.frees, frag);
+                return new MemFS::StringBuffer(string(b.c_str()));
+            }
+        private:
+            size_t mCache;
+    };
+
+    class FreeBlocksFile : public MemFS::File {
+        public:
+            FreeBlocksFile() : MemFS::File("freeblocks") {}
+
+            delete_ptr<MemFS::FileBuffer> content() override {
+                size_t counts[PhysicalPageManager::gMaxBlockOrder + 1];
+                PhysicalPageManager::get().freeblocks(&counts[0]);
+                buffer b(512);
+                size_t written = 0;
+                for (auto order = 0u; order <= PhysicalPageManager::gMaxBlockOrder; ++order) {
+                    written += sprint(b.data<char>() + written, b.size() - written - 1, "order %u: %u\n", order, counts[order]);
+                }
+                return new MemFS::StringBuffer(string(b.c_str()));
+            }
+    };
+
+    class ZeroPoolFile : public MemFS::File {
+        public:
+            ZeroPoolFile() : MemFS::File("zeropool") {}
+
+            delete_ptr<MemFS::FileBuffer> content() override {
+                auto& pool(ZeroPagePool::get());
+                buffer b(256);
+                b.printf("size: %u\nlow watermark: %u\nhigh watermark: %u\nhits: %llu\nmisses: %llu\n",
+                    pool.size(), pool.low(), pool.high(), pool.hits(), pool.misses());
+                return new MemFS::StringBuffer(string(b.c_str()));
+            }
+    };
+
+    class PageCacheFile : public MemFS::File {
+        public:
+            PageCacheFile() : MemFS::File("pagecache") {}
+
+            delete_ptr<MemFS::FileBuffer> content() override {
+                auto& cache(PageCache::get());
+                const uint64_t lookups = cache.hits() + cache.misses();
+                const uint32_t hitrate = lookups ? (uint32_t)(100 * cache.hits() / lookups) : 0;
+                buffer b(256);
+                b.printf("files: %u\nresident pages: %u\nresident bytes: %u\nhits: %llu\nmisses: %llu\nhit rate: %u%%\nevictions: %llu\n",
+                    cache.numFiles(), cache.residentPages(), cache.residentPages() * VirtualPageManager::gPageSize,
+                    cache.hits(), cache.misses(), hitrate, cache.evictions());
+                return new MemFS::StringBuffer(string(b.c_str()));
+            }
+    };
+
+    class LargeAllocationsFile : public MemFS::File {
+        public:
+            LargeAllocationsFile() : MemFS::File("large") {}
+
+            delete_ptr<MemFS::FileBuffer> content() override {
+                malloc_large_stats_t stats;
+                malloc_large_stats(&stats);
+                buffer b(256);
+                b.printf("reserved: %u\nin use: %u\nallocs: %llu\nfrees: %llu\npooled slab pages: %u\n",
+                    stats.reserved, stats.inuse, stats.allocs, stats.frees, SlabAllocator::get().pooledPages());
+                return new MemFS::StringBuffer(string(b.c_str()));
+            }
+    };
+}
+
 RamDevice& RamDevice::get() {
     static RamDevice gDevice;
 
@@ -50,4 +133,18 @@ RamDevice::RamDevice() : mDeviceDirectory(nullptr) {
     mDeviceDirectory = devfs.getDeviceDirectory("memory");
     mDeviceDirectory->add(new free());
     mDeviceDirectory->add(new total());
+    mDeviceDirectory->add(new FreeBlocksFile());
+    mDeviceDirectory->add(new ZeroPoolFile());
+    mDeviceDirectory->add(new PageCacheFile());
+
+    auto kmallocDirectory = new MemFS::Directory("kmalloc");
+    mDeviceDirectory->add(kmallocDirectory);
+    for (auto i = 0u; i < SlabAllocator::gNumCaches; ++i) {
+        SlabAllocator::cache_stats_t stats;
+        SlabAllocator::get().stats(i, &stats);
+        buffer name(16);
+        name.printf("%u", stats.objsize);
+        kmallocDirectory->add(new SlabCacheFile(i, name.c_str()));
+    }
+    kmallocDirectory->add(new LargeAllocationsFile());
 }
@@ -107,6 +107,10 @@ class FATFileSystemFile : public Filesystem::File {
             }
         }
 
+        bool cacheable() const override {
+            return true;
+        }
+
         bool doStat(stat_t& stat) override {
             stat.kind = file_kind_t::file;
             stat.size = mFileInfo.fsize ? mFileInfo.fsize : f_size(mFile);
@@ -362,6 +366,24 @@ bool FATFileSystem::mkdir(const char* path) {
     return false;
 }
 
+// anything else f_stat() can fail with (a disk error, say) may well go away, so only a missing
+// name, or a missing directory on the way to it, counts
+bool FATFileSystem::absent(const char* path) {
+    if (path == nullptr || path[0] == 0) return false;
+    auto len = 4 + strlen(path);
+    delete_ptr<char> fullpath((char*)calloc(len, 1));
+    sprint(fullpath.get(), len, "%d:%s", mFatFS.pdrv, path);
+
+    FILINFO fi;
+    switch (f_stat(fullpath.get(), &fi)) {
+        case FR_NO_FILE:
+        case FR_NO_PATH:
+            return true;
+        default:
+            return false;
+    }
+}
+
 bool FATFileSystem::fillInfo(filesystem_info_t* info) {
     bzero(info, sizeof(*info));
 
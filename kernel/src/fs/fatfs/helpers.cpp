@@ -18,6 +18,9 @@
 #include <kernel/libc/time.h>
 #include <kernel/fs/fatfs/fs.h>
 #include <kernel/fs/vol/volume.h>
+#include <kernel/libc/memory.h>
+#include <kernel/process/current.h>
+#include <kernel/synch/waitqueue.h>
 
 namespace {
     union fat_time_t {
@@ -35,6 +38,63 @@ namespace {
     static_assert(sizeof(fat_time_t) == sizeof(uint32_t));
     // wish I could write this:
     // static_assert( fat_time_t{1}.representation.second == 1 );
+
+    // FatFs holds this around every operation on a volume; a disk request can put the calling
+    // process to sleep, and another process must not enter FatFs for the same volume meanwhile.
+    // It is recursive, since a page fault on a user buffer can re-enter FatFs from the owner
+    struct fatfs_lock_t {
+        process_t* owner;
+        uint32_t depth;
+        WaitQueue waiters;
+    };
+}
+
+extern "C"
+void* ff_memalloc (UINT msize) {
+    return malloc(msize);
+}
+
+extern "C"
+void ff_memfree (void* mblock) {
+    free(mblock);
+}
+
+extern "C"
+int ff_cre_syncobj (BYTE, FF_SYNC_t* sobj) {
+    auto lock = new fatfs_lock_t();
+    lock->owner = nullptr;
+    lock->depth = 0;
+    *sobj = lock;
+    return 1;
+}
+
+extern "C"
+int ff_del_syncobj (FF_SYNC_t sobj) {
+    delete (fatfs_lock_t*)sobj;
+    return 1;
+}
+
+extern "C"
+int ff_req_grant (FF_SYNC_t sobj) {
+    auto lock = (fatfs_lock_t*)sobj;
+    while (lock->depth != 0 && lock->owner != gCurrentProcess) {
+        lock->waiters.yield(gCurrentProcess, 0);
+    }
+    if (lock->depth++ == 0) {
+        lock->owner = gCurrentProcess;
+        if (gCurrentProcess) ++gCurrentProcess->heldlocks;
+    }
+    return 1;
+}
+
+extern "C"
+void ff_rel_grant (FF_SYNC_t sobj) {
+    auto lock = (fatfs_lock_t*)sobj;
+    if (--lock->depth == 0) {
+        if (lock->owner) --lock->owner->heldlocks;
+        lock->owner = nullptr;
+        lock->waiters.wakeone();
+    }
 }
 
 extern "C"
@@ -78,7 +138,7 @@ DRESULT disk_write (FATFS* pdrv, const BYTE* buff, DWORD sector, UINT count) {
 extern "C"
 DRESULT disk_ioctl (FATFS* pdrv, BYTE cmd, void* buff) {
     switch (cmd) {
-        case CTRL_SYNC:
+        case CTRL_SYNC: return pdrv->vol->flush() ? RES_OK : RES_ERROR;
         case CTRL_TRIM: break;
         case GET_SECTOR_COUNT: *(uint32_t*)buff = pdrv->vol->numsectors(); break;
         case GET_SECTOR_SIZE: *(uint32_t*)buff = pdrv->vol->sectorsize(); break;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <kernel/fs/filesystem.h>
+#include <kernel/fs/pagecache.h>
 #include <kernel/log/log.h>
 #include <kernel/panic/panic.h>
 
@@ -46,13 +47,46 @@ void Filesystem::FilesystemObject::kind(kind_t k) {
     mKind = k;
 }
 
-Filesystem::File::File() : FilesystemObject(Filesystem::FilesystemObject::kind_t::file) {}
+Filesystem::File::File() : FilesystemObject(Filesystem::FilesystemObject::kind_t::file), mPageCache(nullptr) {}
+
+Filesystem::File::~File() {
+    if (mPageCache) PageCache::get().release(mPageCache);
+}
+
+bool Filesystem::File::cacheable() const {
+    return false;
+}
+
+bool Filesystem::File::sharedMemory() const {
+    return false;
+}
+
+uintptr_t Filesystem::File::sharedPage(size_t) {
+    return 0;
+}
+
+pagecache_file_t* Filesystem::File::pagecache() const {
+    return mPageCache;
+}
+
+void Filesystem::File::pagecache(pagecache_file_t* entry) {
+    mPageCache = entry;
+}
 Filesystem::Directory::Directory() : FilesystemObject(Filesystem::FilesystemObject::kind_t::directory) {}
 
 WaitableObject* Filesystem::File::waitable() {
     return nullptr;
 }
 
+Pollable* Filesystem::File::pollable() {
+    return waitable();
+}
+
+uint32_t Filesystem::File::ready() {
+    if (auto p = pollable()) return p->ready();
+    return POLL_IN | POLL_OUT;
+}
+
 uintptr_t Filesystem::File::ioctl(uintptr_t, uintptr_t) {
     return 0;
 }
@@ -84,6 +84,18 @@ Filesystem::Directory* Initrd::doOpendir(const char* path) {
     return nullptr;
 }
 
+// an initrd never changes, so anything not in its table will never be there
+bool Initrd::absent(const char* path) {
+    if (path == nullptr) return false;
+    if (path[0] == '/') ++path;
+    if (path[0] == 0) return false;
+    for (auto i = 0u; i < mFiles->count; ++i) {
+        auto f = file(i);
+        if (f && 0 == strcmp((const char*)f->name, path)) return false;
+    }
+    return true;
+}
+
 bool Initrd::fillInfo(filesystem_info_t* info) {
     info->fs_uuid = mHeader->serial;
     info->fs_free_size = 0;
@@ -0,0 +1,389 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/fs/pagecache.h>
+#include <kernel/mm/phys.h>
+#include <kernel/mm/virt.h>
+#include <kernel/libc/memory.h>
+#include <kernel/libc/string.h>
+#include <kernel/sys/config.h>
+#include <muzzle/strings.h>
+
+#define LOG_LEVEL 2
+#include <kernel/log/log.h>
+
+LOG_TAG(PAGECACHE, 2);
+
+// physical page reference counts are 8 bits wide; past this many users, processes get a private copy
+static constexpr size_t gMaxPageSharers = 250;
+
+// how many pages to try and free at once when memory runs low
+static constexpr size_t gReclaimBatch = 32;
+
+// the most pages read() brings in with one request to the file; 64KB is also the default size
+// at which the block cache lets a request go straight to the disk
+static constexpr size_t gMaxReadPages = 16;
+
+// only FAT files are cacheable, and FAT ignores case in names; matching paths any other way would let a
+// write through one spelling of a name leave the cached pages of another spelling in place
+static bool samePath(const char* a, const char* b) {
+    return 0 == strcasecmp(a, b);
+}
+
+struct pagecache_page_t {
+    pagecache_file_t* file;
+    size_t index;
+    uintptr_t phys;
+    pagecache_page_t* prev;
+    pagecache_page_t* next;
+};
+
+static size_t pagecache_reclaim(size_t npages) {
+    return PageCache::get().reclaim(npages);
+}
+
+PageCache& PageCache::get() {
+    static PageCache gCache;
+
+    return gCache;
+}
+
+PageCache::PageCache() : mFiles(), mLRUHead(nullptr), mLRUTail(nullptr), mFreeNodes(nullptr),
+    mResident(0), mHits(0), mMisses(0), mEvictions(0) {
+    PhysicalPageManager::get().reclaimer(pagecache_reclaim);
+}
+
+pagecache_file_t* PageCache::acquire(Filesystem* fs, const char* path, const file_stat_t& stat) {
+    for (auto entry : mFiles) {
+        if (entry->fs != fs || !samePath(entry->path, path)) continue;
+        if (entry->size == stat.size && entry->time == stat.time) {
+            mFiles.remove(entry);
+            mFiles.add(entry);
+            ++entry->refcount;
+            return entry;
+        }
+        TAG_DEBUG(PAGECACHE, "%s has changed on disk; dropping cached pages", path);
+        invalidate(fs, path);
+        break;
+    }
+
+    auto entry = new pagecache_file_t();
+    entry->fs = fs;
+    entry->path = strdup(path);
+    entry->size = stat.size;
+    entry->time = stat.time;
+    entry->numpages = (stat.size + VirtualPageManager::gPageSize - 1) / VirtualPageManager::gPageSize;
+    entry->pages = (pagecache_page_t**)calloc(entry->numpages + 1, sizeof(pagecache_page_t*));
+    entry->resident = 0;
+    entry->refcount = 2; // the caller's reference, and the cache's own
+    entry->stale = false;
+    TAG_DEBUG(PAGECACHE, "new entry 0x%p for %s, %u pages", entry, path, entry->numpages);
+
+    mFiles.add(entry);
+    trim();
+    return entry;
+}
+
+void PageCache::attach(Filesystem* fs, const char* path, Filesystem::File* file, bool writable) {
+    if (!file->cacheable()) return;
+
+    file_stat_t stat;
+    if (!file->stat(stat)) return;
+
+    auto entry = acquire(fs, path, stat);
+    if (writable) invalidate(fs, path);
+    file->pagecache(entry);
+}
+
+void PageCache::release(pagecache_file_t* entry) {
+    auto rc = --entry->refcount;
+    if (rc == 0) destroy(entry);
+    else if (rc == 1 && !entry->stale) trim();
+}
+
+void PageCache::invalidate(Filesystem* fs, const char* path) {
+    for (auto entry : mFiles) {
+        if (entry->fs != fs || !samePath(entry->path, path)) continue;
+        TAG_DEBUG(PAGECACHE, "invalidating entry 0x%p for %s", entry, path);
+        entry->stale = true;
+        mFiles.remove(entry);
+
+        // pages that processes still have mapped stay with the entry until it goes away
+        auto&& pmm(PhysicalPageManager::get());
+        for (auto i = 0u; i < entry->numpages; ++i) {
+            auto page = entry->pages[i];
+            if (page && pmm.refcount(page->phys) == 1) evict(page);
+        }
+
+        release(entry);
+        return;
+    }
+}
+
+void PageCache::written(Filesystem::File* file) {
+    if (auto entry = file->pagecache()) invalidate(entry->fs, entry->path);
+}
+
+void PageCache::destroy(pagecache_file_t* entry) {
+    TAG_DEBUG(PAGECACHE, "releasing entry 0x%p for %s", entry, entry->path);
+    for (auto i = 0u; i < entry->numpages; ++i) {
+        if (entry->pages[i]) evict(entry->pages[i]);
+    }
+    free(entry->pages);
+    free(entry->path);
+    delete entry;
+}
+
+void PageCache::trim() {
+    // entries that nobody has open and that have nothing cached are of no use
+    size_t idle = 0;
+    pagecache_file_t* empty = nullptr;
+    for (auto entry : mFiles) {
+        if (entry->refcount != 1) continue;
+        if (entry->resident == 0 && empty == nullptr) empty = entry;
+        ++idle;
+    }
+    if (empty) {
+        invalidate(empty->fs, empty->path);
+        --idle;
+    }
+
+    // entries are kept in least recently opened order, so evict from the front
+    while (idle > gMaxIdleFiles) {
+        pagecache_file_t* victim = nullptr;
+        for (auto entry : mFiles) {
+            if (entry->refcount == 1) {
+                victim = entry;
+                break;
+            }
+        }
+        invalidate(victim->fs, victim->path);
+        --idle;
+    }
+}
+
+void PageCache::lruAppend(pagecache_page_t* page) {
+    page->next = nullptr;
+    page->prev = mLRUTail;
+    if (mLRUTail) mLRUTail->next = page;
+    else mLRUHead = page;
+    mLRUTail = page;
+}
+
+void PageCache::lruRemove(pagecache_page_t* page) {
+    if (page->prev) page->prev->next = page->next;
+    else mLRUHead = page->next;
+    if (page->next) page->next->prev = page->prev;
+    else mLRUTail = page->prev;
+    page->prev = page->next = nullptr;
+}
+
+void PageCache::evict(pagecache_page_t* page) {
+    auto entry = page->file;
+    entry->pages[page->index] = nullptr;
+    --entry->resident;
+    --mResident;
+    lruRemove(page);
+    PhysicalPageManager::get().dealloc(page->phys);
+
+    page->next = mFreeNodes;
+    mFreeNodes = page;
+}
+
+size_t PageCache::reclaim(size_t npages) {
+    auto&& pmm(PhysicalPageManager::get());
+
+    size_t freed = 0;
+    size_t scanned = 0;
+    const size_t limit = mResident;
+    auto page = mLRUHead;
+    while (page && freed < npages && scanned++ < limit) {
+        auto next = page->next;
+        if (pmm.refcount(page->phys) == 1) {
+            evict(page);
+            ++freed;
+            ++mEvictions;
+        } else {
+            // mapped by some process, so evicting it would not free any memory; give it another chance
+            lruRemove(page);
+            lruAppend(page);
+        }
+        page = next;
+    }
+
+    TAG_DEBUG(PAGECACHE, "reclaimed %u pages out of %u requested", freed, npages);
+    return freed;
+}
+
+void PageCache::lowMemoryCheck() {
+    auto minfree = gKernelConfiguration()->pagecache.minfree;
+    if (PhysicalPageManager::get().getfreepages() < minfree) reclaim(gReclaimBatch);
+}
+
+pagecache_file_t* PageCache::entry(Filesystem::File* file) const {
+    return file->pagecache();
+}
+
+uintptr_t PageCache::lookup(pagecache_file_t* entry, size_t offset) {
+    auto idx = offset / VirtualPageManager::gPageSize;
+    if (entry->stale || idx >= entry->numpages || entry->pages[idx] == nullptr) {
+        ++mMisses;
+        return 0;
+    }
+
+    auto&& pmm(PhysicalPageManager::get());
+    auto page = entry->pages[idx];
+    if (pmm.refcount(page->phys) >= gMaxPageSharers) {
+        ++mMisses;
+        return 0;
+    }
+
+    ++mHits;
+    lruRemove(page);
+    lruAppend(page);
+    return pmm.alloc(page->phys);
+}
+
+void PageCache::insert(pagecache_file_t* entry, size_t offset, uintptr_t phys) {
+    auto idx = offset / VirtualPageManager::gPageSize;
+    if (entry->stale || idx >= entry->numpages || entry->pages[idx] != nullptr) return;
+
+    lowMemoryCheck();
+
+    pagecache_page_t* page = mFreeNodes;
+    if (page) mFreeNodes = page->next;
+    else page = new pagecache_page_t();
+
+    // allocating the node could have caused a reclaim, or a concurrent insert
+    if (entry->pages[idx] != nullptr) {
+        page->next = mFreeNodes;
+        mFreeNodes = page;
+        return;
+    }
+
+    page->file = entry;
+    page->index = idx;
+    page->phys = PhysicalPageManager::get().alloc(VirtualPageManager::page(phys));
+    entry->pages[idx] = page;
+    ++entry->resident;
+    ++mResident;
+    lruAppend(page);
+}
+
+bool PageCache::contains(pagecache_file_t* entry, size_t offset) const {
+    auto idx = offset / VirtualPageManager::gPageSize;
+    return !entry->stale && idx < entry->numpages && entry->pages[idx] != nullptr;
+}
+
+bool PageCache::isShared(pagecache_file_t* entry, size_t offset, uintptr_t phys) const {
+    auto idx = offset / VirtualPageManager::gPageSize;
+    if (phys == 0 || idx >= entry->numpages || entry->pages[idx] == nullptr) return false;
+    return entry->pages[idx]->phys == VirtualPageManager::page(phys);
+}
+
+size_t PageCache::read(Filesystem::File* file, size_t len, char* dest) {
+    auto entry = file->pagecache();
+    size_t pos = 0;
+    if (entry == nullptr || entry->stale || !file->tell(&pos)) return file->read(len, dest);
+
+    if (pos >= entry->size) return 0;
+    if (len > entry->size - pos) len = entry->size - pos;
+
+    auto&& pmm(PhysicalPageManager::get());
+    auto&& vmm(VirtualPageManager::get());
+
+    size_t done = 0;
+    while (done < len) {
+        const auto offset = pos + done;
+        const auto pgoffset = VirtualPageManager::page(offset);
+        const auto inpage = offset - pgoffset;
+
+        if (auto phys = lookup(entry, pgoffset)) {
+            auto chunk = VirtualPageManager::gPageSize - inpage;
+            if (chunk > len - done) chunk = len - done;
+            {
+                auto sp = vmm.getScratchPage(phys, VirtualPageManager::map_options_t::kernel());
+                memcpy(dest + done, sp.get<char>() + inpage, chunk);
+            }
+            pmm.dealloc(phys);
+            done += chunk;
+            continue;
+        }
+
+        // this page and the uncached ones after it, up to the end of the request, come in with one read
+        const auto last = VirtualPageManager::page(pos + len - 1);
+        size_t npages = 1;
+        while (npages < gMaxReadPages) {
+            const auto next = pgoffset + npages * VirtualPageManager::gPageSize;
+            if (next > last || contains(entry, next)) break;
+            ++npages;
+        }
+        mMisses += npages - 1;
+
+        size_t expected = entry->size - pgoffset;
+        if (expected > npages * VirtualPageManager::gPageSize) expected = npages * VirtualPageManager::gPageSize;
+        auto buffer = (char*)malloc(expected);
+        size_t sz = 0;
+        if (buffer && file->seek(pgoffset)) sz = file->read(expected, buffer);
+        if (sz != expected) {
+            TAG_ERROR(PAGECACHE, "short read of %u bytes at offset %u of %s", sz, pgoffset, entry->path);
+            free(buffer);
+            break;
+        }
+
+        for (auto i = 0u; i < npages; ++i) {
+            const auto from = i * VirtualPageManager::gPageSize;
+            auto count = expected - from;
+            if (count > VirtualPageManager::gPageSize) count = VirtualPageManager::gPageSize;
+            // without a page to spare the data still goes to the caller, it just isn't cached
+            uintptr_t phys;
+            if (!pmm.alloc().result(&phys)) break;
+            {
+                auto sp = vmm.getScratchPage(phys, VirtualPageManager::map_options_t::kernel().clear(true));
+                memcpy(sp.get<char>(), buffer + from, count);
+            }
+            insert(entry, pgoffset + from, phys);
+            pmm.dealloc(phys);
+        }
+
+        auto chunk = expected - inpage;
+        if (chunk > len - done) chunk = len - done;
+        memcpy(dest + done, buffer + inpage, chunk);
+        free(buffer);
+        done += chunk;
+    }
+
+    file->seek(pos + done);
+    return done;
+}
+
+size_t PageCache::numFiles() const {
+    return mFiles.count();
+}
+
+size_t PageCache::residentPages() const {
+    return mResident;
+}
+
+uint64_t PageCache::hits() const {
+    return mHits;
+}
+
+uint64_t PageCache::misses() const {
+    return mMisses;
+}
+
+uint64_t PageCache::evictions() const {
+    return mEvictions;
+}
@@ -0,0 +1,126 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/fs/pathcache.h>
+#include <kernel/libc/memory.h>
+#include <kernel/libc/string.h>
+#include <muzzle/strings.h>
+
+// FNV-1a; paths differ mostly in their last few characters, which this mixes into every bit
+uint32_t PathCache::hash(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (auto i = 0u; i < len; ++i) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+PathCache::PathCache() : mCount(0), mHits(0), mMisses(0), mAbsences(0), mInvalidations(0) {
+    bzero(&mEntries[0], sizeof(mEntries));
+}
+
+PathCache::entry_t* PathCache::lookup(const char* path) {
+    if (path[0] == '/') ++path;
+    const auto len = strlen(path);
+    const auto h = hash(path, len);
+    auto& entry(mEntries[h % gNumEntries]);
+    if (entry.path && entry.hash == h && entry.len == len && 0 == strncmp(entry.path, path, len)) return &entry;
+    return nullptr;
+}
+
+bool PathCache::find(const char* path, resolution_t* res) {
+    if (auto entry = lookup(path)) {
+        *res = entry->res;
+        ++mHits;
+        return true;
+    }
+
+    ++mMisses;
+    return false;
+}
+
+void PathCache::insert(const char* path, const resolution_t& res) {
+    if (path[0] == '/') ++path;
+    const auto len = strlen(path);
+    const auto h = hash(path, len);
+    auto& entry(mEntries[h % gNumEntries]);
+    if (entry.path) drop(entry);
+
+    entry.path = strdup(path);
+    entry.len = len;
+    entry.hash = h;
+    entry.res = res;
+    ++mCount;
+}
+
+// invalidate() matches paths as text, so a path that can be spelled more than one way ("a//b") is
+// never remembered as absent, as creating it under another spelling would not find it
+void PathCache::missing(const char* path) {
+    if (strstr(path, "//")) return;
+    if (auto entry = lookup(path)) entry->res.absent = true;
+}
+
+void PathCache::absent() {
+    ++mAbsences;
+}
+
+void PathCache::drop(entry_t& entry) {
+    free(entry.path);
+    entry.path = nullptr;
+    --mCount;
+}
+
+// some filesystems (FAT) ignore case, so paths that only differ in case are all dropped together
+void PathCache::invalidate(Filesystem* fs, const char* path) {
+    if (path[0] == '/') ++path;
+    const auto len = strlen(path);
+    for (auto& entry : mEntries) {
+        if (entry.path == nullptr || entry.res.fs != fs) continue;
+        const char* rel = entry.path + entry.res.offset;
+        if (rel[0] == '/') ++rel;
+        if (strncasecmp(rel, path, len)) continue;
+        if (rel[len] != 0 && rel[len] != '/') continue;
+        drop(entry);
+        ++mInvalidations;
+    }
+}
+
+void PathCache::flush() {
+    for (auto& entry : mEntries) {
+        if (entry.path == nullptr) continue;
+        drop(entry);
+        ++mInvalidations;
+    }
+}
+
+uint64_t PathCache::hits() const {
+    return mHits;
+}
+
+uint64_t PathCache::misses() const {
+    return mMisses;
+}
+
+uint64_t PathCache::absences() const {
+    return mAbsences;
+}
+
+uint64_t PathCache::invalidations() const {
+    return mInvalidations;
+}
+
+size_t PathCache::count() const {
+    return mCount;
+}
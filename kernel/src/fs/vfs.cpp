@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <kernel/fs/vfs.h>
+#include <kernel/fs/pagecache.h>
 #include <kernel/log/log.h>
 #include <kernel/libc/string.h>
 #include <kernel/libc/memory.h>
@@ -22,7 +23,22 @@
 #include <kernel/boot/bootinfo.h>
 #include <kernel/fs/devfs/devfs.h>
 #include <kernel/time/manager.h>
-#include <kernel/libc/buffer.h>
+#include <kernel/fs/memfs/memfs.h>
+
+namespace {
+    class CacheStatsFile : public MemFS::File {
+        public:
+            CacheStatsFile() : MemFS::File("cache") {
+                kind(file_kind_t::chardevice);
+            }
+
+            delete_ptr<MemFS::FileBuffer> content() override {
+                vfs_cache_stats_t *stats = (vfs_cache_stats_t*)calloc(1, sizeof(vfs_cache_stats_t));
+                VFS::get().cacheStats(stats);
+                return new MemFS::ExternalDataBuffer<true>((uint8_t*)stats, sizeof(vfs_cache_stats_t));
+            }
+    };
+}
 
 namespace boot::vfs {
     uint32_t init() {
@@ -30,6 +46,7 @@ namespace boot::vfs {
         auto& vfs(VFS::get());
 
         vfs.mount("devices", DevFS::get().getMemFS());
+        DevFS::get().getDeviceDirectory("vfs")->add(new CacheStatsFile());
 
         bool anyfs = false;
 
@@ -79,14 +96,35 @@ VFS& VFS::get() {
     return gVFS;
 }
 
-VFS::VFS() : mMounts() {
+size_t VFS::mount_name_helper::index(const mount_name_t& n) {
+    return PathCache::hash(n.name, n.len);
+}
+
+bool VFS::mount_name_helper::eq(const mount_name_t& n1, const mount_name_t& n2) {
+    return n1.len == n2.len && 0 == strncmp(n1.name, n2.name, n1.len);
+}
+
+VFS::VFS() : mMounts(), mMountTable(), mNumMounts(0), mPaths() {
     LOG_DEBUG("initializing VFS");
 }
 
+// with more than one filesystem at the same name, the first one mounted is the one paths lead to
+void VFS::addMount(const mount_t& m) {
+    mMounts.add(m);
+    ++mNumMounts;
+    mount_name_t name{m.path, strlen(m.path)};
+    if (!mMountTable.find(name)) mMountTable.insert(name, m);
+    mPaths.flush();
+}
+
+bool VFS::findMount(const char* name, size_t len, mount_t* m) {
+    return mMountTable.find(mount_name_t{name, len}, m);
+}
+
 bool VFS::mount(const char* path, Filesystem* fs, Volume* vol) {
     if (path[0] == '/') ++path;
     LOG_DEBUG("mounting /%s as 0x%p", path, fs);
-    mMounts.add(mount_t{
+    addMount(mount_t{
         strdup(path),
         TimeManager::get().UNIXtime(),
         vol,
@@ -95,25 +133,15 @@ bool VFS::mount(const char* path, Filesystem* fs, Volume* vol) {
 }
 
 Volume* VFS::findvol(const char* mnt) {
-    auto b = mMounts.begin(), e = mMounts.end();
-    for(; b != e; ++b) {
-        auto&& m = *b;
-        if (0 == strcmp(m.path, mnt)) {
-            return m.volume;
-        }
-    }
+    mount_t m;
+    if (findMount(mnt, strlen(mnt), &m)) return m.volume;
 
     return nullptr;
 }
 
 Filesystem* VFS::findfs(const char* mnt) {
-    auto b = mMounts.begin(), e = mMounts.end();
-    for(; b != e; ++b) {
-        auto&& m = *b;
-        if (0 == strcmp(m.path, mnt)) {
-            return m.fs;
-        }
-    }
+    mount_t m;
+    if (findMount(mnt, strlen(mnt), &m)) return m.fs;
 
     return nullptr;
 }
@@ -129,18 +157,11 @@ Filesystem* VFS::fsForPath(const char* path) {
             path_start[path_len] == '/') break;
         else ++path_len;
     }
-    buffer buf(path_len + 2);
-    buf.printf("%.*s", path_len+1, path_start);
 
-    LOG_DEBUG("for path '%s', seeking filesystem at '%s'", path, buf.c_str());
+    LOG_DEBUG("for path '%s', seeking filesystem at '%.*s'", path, path_len, path_start);
 
-    auto b = mMounts.begin(), e = mMounts.end();
-    for(; b != e; ++b) {
-        auto&& m = *b;
-        if (0 == strcmp(m.path, buf.c_str())) {
-            return m.fs;
-        }
-    }
+    mount_t m;
+    if (findMount(path_start, path_len, &m)) return m.fs;
 
     return nullptr;
 }
@@ -172,9 +193,22 @@ bool VFS::unmount(const char* path) {
                 LOG_ERROR("filesystem 0x%p can't be unmounted: refcount=%u open objects=%u", m.fs->refcount(), m.fs->openObjectsCount());
                 return false;
             }
+            mount_name_t name{m.path, strlen(m.path)};
+            mMountTable.erase(name);
+            mPaths.flush();
             if (0 == m.fs->decref()) delete m.fs;
+            if (m.volume) m.volume->flush();
+            auto p = m.path;
             mMounts.remove(b);
-            free((void*)m.path);
+            --mNumMounts;
+            // another filesystem mounted at the same name now takes this one's place
+            for (auto& other : mMounts) {
+                if (0 == strcmp(other.path, p)) {
+                    mMountTable.insert(mount_name_t{other.path, strlen(other.path)}, other);
+                    break;
+                }
+            }
+            free((void*)p);
             return true;
         }
     }
@@ -197,7 +231,7 @@ fs_ident_t::mount_result_t VFS::mount(Volume* vol, const char* where) {
             vol,
             previous_mount.fs
         };
-        mMounts.add(new_mount);
+        addMount(new_mount);
         return {true, new_mount.path};
     }
 }
@@ -222,24 +256,25 @@ fs_ident_t::mount_result_t VFS::doMountVolume(Volume* vol, const char* where) {
     return {false, nullptr};
 }
 
-pair<Filesystem*, const char*> VFS::getfs(const char* root) {
+pair<Filesystem*, const char*> VFS::getfs(const char* root, bool* absent) {
     if (root == nullptr || root[0] == 0) return {nullptr, nullptr};
     if (root[0] == '/') ++root;
-    auto b = mMounts.begin(), e = mMounts.end();
-    for(; b != e; ++b) {
-        auto&& m = *b;
-        const char* next = nullptr;
-        bool match = strprefix(m.path, root, &next);
-        if (match == false || next == nullptr) continue;
-        switch (*next) {
-            case 0:
-            case '/':
-                LOG_DEBUG("found matching root fs %s (at 0x%p) - next = '%s'", m.path, m.fs, next);
-                return {m.fs, next};
-        }
+
+    PathCache::resolution_t res;
+    if (mPaths.find(root, &res)) {
+        if (absent) *absent = res.absent;
+        return {res.fs, root + res.offset};
     }
 
-    return {nullptr, nullptr};
+    size_t len = 0;
+    while (root[len] != 0 && root[len] != '/') ++len;
+    mount_t m;
+    if (!findMount(root, len, &m)) return {nullptr, nullptr};
+
+    LOG_DEBUG("found matching root fs %s (at 0x%p) - next = '%s'", m.path, m.fs, root + len);
+    mPaths.insert(root, {m.fs, len, false});
+    if (absent) *absent = false;
+    return {m.fs, root + len};
 }
 
 bool VFS::del(const char* path) {
@@ -251,6 +286,8 @@ bool VFS::del(const char* path) {
         return false;
     }
 
+    PageCache::get().invalidate(rest.first, path);
+    mPaths.invalidate(rest.first, rest.second);
     return rest.first->del(rest.second);
 }
 
@@ -263,9 +300,20 @@ bool VFS::mkdir(const char* path) {
         return false;
     }
 
+    mPaths.invalidate(rest.first, rest.second);
     return rest.first->mkdir(rest.second);
 }
 
+void VFS::cacheStats(vfs_cache_stats_t* stats) {
+    stats->hits = mPaths.hits();
+    stats->misses = mPaths.misses();
+    stats->absent = mPaths.absences();
+    stats->invalidations = mPaths.invalidations();
+    stats->entries = mPaths.count();
+    stats->capacity = PathCache::gNumEntries;
+    stats->mounts = mNumMounts;
+}
+
 class RootDirectory : public Filesystem::Directory {
     public:
         RootDirectory() : mIterator(VFS::get().mMounts.begin()), mEnd(VFS::get().mMounts.end()) {
@@ -322,14 +370,29 @@ static VFSFilesystem gVFSFilesystem;
 VFS::filehandle_t VFS::open(const char* path, uint32_t mode) {
     if (!isAbsolutePath(path)) return {nullptr, nullptr};
 
-    auto rest = getfs(path);
+    bool absent = false;
+    auto rest = getfs(path, &absent);
     if (rest.first == nullptr) {
         LOG_DEBUG("could not find filesystem to open '%s'", path);
         return {nullptr, nullptr};
     }
 
+    // anything that may create the file makes what is known about the path out of date
+    const bool writable = (mode & (FILE_OPEN_WRITE | FILE_OPEN_NEW | FILE_OPEN_APPEND)) != 0;
+    if (writable) {
+        mPaths.invalidate(rest.first, rest.second);
+    } else if (absent) {
+        mPaths.absent();
+        return {nullptr, nullptr};
+    }
+
     LOG_DEBUG("found matching root fs at 0x%p - forwarding open request of '%s'", rest.first, rest.second);
-    return {rest.first, rest.first->open(rest.second, mode)};
+    auto file = rest.first->open(rest.second, mode);
+    if (file && Filesystem::File::classof(file)) {
+        PageCache::get().attach(rest.first, path, file, writable);
+    }
+    if (file == nullptr && !writable && rest.first->absent(rest.second)) mPaths.missing(path);
+    return {rest.first, file};
 }
 
 VFS::filehandle_t VFS::opendir(const char* path) {
@@ -346,13 +409,20 @@ VFS::filehandle_t VFS::opendir(const char* path) {
         }
     }
 
-    auto rest = getfs(path);
+    bool absent = false;
+    auto rest = getfs(path, &absent);
     if (rest.first == nullptr) {
         LOG_DEBUG("no matching filesystem found for '%s'- failure", path);
         return {nullptr, nullptr};
     }
+    if (absent) {
+        mPaths.absent();
+        return {nullptr, nullptr};
+    }
     LOG_DEBUG("found matching root fs at 0x%p - forwarding opendir request of '%s'", rest.first, rest.second);
-    return {rest.first, rest.first->opendir(rest.second)};
+    auto dir = rest.first->opendir(rest.second);
+    if (dir == nullptr && rest.first->absent(rest.second)) mPaths.missing(path);
+    return {rest.first, dir};
 }
 
 bool VFS::isAbsolutePath(const char* path) {
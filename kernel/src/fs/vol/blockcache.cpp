@@ -0,0 +1,375 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/fs/vol/blockcache.h>
+#include <kernel/fs/vol/volume.h>
+#include <kernel/libc/memory.h>
+#include <kernel/libc/string.h>
+#include <kernel/sys/config.h>
+
+#define LOG_LEVEL 2
+#include <kernel/log/log.h>
+
+LOG_TAG(BLKCACHE, 2);
+
+BlockCache::BlockCache(Volume* vol) : mVolume(vol), mConfigured(false), mWriteBack(false),
+    mSectorSize(0), mSectorsPerBlock(0), mBypassSectors(0), mHashMask(0),
+    mBlocks(nullptr), mData(nullptr), mHash(nullptr),
+    mHead(gNone), mTail(gNone), mFree(gNone) {
+    bzero(&mStats, sizeof(mStats));
+}
+
+BlockCache::~BlockCache() {
+    free(mHash);
+    free(mData);
+    free(mBlocks);
+}
+
+bool BlockCache::configure() {
+    if (mConfigured) return mStats.capacity != 0;
+    mConfigured = true;
+
+    auto&& config(gKernelConfiguration()->blockcache);
+    mWriteBack = config.writeback;
+    mSectorSize = mVolume->sectorsize();
+    if (mSectorSize == 0 || (gBlockSize % mSectorSize) != 0 || (gBlockSize / mSectorSize) > gMaxSectorsPerBlock) {
+        TAG_ERROR(BLKCACHE, "volume 0x%p has sector size %u; caching disabled", mVolume, mSectorSize);
+        return false;
+    }
+    mSectorsPerBlock = gBlockSize / mSectorSize;
+    mBypassSectors = config.bypass * mSectorsPerBlock;
+
+    const uint32_t capacity = config.blocks;
+    if (capacity == 0) return false;
+
+    // keep the table at most half full so that probe sequences stay short
+    uint32_t hashSize = 1;
+    while (hashSize < 2 * capacity) hashSize <<= 1;
+
+    mBlocks = ::allocate<block_t>(capacity);
+    mData = ::allocate<unsigned char>(capacity * gBlockSize);
+    mHash = ::allocate<uint32_t>(hashSize);
+    if (mBlocks == nullptr || mData == nullptr || mHash == nullptr) {
+        TAG_ERROR(BLKCACHE, "volume 0x%p could not allocate a cache of %u blocks", mVolume, capacity);
+        return false;
+    }
+
+    memset(mHash, 0xFF, hashSize * sizeof(uint32_t));
+    for (auto i = 0u; i < capacity; ++i) {
+        mBlocks[i] = block_t{gNone, gNone, (i + 1 < capacity) ? i + 1 : gNone, 0, 0};
+    }
+    mFree = 0;
+    mHashMask = hashSize - 1;
+    mStats.capacity = capacity;
+
+    TAG_INFO(BLKCACHE, "volume 0x%p caches %u blocks of %u sectors (%s, bypassed by requests of %u sectors or more)",
+        mVolume, capacity, mSectorsPerBlock, mWriteBack ? "write-back" : "write-through", mBypassSectors);
+    return true;
+}
+
+unsigned char* BlockCache::data(uint32_t idx, uint32_t sector) {
+    return mData + idx * gBlockSize + sector * mSectorSize;
+}
+
+uint32_t BlockCache::home(uint32_t id) const {
+    // Fibonacci hashing, since consecutive block ids are the common case
+    return (id * 2654435769u) & mHashMask;
+}
+
+uint32_t BlockCache::find(uint32_t id) const {
+    for (auto slot = home(id); mHash[slot] != gNone; slot = (slot + 1) & mHashMask) {
+        if (mBlocks[mHash[slot]].id == id) return mHash[slot];
+    }
+    return gNone;
+}
+
+void BlockCache::hashInsert(uint32_t id, uint32_t idx) {
+    auto slot = home(id);
+    while (mHash[slot] != gNone) slot = (slot + 1) & mHashMask;
+    mHash[slot] = idx;
+}
+
+void BlockCache::hashErase(uint32_t id) {
+    auto hole = home(id);
+    while (mBlocks[mHash[hole]].id != id) hole = (hole + 1) & mHashMask;
+
+    // shift back any entry further along the probe sequence that can fill the hole, so that
+    // lookups never stop early at an empty slot (this saves needing tombstones)
+    for (auto slot = (hole + 1) & mHashMask; mHash[slot] != gNone; slot = (slot + 1) & mHashMask) {
+        auto want = home(mBlocks[mHash[slot]].id);
+        const bool stays = (hole <= slot) ? (hole < want && want <= slot) : (hole < want || want <= slot);
+        if (stays) continue;
+        mHash[hole] = mHash[slot];
+        hole = slot;
+    }
+    mHash[hole] = gNone;
+}
+
+void BlockCache::lruRemove(uint32_t idx) {
+    auto& block(mBlocks[idx]);
+    if (block.prev != gNone) mBlocks[block.prev].next = block.next;
+    else mHead = block.next;
+    if (block.next != gNone) mBlocks[block.next].prev = block.prev;
+    else mTail = block.prev;
+    block.prev = block.next = gNone;
+}
+
+void BlockCache::lruPush(uint32_t idx) {
+    auto& block(mBlocks[idx]);
+    block.prev = gNone;
+    block.next = mHead;
+    if (mHead != gNone) mBlocks[mHead].prev = idx;
+    else mTail = idx;
+    mHead = idx;
+}
+
+bool BlockCache::writeback(uint32_t idx) {
+    auto& block(mBlocks[idx]);
+    if (block.dirty == 0) return true;
+
+    // write contiguous runs of dirty sectors with one request each
+    const uint32_t first = block.id * mSectorsPerBlock;
+    for (auto i = 0u; i < mSectorsPerBlock;) {
+        if ((block.dirty & (1u << i)) == 0) {
+            ++i;
+            continue;
+        }
+        auto j = i;
+        while (j < mSectorsPerBlock && (block.dirty & (1u << j))) ++j;
+        if (!mVolume->doWrite(first + i, j - i, data(idx, i))) {
+            TAG_ERROR(BLKCACHE, "volume 0x%p failed to write back sectors %u to %u", mVolume, first + i, first + j - 1);
+            return false;
+        }
+        mStats.writebacks += (j - i);
+        i = j;
+    }
+
+    block.dirty = 0;
+    --mStats.dirty;
+    return true;
+}
+
+uint32_t BlockCache::allocate(uint32_t id) {
+    uint32_t idx = mFree;
+    if (idx != gNone) {
+        mFree = mBlocks[idx].next;
+        ++mStats.resident;
+    } else {
+        idx = mTail;
+        if (!writeback(idx)) return gNone;
+        hashErase(mBlocks[idx].id);
+        lruRemove(idx);
+        ++mStats.evictions;
+        TAG_DEBUG(BLKCACHE, "volume 0x%p evicted block %u", mVolume, mBlocks[idx].id);
+    }
+
+    auto& block(mBlocks[idx]);
+    block.id = id;
+    block.valid = block.dirty = 0;
+    hashInsert(id, idx);
+    lruPush(idx);
+    return idx;
+}
+
+void BlockCache::discard(uint32_t idx) {
+    auto& block(mBlocks[idx]);
+    if (block.dirty) --mStats.dirty;
+    hashErase(block.id);
+    lruRemove(idx);
+    block.id = gNone;
+    block.next = mFree;
+    mFree = idx;
+    --mStats.resident;
+}
+
+void BlockCache::touch(uint32_t idx) {
+    if (idx == mHead) return;
+    lruRemove(idx);
+    lruPush(idx);
+}
+
+bool BlockCache::contains(uint32_t sector) const {
+    auto idx = find(sector / mSectorsPerBlock);
+    return (idx != gNone) && (mBlocks[idx].valid & (1u << (sector % mSectorsPerBlock)));
+}
+
+bool BlockCache::hit(uint32_t sector, unsigned char* buffer) {
+    const uint32_t offset = sector % mSectorsPerBlock;
+    auto idx = find(sector / mSectorsPerBlock);
+    if (idx == gNone || (mBlocks[idx].valid & (1u << offset)) == 0) return false;
+
+    ++mStats.hits;
+    touch(idx);
+    memcpy(buffer, data(idx, offset), mSectorSize);
+    return true;
+}
+
+bool BlockCache::fetch(uint32_t sector, unsigned char* buffer) {
+    const uint32_t id = sector / mSectorsPerBlock;
+    const uint32_t offset = sector % mSectorsPerBlock;
+    auto idx = find(id);
+    if (idx == gNone) {
+        idx = allocate(id);
+        if (idx == gNone) return mVolume->doRead(sector, 1, buffer);
+
+        // a fresh block holds nothing that the disk does not, so read all of it at once
+        const uint32_t first = id * mSectorsPerBlock;
+        if (first + mSectorsPerBlock <= mVolume->numsectors() && mVolume->doRead(first, mSectorsPerBlock, data(idx))) {
+            mBlocks[idx].valid = (uint8_t)((1u << mSectorsPerBlock) - 1);
+        }
+    } else {
+        touch(idx);
+    }
+
+    auto& block(mBlocks[idx]);
+    if ((block.valid & (1u << offset)) == 0) {
+        if (!mVolume->doRead(sector, 1, data(idx, offset))) {
+            if (block.valid == 0) discard(idx);
+            return false;
+        }
+        block.valid |= (1u << offset);
+    }
+
+    memcpy(buffer, data(idx, offset), mSectorSize);
+    return true;
+}
+
+void BlockCache::fill(uint32_t sector, uint32_t count, const unsigned char* buffer, bool add) {
+    for (const auto end = sector + count; sector < end;) {
+        const uint32_t id = sector / mSectorsPerBlock;
+        const uint32_t offset = sector % mSectorsPerBlock;
+        const uint32_t n = (end - sector < mSectorsPerBlock - offset) ? (end - sector) : (mSectorsPerBlock - offset);
+
+        auto idx = find(id);
+        if (idx == gNone && add) idx = allocate(id);
+        if (idx != gNone) {
+            // the disk now matches buffer, so these sectors are clean whatever they held before
+            auto& block(mBlocks[idx]);
+            const uint8_t mask = (uint8_t)(((1u << n) - 1) << offset);
+            memcpy(data(idx, offset), buffer, n * mSectorSize);
+            block.valid |= mask;
+            if (block.dirty) {
+                block.dirty &= ~mask;
+                if (block.dirty == 0) --mStats.dirty;
+            }
+            touch(idx);
+        }
+
+        sector += n;
+        buffer += n * mSectorSize;
+    }
+}
+
+void BlockCache::overlay(uint32_t sector, uint32_t count, unsigned char* buffer) {
+    if (mStats.dirty == 0) return;
+
+    for (const auto end = sector + count; sector < end; ++sector, buffer += mSectorSize) {
+        auto idx = find(sector / mSectorsPerBlock);
+        if (idx == gNone) continue;
+        const uint32_t offset = sector % mSectorsPerBlock;
+        if (mBlocks[idx].dirty & (1u << offset)) memcpy(buffer, data(idx, offset), mSectorSize);
+    }
+}
+
+bool BlockCache::bypass(uint32_t count) const {
+    return mBypassSectors != 0 && count >= mBypassSectors;
+}
+
+bool BlockCache::read(uint32_t sector, uint32_t count, unsigned char* buffer) {
+    if (!configure()) return mVolume->doRead(sector, count, buffer);
+
+    if (bypass(count)) {
+        // a streaming read would only push everything else out of the cache
+        if (!mVolume->doRead(sector, count, buffer)) return false;
+        mStats.bypassed += count;
+        overlay(sector, count, buffer);
+        return true;
+    }
+
+    while (count != 0) {
+        if (hit(sector, buffer)) {
+            sector += 1;
+            count -= 1;
+            buffer += mSectorSize;
+            continue;
+        }
+
+        uint32_t run = 1;
+        while (run < count && !contains(sector + run)) ++run;
+        mStats.misses += run;
+
+        if (run < mSectorsPerBlock) {
+            // too short to be worth a request of its own; read whole blocks around it instead
+            for (auto i = 0u; i < run; ++i) {
+                if (!fetch(sector + i, buffer + i * mSectorSize)) return false;
+            }
+        } else {
+            if (!mVolume->doRead(sector, run, buffer)) return false;
+            fill(sector, run, buffer, true);
+        }
+
+        sector += run;
+        count -= run;
+        buffer += run * mSectorSize;
+    }
+
+    return true;
+}
+
+bool BlockCache::write(uint32_t sector, uint32_t count, unsigned char* buffer) {
+    if (!configure()) return mVolume->doWrite(sector, count, buffer);
+
+    const bool streaming = bypass(count);
+    if (!mWriteBack || streaming) {
+        if (!mVolume->doWrite(sector, count, buffer)) return false;
+        // a streaming write only refreshes blocks that are already cached
+        if (streaming) mStats.bypassed += count;
+        fill(sector, count, buffer, !streaming);
+        return true;
+    }
+
+    for (; count != 0; sector += 1, count -= 1, buffer += mSectorSize) {
+        const uint32_t id = sector / mSectorsPerBlock;
+        const uint32_t offset = sector % mSectorsPerBlock;
+        auto idx = find(id);
+        if (idx == gNone) idx = allocate(id);
+        else touch(idx);
+        if (idx == gNone) {
+            if (!mVolume->doWrite(sector, 1, buffer)) return false;
+            continue;
+        }
+
+        auto& block(mBlocks[idx]);
+        memcpy(data(idx, offset), buffer, mSectorSize);
+        block.valid |= (1u << offset);
+        if (block.dirty == 0) ++mStats.dirty;
+        block.dirty |= (1u << offset);
+    }
+
+    return true;
+}
+
+bool BlockCache::flush() {
+    if (mStats.dirty == 0) return true;
+
+    bool ok = true;
+    for (auto idx = mHead; idx != gNone; idx = mBlocks[idx].next) {
+        ok = writeback(idx) && ok;
+    }
+    return ok;
+}
+
+const BlockCache::stats_t& BlockCache::stats() const {
+    return mStats;
+}
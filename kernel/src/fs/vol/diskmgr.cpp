@@ -92,3 +92,11 @@ iterable_vector_view<Disk*> DiskManager::disks() {
 iterable_vector_view<Volume*> DiskManager::volumes() {
     return iterable_vector_view<Volume*>(mVolumes);
 }
+
+bool DiskManager::flush() {
+    bool ok = true;
+    for (auto vol : volumes()) {
+        ok = vol->flush() && ok;
+    }
+    return ok;
+}
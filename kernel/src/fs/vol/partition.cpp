@@ -30,13 +30,13 @@ uint8_t Partition::sysid() {
 }
 
 bool Partition::doRead(uint32_t sector, uint16_t count, unsigned char* buffer) {
-    if (sector >= mPartition.size) return false;
+    if (sector >= mPartition.size || count > mPartition.size - sector) return false;
     sector += mPartition.sector;
     return mDisk->read(sector, count, buffer);
 }
 
 bool Partition::doWrite(uint32_t sector, uint16_t count, unsigned char* buffer) {
-    if (sector >= mPartition.size) return false;
+    if (sector >= mPartition.size || count > mPartition.size - sector) return false;
     sector += mPartition.sector;
     return mDisk->write(sector, count, buffer);
 }
@@ -22,7 +22,7 @@
 #include <kernel/fs/vol/diskctrl.h>
 
 Volume::Volume(Disk *disk, const char* Id) :
-     mDisk(disk), mId(Id ? Id : ""), mNumSectorsRead(0), mNumSectorsWritten(0), mNumSectorCacheHits(0) {}
+     mDisk(disk), mId(Id ? Id : ""), mCache(this), mNumSectorsRead(0), mNumSectorsWritten(0) {}
 
 Volume::~Volume() = default;
 
@@ -44,71 +44,22 @@ void Volume::filename(buffer* buf) {
     buf->printf("%s%s%s", disk()->controller()->id(), disk()->id(), id());
 }
 
-LOG_TAG(LRUCACHE, 2);
-
-bool Volume::tryReadSector(uint32_t sector, unsigned char* buffer, bool tryReadCache, bool updateCache) {
-    if (tryReadCache) {
-        decltype(mCache)::Sector payload;
-        bool in_cache = mCache.find(sector, &payload);
-        if (in_cache) {
-            ++mNumSectorCacheHits;
-            TAG_DEBUG(LRUCACHE, "volume 0x%p sector %u found in cache - skipped a disk access", this, sector);
-            memcpy(buffer, payload.data, decltype(payload)::gSize);
-            return true;
-        } else {
-            TAG_DEBUG(LRUCACHE, "volume 0x%p sector %u not found in cache - will go to disk", this, sector);
-        }
-    }
-
-    bool in_disk = doRead(sector, 1, buffer);
-    if (!in_disk) return false;
-    if (updateCache) {
-        decltype(mCache)::Sector payload;
-        memcpy(payload.data, buffer, decltype(payload)::gSize);
-        mCache.insert(sector, payload);
-        TAG_DEBUG(LRUCACHE, "volume 0x%p sector %u inserted in cache", this, sector);
-    }
-
-    return true;
-}
-
-bool Volume::tryWriteSector(uint32_t sector, unsigned char* buffer, bool updateCache) {
-    bool on_disk = doWrite(sector, 1, buffer);
-    if (!on_disk) return false;
-
-    if (updateCache) {
-        decltype(mCache)::Sector payload;
-        memcpy(payload.data, buffer, decltype(payload)::gSize);
-        mCache.insert(sector, payload);
-    }
-
-    return true;
-}
-
 bool Volume::read(uint32_t sector, uint16_t count, unsigned char* buffer) {
-    while(count != 0) {
-        bool ok = tryReadSector(sector, buffer);
-        if (!ok) return false;
-        sector += 1;
-        count -= 1;
-        buffer += sectorsize();
-        readAccounting(1);
-    }
-
-    return true;
+    if (count == 0) return true;
+    bool ok = mCache.read(sector, count, buffer);
+    if (ok) readAccounting(count);
+    return ok;
 }
 
 bool Volume::write(uint32_t sector, uint16_t count, unsigned char* buffer) {
-    while (count != 0) {
-        bool ok = tryWriteSector(sector, buffer);
-        if (!ok) return false;
-        sector += 1;
-        count -= 1;
-        buffer += sectorsize();
-        writeAccounting(1);
-    }
+    if (count == 0) return true;
+    bool ok = mCache.write(sector, count, buffer);
+    if (ok) writeAccounting(count);
+    return ok;
+}
 
-    return true;
+bool Volume::flush() {
+    return mCache.flush();
 }
 
 void Volume::readAccounting(uint16_t sectors) {
@@ -132,7 +83,15 @@ uintptr_t Volume::ioctl(uintptr_t a, uintptr_t b) {
         blockdevice_usage_stats_t* stats = (blockdevice_usage_stats_t*)b;
         stats->sectors_read = mNumSectorsRead;
         stats->sectors_written = mNumSectorsWritten;
-        stats->cache_hits = mNumSectorCacheHits;
+        auto&& cache(mCache.stats());
+        stats->cache_hits = cache.hits;
+        stats->cache_misses = cache.misses;
+        stats->cache_evictions = cache.evictions;
+        stats->cache_writebacks = cache.writebacks;
+        stats->cache_bypassed = cache.bypassed;
+        stats->cache_dirty = cache.dirty;
+        stats->cache_resident = cache.resident;
+        stats->cache_capacity = cache.capacity;
         return 1;
     }
     return 0;
@@ -19,13 +19,15 @@
 #include <kernel/boot/phase.h>
 #include <kernel/drivers/cpu/device.h>
 #include <kernel/i386/mtrr.h>
+#include <kernel/i386/sysenter.h>
+#include <kernel/process/cpu.h>
 #include <kernel/drivers/framebuffer/fb.h>
 
 namespace boot::i386 {
     uint32_t init() {
         // must clear this bit
         static constexpr uint32_t rdpcm_ring3_allow = 0x00000100;
-        // must set this bit
+        // must clear this bit
         static constexpr uint32_t rdtsc_ring3_prevent = 0x4;
 
         static constexpr uint32_t no_x87_emu = ~(1 << 2);
@@ -34,9 +36,10 @@ namespace boot::i386 {
         static constexpr uint32_t osfxsr = 1 << 9;
         static constexpr uint32_t unmasked_smid_except = 1 << 10;
 
-        // prevent userspace from accessing detailed timing information
+        // prevent userspace from reading performance counters; the TSC stays readable, as userspace
+        // reads the time off the kernel data page and needs the TSC to bring it up to date
         auto original_cr4 = readcr4();
-        auto cr4 = original_cr4 | rdtsc_ring3_prevent;
+        auto cr4 = original_cr4 & ~rdtsc_ring3_prevent;
         cr4 &= ~rdpcm_ring3_allow;
         writecr4(cr4);
         cr4 = readcr4();
@@ -69,6 +72,13 @@ namespace boot::i386 {
 
         CPUDevice::get();
 
+        // application processors do the same for themselves as they come online
+        if (Sysenter::setup(CPUs::get().cpu(0))) {
+            LOG_INFO("fast system calls via sysenter available");
+        } else {
+            LOG_WARNING("sysenter not supported by CPU; system calls will use int 0x80");
+        }
+
         MTRR *mtrr = MTRR::tryGet();
         if (mtrr == nullptr) {
             LOG_WARNING("MTRR not supported by CPU");
@@ -21,11 +21,15 @@
 #include <kernel/process/manager.h>
 #include <kernel/process/current.h>
 #include <kernel/synch/waitqueue.h>
+#include <kernel/synch/biglock.h>
+#include <kernel/process/reaper.h>
+#include <kernel/process/cpu.h>
+#include <kernel/syscalls/manager.h>
 
 LOG_TAG(INIRQ, 2);
 LOG_TAG(IRQSETUP, 1);
 
-Interrupts::handler_t::handler_t() : func(nullptr), payload(nullptr), count(0) {
+Interrupts::handler_t::handler_t() : func(nullptr), payload(nullptr), count(0), lockless(false) {
     bzero(name, sizeof(name));
 }
 
@@ -33,17 +37,34 @@ Interrupts::handler_t::operator bool() {
     return func != nullptr;
 }
 
-static uint32_t gIRQDepthCounter = 0;
+// vectors below this are CPU exceptions
+static constexpr uint32_t gFirstHardwareIRQ = 32;
 
 extern "C"
 void interrupt_handler(GPR gpr, InterruptStack stack) {
-    __atomic_add_fetch(&gIRQDepthCounter, 1, __ATOMIC_SEQ_CST);
+    const bool hardware = stack.irqnumber >= gFirstHardwareIRQ && stack.irqnumber != SyscallManager::gSyscallIRQ;
+    // hardware vectors are interrupt gates, so this runs start to finish on the CPU it counts on
+    auto& cpu(CPUs::current());
+    if (hardware) ++cpu.irqdepth;
     bool yield_on_exit = false;
 
     TAG_DEBUG(INIRQ, "received IRQ %u", stack.irqnumber);
     auto& handler = Interrupts::get().mHandlers[stack.irqnumber];
     handler.count += 1;
     TAG_DEBUG(INIRQ, "IRQ %u occurred %llu times", stack.irqnumber, handler.count);
+
+    if (handler && handler.lockless) {
+        handler.func(gpr, stack, handler.payload);
+        if (hardware) --cpu.irqdepth;
+        return;
+    }
+
+    // only one CPU at a time runs kernel code; entering from userspace, or from the idle loop,
+    // takes the lock, and whoever took it gives it back on the way out
+    auto& bkl(BigKernelLock::get());
+    const bool locked = !bkl.held();
+    if (locked) bkl.lock();
+
 	if (handler) {
 		auto action = handler.func(gpr, stack, handler.payload);
         if ((action & IRQ_RESPONSE_WAKE) == IRQ_RESPONSE_WAKE) {
@@ -64,12 +85,18 @@ void interrupt_handler(GPR gpr, InterruptStack stack) {
         TAG_DEBUG(INIRQ, "IRQ %u received - no handler", stack.irqnumber);
     }
 
-    __atomic_fetch_sub(&gIRQDepthCounter, 1, __ATOMIC_SEQ_CST);
+    if (hardware) --cpu.irqdepth;
     if (yield_on_exit) ProcessManager::get().yield();
+
+    if (locked) {
+        // a kill that came in from another CPU while this process was running here
+        if (gCurrentProcess && gCurrentProcess->flags.killpending && gCurrentProcess->heldlocks == 0) reaper(gCurrentProcess->exitstatus.toWord());
+        bkl.unlock();
+    }
 }
 
 uint32_t Interrupts::irqDepth() const {
-    return __atomic_load_n(&gIRQDepthCounter, __ATOMIC_SEQ_CST);
+    return CPUs::current().irqdepth;
 }
 
 Interrupts& Interrupts::get() {
@@ -139,6 +166,10 @@ void Interrupts::sethandler(uint8_t irq, const char* name, handler_t::irq_handle
 	handler.func = f;
 }
 
+void Interrupts::setLockless(uint8_t irq, bool lockless) {
+    mHandlers[irq].lockless = lockless;
+}
+
 void Interrupts::setWakeQueue(uint8_t irq, WaitQueue* wq) {
     auto& handler = mHandlers[irq];
     handler.wq = wq;
@@ -182,11 +182,40 @@ readtaskreg:
 	str ax
 	ret
 
+; void ctxswitch(uintptr_t* from, uintptr_t to)
+; saves the callee-saved registers and data segments on the current stack, stores
+; the stack pointer in *from and resumes the context whose stack pointer is "to"
 global ctxswitch
 ctxswitch:
-	jmp 0x28:0
+	mov eax, [esp + 4]
+	mov edx, [esp + 8]
+	push ebp
+	push ebx
+	push esi
+	push edi
+	push ds
+	push es
+	push fs
+	push gs
+	mov [eax], esp
+	mov esp, edx
+	pop gs
+	pop fs
+	pop es
+	pop ds
+	pop edi
+	pop esi
+	pop ebx
+	pop ebp
 	ret
 
+; a freshly built context "returns" here from ctxswitch with its entry point on the stack
+global ctxstart
+ctxstart:
+	pop eax
+	sti
+	jmp eax
+
 global iowait
 iowait:
 	xor al, al
@@ -343,6 +372,13 @@ haltforever:
 	hlt
 	jmp haltforever
 
+; sti only takes effect after the next instruction, so no IRQ can be taken between the two
+global waitforirq
+waitforirq:
+	sti
+	hlt
+	ret
+
 global readfpsw
 readfpsw:
 	xor eax, eax
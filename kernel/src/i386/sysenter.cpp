@@ -0,0 +1,50 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/i386/sysenter.h>
+#include <kernel/i386/cpuid.h>
+#include <kernel/i386/primitives.h>
+#include <kernel/process/cpu.h>
+#include <kernel/log/log.h>
+
+LOG_TAG(SYSENTER, 1);
+
+// see sysenter.s
+extern "C" uint8_t sysenter_entry;
+
+namespace Sysenter {
+    bool supported() {
+        auto& cpuid(CPUID::get());
+        if (!cpuid.getFeatures().sep) return false;
+
+        // the Pentium Pro sets the SEP bit without implementing the instructions
+        const auto& sig(cpuid.getSignature());
+        if (sig.family == 6 && sig.model < 3 && sig.stepping < 3) return false;
+
+        return true;
+    }
+
+    bool setup(cpu_t& cpu) {
+        if (!supported()) return false;
+
+        // the CPU loads the stack pointer from the MSR, but the kernel stack changes on every
+        // context switch; instead, point it at this CPU's TSS.esp0 and let the entry stub load that
+        writemsr(gMSRCodeSegment, 0x08);
+        writemsr(gMSRStack, (uintptr_t)&cpu.tss.esp0);
+        writemsr(gMSREntryPoint, (uintptr_t)&sysenter_entry);
+
+        TAG_INFO(SYSENTER, "sysenter enabled on CPU %u, entry at 0x%p", cpu.index, &sysenter_entry);
+        return true;
+    }
+}
@@ -0,0 +1,95 @@
+; Copyright 2018 Google LLC
+;
+; Licensed under the Apache License, Version 2.0 (the "License");
+; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;      http://www.apache.org/licenses/LICENSE-2.0
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS,
+; WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+; See the License for the specific language governing permissions and
+; limitations under the License.
+
+extern interrupt_handler
+
+; userspace enters here with sysenter, after pushing its return address and pointing ebp at it;
+; the system call number and arguments are in the same registers int 0x80 uses.
+; Interrupts are off, and esp is the SYSENTER_ESP MSR, i.e. the address of this CPU's TSS.esp0
+global sysenter_entry
+sysenter_entry:
+    mov esp, [esp]
+
+    ; build the frame an int 0x80 from ring 3 would have left, so that interrupt_handler
+    ; and everything after it can not tell the difference; eip is not known yet, and the
+    ; marker error code asks the syscall handler to fetch it from the user stack
+    push dword 0x23
+    push ebp
+    pushfd
+    or dword [esp], 0x200
+    push dword 0x1b
+    push dword 0
+    push dword 0x5e ; Sysenter::gFrameMarker
+    push dword 0x80
+
+    push esp
+    push edi
+    push esi
+    push ebp
+    push edx
+    push ecx
+    push ebx
+    push eax
+    mov eax, cr4
+    push eax
+    mov eax, cr3
+    push eax
+    mov eax, cr2
+    push eax
+    mov eax, cr0
+    push eax
+
+    ; sysenter leaves the other user flags in place; a stray NT would turn the next iret in
+    ; the kernel into a task switch. int 0x80 is a trap gate, so syscalls run with interrupts enabled
+    push dword 0x2
+    popfd
+    sti
+    call interrupt_handler
+
+    pop eax
+    pop eax
+    pop eax
+    pop eax
+    pop eax
+    pop ebx
+    pop ecx
+    pop edx
+    pop ebp
+    pop esi
+    pop edi
+    pop esp
+
+    add esp, 8
+
+    ; sysexit can only go back to flat ring 3 segments, and loading a trap flag in ring 0
+    ; would single-step the kernel; anything else leaves the way it would have from int 0x80
+    cmp dword [esp + 4], 0x1b
+    jne .slow
+    cmp dword [esp + 16], 0x23
+    jne .slow
+    test dword [esp + 8], 0x100
+    jnz .slow
+
+    mov edx, [esp]
+    mov ecx, [esp + 12]
+    push dword [esp + 8]
+    and dword [esp], ~0x200
+    popfd
+    ; sti only takes effect after the next instruction, so no interrupt can land on the kernel
+    ; stack with user registers loaded
+    sti
+    sysexit
+
+.slow:
+    iret
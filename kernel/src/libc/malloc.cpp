@@ -20,6 +20,7 @@
 #include <kernel/libc/string.h>
 #include <kernel/libc/memory.h>
 #include <kernel/mm/virt.h>
+#include <kernel/mm/slab.h>
 
 #define LOG_LEVEL 2
 #include <kernel/log/log.h>
@@ -40,12 +41,15 @@ union header {
 static union header list;
 static union header *first = nullptr;
 
-extern "C"
-void free(void* ptr) {
-  if (ptr == nullptr) {
-    return;
-  }
+// small allocations are served by the SlabAllocator; the free list below only
+// ever sees requests larger than SlabAllocator::gMaxObjectSize
+static malloc_large_stats_t gLargeStats;
 
+void malloc_large_stats(malloc_large_stats_t* stats) {
+  *stats = gLargeStats;
+}
+
+static void large_free(void* ptr) {
   union header *iter, *block;
   iter = first;
   block = (union header*)ptr - 1;
@@ -81,8 +85,12 @@ void free(void* ptr) {
   first = iter;
 }
 
-extern "C"
-void *malloc(size_t size) {
+static size_t large_size(void* ptr) {
+  union header *block = (union header*)ptr - 1;
+  return (block->meta.len - 1) * sizeof(union header);
+}
+
+static void *large_malloc(size_t size) {
   LOG_DEBUG("malloc(%u)", size);
   union header *p, *prev;
   prev = first;
@@ -141,11 +149,12 @@ void *malloc(size_t size) {
       LOG_DEBUG("returning nullptr");
 		  return nullptr;
       }
+      gLargeStats.reserved += kernel_ask_size;
       /* Create a fragment from this new memory and add it to the list
        * so the above logic can handle breaking it if necessary. */
       block = (union header *)page;
       block->meta.len = sbrk_size;
-      free((void *)(block + 1));
+      large_free((void *)(block + 1));
       p = first;
     }
 
@@ -156,6 +165,33 @@ void *malloc(size_t size) {
   return nullptr;
 }
 
+extern "C"
+void free(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  if (SlabAllocator::get().free(ptr)) return;
+
+  gLargeStats.inuse -= large_size(ptr);
+  ++gLargeStats.frees;
+  large_free(ptr);
+}
+
+extern "C"
+void *malloc(size_t size) {
+  if (size <= SlabAllocator::gMaxObjectSize) {
+    return SlabAllocator::get().alloc(size);
+  }
+
+  void* ptr = large_malloc(size);
+  if (ptr != nullptr) {
+    gLargeStats.inuse += large_size(ptr);
+    ++gLargeStats.allocs;
+  }
+  return ptr;
+}
+
 extern "C"
 void* calloc(size_t num, size_t len) {
   void* ptr = malloc(num * len);
@@ -170,17 +206,30 @@ void* calloc(size_t num, size_t len) {
 
 extern "C"
 void* realloc(void *ptr, size_t new_size) {
-  size_t old_size = 0; /* XXX yolo */
+  if (ptr == nullptr) {
+    return malloc(new_size);
+  }
+  if (new_size == 0) {
+    free(ptr);
+    return nullptr;
+  }
+
+  size_t old_size = SlabAllocator::get().usableSize(ptr);
+  if (old_size == 0) {
+    old_size = large_size(ptr);
+  }
+
+  /* The existing block is large enough - nothing to do. */
+  if (new_size <= old_size) {
+    return ptr;
+  }
+
   void* newp = malloc(new_size);
 
   if (newp != nullptr) {
-    /* We cannot grow the memory segment. */
-    if (new_size > old_size) {
-      new_size = old_size;
-    }
-    memcopy((uint8_t*)ptr, (uint8_t*)newp, new_size);
+    memcopy((uint8_t*)ptr, (uint8_t*)newp, old_size);
     free(ptr);
   }
 
   return newp;
-}
\ No newline at end of file
+}
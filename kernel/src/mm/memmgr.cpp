@@ -16,6 +16,8 @@
 #include <kernel/log/log.h>
 #include <kernel/process/process.h>
 #include <kernel/process/current.h>
+#include <kernel/fs/pagecache.h>
+#include <kernel/syscalls/types.h>
 
 static constexpr uintptr_t gKernelInitial = VirtualPageManager::gKernelBase;
 static constexpr uintptr_t gKernelFinal =   0xFFFFFFFF;
@@ -28,6 +30,7 @@ MemoryManager::region_t::region_t (uintptr_t f, uintptr_t t, permission_t p) {
     permission = p;
     mmap_data.fhandle.object = nullptr;
     mmap_data.size = 0;
+    mmap_data.offset = 0;
 }
 
 bool MemoryManager::region_t::operator==(const region_t& other) const {
@@ -46,6 +49,9 @@ MemoryManager::MemoryManager(process_t* process) : mProcess(process), mRegions()
     // do not allow the zero page to be mapped
     mRegions.add({0x0, 0xFFF});
 
+    // the kernel maps its data pages here, see DataPages
+    mRegions.add({kernel_data_t::gAddress, process_data_t::gAddress + VirtualPageManager::gPageSize - 1});
+
     // the entire kernel region is off limits, never allow it
     mRegions.add({gKernelInitial,gKernelFinal});
 }
@@ -193,6 +199,22 @@ MemoryManager::region_t MemoryManager::addUnmappedRegion(uintptr_t f, uintptr_t
     return addRegion({f, t});
 }
 
+MemoryManager::region_t MemoryManager::addZeroPageRegion(uintptr_t f, uintptr_t t, const VirtualPageManager::map_options_t& opts) {
+    VirtualPageManager::get().mapZeroPage(f, t, opts);
+    return addRegion({f, t, opts});
+}
+
+MemoryManager::region_t MemoryManager::addFileMapRegion(uintptr_t f, uintptr_t t, VFS::filehandle_t fhandle, size_t offset, size_t size, const VirtualPageManager::map_options_t& opts) {
+    region_t region(f, t, opts);
+    VirtualPageManager::get().mapZeroPage(f, t, opts);
+    fhandle.region = (void*)f;
+    fhandle.object->incref(); // the region keeps the file alive until it is removed
+    region.mmap_data.fhandle = fhandle;
+    region.mmap_data.size = size;
+    region.mmap_data.offset = offset;
+    return addRegion(region);
+}
+
 void MemoryManager::removeRegion(region_t region) {
     auto&& vmm(VirtualPageManager::get());
 
@@ -200,7 +222,13 @@ void MemoryManager::removeRegion(region_t region) {
         LOG_DEBUG("region [0x%p - 0x%p] deleted, unmapping all pages", region.from, region.to);
         mAllRegionsSize -= region.size();
         gCurrentProcess->memstats.available -= region.size();
+        auto&& cache(PageCache::get());
+        auto file = region.isMmapRegion() ? region.mmap_data.fhandle.asFile() : nullptr;
+        auto entry = file ? cache.entry(file) : nullptr;
         for (auto base = region.from; base < region.to; base += VirtualPageManager::gPageSize) {
+            if (entry && cache.isShared(entry, region.mmap_data.offset + (base - region.from), vmm.mapping(base))) {
+                --gCurrentProcess->memstats.sharedpages;
+            }
             vmm.unmap(base);
         }
         if (region.isMmapRegion()) region.mmap_data.fhandle.close();
@@ -223,6 +251,26 @@ uintptr_t MemoryManager::getTotalRegionsSize() const {
 void MemoryManager::clone(MemoryManager* ret) const {
     ret->mRegions = mRegions;
     ret->mAllRegionsSize = mAllRegionsSize;
+
+    // the clone will close its own copy of every memory mapped file
+    ret->mRegions.foreach([] (region_t& rgn) -> bool {
+        if (rgn.isMmapRegion()) rgn.mmap_data.fhandle.object->incref();
+        return true;
+    });
+}
+
+void MemoryManager::releaseSharedPages() {
+    auto&& vmm(VirtualPageManager::get());
+    mRegions.foreach([&vmm] (region_t& rgn) -> bool {
+        auto file = rgn.isMmapRegion() ? rgn.mmap_data.fhandle.asFile() : nullptr;
+        if (file == nullptr || !file->sharedMemory()) return true;
+        for (auto base = rgn.from; base < rgn.to; base += VirtualPageManager::gPageSize) {
+            if (!vmm.mapped(base)) continue;
+            vmm.unmap(base);
+            vmm.mapZeroPage(base, rgn.permission);
+        }
+        return true;
+    });
 }
 
 void MemoryManager::cleanupAllRegions() {
@@ -20,6 +20,9 @@
 #include <kernel/process/process.h>
 #include <kernel/mm/memmgr.h>
 #include <kernel/fs/vfs.h>
+#include <kernel/sys/config.h>
+#include <kernel/fs/pagecache.h>
+#include <kernel/mm/phys.h>
 
 LOG_TAG(PGFAULT, 2);
 
@@ -87,12 +90,114 @@ static const char* pageflt_description(uint32_t err) {
     }
 }
 
+// returns the number of pages in the fault-around window for vpage, and the first of them in *first;
+// the window is aligned to its own size, clipped to [rgn.from, limit] and shrunk to the run of
+// contiguous zero-page mapped pages that contains vpage, so it can be filled in one go
+static size_t faultaround_window(VirtualPageManager& vmm, uintptr_t vpage, const MemoryManager::region_t& rgn, uintptr_t limit, uintptr_t* first) {
+    *first = vpage;
+    if (rgn.isKernelRegion()) return 1;
+
+    size_t window = gKernelConfiguration()->faultaround.value;
+    if (window <= 1) return 1;
+
+    const auto span = window * VirtualPageManager::gPageSize;
+    auto low = vpage - (vpage % span);
+    auto high = low + span - VirtualPageManager::gPageSize;
+    if (low < rgn.from) low = VirtualPageManager::page(rgn.from);
+
+    while (*first > low) {
+        auto prev = *first - VirtualPageManager::gPageSize;
+        if (prev < rgn.from || !vmm.isZeroPageAccess(prev)) break;
+        *first = prev;
+    }
+
+    auto last = vpage;
+    while (last < high) {
+        auto next = last + VirtualPageManager::gPageSize;
+        if (next + VirtualPageManager::gPageSize - 1 > limit || !vmm.isZeroPageAccess(next)) break;
+        last = next;
+    }
+
+    return 1 + (last - *first) / VirtualPageManager::gPageSize;
+}
+
+static void faultaround_account(size_t npages) {
+    ++gCurrentProcess->memstats.demandfaults;
+    gCurrentProcess->memstats.faultaround += npages - 1;
+}
+
+// is the page at rgn_offset entirely backed by file data, so that it can be kept in the page cache?
+static bool mmap_page_shareable(pagecache_file_t* entry, const MemoryManager::region_t& rgn, size_t rgn_offset) {
+    return entry && !entry->stale && (rgn_offset + VirtualPageManager::gPageSize <= rgn.mmap_data.size);
+}
+
+// fills npages pages starting at first (rgn_offset from the base of the region) with one read from the file
+static bool mmap_read_run(VirtualPageManager& vmm, Filesystem::File* realFile, MemoryManager::region_t& rgn, uintptr_t first, size_t rgn_offset, size_t npages) {
+    const auto file_offset = rgn.mmap_data.offset + rgn_offset;
+    bool sk = realFile->seek(file_offset);
+    if (!sk) {
+        TAG_ERROR(PGFAULT, "file 0x%p can't accept a seek at %u", realFile, file_offset);
+        return false;
+    }
+
+    // pages are filled in by the kernel, so they need to be writable at first
+    auto opts = rgn.permission;
+    opts.clear(true).rw(true);
+    for (auto i = 0u; i < npages; ++i) {
+        vmm.mapAnyPhysicalPage(first + i * VirtualPageManager::gPageSize, opts);
+    }
+
+    size_t len = npages * VirtualPageManager::gPageSize;
+    if (rgn_offset >= rgn.mmap_data.size) len = 0;
+    else if (rgn_offset + len > rgn.mmap_data.size) len = rgn.mmap_data.size - rgn_offset;
+    TAG_DEBUG(PGFAULT, "reading %u bytes at offset %u into 0x%p", len, file_offset, first);
+    size_t sz = len ? realFile->read(len, (char*)first) : 0;
+
+    auto&& cache(PageCache::get());
+    auto entry = cache.entry(realFile);
+    for (auto i = 0u; i < npages; ++i) {
+        auto page = first + i * VirtualPageManager::gPageSize;
+        auto page_offset = rgn_offset + i * VirtualPageManager::gPageSize;
+        const bool share = (sz == len) && mmap_page_shareable(entry, rgn, page_offset);
+        if (!share && rgn.permission.rw()) continue;
+
+        vmm.mapped(page, &opts);
+        opts.rw(false);
+        if (share) {
+            // the cached copy must never change; writable regions get their own copy on first write
+            cache.insert(entry, rgn.mmap_data.offset + page_offset, vmm.mapping(page));
+            opts.cow(rgn.permission.rw());
+            ++gCurrentProcess->memstats.sharedpages;
+        }
+        vmm.newoptions(page, opts);
+    }
+
+    return (sz != 0);
+}
+
+// shared memory is mapped as it is, so that writes are seen by everyone else who has it mapped
+static bool shm_fault_recover(VirtualPageManager& vmm, Filesystem::File* realFile, uintptr_t vaddr, MemoryManager::region_t& rgn) {
+    auto vpage = VirtualPageManager::page(vaddr);
+    auto phys = realFile->sharedPage(rgn.mmap_data.offset + (vpage - rgn.from));
+    if (phys == 0) {
+        TAG_ERROR(PGFAULT, "page fault at 0x%p is past the end of shared memory file 0x%p", vaddr, realFile);
+        return false;
+    }
+
+    // the mapping holds a reference of its own, so the page stays alive if the object shrinks or goes away
+    auto opts = rgn.permission;
+    opts.frompmm(true).clear(false).cow(false);
+    vmm.map(PhysicalPageManager::get().alloc(phys), vpage, opts);
+    ++gCurrentProcess->memstats.demandfaults;
+    return true;
+}
+
 static bool mmap_fault_recover(VirtualPageManager& vmm, uintptr_t vaddr, MemoryManager*, MemoryManager::region_t& rgn) {
     size_t rgn_offset = vaddr - rgn.from;
     auto vpage = VirtualPageManager::page(vaddr);
-    size_t base_offset = VirtualPageManager::page(rgn_offset);
 
-    if (rgn_offset > rgn.mmap_data.size) {
+    // the last page of the file may be followed by zero-filled memory in the same region
+    if (VirtualPageManager::page(rgn_offset) > rgn.mmap_data.size) {
         TAG_ERROR(PGFAULT, "page fault at 0x%p is at offset %u from region base; this is bigger than mapping size %u",
             vaddr, rgn_offset, rgn.mmap_data.size);
         return false;
@@ -108,16 +213,46 @@ static bool mmap_fault_recover(VirtualPageManager& vmm, uintptr_t vaddr, MemoryM
         TAG_ERROR(PGFAULT, "mmap page fault at 0x%p can't be solved - file 0x%p is invalid", vaddr, file.object);
         return false;
     }
+    if (realFile->sharedMemory()) return shm_fault_recover(vmm, realFile, vaddr, rgn);
 
-    bool sk = realFile->seek(base_offset);
-    if (!sk) {
-        TAG_ERROR(PGFAULT, "file 0x%p can't accept a seek at %u", realFile, base_offset);
-        return false;
+    // do not fault-around past the last page that holds file data
+    uintptr_t limit = rgn.from + VirtualPageManager::page(rgn.mmap_data.size + VirtualPageManager::gPageSize - 1) - 1;
+    if (limit > rgn.to) limit = rgn.to;
+    uintptr_t first;
+    auto npages = faultaround_window(vmm, vpage, rgn, limit, &first);
+    size_t base_offset = first - rgn.from;
+    TAG_DEBUG(PGFAULT, "mmap fault at 0x%p - filling %u pages from 0x%p", vaddr, npages, first);
+
+    auto&& cache(PageCache::get());
+    auto entry = cache.entry(realFile);
+    auto sharedopts = rgn.permission;
+    sharedopts.frompmm(true).clear(false).rw(false).cow(rgn.permission.rw());
+
+    // map pages already in the page cache, and read each run of pages in between with a single read
+    bool ok = true;
+    size_t i = 0;
+    while (i < npages) {
+        auto page_offset = base_offset + i * VirtualPageManager::gPageSize;
+        if (mmap_page_shareable(entry, rgn, page_offset)) {
+            if (auto phys = cache.lookup(entry, rgn.mmap_data.offset + page_offset)) {
+                vmm.map(phys, first + i * VirtualPageManager::gPageSize, sharedopts);
+                ++gCurrentProcess->memstats.sharedpages;
+                ++i;
+                continue;
+            }
+        }
+
+        auto j = i + 1;
+        for (; j < npages; ++j) {
+            auto next_offset = base_offset + j * VirtualPageManager::gPageSize;
+            if (mmap_page_shareable(entry, rgn, next_offset) && cache.contains(entry, rgn.mmap_data.offset + next_offset)) break;
+        }
+        ok = mmap_read_run(vmm, realFile, rgn, first + i * VirtualPageManager::gPageSize, page_offset, j - i) && ok;
+        i = j;
     }
 
-    vmm.mapAnyPhysicalPage(vpage, rgn.permission.clear(true));
-    size_t sz = realFile->read(VirtualPageManager::gPageSize, (char*)vpage);
-    return (sz != 0);
+    faultaround_account(npages);
+    return ok;
 }
 
 static bool zeropage_recover(VirtualPageManager& vmm, uintptr_t vaddr) {
@@ -128,8 +263,13 @@ static bool zeropage_recover(VirtualPageManager& vmm, uintptr_t vaddr) {
             return mmap_fault_recover(vmm, vaddr, memmgr, region);
         } else {
             auto vpage = VirtualPageManager::page(vaddr);
-            TAG_DEBUG(PGFAULT, "faulting address found within a memory region - mapping page 0x%p", vpage);
-            vmm.mapAnyPhysicalPage(vpage, region.permission);
+            uintptr_t first;
+            auto npages = faultaround_window(vmm, vpage, region, region.to, &first);
+            TAG_DEBUG(PGFAULT, "faulting address found within a memory region - mapping page 0x%p and %u neighbours", vpage, npages - 1);
+            for (auto i = 0u; i < npages; ++i) {
+                vmm.mapAnyPhysicalPage(first + i * VirtualPageManager::gPageSize, region.permission);
+            }
+            faultaround_account(npages);
             return true;
         }
     } else {
@@ -137,9 +277,25 @@ static bool zeropage_recover(VirtualPageManager& vmm, uintptr_t vaddr) {
     }
 }
 
+// a write to a page shared through the page cache gives the process its own copy of it
+static void cow_unshare(VirtualPageManager& vmm, uintptr_t vaddr) {
+    MemoryManager::region_t rgn;
+    if (!gCurrentProcess->getMemoryManager()->isWithinRegion(vaddr, &rgn)) return;
+    if (!rgn.isMmapRegion()) return;
+    auto file = rgn.mmap_data.fhandle.asFile();
+    auto entry = file ? PageCache::get().entry(file) : nullptr;
+    if (entry == nullptr) return;
+
+    auto offset = rgn.mmap_data.offset + (VirtualPageManager::page(vaddr) - rgn.from);
+    if (PageCache::get().isShared(entry, offset, vmm.mapping(vaddr))) {
+        --gCurrentProcess->memstats.sharedpages;
+    }
+}
+
 static bool cow_recover(VirtualPageManager& vmm, uintptr_t vaddr) {
     VirtualPageManager::map_options_t opts;
     if (vmm.mapped(vaddr, &opts)) {
+        cow_unshare(vmm, vaddr);
         auto phys_result = vmm.clonePage(vaddr, opts);
         uintptr_t phys;
         if (phys_result.result(&phys)) {
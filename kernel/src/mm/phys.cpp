@@ -28,10 +28,17 @@ PhysicalPageManager& PhysicalPageManager::get() {
 	return gAllocator;
 }
 
-PhysicalPageManager::PhysicalPageManager() : mLastChecked(0), mTotalPages(0), mLowestPage(0), mHighestPage(0), mFreePages(0) {
+PhysicalPageManager::PhysicalPageManager() : mBitmapL3(0), mTotalPages(0), mLowestPage(0), mHighestPage(0), mFreePages(0), mReclaimer(nullptr), mReclaiming(false) {
 	bzero((uint8_t*)&mPages[0],sizeof(mPages));
+	bzero((uint8_t*)&mBitmapL0[0],sizeof(mBitmapL0));
+	bzero((uint8_t*)&mBitmapL1[0],sizeof(mBitmapL1));
+	bzero((uint8_t*)&mBitmapL2[0],sizeof(mBitmapL2));
+	bzero((uint8_t*)&mFullWords[0],sizeof(mFullWords));
 }
 
+// how many pages to ask the reclaimer for when memory runs out
+static constexpr size_t gReclaimBatch = 32;
+
 static constexpr uintptr_t offalignment(uintptr_t addr) {
 	return addr & (PhysicalPageManager::gPageSize - 1);
 }
@@ -63,11 +70,123 @@ static size_t index(uintptr_t addr) {
 	return addr / PhysicalPageManager::gPageSize;
 }
 
+static constexpr uint32_t gAllBits = 0xFFFFFFFF;
+
+static constexpr uint32_t bitfor(size_t idx) {
+	return 1u << (idx % 32);
+}
+
+uint32_t* PhysicalPageManager::bitmap(size_t level) {
+	switch (level) {
+		case 0: return &mBitmapL0[0];
+		case 1: return &mBitmapL1[0];
+		case 2: return &mBitmapL2[0];
+		default: return &mBitmapL3;
+	}
+}
+
+void PhysicalPageManager::markFree(size_t idx) {
+	for (size_t level = 0; level < gBitmapLevels; ++level) {
+		auto& word = bitmap(level)[idx / gBitsPerWord];
+		const bool wasempty = (word == 0);
+		word |= bitfor(idx);
+		if (level == 0 && word == gAllBits) {
+			mFullWords[idx / (gBitsPerWord * gBitsPerWord)] |= bitfor(idx / gBitsPerWord);
+		}
+		if (!wasempty) break;
+		idx /= gBitsPerWord;
+	}
+}
+
+void PhysicalPageManager::markUsed(size_t idx) {
+	for (size_t level = 0; level < gBitmapLevels; ++level) {
+		auto& word = bitmap(level)[idx / gBitsPerWord];
+		if (level == 0 && word == gAllBits) {
+			mFullWords[idx / (gBitsPerWord * gBitsPerWord)] &= ~bitfor(idx / gBitsPerWord);
+		}
+		word &= ~bitfor(idx);
+		if (word != 0) break;
+		idx /= gBitsPerWord;
+	}
+}
+
+bool PhysicalPageManager::findFree(size_t *idx) {
+	if (mBitmapL3 == 0) return false;
+	size_t i = 0;
+	for (size_t level = gBitmapLevels; level > 0; --level) {
+		i = i * gBitsPerWord + __builtin_ctz(bitmap(level - 1)[i]);
+	}
+	*idx = i;
+	return true;
+}
+
+// find a run of "num" (< 32) free pages that does not cross an L0 word boundary
+bool PhysicalPageManager::findRunInWord(size_t num, size_t *idx) {
+	const bool pow2 = (num & (num - 1)) == 0;
+	uint32_t aligned = gAllBits;
+	if (pow2) {
+		aligned = 0;
+		for (size_t b = 0; b < gBitsPerWord; b += num) aligned |= 1u << b;
+	}
+
+	for (size_t w1 = 0; w1 < gNumL1Words; ++w1) {
+		uint32_t nonempty = mBitmapL1[w1];
+		while (nonempty) {
+			size_t w = w1 * gBitsPerWord + __builtin_ctz(nonempty);
+			nonempty &= nonempty - 1;
+
+			// after this loop, bit b of m is set iff bits [b, b+num) of the word are all set
+			uint32_t word = mBitmapL0[w];
+			uint32_t m = word;
+			for (size_t k = 1; k < num;) {
+				size_t shift = (k < num - k) ? k : num - k;
+				m &= m >> shift;
+				k += shift;
+			}
+			m &= aligned;
+			if (m) {
+				*idx = w * gBitsPerWord + __builtin_ctz(m);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// find a run of "num" free pages made of entirely free L0 words
+bool PhysicalPageManager::findRunOfWords(size_t num, size_t *idx) {
+	const size_t needed = (num + gBitsPerWord - 1) / gBitsPerWord;
+	size_t run = 0;
+	size_t start = 0;
+	for (size_t w = 0; w < gNumL1Words; ++w) {
+		const uint32_t bits = mFullWords[w];
+		if (bits == 0) {
+			run = 0;
+			continue;
+		}
+		for (size_t b = 0; b < gBitsPerWord; ++b) {
+			if (bits & (1u << b)) {
+				if (run++ == 0) start = w * gBitsPerWord + b;
+				if (run == needed) {
+					*idx = start * gBitsPerWord;
+					return true;
+				}
+			} else {
+				run = 0;
+			}
+		}
+	}
+
+	return false;
+}
+
 void PhysicalPageManager::addpage(uintptr_t base) {
 	auto i = index(base);
 	if (i < mLowestPage) mLowestPage = i;
 	if (i > mHighestPage) mHighestPage = i;
 	mPages[i].usable = true;
+	markFree(i);
 	++mTotalPages;
 	++mFreePages;
 	LOG_DEBUG("added a new physical page, base = 0x%p, index = %u (lowest page = %u, highest page = %u)", base, i, mLowestPage, mHighestPage);
@@ -96,6 +215,7 @@ void PhysicalPageManager::reserve(uintptr_t base) {
 	}
 
 	mPages[idx].usable = false;
+	if (mPages[idx].free()) markUsed(idx);
 
 	--mFreePages;
 }
@@ -112,21 +232,31 @@ void PhysicalPageManager::reserve(uintptr_t begin, uintptr_t end) {
 	}
 }
 
+void PhysicalPageManager::reclaimer(reclaimer_f f) {
+	mReclaimer = f;
+}
+
 kernel_result_t<uintptr_t> PhysicalPageManager::alloc() {
-	for (size_t n = 0u, idx = mLastChecked; n < gNumPages; ++n, ++idx) {
-		if (idx == gNumPages) idx = 0;
-		if (!mPages[idx].usable) continue;
-		if (mPages[idx].free()) {
-			auto rc = mPages[idx].incref();
-			mLastChecked = idx;
-			// this if condition is going to basically always be true - but having it there
-			// allows us to leave rc in the code, even if LOG_NODEBUG is defined
-			if (rc > 0) --mFreePages;
-			auto base = gPageSize * idx;
-			TAG_DEBUG(PMLEAK, "ALLOC 0x%p", base);
-			LOG_DEBUG("physical allocator returned page at 0x%p (idx = %u) - rc = %u", base, idx, rc);
-			return kernel_success(base);
-		}
+	size_t idx;
+	bool found = findFree(&idx);
+	// the reclaimer may itself need to allocate, so do not let it recurse
+	if (!found && mReclaimer && !mReclaiming) {
+		mReclaiming = true;
+		auto freed = mReclaimer(gReclaimBatch);
+		mReclaiming = false;
+		LOG_INFO("out of physical memory - reclaimed %u pages", freed);
+		found = findFree(&idx);
+	}
+	if (found) {
+		auto rc = mPages[idx].incref();
+		markUsed(idx);
+		// this if condition is going to basically always be true - but having it there
+		// allows us to leave rc in the code, even if LOG_NODEBUG is defined
+		if (rc > 0) --mFreePages;
+		auto base = gPageSize * idx;
+		TAG_DEBUG(PMLEAK, "ALLOC 0x%p", base);
+		LOG_DEBUG("physical allocator returned page at 0x%p (idx = %u) - rc = %u", base, idx, rc);
+		return kernel_success(base);
 	}
 
 	return kernel_failure<uintptr_t>(kernel_status_t::OUT_OF_MEMORY);
@@ -138,7 +268,10 @@ uintptr_t PhysicalPageManager::alloc(uintptr_t base) {
 		PANIC("trying to allocate a non-usable page");
 	}
 	auto rc = mPages[idx].incref();
-	if (1 == rc) --mFreePages;
+	if (1 == rc) {
+		--mFreePages;
+		markUsed(idx);
+	}
 	LOG_DEBUG("allocated page at 0x%p (idx = %u) - rc = %u", base, idx, rc);
 
 	return base;
@@ -153,6 +286,7 @@ void PhysicalPageManager::dealloc(uintptr_t base) {
 	auto rc = mPages[idx].decref();
 	if (0 == rc) {
 		++mFreePages;
+		markFree(idx);
 		TAG_DEBUG(PMLEAK, "DEALLOC 0x%p", base);
 	}
 	LOG_DEBUG("deallocated page at 0x%p (idx = %u) - rc = %u", base, idx, rc);
@@ -165,31 +299,59 @@ size_t PhysicalPageManager::refcount(uintptr_t base) {
 }
 
 bool PhysicalPageManager::allocContiguousPages(size_t num, uintptr_t *base) {
-	auto page_idx = mLowestPage;
-	while(true) {
-		bool all_free = true;
-		for (auto u = 0u; u < num; ++u) {
-			const bool usable = mPages[page_idx + u].usable;
-			const bool free = mPages[page_idx + u].free();
-			if (!usable || !free) {
-				// start again right after the unavailable page
-				page_idx = page_idx + u + 1;
-				all_free = false;
-				break;
-			}
+	size_t page_idx = 0;
+	bool found = false;
+	if (num > 0 && num < gBitsPerWord) {
+		found = findRunInWord(num, &page_idx);
+	}
+	if (num > 0 && !found) {
+		found = findRunOfWords(num, &page_idx);
+	}
+
+	if (!found) {
+		*base = 0;
+		return false;
+	}
+
+	for (auto u = 0u; u < num; ++u) {
+		alloc( (page_idx + u) * gPageSize );
+	}
+	*base = page_idx * gPageSize;
+	return true;
+}
+
+void PhysicalPageManager::freeblocks(size_t *counts) {
+	bzero((uint8_t*)counts, sizeof(size_t) * (gMaxBlockOrder + 1));
+
+	// split every maximal run of free pages into naturally aligned power-of-two blocks
+	auto account = [counts] (size_t begin, size_t end) -> void {
+		while (begin < end) {
+			size_t order = begin ? __builtin_ctz(begin) : gMaxBlockOrder;
+			if (order > gMaxBlockOrder) order = gMaxBlockOrder;
+			while ((1u << order) > (end - begin)) --order;
+			++counts[order];
+			begin += (1u << order);
 		}
-		if (all_free) {
-			for (auto u = 0u; u < num; ++u) {
-				alloc( (page_idx + u) * gPageSize );
+	};
+
+	size_t runstart = 0;
+	bool inrun = false;
+	for (size_t w = 0; w < gNumL0Words; ++w) {
+		const uint32_t word = mBitmapL0[w];
+		if ((word == 0 && !inrun) || (word == gAllBits && inrun)) continue;
+		for (size_t b = 0; b < gBitsPerWord; ++b) {
+			const bool isfree = word & (1u << b);
+			const size_t idx = w * gBitsPerWord + b;
+			if (isfree && !inrun) {
+				runstart = idx;
+				inrun = true;
+			} else if (!isfree && inrun) {
+				account(runstart, idx);
+				inrun = false;
 			}
-			*base = page_idx * gPageSize;
-			return true;
-		}
-		if (page_idx > mHighestPage) {
-			*base = 0;
-			return false;
 		}
 	}
+	if (inrun) account(runstart, gNumPages);
 }
 
 size_t PhysicalPageManager::gettotalpages() const {
@@ -0,0 +1,208 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/mm/slab.h>
+#include <kernel/libc/string.h>
+
+#define LOG_LEVEL 2
+#include <kernel/log/log.h>
+
+LOG_TAG(SLAB, 2);
+
+static_assert(SlabAllocator::gMinObjectSize << (SlabAllocator::gNumCaches - 1) == SlabAllocator::gMaxObjectSize);
+
+SlabAllocator& SlabAllocator::get() {
+    static SlabAllocator gAllocator;
+
+    return gAllocator;
+}
+
+SlabAllocator::SlabAllocator() : mHeapBase(0), mPool(gNoSlab), mPoolSize(0) {
+    bzero(&mSlabs[0], sizeof(mSlabs));
+    bzero(&mCaches[0], sizeof(mCaches));
+
+    for (auto i = 0u; i < gNumCaches; ++i) {
+        auto& cache(mCaches[i]);
+        cache.objsize = gMinObjectSize << i;
+        cache.perslab = VirtualPageManager::gPageSize / cache.objsize;
+        cache.partial = cache.empty = gNoSlab;
+    }
+}
+
+static size_t cacheForSize(size_t size) {
+    if (size <= SlabAllocator::gMinObjectSize) return 0;
+    // round up to the next power of two, and rebase so that gMinObjectSize is cache 0
+    return (32 - __builtin_clz(size - 1)) - __builtin_ctz(SlabAllocator::gMinObjectSize);
+}
+
+uint16_t SlabAllocator::index(uintptr_t page) const {
+    return (page - mHeapBase) / VirtualPageManager::gPageSize;
+}
+
+uintptr_t SlabAllocator::address(uint16_t idx) const {
+    return mHeapBase + idx * VirtualPageManager::gPageSize;
+}
+
+bool SlabAllocator::owned(void* ptr, uint16_t* idx) const {
+    if (mHeapBase == 0) return false;
+    auto p = (uintptr_t)ptr;
+    if (p < mHeapBase || p >= mHeapBase + VirtualPageManager::gKernelHeapSize) return false;
+    *idx = index(VirtualPageManager::page(p));
+    return mSlabs[*idx].cache != 0;
+}
+
+void SlabAllocator::link(uint16_t* head, uint16_t idx) {
+    auto& slab(mSlabs[idx]);
+    slab.prev = gNoSlab;
+    slab.next = *head;
+    if (*head != gNoSlab) mSlabs[*head].prev = idx;
+    *head = idx;
+}
+
+void SlabAllocator::unlink(uint16_t* head, uint16_t idx) {
+    auto& slab(mSlabs[idx]);
+    if (slab.prev != gNoSlab) mSlabs[slab.prev].next = slab.next;
+    else *head = slab.next;
+    if (slab.next != gNoSlab) mSlabs[slab.next].prev = slab.prev;
+    slab.prev = slab.next = gNoSlab;
+}
+
+uint16_t SlabAllocator::newslab(uint8_t cacheid) {
+    uint16_t idx;
+    if (mPool != gNoSlab) {
+        idx = mPool;
+        mPool = mSlabs[idx].next;
+        --mPoolSize;
+    } else {
+        // ksbrk() panics on failure, so no need to check the result here
+        auto page = VirtualPageManager::get().ksbrk(VirtualPageManager::gPageSize);
+        if (mHeapBase == 0) mHeapBase = VirtualPageManager::get().getheapbegin();
+        idx = index(page);
+    }
+
+    auto& cache(mCaches[cacheid - 1]);
+    auto& slab(mSlabs[idx]);
+    slab.cache = cacheid;
+    slab.inuse = 0;
+    slab.freelist = nullptr;
+    slab.prev = slab.next = gNoSlab;
+
+    // thread the free list through the objects themselves, lowest address first
+    auto base = (uint8_t*)address(idx);
+    for (auto i = cache.perslab; i > 0; --i) {
+        void** obj = (void**)(base + (i - 1) * cache.objsize);
+        *obj = slab.freelist;
+        slab.freelist = obj;
+    }
+
+    ++cache.numslabs;
+    TAG_DEBUG(SLAB, "new slab at 0x%p for cache of size %u", base, cache.objsize);
+    return idx;
+}
+
+void SlabAllocator::releaseslab(uint16_t idx) {
+    auto& slab(mSlabs[idx]);
+    --mCaches[slab.cache - 1].numslabs;
+    slab.cache = 0;
+    slab.freelist = nullptr;
+    slab.prev = gNoSlab;
+    slab.next = mPool;
+    mPool = idx;
+    ++mPoolSize;
+}
+
+void* SlabAllocator::alloc(size_t size) {
+    if (size > gMaxObjectSize) return nullptr;
+
+    auto cacheid = cacheForSize(size);
+    auto& cache(mCaches[cacheid]);
+
+    if (cache.partial == gNoSlab) {
+        if (cache.empty != gNoSlab) {
+            auto idx = cache.empty;
+            unlink(&cache.empty, idx);
+            --cache.numempty;
+            link(&cache.partial, idx);
+        } else {
+            link(&cache.partial, newslab(cacheid + 1));
+        }
+    }
+
+    auto idx = cache.partial;
+    auto& slab(mSlabs[idx]);
+    void** obj = (void**)slab.freelist;
+    slab.freelist = *obj;
+    if (++slab.inuse == cache.perslab) {
+        // full slabs are not on any list; free() will put them back on the partial list
+        unlink(&cache.partial, idx);
+    }
+
+    ++cache.inuse;
+    ++cache.allocs;
+    return obj;
+}
+
+bool SlabAllocator::free(void* ptr) {
+    uint16_t idx;
+    if (!owned(ptr, &idx)) return false;
+
+    auto& slab(mSlabs[idx]);
+    auto& cache(mCaches[slab.cache - 1]);
+
+    const bool wasfull = (slab.inuse == cache.perslab);
+    *(void**)ptr = slab.freelist;
+    slab.freelist = ptr;
+    --slab.inuse;
+    --cache.inuse;
+    ++cache.frees;
+
+    if (slab.inuse == 0) {
+        if (!wasfull) unlink(&cache.partial, idx);
+        if (cache.numempty < gMaxEmptySlabsPerCache) {
+            link(&cache.empty, idx);
+            ++cache.numempty;
+        } else {
+            TAG_DEBUG(SLAB, "slab at 0x%p returned to the shared pool", address(idx));
+            releaseslab(idx);
+        }
+    } else if (wasfull) {
+        link(&cache.partial, idx);
+    }
+
+    return true;
+}
+
+size_t SlabAllocator::usableSize(void* ptr) {
+    uint16_t idx;
+    if (!owned(ptr, &idx)) return 0;
+    return mCaches[mSlabs[idx].cache - 1].objsize;
+}
+
+bool SlabAllocator::stats(size_t i, cache_stats_t* stats) {
+    if (i >= gNumCaches) return false;
+    const auto& cache(mCaches[i]);
+
+    stats->objsize = cache.objsize;
+    stats->slabs = cache.numslabs;
+    stats->emptyslabs = cache.numempty;
+    stats->capacity = cache.numslabs * cache.perslab;
+    stats->inuse = cache.inuse;
+    stats->allocs = cache.allocs;
+    stats->frees = cache.frees;
+    return true;
+}
+
+size_t SlabAllocator::pooledPages() const {
+    return mPoolSize;
+}
@@ -20,8 +20,10 @@
 #include <kernel/panic/panic.h>
 #include <kernel/libc/memory.h>
 #include <kernel/process/current.h>
+#include <kernel/process/cpu.h>
 #include <kernel/libc/memory.h>
 #include <kernel/libc/bitmask.h>
+#include <kernel/mm/zeropool.h>
 
 #define LOG_LEVEL 2
 #include <kernel/log/log.h>
@@ -39,9 +41,9 @@ static_assert(gFlagsBitmask == 0xFFF);
 
 VirtualPageManager::DirectoryEntry* VirtualPageManager::gPageDirectory = (DirectoryEntry*)gPageDirectoryAddress;
 
-VirtualPageManager::map_options_t::map_options_t() : _rw(true), _user(false), _clear(false), _frompmm(false), _cow(false), _cached(true), _global(false) {}
+VirtualPageManager::map_options_t::map_options_t() : _rw(true), _user(false), _clear(false), _frompmm(false), _cow(false), _cached(true), _global(false), _zeroed(false) {}
 
-VirtualPageManager::map_options_t::map_options_t(bool rw, bool user, bool clear, bool frompmm) : _rw(rw), _user(user), _clear(clear), _frompmm(frompmm), _cow(false), _cached(true), _global(false) {}
+VirtualPageManager::map_options_t::map_options_t(bool rw, bool user, bool clear, bool frompmm) : _rw(rw), _user(user), _clear(clear), _frompmm(frompmm), _cow(false), _cached(true), _global(false), _zeroed(false) {}
 
 #define DEFINE_OPTION(type, name) \
 type VirtualPageManager::map_options_t:: name () const { return _ ## name; } \
@@ -54,6 +56,7 @@ DEFINE_OPTION(bool, frompmm);
 DEFINE_OPTION(bool, cow);
 DEFINE_OPTION(bool, cached);
 DEFINE_OPTION(bool, global);
+DEFINE_OPTION(bool, zeroed);
 
 #undef DEFINE_OPTION
 
@@ -315,7 +318,10 @@ uintptr_t VirtualPageManager::map(uintptr_t phys, uintptr_t virt, const map_opti
 	
 	LOG_DEBUG("asked to map phys 0x%p to virt 0x%p; that will be page dir entry %u, and page table entry %u", phys, virt, indices.dir, indices.tbl);
 
-	if (options.user() & !options.clear()) {
+	// a page that is already zeroed needs no clearing, and is safe to hand to userspace
+	const bool mustclear = options.clear() && !options.zeroed();
+
+	if (options.user() & !options.clear() & !options.zeroed()) {
 		LOG_WARNING("page mapping virt=0x%p phys=0x%p shall be visible to userspace, but is not being zeroed out", virt, phys);
 	}
 
@@ -327,9 +333,11 @@ uintptr_t VirtualPageManager::map(uintptr_t phys, uintptr_t virt, const map_opti
 
 	// if we are asked to clear the page, first map it R/W, so the kernel can clear it
 	// then clear it, then protect it readonly
-	bool mustprotect = options.clear() && !options.rw();
+	bool mustprotect = mustclear && !options.rw();
 
 	TableEntry &tbl(indices.table());
+	// replacing a mapping means other CPUs may have the old one cached
+	const bool replacing = tbl.present() || tbl.zpmap();
 	tbl.present(true);
 	if (mustprotect) {
 		tbl.rw(true);
@@ -343,8 +351,9 @@ uintptr_t VirtualPageManager::map(uintptr_t phys, uintptr_t virt, const map_opti
 	tbl.cow(options.cow());
 	tbl.page(phys);
 	invtlb(virt);
+	if (replacing) CPUs::get().shootdown(virt);
 
-	if (options.clear()) {
+	if (mustclear) {
 		auto pageptr = (uint8_t*)virt;
 		bzero(pageptr, gPageSize);
 
@@ -382,10 +391,15 @@ uintptr_t VirtualPageManager::mapAnyPhysicalPage(uintptr_t virt, const map_optio
 	if (mapped(virt)) {
 		LOG_DEBUG("virtual address 0x%p already mapped", virt);
 	} else {
-		auto&& physall(PhysicalPageManager::get());
-		auto phys_result = physall.alloc();
-		auto phys = phys_result.result();
 		auto opts = map_options_t(options).frompmm(true);
+		uintptr_t phys;
+		if (options.clear() && ZeroPagePool::get().take(&phys)) {
+			opts.zeroed(true);
+		} else {
+			auto&& physall(PhysicalPageManager::get());
+			auto phys_result = physall.alloc();
+			phys = phys_result.result();
+		}
 		map(phys, virt, opts);
 	}
 
@@ -412,6 +426,8 @@ void VirtualPageManager::unmap(uintptr_t virt) {
 	tbl.zpmap(false); // make sure we don't think this is a zeropage mapping
 	tbl.frompmm(false); // do not assume this page is bound to any physical storage
 	invtlb(virt);
+	// no CPU may keep using the page once it goes back to the physical allocator
+	if (wasthere) CPUs::get().shootdown(virt);
 
 	uintptr_t phys = 0;
 
@@ -502,6 +518,7 @@ uintptr_t VirtualPageManager::newoptions(uintptr_t virt, const map_options_t& op
 		tbl.frompmm(options.frompmm());
 		tbl.cow(options.cow());
 		invtlb(pg);
+		CPUs::get().shootdown(pg);
 		return virt;
 	}
 
@@ -569,7 +586,12 @@ uintptr_t VirtualPageManager::cloneAddressSpace() {
 
 		for (auto j = 0u; j < 1024u; ++j, ++indices) {
 			TableEntry tbl(indices.table()); // NB: this is making a *copy* of the original TableEntry
-			if (!tbl.present()) continue;
+			if (!tbl.present()) {
+				// pages that have not been faulted in yet (e.g. demand-loaded program text)
+				// must still be faulted in by the clone, so preserve the zero page mapping
+				if (tbl.zpmap()) pageTbl[j] = (uint32_t)tbl;
+				continue;
+			}
 			if (tbl.rw()) {
 				// only mark RW pages as COW
 				markCOW(indices.address());
@@ -819,7 +841,7 @@ uintptr_t VirtualPageManager::mapOtherProcessPage(process_t* other, uintptr_t ot
 	// get a scratch page - unmap the physical memory it points to, and remap it to the other process' CR3
 	scratch_page_t other_pd = getScratchPage(map_options_t::kernel());
 	unmap(other_pd.operator uintptr_t());
-	map(other->tss.cr3, other_pd.operator uintptr_t(), map_options_t::kernel());
+	map(other->ctx.cr3, other_pd.operator uintptr_t(), map_options_t::kernel());
 
 	uint32_t *otherPageDir = other_pd.get<uint32_t>();
 	auto otherPageDirEntry = otherPageDir[indices.dir];
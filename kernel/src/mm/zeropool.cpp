@@ -0,0 +1,114 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/mm/zeropool.h>
+#include <kernel/mm/phys.h>
+#include <kernel/mm/virt.h>
+#include <kernel/libc/string.h>
+#include <kernel/sys/config.h>
+#include <kernel/tasks/zeroer.h>
+
+#define LOG_LEVEL 2
+#include <kernel/log/log.h>
+
+LOG_TAG(ZEROPOOL, 2);
+
+// never grow the pool if that would leave less than this many free pages for everyone else
+static constexpr size_t gMinFreePagesMultiplier = 4;
+
+ZeroPagePool& ZeroPagePool::get() {
+    static ZeroPagePool gPool;
+
+    return gPool;
+}
+
+ZeroPagePool::ZeroPagePool() : mSize(0), mLowWatermark(0), mHighWatermark(0), mHits(0), mMisses(0) {
+    bzero(&mPages[0], sizeof(mPages));
+}
+
+void ZeroPagePool::configure() {
+    auto&& config(gKernelConfiguration()->zeropool);
+    mHighWatermark = config.high > gMaxPages ? gMaxPages : config.high;
+    mLowWatermark = config.low > mHighWatermark ? mHighWatermark : config.low;
+    LOG_INFO("zero page pool watermarks: low = %u, high = %u", mLowWatermark, mHighWatermark);
+}
+
+bool ZeroPagePool::take(uintptr_t *phys) {
+    if (mSize == 0) {
+        ++mMisses;
+        tasks::zeroer::queue().wakeall();
+        return false;
+    }
+
+    *phys = mPages[--mSize];
+    ++mHits;
+    if (belowLowWatermark()) tasks::zeroer::queue().wakeall();
+    return true;
+}
+
+bool ZeroPagePool::fillOne() {
+    if (!belowHighWatermark()) return false;
+
+    auto& phys(PhysicalPageManager::get());
+    if (phys.getfreepages() < gMinFreePagesMultiplier * mHighWatermark) {
+        TAG_DEBUG(ZEROPOOL, "only %u free pages left, not growing the pool", phys.getfreepages());
+        return false;
+    }
+
+    uintptr_t page;
+    if (!phys.alloc().result(&page)) return false;
+
+    {
+        // map the page without frompmm, so that releasing the scratch page leaves our reference alone
+        auto opts = VirtualPageManager::map_options_t::kernel().clear(true);
+        auto sp = VirtualPageManager::get().getScratchPage(page, opts);
+    }
+
+    // the pool could have been refilled by someone else while we were zeroing
+    if (!belowHighWatermark()) {
+        phys.dealloc(page);
+        return false;
+    }
+
+    mPages[mSize++] = page;
+    return true;
+}
+
+bool ZeroPagePool::belowLowWatermark() const {
+    return mSize < mLowWatermark;
+}
+
+bool ZeroPagePool::belowHighWatermark() const {
+    return mSize < mHighWatermark;
+}
+
+size_t ZeroPagePool::size() const {
+    return mSize;
+}
+
+size_t ZeroPagePool::low() const {
+    return mLowWatermark;
+}
+
+size_t ZeroPagePool::high() const {
+    return mHighWatermark;
+}
+
+uint64_t ZeroPagePool::hits() const {
+    return mHits;
+}
+
+uint64_t ZeroPagePool::misses() const {
+    return mMisses;
+}
@@ -17,6 +17,8 @@
 #include <kernel/process/current.h>
 #include <kernel/mm/memmgr.h>
 #include <kernel/i386/primitives.h>
+#include <kernel/synch/biglock.h>
+#include <kernel/process/datapages.h>
 
 extern "C"
 void clone_start(uintptr_t eip) {
@@ -27,7 +29,10 @@ void clone_start(uintptr_t eip) {
     auto stackregion = memmgr->findAndZeroPageRegion(process_t::gDefaultStackSize, stackpermission);
     LOG_INFO("stack is begin = 0x%p, end = 0x%p", stackregion.to, stackregion.from);
 
+    DataPages::get().attach();
+
     // gcc tends to expect ESP+4 to be available; and an 8 byte aligned stack
     // is a good thing for other reasons - so just leave 8 bytes and be done with it
+    BigKernelLock::get().unlock();
     toring3(eip, stackregion.to - 8);
 }
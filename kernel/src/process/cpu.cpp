@@ -0,0 +1,106 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/process/cpu.h>
+#include <kernel/process/process.h>
+#include <kernel/drivers/apic/apic.h>
+#include <kernel/i386/primitives.h>
+#include <kernel/mm/virt.h>
+#include <kernel/syscalls/types.h>
+
+cpu_t CPUs::gCPUs[CPUs::gMaxCPUs];
+
+static_assert(CPUs::gMaxCPUs <= SYSINFO_MAX_CPUS, "sysinfo must have room for every CPU");
+
+CPUs& CPUs::get() {
+    static CPUs gTable;
+
+    return gTable;
+}
+
+CPUs::CPUs() : mCount(1), mOnline(1) {
+    for (auto i = 0u; i < gMaxCPUs; ++i) {
+        auto& cpu(gCPUs[i]);
+        cpu.index = i;
+        cpu.shootdown = gNoShootdown;
+    }
+
+    // the boot CPU is running this very code, so it is online by definition; its APIC ID is
+    // filled in once the APIC is known to exist
+    gCPUs[0].online = true;
+}
+
+cpu_t& CPUs::cpu(size_t index) {
+    return gCPUs[index];
+}
+
+size_t CPUs::count() const {
+    return mCount;
+}
+
+size_t CPUs::online() const {
+    return __atomic_load_n(&mOnline, __ATOMIC_SEQ_CST);
+}
+
+cpu_t* CPUs::add(uint8_t apicid) {
+    if (mCount == gMaxCPUs) return nullptr;
+    auto& cpu(gCPUs[mCount++]);
+    cpu.apicid = apicid;
+    return &cpu;
+}
+
+void CPUs::setOnline(cpu_t& cpu) {
+    __atomic_store_n(&cpu.online, true, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&mOnline, 1, __ATOMIC_SEQ_CST);
+}
+
+void CPUs::shootdown(uintptr_t virt) {
+    if (online() <= 1) return;
+
+    auto& self(current());
+    const bool kernel = VirtualPageManager::iskernel(virt);
+    const auto cr3 = readcr3();
+    bool sent[gMaxCPUs] = {false};
+
+    for (auto i = 0u; i < mCount; ++i) {
+        auto& cpu(gCPUs[i]);
+        if (&cpu == &self || !cpu.online) continue;
+        // a userspace mapping can only be cached by CPUs that are in the same address space;
+        // any other CPU will flush it when it loads this cr3
+        if (!kernel && cpu.current && cpu.current->ctx.cr3 != cr3) continue;
+        __atomic_store_n(&cpu.shootdown, virt, __ATOMIC_SEQ_CST);
+        APIC::get().sendIPI(cpu.apicid, gShootdownIRQ);
+        sent[i] = true;
+    }
+
+    for (auto i = 0u; i < mCount; ++i) {
+        if (!sent[i]) continue;
+        while (__atomic_load_n(&gCPUs[i].shootdown, __ATOMIC_SEQ_CST) != gNoShootdown) {
+            __asm__ volatile("pause");
+        }
+    }
+}
+
+void CPUs::serviceShootdown() {
+    auto& self(current());
+    auto virt = __atomic_load_n(&self.shootdown, __ATOMIC_SEQ_CST);
+    if (virt == gNoShootdown) return;
+    invtlb(virt);
+    __atomic_store_n(&self.shootdown, gNoShootdown, __ATOMIC_SEQ_CST);
+}
+
+void CPUs::reschedule(cpu_t& cpu) {
+    if (&cpu == &current() || !cpu.online) return;
+    APIC::get().sendIPI(cpu.apicid, gRescheduleIRQ);
+}
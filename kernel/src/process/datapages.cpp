@@ -0,0 +1,92 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/process/datapages.h>
+#include <kernel/process/current.h>
+#include <kernel/process/process.h>
+#include <kernel/mm/phys.h>
+#include <kernel/mm/virt.h>
+#include <kernel/libc/string.h>
+#include <kernel/panic/panic.h>
+#include <kernel/log/log.h>
+
+LOG_TAG(DATAPAGE, 1);
+
+DataPages& DataPages::get() {
+    static DataPages gPages;
+
+    return gPages;
+}
+
+DataPages::DataPages() {
+    auto& vmm(VirtualPageManager::get());
+
+    mPhysical = PhysicalPageManager::get().alloc().result();
+    interval_t rgn;
+    if (!vmm.findKernelRegion(VirtualPageManager::gPageSize, rgn)) {
+        PANIC("unable to map the kernel data page");
+    }
+    vmm.addKernelRegion(rgn.from, rgn.to);
+    vmm.map(mPhysical, rgn.from, VirtualPageManager::map_options_t::kernel().clear(true));
+    mData = (kernel_data_t*)rgn.from;
+
+    TAG_DEBUG(DATAPAGE, "kernel data page at 0x%p (physical 0x%p)", mData, mPhysical);
+}
+
+void DataPages::attach() {
+    auto& vmm(VirtualPageManager::get());
+
+    // the shared page is never handed back to the physical allocator, however many processes map it;
+    // map() warns about userspace mappings that are not cleared, which this one must never be
+    vmm.map(mPhysical, kernel_data_t::gAddress, VirtualPageManager::map_options_t::kernel().rw(false));
+    vmm.newoptions(kernel_data_t::gAddress, VirtualPageManager::map_options_t::userspace().rw(false));
+
+    if (vmm.mapped(process_data_t::gAddress)) vmm.unmap(process_data_t::gAddress);
+    vmm.mapAnyPhysicalPage(process_data_t::gAddress, VirtualPageManager::map_options_t::userspace().clear(true));
+    auto pd = (process_data_t*)process_data_t::gAddress;
+    pd->pid = gCurrentProcess->leader->pid;
+    vmm.newoptions(process_data_t::gAddress, VirtualPageManager::map_options_t::userspace().rw(false).frompmm(true));
+}
+
+// writes only ever happen with the big kernel lock held, so there is one writer at a time
+void DataPages::beginUpdate() {
+    __atomic_add_fetch(&mData->seq, 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void DataPages::endUpdate() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&mData->seq, 1, __ATOMIC_RELEASE);
+}
+
+void DataPages::publishUptime(uint64_t millis) {
+    beginUpdate();
+    mData->uptime = millis;
+    endUpdate();
+}
+
+void DataPages::publishUNIXtime(uint64_t seconds, uint64_t micros) {
+    beginUpdate();
+    mData->now = seconds;
+    mData->nowMicros = micros;
+    endUpdate();
+}
+
+void DataPages::publishTSC(uint64_t ticksPerMs, uint64_t base, uint64_t baseMicros) {
+    beginUpdate();
+    mData->tsc.ticksPerMs = ticksPerMs;
+    mData->tsc.base = base;
+    mData->tsc.baseMicros = baseMicros;
+    endUpdate();
+}
@@ -30,6 +30,9 @@
 #include <kernel/panic/panic.h>
 #include <kernel/process/elf.h>
 #include <kernel/process/shebang.h>
+#include <kernel/fs/pagecache.h>
+#include <kernel/synch/biglock.h>
+#include <kernel/process/datapages.h>
 
 #define UNHAPPY(cause, N) { \
     process_exit_status_t es(process_exit_status_t::reason_t::kernelError, N); \
@@ -76,16 +79,15 @@ process_loadinfo_t load_binary(const char* path) {
     if (file->stat(fstat) == false) UNHAPPY("unable to discover file size", process_exit_status_t::kernelError_noSuchFile);
     if (fstat.size == 0) UNHAPPY("file length == 0", process_exit_status_t::kernelError_malformedFile);
 
+    // only read the headers; the loader maps the rest of the file on demand. One extra byte
+    // guarantees that the buffer is NUL-terminated for text-based formats
+    auto headersize = fstat.size < gExecHeaderSize ? fstat.size : gExecHeaderSize;
     auto bufferopts = VirtualPageManager::map_options_t().clear(true).rw(true).user(false);
-    auto file_rgn = memmgr->findAndZeroPageRegion(fstat.size, bufferopts);
+    auto file_rgn = memmgr->findAndZeroPageRegion(gExecHeaderSize + 1, bufferopts);
 
-    LOG_DEBUG("file size: %u - mapped region 0x%p-0x%p for read", fstat.size, file_rgn.from, file_rgn.to);
+    LOG_DEBUG("file size: %u - mapped region 0x%p-0x%p for reading %u header bytes", fstat.size, file_rgn.from, file_rgn.to, headersize);
 
-    if (file->read(fstat.size, (char*)file_rgn.from) == false) UNHAPPY("unable to read file data", process_exit_status_t::kernelError_noSuchFile);
-
-    fhandle.close();
-    fhandle.filesystem = nullptr;
-    fhandle.object = nullptr;
+    if (PageCache::get().read(file, headersize, (char*)file_rgn.from) == 0) UNHAPPY("unable to read file data", process_exit_status_t::kernelError_noSuchFile);
 
     exec_format_loader_t *loader_f = nullptr;
 
@@ -101,9 +103,12 @@ process_loadinfo_t load_binary(const char* path) {
 
     if (loader_f == nullptr) UNHAPPY("no loader for this format", process_exit_status_t::kernelError_malformedFile);
 
-    auto loadinfo = loader_f->load_f(file_rgn.from, process_t::gDefaultStackSize);
+    auto loadinfo = loader_f->load_f(file_rgn.from, fhandle, process_t::gDefaultStackSize);
     memmgr->removeRegion(file_rgn);
 
+    // any file-backed regions created by the loader hold their own reference to the file
+    fhandle.close();
+
     return loadinfo;
 }
 
@@ -121,7 +126,11 @@ void fileloader(uintptr_t) {
     fpinit();
     // now we have FPU state and we know we have to save on exit
 
+    DataPages::get().attach();
+
     LOG_DEBUG("about to jump to program entry at 0x%p - stack at 0x%p", loadinfo.eip, loadinfo.stack);
+    // the lock was inherited from whoever switched to this process; userspace does not hold it
+    BigKernelLock::get().unlock();
     toring3(loadinfo.eip, loadinfo.stack);
 
     // we should never ever ever get back here...
@@ -18,6 +18,7 @@
 #include <kernel/libc/string.h>
 #include <kernel/libc/memory.h>
 #include <kernel/process/current.h>
+#include <kernel/mm/memmgr.h>
 
 extern "C" char *stpcpy(char *__restrict, const char *__restrict);
 
@@ -35,12 +36,20 @@ extern "C" bool elf_can_load(uintptr_t load0) {
     return header->sanitycheck();
 }
 
-extern "C" process_loadinfo_t elf_do_load(uintptr_t load0, size_t stacksize) {
+extern "C" process_loadinfo_t elf_do_load(uintptr_t load0, VFS::filehandle_t fhandle, size_t stacksize) {
     elf_header_t *header = (elf_header_t*)load0;
-    return load_main_binary(header, stacksize);
+    return load_main_binary(header, fhandle, stacksize);
 }
 
-elf_load_result_t load_elf_image(elf_header_t* header) {
+static uintptr_t pageup(uintptr_t addr) {
+    return VirtualPageManager::page(addr + VirtualPageManager::gPageSize - 1);
+}
+
+// segments are not copied into memory; the file-backed portion of each is mapped from the
+// executable and faulted in on first access, and anything past that is zero-filled on demand;
+// pages come from the page cache, so they are shared with other processes running the same
+// executable, and writable segments get a private copy of a page when they first write to it
+elf_load_result_t load_elf_image(elf_header_t* header, VFS::filehandle_t fhandle) {
     ph_load_info loaded_headers[10];
     bzero(&loaded_headers[0], sizeof(loaded_headers));
     int loaded_header_idx = 0;
@@ -52,9 +61,14 @@ elf_load_result_t load_elf_image(elf_header_t* header) {
     };
     auto maxprogaddr = header->entry;
 
-    auto&& vmm(VirtualPageManager::get());
     auto&& memmgr(gCurrentProcess->getMemoryManager());
 
+    if (header->phoff + header->phnum * sizeof(elf_program_t) > gExecHeaderSize) {
+        result.ok = false;
+        result.error = "ELF program headers beyond the first page";
+        return result;
+    }
+
     for (auto i = 0u; i < header->phnum; ++i) {
         auto&& pref = header->program(i);
         
@@ -72,72 +86,55 @@ elf_load_result_t load_elf_image(elf_header_t* header) {
             return result;
         }
 
-        auto mapopts = VirtualPageManager::map_options_t().user(true).clear(true);
+        if (VirtualPageManager::offset(pref.vaddr) != VirtualPageManager::offset(pref.offset)) {
+            result.ok = false;
+            result.error = "ELF segment address and file offset are not congruent";
+            return result;
+        }
+
+        if (pref.memsz == 0) continue;
+
+        const auto vaddr0 = VirtualPageManager::page(pref.vaddr); // low address for this section
+        const auto fileend = pref.vaddr + pref.filesz; // end of the file-backed content
+        const auto vaddr1 = pageup(pref.vaddr + pref.memsz); // high address for this section
+
+        if (VirtualPageManager::iskernel(vaddr0) || VirtualPageManager::iskernel(vaddr1 - 1)) {
+            TAG_ERROR(LOADELF, "executable wants to be mapped in kernel memory; fail");
+            result.ok = false;
+            result.error = "cannot load userland binary in kernel memory";
+            return result;
+        }
+
+        MemoryManager::region_t existing;
+        if (memmgr->isWithinRegion(vaddr0, &existing) || memmgr->isWithinRegion(vaddr1 - 1, &existing)) {
+            result.ok = false;
+            result.error = "ELF segments overlap";
+            return result;
+        }
 
-        auto vaddr = (uint8_t*)pref.vaddr;
+        auto mapopts = VirtualPageManager::map_options_t::userspace().rw(pref.writable()).clear(true);
 
         loaded_headers[loaded_header_idx].start = pref.vaddr;
         loaded_headers[loaded_header_idx].offset = pref.offset;
         loaded_headers[loaded_header_idx].size = pref.memsz;
-        loaded_headers[loaded_header_idx].virt_start = (uintptr_t)vaddr;
-
-        auto len = pref.memsz;
-        auto flen = pref.filesz;
-        auto src = pref.content(header);
-        auto vaddr0 = (uintptr_t)vaddr; // low address for this section
-        auto vaddr1 = (uintptr_t)vaddr; // high address for this section
-        while(len != 0) {
-            auto vaddr_Page = VirtualPageManager::page((uintptr_t)vaddr);
-            auto vaddr_PageDelta = (uintptr_t)vaddr - vaddr_Page;
-            TAG_DEBUG(LOADELF, "start by mapping a page at 0x%p (page delta = %u)", vaddr, vaddr_PageDelta);
-            const auto residualPage = VirtualPageManager::gPageSize - vaddr_PageDelta;
-
-            if (VirtualPageManager::iskernel(vaddr_Page)) {
-                TAG_ERROR(LOADELF, "executable wants to be mapped in kernel memory; fail");
-                result.ok = false;
-                result.error = "cannot load userland binary in kernel memory";
-                return result;
-            }
-
-            vmm.mapAnyPhysicalPage( vaddr_Page, mapopts.rw(true) );
-            vaddr1 = (vaddr_Page + VirtualPageManager::gPageSize);
-
-            auto chunk = len;
-            if (chunk < residualPage) {
-                TAG_DEBUG(LOADELF, "chunk size %u is < page size", chunk);
-            } else if (chunk > residualPage) {
-                TAG_DEBUG(LOADELF, "chunk size %u is > page size - truncating to page size", chunk);
-                chunk = residualPage;
-            }
-            if (chunk <= flen) {
-                TAG_DEBUG(LOADELF, "chunk size %u is <= flen %u - copying entire chunk from file", chunk, flen);
-                memcopy(src, vaddr, chunk);
-                flen -= chunk;
-            } else {
-                if (flen > 0) {
-                    TAG_DEBUG(LOADELF, "chunk size %u is > flen %u - copying flen from disk", chunk, flen);                        
-                    memcopy(src, vaddr, flen);
-                    flen = 0;
-                } else {
-                    TAG_DEBUG(LOADELF, "chunk size %u is > flen %u", chunk, flen);                                                
-                }
-            }
-
-            vmm.mapped((uintptr_t)vaddr, &mapopts);
-            mapopts.rw(pref.writable());
-            vmm.newoptions((uintptr_t)vaddr, mapopts);
-
-            len -= chunk;
-            src += chunk;
-            vaddr += chunk;
-            if ((uintptr_t)vaddr > maxprogaddr) {
-                maxprogaddr = (uintptr_t)vaddr;
-            }
-            TAG_DEBUG(LOADELF, "len = %u flen = %u vaddr = 0x%p src = 0x%p", len, flen, vaddr, src);
+        loaded_headers[loaded_header_idx].virt_start = vaddr0;
+        loaded_headers[loaded_header_idx].readonly = !pref.writable();
+
+        auto zero0 = vaddr0;
+        if (pref.filesz > 0) {
+            zero0 = pageup(fileend);
+            TAG_DEBUG(LOADELF, "file-mapping [0x%p - 0x%p] from offset %u, %u bytes", vaddr0, zero0 - 1,
+                pref.offset - (pref.vaddr - vaddr0), fileend - vaddr0);
+            memmgr->addFileMapRegion(vaddr0, zero0 - 1, fhandle,
+                pref.offset - (pref.vaddr - vaddr0), fileend - vaddr0, mapopts);
         }
-        
-        memmgr->addMappedRegion(vaddr0, vaddr1-1);
-        loaded_headers[loaded_header_idx++].virt_end = (uintptr_t)vaddr1-1;
+        if (vaddr1 > zero0) {
+            TAG_DEBUG(LOADELF, "zero-filling [0x%p - 0x%p]", zero0, vaddr1 - 1);
+            memmgr->addZeroPageRegion(zero0, vaddr1 - 1, mapopts);
+        }
+
+        if (vaddr1 > maxprogaddr) maxprogaddr = vaddr1;
+        loaded_headers[loaded_header_idx++].virt_end = vaddr1 - 1;
     }
 
     result.max_load_addr = maxprogaddr;
@@ -181,7 +178,7 @@ static char** copyStringArrayToUserland(char** srcArray, MemoryManager* memmgr)
 }
 
 extern "C"
-process_loadinfo_t load_main_binary(elf_header_t* header, size_t stacksize) {
+process_loadinfo_t load_main_binary(elf_header_t* header, VFS::filehandle_t fhandle, size_t stacksize) {
     auto&& memmgr(gCurrentProcess->getMemoryManager());
 
     process_loadinfo_t loadinfo{
@@ -192,7 +189,7 @@ process_loadinfo_t load_main_binary(elf_header_t* header, size_t stacksize) {
     if (header == nullptr || !header->sanitycheck()) UNHAPPY("invalid ELF header");
     if (header->isDylib()) UNHAPPY("ELF is a shared library");
 
-    auto elf_load_info = load_elf_image(header);
+    auto elf_load_info = load_elf_image(header, fhandle);
     if (elf_load_info.ok == false) {
         UNHAPPY(elf_load_info.error);
     }
@@ -16,6 +16,7 @@
 #include <kernel/sys/globals.h>
 #include <kernel/process/manager.h>
 #include <kernel/i386/primitives.h>
+#include <kernel/i386/tss.h>
 #include <kernel/libc/enableif.h>
 #include <kernel/libc/memory.h>
 #include <kernel/log/log.h>
@@ -25,6 +26,7 @@
 #include <kernel/mm/virt.h>
 #include <kernel/process/fileloader.h>
 #include <kernel/process/clonestart.h>
+#include <kernel/process/threadstart.h>
 #include <kernel/process/reaper.h>
 #include <kernel/boot/phase.h>
 #include <kernel/libc/vec.h>
@@ -33,13 +35,16 @@
 #include <kernel/tasks/collector.h>
 #include <kernel/tasks/deleter.h>
 #include <kernel/tasks/keybqueue.h>
+#include <kernel/tasks/zeroer.h>
 #include <kernel/time/manager.h>
+#include <kernel/process/cpu.h>
+#include <kernel/synch/biglock.h>
+#include <kernel/libc/sprint.h>
+#include <kernel/syscalls/manager.h>
 
 LOG_TAG(TIMING, 2);
 LOG_TAG(FILEOPS, 0);
-
-// this is THE current process information
-process_t *gCurrentProcess;
+LOG_TAG(SCHEDULER, 1);
 
 extern "C" process_t *gParentProcess() {
     if (gCurrentProcess) return ProcessManager::get().getprocess(gCurrentProcess->ppid);
@@ -95,7 +100,7 @@ namespace boot::scheduler_tick {
     uint32_t init() {
         auto& tmgr(TimeManager::get());
 
-        tmgr.registerTickHandler(tick_for_schedule, nullptr, 5);
+        tmgr.registerTickHandler(tick_for_schedule, nullptr, 1);
         tmgr.registerTickHandler(tick_for_metrics, nullptr, 1);
 
         return 0;
@@ -124,21 +129,35 @@ Type & ProcessManager:: Name () { \
 }
 
 PM_GLOBAL(ProcessBitmap<ProcessManager::gNumProcesses>, gPidBitmap);
-PM_GLOBAL(ProcessBitmap<ProcessManager::gNumProcesses>, gGDTBitmap);
 PM_GLOBAL(ProcessTable<ProcessManager::gNumProcesses>, gProcessTable);
 PM_GLOBAL(ProcessTable<ProcessManager::gNumProcesses>, gExitedProcesses);
 PM_GLOBAL(slist<process_t*>, gCollectedProcessList);
-PM_GLOBAL(vector<process_t*>, gReadyQueue);
 
 #undef PM_GLOBAL
 
+ReadyQueue<ProcessManager::gNumProcesses>& ProcessManager::gReadyQueue(size_t cpu) {
+    static ReadyQueue<ProcessManager::gNumProcesses> gQueues[CPUs::gMaxCPUs];
+
+    return gQueues[cpu];
+}
+
+ReadyQueue<ProcessManager::gNumProcesses>& ProcessManager::gReadyQueue() {
+    return gReadyQueue(CPUs::currentIndex());
+}
+
+// the dummy process is the boot CPU's idle process; like the other CPUs' idle processes, it is never
+// in a ready queue, and the scheduler falls back to it when nothing else can run
 static process_t gDummyProcess;
+static TTY gDummyProcessTTY;
+
+// the length of one unit of priority.quantum
+static constexpr uint64_t gQuantumMicros = 5000;
 
-static process_t *gSchedulerTask;
 static process_t *gCollectorTask;
 static process_t *gAwakerTask;
 static process_t *gDeleterTask;
 static process_t *gKeybQTask;
+static process_t *gZeroerTask;
 static process_t *gInitTask;
 
 int ProcessManager::sleep_queue_helper::compare(const sleep_queue_helper::qentry& p1, const sleep_queue_helper::qentry& p2) {
@@ -167,7 +186,6 @@ namespace {
     };
 }
 
-#define NOSCHED 0
 #define LOW 5
 #define NORMAL 20
 #define HIGH 30
@@ -196,15 +214,14 @@ namespace {
 }
 
 static system_task_t gSystemTasks[] = {
-    SYSTEM_TASK(tasks::scheduler::task,   NOSCHED,  "scheduler",   &gSchedulerTask),
     SYSTEM_TASK(tasks::collector::task,   LOW,      "collector",   &gCollectorTask),
     SYSTEM_TASK(tasks::awaker::task,      NORMAL,   "awaker",      &gAwakerTask),
     SYSTEM_TASK(tasks::deleter::task,     LOW,      "deleter",     &gDeleterTask),
     SYSTEM_TASK(tasks::keybqueue::task,   HIGH,     "keybqueue",   &gKeybQTask),
+    SYSTEM_TASK(tasks::zeroer::task,      LOW,      "zeroer",      &gZeroerTask),
 };
 
 #undef SYSTEM_TASK
-#undef NOSCHED
 #undef LOW
 #undef NORMAL
 #undef HIGH
@@ -238,59 +255,88 @@ void task0() {
         LOG_DEBUG("init process ready as 0x%p %u", gInitTask, (uint32_t)gInitTask->pid);
     }
 
-    while(true) {
-        haltforever();
-    }
+    // the lock has been held since the other CPUs were started; the idle loop takes it as needed
+    BigKernelLock::get().unlock();
+    ProcessManager::get().idle();
 }
 
-ProcessManager::ProcessManager() {
-    {
-        const auto num_reserved_gdt_selectors = val_numsysgdtentries<uint32_t>();
-        auto& gdt_bitmap(gGDTBitmap());
-        LOG_DEBUG("system reserved %u GDT selectors", num_reserved_gdt_selectors);
-        for (auto i = 0u; i < num_reserved_gdt_selectors; ++i) {
-            gdt_bitmap.reserve(i);
+// each CPU has one TSS; it is never switched to, but the CPU reads esp0 and ss0 from it
+// whenever userspace enters the kernel, so ctxswitch() keeps esp0 current
+static void installTSS(cpu_t& cpu, uintptr_t esp0) {
+    auto& tss(cpu.tss);
+    tss.ss0 = 0x10;
+    tss.esp0 = esp0;
+    // point the I/O bitmap past the segment limit, so ring 3 gets no port access
+    tss.iomap = sizeof(TaskStateSegment);
+
+    auto idx = CPUs::gFirstTSSIndex + cpu.index;
+    auto dtbl = addr_gdt<uint64_t*>();
+    dtbl[idx] = tss.segment();
+    LOG_DEBUG("TSS for CPU %u at 0x%p, gdt entry is 0x%llx", cpu.index, &tss, dtbl[idx]);
+}
+
+void ProcessManager::prepareCPU(cpu_t& cpu) {
+    char name[32] = {0};
+    sprint(name, sizeof(name), "idle task %u", cpu.index);
+
+    auto idle = new process_t();
+    idle->ctx.cr3 = readcr3();
+    idle->ctx.esp0 = 4096 + (uintptr_t)malloc(4096);
+    idle->pid = gPidBitmap().next();
+    idle->state = process_t::State::AVAILABLE;
+    idle->path = strdup(name);
+    idle->ttyinfo = process_t::ttyinfo_t(&gDummyProcessTTY);
+    idle->flags.system = true;
+    idle->priority = gDummyProcess.priority;
+    idle->cpu = cpu.index;
+    gProcessTable().set(idle);
+
+    installTSS(cpu, idle->ctx.esp0);
+    cpu.idle = cpu.current = idle;
+    cpu.lastcharge = TimeManager::get().millisUptime();
+}
+
+void ProcessManager::idle() {
+    auto& bkl(BigKernelLock::get());
+    auto& cpu(CPUs::current());
+    auto& ready(gReadyQueue(cpu.index));
+
+    disableirq();
+    bkl.lock();
+    while(true) {
+        if (!ready.empty() || steal(cpu)) {
+            yield();
+            continue;
         }
+        bkl.unlock();
+        // re-enables IRQs right before halting, so a wakeup cannot slip in between the check and the hlt
+        waitforirq();
+        disableirq();
+        bkl.lock();
     }
+}
 
-    static TTY gDummyProcessTTY;
-
-    // prepare the initial dummy task
-    gDummyProcess.tss.cr3 = readcr3();
-    gDummyProcess.tss.eip = (uintptr_t)&task0;
-    gDummyProcess.tss.cs = 0x0b;
-    gDummyProcess.tss.ss = gDummyProcess.tss.ds = gDummyProcess.tss.es =
-        gDummyProcess.tss.fs = gDummyProcess.tss.gs = 0x13;
-    gDummyProcess.tss.ss0 = 0x10;
-    gDummyProcess.tss.esp0 = 4096 + (uintptr_t)malloc(4096);
+ProcessManager::ProcessManager() {
+    // prepare the initial dummy task - kmain() calls task0() directly on the boot stack,
+    // and the first ctxswitch() away from it will save that context like any other
+    gDummyProcess.ctx.cr3 = readcr3();
+    gDummyProcess.ctx.esp0 = 4096 + (uintptr_t)malloc(4096);
     gDummyProcess.pid = gPidBitmap().next();
     gDummyProcess.state = process_t::State::AVAILABLE;
     gDummyProcess.priority.quantum.current = gDummyProcess.priority.quantum.max = 1;
     gDummyProcess.path = strdup("kernel task");
-    gDummyProcess.gdtidx = gGDTBitmap().next();
     gDummyProcess.ttyinfo = process_t::ttyinfo_t(&gDummyProcessTTY);
     gDummyProcess.flags.system = true;
     gDummyProcess.priority.scheduling.current = gDummyProcess.priority.quantum.current = 1;
     gDummyProcess.priority.scheduling.max = gDummyProcess.priority.quantum.max = 128;
 
-    auto dtbl = addr_gdt<uint64_t*>();
-
-    LOG_DEBUG("dtbl = 0x%p, sizeof(TSS) = %u, gDummyTaskSegment = 0x%p", dtbl, sizeof(process_t), &gDummyProcess);
-    LOG_DEBUG("msb is 0x%p", ((uint64_t)&gDummyProcess) & 0xFF000000);
-
-    dtbl[gDummyProcess.gdtidx] = sizeof(process_t) & 0xFFFF;
-    dtbl[gDummyProcess.gdtidx] |= (((uint64_t)&gDummyProcess) & 0xFFFFFFULL) << 16;
-    dtbl[gDummyProcess.gdtidx] |= 0xE90000000000ULL;
-    dtbl[gDummyProcess.gdtidx] |= (((uint64_t)&gDummyProcess) & 0xFF000000ULL) << 32;
-
-    LOG_DEBUG("gdt idx is %u entry is 0x%llx", gDummyProcess.gdtidx, dtbl[gDummyProcess.gdtidx]);
-
-    dtbl[5] = 0x300000 | 0x1E50000000000;
-    writetaskreg(gDummyProcess.gdtidx*8 | 3);
+    auto& bsp(CPUs::get().cpu(0));
+    installTSS(bsp, gDummyProcess.ctx.esp0);
+    writetaskreg(CPUs::gFirstTSSIndex * 8);
 
+    bsp.idle = &gDummyProcess;
     gCurrentProcess = &gDummyProcess;
     gProcessTable().set(&gDummyProcess);
-    gReadyQueue().push_back(&gDummyProcess);
 
     mProcessPagesLow = mProcessPagesHigh = 0;
 }
@@ -335,6 +381,22 @@ static typename enable_if<idx >= 0, uint32_t*>::type stackpush(uint32_t *esp, T
     return stackpush<idx-1>(esp, values...);
 }
 
+// lays out a frame below top that ctxswitch() resumes into; ctxstart() then enters eip with esp == top
+static uintptr_t makecontext(uint32_t* top, uintptr_t eip) {
+    uint32_t* esp = top;
+    *--esp = eip;
+    *--esp = (uintptr_t)&ctxstart;
+    *--esp = 0; // ebp
+    *--esp = 0; // ebx
+    *--esp = 0; // esi
+    *--esp = 0; // edi
+    *--esp = 0x10; // ds
+    *--esp = 0x10; // es
+    *--esp = 0x10; // fs
+    *--esp = 0x10; // gs
+    return (uintptr_t)esp;
+}
+
 namespace {
     class process_pages_t {
         public:
@@ -461,12 +523,21 @@ process_t* ProcessManager::spawn(const spawninfo_t& si) {
         copyEnvironment(process, si.environment);
     }
 
+    // whichever thread spawns a process, it becomes a child of the process as a whole
+    auto parent = gCurrentProcess->leader;
+    if (si.thread) {
+        process->leader = parent;
+        process->fds = parent->fds;
+        ++parent->thread.count;
+        // the address space goes away when the last thread using it is deleted
+        PhysicalPageManager::get().alloc(si.cr3);
+    }
+
     if (si.name) process->path = strdup(si.name);
 
-    process->tss.cr3 = si.cr3;
-    process->tss.eip = si.eip;
+    process->ctx.cr3 = si.cr3;
     process->pid = gPidBitmap().next();
-    process->ppid = gCurrentProcess->pid;
+    process->ppid = parent->pid;
     process->ttyinfo = gCurrentProcess->ttyinfo;
     process->cwd = strdup(gCurrentProcess->cwd);
 
@@ -477,29 +548,19 @@ process_t* ProcessManager::spawn(const spawninfo_t& si) {
 
     process->flags.system = si.system;
 
-    process->tss.cs = 0x08;
-    process->tss.ss = process->tss.ds = process->tss.es = process->tss.fs = process->tss.gs = 0x10;
-    process->tss.ss0 = 0x10;
-    process->tss.esp0 = VirtualPageManager::gPageSize - 1 + pages.esp0;
-
-    process->tss.eflags = 512; // enable IRQ
+    process->ctx.esp0 = VirtualPageManager::gPageSize + pages.esp0;
 
     // TODO: is one page enough? factor this out to a global anyway
     // this is [0] thru [1023], where [1023] is the first element
     // because of x86 stack rules
     uint32_t* esp = pages.getesp();
     esp = stackpush<1023>(esp, si.argument);
-    process->tss.esp = (uintptr_t)esp;
-
-    LOG_DEBUG("esp = 0x%p", process->tss.esp);
-
-    auto gdtval = fillGDT(process);
+    process->ctx.esp = makecontext(esp, si.eip);
 
-    LOG_DEBUG("process %u spawning process %u; eip = 0x%p, cr3 = 0x%p, esp0 = 0x%p, esp = 0x%p, gdt index %u value 0x%llx",
+    LOG_DEBUG("process %u spawning process %u; eip = 0x%p, cr3 = 0x%p, esp0 = 0x%p, esp = 0x%p",
         process->ppid, process->pid,
-        process->tss.eip, process->tss.cr3,
-        process->tss.esp0, process->tss.esp,
-        process->gdtidx, gdtval);
+        si.eip, process->ctx.cr3,
+        process->ctx.esp0, process->ctx.esp);
 
     gProcessTable().set(process);
     if (si.schedulable) {
@@ -509,69 +570,82 @@ process_t* ProcessManager::spawn(const spawninfo_t& si) {
         LOG_DEBUG("process %u is not schedulable", process->pid);
     }
 
-    forwardTTY(process);
-
-    execFileops(gCurrentProcess, process, si.fileops);
+    if (!si.thread) {
+        forwardTTY(process);
+        execFileops(gCurrentProcess, process, si.fileops);
+    }
 
-    gCurrentProcess->children.add(process);
+    parent->children.add(process);
 
     return process;
 }
 
 process_t* ProcessManager::kspawn(const spawninfo_t& si) {
     auto sinfo(si);
-    sinfo.cr3 = gDummyProcess.tss.cr3;
+    sinfo.cr3 = gDummyProcess.ctx.cr3;
     sinfo.system = true;
     return spawn(sinfo);
 }
 
-#define GDT_IDX_TO_TSS_ENTRY(idx) (((idx * 8) << 16) | 0x1E50000000000ULL)
-
 static uint64_t gNumCtxSwitches = 0;
 
-uint64_t ProcessManager::numContextSwitches() {
-    return gNumCtxSwitches;
+// with no periodic tick, time has to be accounted for whenever the running process changes,
+// as well as on timer interrupts; charging whole milliseconds since the last charge loses nothing,
+// as fractions carry over to whoever is running at the next charge
+static void chargeRuntime() {
+    auto& cpu(CPUs::current());
+    auto now = TimeManager::get().millisUptime();
+    auto delta = now - cpu.lastcharge;
+    cpu.lastcharge = now;
+
+    if (cpu.current == nullptr) return;
+    __sync_add_and_fetch(&cpu.current->runtimestats.runtime, delta);
+    if (cpu.current == cpu.idle) cpu.stats.idle += delta;
+    else cpu.stats.busy += delta;
 }
 
-static inline void doGDTSwitch(uint16_t, size_t gdtidx) {
-    ++gNumCtxSwitches;
-    auto dtbl = addr_gdt<uint64_t*>();
-    dtbl[5] = GDT_IDX_TO_TSS_ENTRY(gdtidx);
-    ::ctxswitch();
+uint64_t ProcessManager::numContextSwitches() {
+    return gNumCtxSwitches;
 }
 
+// must be called with IRQs disabled
 void ProcessManager::ctxswitch(process_t* task) {
-    auto cr0 = gCurrentProcess->cr0;
+    auto prev = gCurrentProcess;
+    if (task == prev) return;
+
+    chargeRuntime();
+
+    // TS clear means the outgoing process has touched the FPU since it was switched in; save its
+    // state now and set TS so that the incoming process restores its own state on first use
+    auto cr0 = readcr0();
     if (0 == (cr0 & 0x8)) {
-        LOG_DEBUG("saving FP state for process %u", gCurrentProcess->pid);
-        cleartaskswitchflag();
-        fpsave((uintptr_t)&gCurrentProcess->fpstate[0]);
+        LOG_DEBUG("saving FP state for process %u", prev->pid);
+        fpsave((uintptr_t)&prev->fpstate[0]);
+        writecr0(cr0 | 0x8);
     }
 
-    gCurrentProcess = task;
-    doGDTSwitch(task->pid, task->gdtidx);
-}
+    ++gNumCtxSwitches;
+    CPUs::current().tss.esp0 = task->ctx.esp0;
+    if (task->ctx.cr3 != prev->ctx.cr3) writecr3(task->ctx.cr3);
 
-void ProcessManager::switchtoscheduler() {
-    // cr0 is not part of the hardware context switch, save it upon switching to scheduler
-    gCurrentProcess->cr0 = readcr0();
-    doGDTSwitch(gSchedulerTask->pid, gSchedulerTask->gdtidx);
+    gCurrentProcess = task;
+    ::ctxswitch(&prev->ctx.esp, task->ctx.esp);
 }
 
-#define GDT_ENTRY_TO_TSS_PTR(tssval) ((tssval & 0xFFFFFF0000ULL) >> 16) | ((tssval & 0xFF00000000000000ULL) >> 32)
-
 process_t* ProcessManager::getprocess(kpid_t pid) {
     return gProcessTable().get(pid);
 }
 
-#undef GDT_ENTRY_TO_TSS_PTR
-
 kpid_t ProcessManager::getpid() {
     return gCurrentProcess->pid;
 }
 
 void ProcessManager::sleep(uint32_t durationMs) {
-    gCurrentProcess->sleeptill = TimeManager::get().millisUptime() + durationMs;
+    usleep(1000 * (uint64_t)durationMs);
+}
+
+void ProcessManager::usleep(uint64_t durationUs) {
+    gCurrentProcess->sleeptill = TimeManager::get().microsUptime() + durationUs;
     LOG_DEBUG("task %u scheduled to sleep till %llu", gCurrentProcess->pid, gCurrentProcess->sleeptill);
     deschedule(gCurrentProcess, process_t::State::SLEEPING, nullptr);
     gSleepQueue().insert({gCurrentProcess->waitToken, gCurrentProcess});
@@ -582,40 +656,152 @@ void ProcessManager::sleep(uint32_t durationMs) {
 // This is a fairly sharp tool: it takes a (non-running) process and hijacks it
 // into going to a whole different place next time it's scheduled. This has the potential
 // to lose all information about where the process originally was and what it was doing.
-void ProcessManager::resumeat(process_t* task, uintptr_t eip, uintptr_t esp, uint16_t cs, uint16_t ss) {
-    auto&& tss(task->tss);
-
-    tss.eip = eip;
-    tss.esp = esp;
-    tss.cs = cs;
-    tss.ss = ss;
+void ProcessManager::resumeat(process_t* task, uintptr_t eip, uintptr_t esp) {
+    task->ctx.esp = makecontext((uint32_t*)esp, eip);
 }
 
 bool ProcessManager::kill(kpid_t pid) {
     process_exit_status_t es(process_exit_status_t::reason_t::killed, 0);
-    auto task = getprocess(pid);
+    return kill(getprocess(pid), es);
+}
+
+bool ProcessManager::kill(process_t* task, process_exit_status_t es) {
     LOG_DEBUG("task %u 0x%p killing task %u 0x%p", gCurrentProcess->pid, gCurrentProcess, task->pid, task);
     if (task == gCurrentProcess) {
         exit(es);
     } else if (task != nullptr) {
+        // already on its way out, and taking its threads along
+        if (task->flags.exiting || task->state == process_t::State::EXITED) return true;
         if (task->flags.system && !gCurrentProcess->flags.system) {
             LOG_ERROR("process %u tried to kill system task %u", gCurrentProcess->pid, task->pid);
             return false;
         }
-        // push the exit status
-        uint32_t *stack = (uint32_t*)task->esp0start;
-        *stack = es.toWord();
+        if (task->heldlocks != 0) {
+            // asleep holding a lock; it goes to the reaper once it lets go of the last one
+            task->exitstatus = es;
+            task->flags.killpending = true;
+            return true;
+        }
+        auto& cpu(CPUs::get().cpu(task->cpu));
+        if (cpu.current == task) {
+            // running on some other CPU, which is using its kernel stack; that CPU will see the flag
+            // as soon as it gets into the kernel, which the IPI makes sure happens soon
+            task->exitstatus = es;
+            task->flags.killpending = true;
+            CPUs::get().reschedule(cpu);
+            return true;
+        }
+        // push the exit status at the top of the kernel stack - whatever was there is being abandoned
+        uint32_t *stack = (uint32_t*)(task->esp0start + VirtualPageManager::gPageSize);
+        *--stack = es.toWord();
         --stack;
-        resumeat(task, (uintptr_t)&reaper, (uint32_t)stack, 0x08, 0x10);
+        resumeat(task, (uintptr_t)&reaper, (uint32_t)stack);
     }
     return true;
 }
 
 void ProcessManager::exit(process_exit_status_t es) {
-    exit(gCurrentProcess, es);
+    auto task = gCurrentProcess;
+    if (task->leader != task) {
+        // a thread that dies for any reason other than exiting on its own takes the process with it
+        if (!task->leader->flags.exiting) kill(task->leader, es);
+        exitThread(task, es);
+    } else {
+        exit(task, es);
+    }
+    yield();
+}
+
+void ProcessManager::exitThread(bool detached) {
+    auto task = gCurrentProcess;
+    process_exit_status_t es(process_exit_status_t::reason_t::cleanExit, 0);
+
+    if (task->leader == task) {
+        // the main thread leaving ends the process, but not before every other thread is done;
+        // a syscall ring poller only ever works for the others, so it would wait forever
+        task->sysring.stopping = true;
+        while (task->thread.count) {
+            deschedule(task, process_t::State::COLLECTING, nullptr);
+            yield();
+        }
+        exit(es);
+        return;
+    }
+
+    if (detached) {
+        auto parent = getprocess(task->ppid);
+        auto c0 = parent->children.begin();
+        auto ce = parent->children.end();
+        for (; c0 != ce; ++c0) {
+            if ((*c0) == task) {
+                parent->children.remove(c0);
+                break;
+            }
+        }
+        LOG_DEBUG("detached thread %u going to collector process %u", task->pid, gCollectorTask->pid);
+        task->ppid = gCollectorTask->pid;
+        gCollectorTask->children.add(task);
+        tasks::collector::queue().wakeall();
+    }
+
+    exitThread(task, es);
     yield();
 }
 
+// any thread of a process may be waiting to collect one of its children
+void ProcessManager::wakeCollectors(process_t* parent) {
+    if (parent == nullptr) {
+        LOG_DEBUG("process has no parent");
+        return;
+    }
+    if (parent->thread.count == 0) {
+        if (parent->state == process_t::State::COLLECTING) {
+            LOG_DEBUG("parent %u woken up for collection", parent->pid);
+            // TODO: a process should be a WaitableObject
+            reschedule(parent);
+        } else {
+            LOG_DEBUG("parent %u was not waiting to collect", parent->pid);
+        }
+        return;
+    }
+
+    gProcessTable().foreach([this, parent] (const process_t* p) -> bool {
+        if (p->leader == parent && p->state == process_t::State::COLLECTING) {
+            LOG_DEBUG("thread %u of parent %u woken up for collection", p->pid, parent->pid);
+            reschedule((process_t*)p);
+        }
+        return true;
+    });
+}
+
+// unlike a process, a thread leaves the address space and file table alone; those belong to its leader
+void ProcessManager::exitThread(process_t* task, process_exit_status_t es) {
+    auto leader = task->leader;
+    LOG_DEBUG("thread %u of process %u exiting", task->pid, leader->pid);
+
+    deschedule(task, process_t::State::EXITED, nullptr);
+    gSleepQueue().remove([task] (const sleep_queue_helper::qentry& q) -> bool {
+        return q.process == task;
+    });
+
+    MemoryManager::region_t stack;
+    auto memmgr = task->getMemoryManager();
+    if (task->thread.stack && memmgr->isWithinRegion(task->thread.stack, &stack)) {
+        memmgr->removeRegion(stack);
+    }
+
+    task->state = process_t::State::EXITED;
+    task->exitstatus = es;
+    enqueueForDeath(task);
+
+    --leader->thread.count;
+    // the leader may be waiting for its threads to be done, rather than for this one to be collected
+    if (leader->thread.count == 0 && leader->state == process_t::State::COLLECTING) {
+        reschedule(leader);
+    }
+    wakeCollectors(getprocess(task->ppid));
+}
+
 void ProcessManager::exit(process_t* task, process_exit_status_t es) {
     if (task->flags.system) {
         PANIC("attempting to kill a system process");
@@ -623,6 +809,20 @@ void ProcessManager::exit(process_t* task, process_exit_status_t es) {
         LOG_DEBUG("killing process %u", task->pid);
     }
 
+    if (task->thread.count) {
+        task->flags.exiting = true;
+        gProcessTable().foreach([this, task, es] (const process_t* p) -> bool {
+            if (p != task && p->leader == task) kill((process_t*)p, es);
+            return true;
+        });
+        // the address space cannot be torn down while any thread might still be running in it
+        while (task->thread.count) {
+            LOG_DEBUG("process %u waiting for %u threads to exit", task->pid, task->thread.count);
+            deschedule(task, process_t::State::COLLECTING, nullptr);
+            yield();
+        }
+    }
+
     {
         auto c0 = task->children.begin();
         auto end = task->children.end();
@@ -643,9 +843,9 @@ void ProcessManager::exit(process_t* task, process_exit_status_t es) {
     LOG_DEBUG("done cleaning memory regions");
     VirtualPageManager::get().cleanAddressSpace();
 
-    for(auto i = 0u; i < task->fds.size(); ++i) {
-        decltype(task->fds)::entry_t fd;
-        if (task->fds.is(i, &fd)) {
+    for(auto i = 0u; i < task->fds->size(); ++i) {
+        process_t::fdtable_t::entry_t fd;
+        if (task->fds->is(i, &fd)) {
             if (fd) {
                 LOG_DEBUG("for process %u, closing file handle %u (fs = 0x%p, fh = 0x%p)", task->pid, i, fd.filesystem, fd.object);
                 fd.close();
@@ -654,21 +854,20 @@ void ProcessManager::exit(process_t* task, process_exit_status_t es) {
     }
     LOG_DEBUG("done releasing file handles");
 
+    deschedule(task, process_t::State::EXITED, nullptr);
+    gSleepQueue().remove([task] (const sleep_queue_helper::qentry& q) -> bool {
+        return q.process == task;
+    });
     task->state = process_t::State::EXITED;
     task->ttyinfo.tty->popfg(task->pid);
     task->exitstatus = es;
+    SyscallManager::get().untrack(task->pid);
+    // the process is still running on its own kernel stack, but nothing can free it before it
+    // switches away for good, so it can go on the exited list right now instead of the scheduler
+    // having to notice it later
+    enqueueForDeath(task);
 
-    auto parent = getprocess(task->ppid);
-    if (parent == nullptr) {
-        LOG_DEBUG("process has no parent");
-    }
-    if (parent->state == process_t::State::COLLECTING) {
-        LOG_DEBUG("parent %u woken up for collection", parent->pid);
-        // TODO: a process should be a WaitableObject
-        reschedule(parent);
-    } else {
-        LOG_DEBUG("parent %u was not waiting to collect", parent->pid);
-    }
+    wakeCollectors(getprocess(task->ppid));
 }
 
 bool ProcessManager::isinterruptible(uintptr_t addr) {
@@ -684,20 +883,46 @@ bool ProcessManager::isinterruptible(uintptr_t addr) {
 }
 
 void ProcessManager::tickForMetrics() {
-    if (gCurrentProcess) __sync_add_and_fetch(&gCurrentProcess->runtimestats.runtime, TimeManager::get().millisPerTick());
+    chargeRuntime();
 }
 
 void ProcessManager::tickForSchedule(bool can_yield, bool* will_yield) {
     *will_yield = false;
 
-    auto allowedticks = __atomic_load_n(&gCurrentProcess->priority.quantum.current, __ATOMIC_SEQ_CST);
-    if (allowedticks > 0) {
-        auto usedticks = __atomic_add_fetch(&gCurrentProcess->usedticks, 1, __ATOMIC_SEQ_CST);
-        if (usedticks >= allowedticks) {
-            if (can_yield) *will_yield = true;
-            else gCurrentProcess->flags.due_for_reschedule = true;
-        }
+    auto now = TimeManager::get().microsUptime();
+    auto quantumend = gCurrentProcess->quantumend;
+    if (quantumend != 0 && quantumend <= now) {
+        if (can_yield) *will_yield = true;
+        else gCurrentProcess->flags.due_for_reschedule = true;
+    }
+
+    // yielding re-arms the timer on its own
+    if (*will_yield == false) armTimer(gCurrentProcess);
+}
+
+// programs the next timer interrupt for the earlier of the running process' quantum expiry and the
+// first sleeper's wakeup; deadlines already in the past are not armed again: an expired quantum is
+// waiting on the process to get to a point where it can be rescheduled, and due sleepers are handed
+// to the awaker task right here
+void ProcessManager::armTimer(process_t* running) {
+    auto& tmgr(TimeManager::get());
+    auto now = tmgr.microsUptime();
+
+    auto& sq(gSleepQueue());
+    if (!sq.empty() && sq.top().process->sleeptill <= now) {
+        tasks::awaker::queue().wakeall();
+    }
+
+    if (!tmgr.tickless()) return;
+
+    uint64_t deadline = 0;
+    if (running->quantumend > now) deadline = running->quantumend;
+    if (!sq.empty()) {
+        auto sleeptill = sq.top().process->sleeptill;
+        if (sleeptill > now && (deadline == 0 || sleeptill < deadline)) deadline = sleeptill;
     }
+
+    tmgr.setDeadline(deadline);
 }
 
 void ProcessManager::yield(bool bytimer) {
@@ -705,15 +930,37 @@ void ProcessManager::yield(bool bytimer) {
         __sync_add_and_fetch(&gCurrentProcess->runtimestats.ctxswitches, 1);
         if (!bytimer) __sync_add_and_fetch(&gCurrentProcess->runtimestats.runtime, 1);
     }
-    switchtoscheduler();
+
+    // a kill that came in while this process was running on another CPU, or holding a lock
+    if (gCurrentProcess->flags.killpending && gCurrentProcess->heldlocks == 0 &&
+        gCurrentProcess->state != process_t::State::EXITED) {
+        reaper(gCurrentProcess->exitstatus.toWord());
+    }
+
+    // pick the next task right here on the current kernel stack, no trip through a scheduler task
+    const bool irq = (0 != (readflags() & 512));
+    if (irq) disableirq();
+
+    auto& cpu(CPUs::current());
+    auto& ready(gReadyQueue(cpu.index));
+    if (ready.empty()) steal(cpu);
+    auto next = ready.empty() ? cpu.idle : tasks::scheduler::next();
+    next->flags.due_for_reschedule = false;
+
+    // a new quantum starts whenever a process is picked, even if it is the one yielding
+    auto quantum = next->priority.quantum.current;
+    if (quantum == 0 || next == cpu.idle) next->quantumend = 0;
+    else next->quantumend = TimeManager::get().microsUptime() + quantum * gQuantumMicros;
+    armTimer(next);
+
+    ctxswitch(next);
+
+    if (irq) enableirq();
 }
 
 kpid_t ProcessManager::initpid() {
     return gInitTask->pid;
 }
-kpid_t schedulerpid() {
-    return gSchedulerTask->pid;
-}
 
 void ProcessManager::ready(process_t* task, void* waitable) {
     if (task->state == process_t::State::AVAILABLE) {
@@ -738,35 +985,80 @@ void ProcessManager::wake(process_t* task) {
     }
 }
 
+// a process stays with the CPU it last ran on, where its working set may still be cached,
+// unless some other CPU has a clearly shorter ready queue
+static cpu_t& pickCPU(process_t* task) {
+    auto& cpus(CPUs::get());
+    cpu_t* best = nullptr;
+    size_t bestsize = 0;
+    for (auto i = 0u; i < cpus.count(); ++i) {
+        auto& cpu(cpus.cpu(i));
+        if (!cpu.online) continue;
+        auto size = ProcessManager::gReadyQueue(i).size();
+        if (best == nullptr || size < bestsize) {
+            best = &cpu;
+            bestsize = size;
+        }
+    }
+
+    auto& last(cpus.cpu(task->cpu));
+    if (last.online && ProcessManager::gReadyQueue(last.index).size() <= bestsize + 1) return last;
+    return *best;
+}
+
 void ProcessManager::reschedule(process_t* task) {
     task->waitToken += 1;
     task->state = process_t::State::AVAILABLE;
-    gReadyQueue().push_back(task);
+    if (gReadyQueue(task->cpu).contains(task)) return;
+
+    auto& cpu(pickCPU(task));
+    task->cpu = cpu.index;
+    gReadyQueue(cpu.index).push(task);
+    if (cpu.current == cpu.idle) CPUs::get().reschedule(cpu);
 }
 
-void ProcessManager::deschedule(process_t* task, process_t::State newstate, void* waitable) {
-    int numfound = 0;
-
-    auto&& rq(gReadyQueue());
-    auto b = rq.begin(), e = rq.end();
-    while(b != e) {
-        if (*b == task) {
-            ++numfound;
-            (*b)->state = newstate;
-            (*b)->wakeReason.waitable = waitable;
-            rq.erase(b);
-            b = rq.begin();
-            e = rq.end();
-        } else {
-            ++b;
+// a CPU about to go idle takes a process that is ready, but not running, from the longest ready queue it can find
+bool ProcessManager::steal(cpu_t& thief) {
+    auto& cpus(CPUs::get());
+    process_t* loot = nullptr;
+    size_t lootsize = 0;
+    for (auto i = 0u; i < cpus.count(); ++i) {
+        auto& victim(cpus.cpu(i));
+        if (&victim == &thief || !victim.online) continue;
+        auto& rq(gReadyQueue(i));
+        if (rq.size() <= lootsize) continue;
+        auto candidate = rq.findFirst([&victim] (const process_t* p) -> bool {
+            return p != victim.current;
+        });
+        if (candidate) {
+            loot = candidate;
+            lootsize = rq.size();
         }
     }
 
-    if (numfound > 1) {
-        PANIC("process enqueued for execution multiple times");
+    if (loot == nullptr) return false;
+
+    TAG_DEBUG(SCHEDULER, "CPU %u stealing process %u from CPU %u", thief.index, loot->pid, loot->cpu);
+    gReadyQueue(loot->cpu).remove(loot);
+    loot->cpu = thief.index;
+    gReadyQueue(thief.index).push(loot);
+    ++thief.stats.steals;
+    return true;
+}
+
+void ProcessManager::deschedule(process_t* task, process_t::State newstate, void* waitable) {
+    auto&& rq(gReadyQueue(task->cpu));
+    if (rq.contains(task)) {
+        task->state = newstate;
+        task->wakeReason.waitable = waitable;
+        rq.remove(task);
     }
 }
 
+void ProcessManager::reprioritize(process_t* task) {
+    gReadyQueue(task->cpu).update(task);
+}
+
 void ProcessManager::enqueueForDeath(process_t* task) {
     if (task->state != process_t::State::EXITED) {
         PANIC("only EXITED processes can go on exited list");
@@ -777,11 +1069,13 @@ void ProcessManager::enqueueForDeath(process_t* task) {
 
 bool ProcessManager::collectany(bool wait, kpid_t* pid, process_exit_status_t* status) {
     do {
-        auto c0 = gCurrentProcess->children.begin();
-        auto ce = gCurrentProcess->children.end();
+        auto c0 = gCurrentProcess->leader->children.begin();
+        auto ce = gCurrentProcess->leader->children.end();
 
         for (; c0 != ce; ++c0) {
             auto child = *c0;
+            // threads are joined by pid, never reaped by a wait for any child
+            if (child->leader != child) continue;
             if (child->state == process_t::State::EXITED) {
                 *status = collect(*pid = child->pid);
                 LOG_DEBUG("process %u collectany'd by parent %u", *pid, gCurrentProcess->pid);
@@ -811,7 +1105,7 @@ begin:
 
     auto parent = getprocess(task->ppid);
 
-    if (parent != gCurrentProcess) {
+    if (parent != gCurrentProcess->leader) {
         // TODO: make this a fatal process error
         PANIC("cannot collect another process' child - that's creepy");
     }
@@ -855,6 +1149,9 @@ begin:
 process_t* ProcessManager::cloneProcess(uintptr_t eip, exec_fileop_t* fops) {
     auto&& vm(VirtualPageManager::get());
 
+    // both processes fault shared memory back in from the object it belongs to
+    gCurrentProcess->getMemoryManager()->releaseSharedPages();
+
     spawninfo_t si {
         cr3 : vm.cloneAddressSpace(),
         eip : (uintptr_t)clone_start,
@@ -879,24 +1176,46 @@ process_t* ProcessManager::cloneProcess(uintptr_t eip, exec_fileop_t* fops) {
     return spawn(si);
 }
 
-uint64_t ProcessManager::fillGDT(process_t* process) {
-    auto dtbl = addr_gdt<uint64_t*>();
+process_t* ProcessManager::cloneThread(uintptr_t eip, uintptr_t arg) {
+    auto leader = gCurrentProcess->leader;
+    if (leader->flags.exiting) return nullptr;
 
-    process->gdtidx = gGDTBitmap().next();
-
-    dtbl[process->gdtidx] = sizeof(process_t) & 0xFFFF;
-    dtbl[process->gdtidx] |= (((uint64_t)process) & 0xFFFFFFULL) << 16;
-    dtbl[process->gdtidx] |= 0xE90000000000ULL;
-    dtbl[process->gdtidx] |= (((uint64_t)process) & 0xFF000000ULL) << 32;
+    spawninfo_t si {
+        cr3 : leader->ctx.cr3,
+        eip : (uintptr_t)thread_start,
+        max_priority : exec_priority_t {
+            quantum : gCurrentProcess->priority.quantum.max,
+            scheduling : gCurrentProcess->priority.scheduling.max,
+        },
+        current_priority : exec_priority_t {
+            quantum : gCurrentProcess->priority.quantum.current,
+            scheduling : gCurrentProcess->priority.scheduling.current,
+        },
+        argument : eip,
+        environment : nullptr,
+        name : gCurrentProcess->path,
+        cwd : gCurrentProcess->cwd,
+        fileops : nullptr,
+        schedulable : false,
+        system : gCurrentProcess->flags.system,
+        clone : false,
+        thread : true
+    };
 
-    return dtbl[process->gdtidx];
+    auto thread = spawn(si);
+    if (thread) {
+        // thread_start() reads the argument, so it must be in place before the thread can run
+        thread->thread.arg = arg;
+        reschedule(thread);
+    }
+    return thread;
 }
 
 void ProcessManager::forwardTTY(process_t* process) {
     size_t ttyfd0=3, ttyfd1=3, ttyfd2=3;
-    bool ok0 = process->fds.set({nullptr, &process->ttyinfo.ttyfile}, ttyfd0);
-    bool ok1 = process->fds.set({nullptr, &process->ttyinfo.ttyfile}, ttyfd1);
-    bool ok2 = process->fds.set({nullptr, &process->ttyinfo.ttyfile}, ttyfd2);
+    bool ok0 = process->fds->set({nullptr, &process->ttyinfo.ttyfile}, ttyfd0);
+    bool ok1 = process->fds->set({nullptr, &process->ttyinfo.ttyfile}, ttyfd1);
+    bool ok2 = process->fds->set({nullptr, &process->ttyinfo.ttyfile}, ttyfd2);
     if ((ok0 && 0 == ttyfd0) && (ok1 && 1 == ttyfd1) && (ok2 && 2 == ttyfd2)) {
         LOG_DEBUG("TTY setup complete - tty is 0x%p ttyfile is 0x%p", process->ttyinfo.tty, &process->ttyinfo.ttyfile);
     } else {
@@ -911,26 +1230,26 @@ void ProcessManager::execFileops(process_t* parent, process_t* child, exec_fileo
             case exec_fileop_t::operation::CLOSE_CHILD_FD: {
                 auto child_fd = fops->param1;
                 VFS::filehandle_t child_handle = {nullptr, nullptr};
-                bool ok = child->fds.is(child_fd, &child_handle);
+                bool ok = child->fds->is(child_fd, &child_handle);
                 if (ok) {
                     if (child_handle) {
                         child_handle.close();
                     }
                 }
-                child->fds.clear(child_fd);
+                child->fds->clear(child_fd);
                 TAG_DEBUG(FILEOPS, "closed handle %u in child process %u", child_fd, child->pid);
             }
                 break;
             case exec_fileop_t::operation::DUP_PARENT_FD: {
                 auto parent_fd = fops->param1;
                 VFS::filehandle_t parent_handle = {nullptr, nullptr};
-                bool ok = parent->fds.is(parent_fd, &parent_handle);
+                bool ok = parent->fds->is(parent_fd, &parent_handle);
                 if (!ok) {
                     TAG_ERROR(FILEOPS, "file handle %u in parent process %u is not available; can't duplicate", parent_fd, parent->pid);
                 } else {
                     if (parent_handle.object) {
                         parent_handle.object->incref();
-                        ok = child->fds.set(parent_handle, fops->param2);
+                        ok = child->fds->set(parent_handle, fops->param2);
                         if (!ok) {
                             TAG_ERROR(FILEOPS, "failed to duplicate handle %u from process %u in child process %u",
                                 parent_fd, parent->pid, child->pid);
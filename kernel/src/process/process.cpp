@@ -16,11 +16,17 @@
 #include <kernel/libc/string.h>
 #include <kernel/i386/primitives.h>
 
-process_t::process_t() : tss(), args(nullptr), environ(nullptr), mmap(this), ttyinfo(), exitstatus(0), children() {
+process_t::process_t() : ctx(), args(nullptr), environ(nullptr), mmap(this), ttyinfo(), exitstatus(0), children() {
     pid = ppid = 0;
     state = State::NEW;
     sleeptill = 0;
-    priority = {usedticks = 0,0};
+    quantumend = 0;
+    cpu = 0;
+    heldlocks = 0;
+    fds = &filetable;
+    leader = this;
+    bzero(&this->thread, sizeof(this->thread));
+    bzero(&this->sysring, sizeof(this->sysring));
     args = nullptr;
     path = nullptr;
     cwd = strdup("/");
@@ -31,6 +37,7 @@ process_t::process_t() : tss(), args(nullptr), environ(nullptr), mmap(this), tty
     bzero(&this->iostats, sizeof(this->iostats));
     bzero(&this->runtimestats, sizeof(this->runtimestats));
     bzero(&this->priority, sizeof(this->priority));
+    bzero(&this->ready, sizeof(this->ready));
 
     wakeReason.clear();
 }
@@ -52,13 +59,10 @@ process_t::ttyinfo_t& process_t::ttyinfo_t::operator=(const ttyinfo_t& info) {
 process_t::ttyinfo_t::~ttyinfo_t() = default;
 
 MemoryManager* process_t::getMemoryManager() {
-    return &mmap;
+    return &leader->mmap;
 }
 
 void process_t::clone(process_t* other) {
-    other->tss = tss;
-    other->cr0 = cr0;
-
     other->path = strdup(path);
     copyArguments((const char**)other->args, false);
     other->cwd = strdup(cwd);
@@ -68,9 +72,9 @@ void process_t::clone(process_t* other) {
     other->state = process_t::State::NEW;
     other->sleeptill = 0;
     other->priority = priority;
-    other->usedticks = 0;
+    other->quantumend = 0;
 
-    mmap.clone(&other->mmap);
+    getMemoryManager()->clone(&other->mmap);
     // tty is cloned in ProcessManager
 
     fpsave((uintptr_t)&fpstate[0]);
@@ -78,9 +82,12 @@ void process_t::clone(process_t* other) {
 
     other->flags.system = flags.system;
 
-    other->memstats.allocated = memstats.allocated;
     other->memstats.allocated = 0;
     other->memstats.pagefaults = 0;
+    other->memstats.demandfaults = 0;
+    other->memstats.faultaround = 0;
+    // the child maps the same page cache pages as the parent
+    other->memstats.sharedpages = memstats.sharedpages;
 
     other->iostats.read = other->iostats.written = 0;
 
@@ -38,7 +38,7 @@ static size_t numStringsInArray(char** array) {
     return i;
 }
 
-extern "C" process_loadinfo_t shebang_do_load(uintptr_t load0, size_t) {
+extern "C" process_loadinfo_t shebang_do_load(uintptr_t load0, VFS::filehandle_t, size_t) {
     const char* txt = (const char*)load0;
     const char* bangspec = &txt[2];
     const char* space = strchr(bangspec, ' ');
@@ -0,0 +1,45 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/process/threadstart.h>
+#include <kernel/log/log.h>
+#include <kernel/process/current.h>
+#include <kernel/mm/memmgr.h>
+#include <kernel/i386/primitives.h>
+#include <kernel/synch/biglock.h>
+
+extern "C"
+void thread_start(uintptr_t eip) {
+    auto self = gCurrentProcess;
+    LOG_INFO("thread %u of process %u is starting at 0x%p", self->pid, self->leader->pid, eip);
+    auto&& memmgr(self->getMemoryManager());
+
+    auto stackpermission = VirtualPageManager::map_options_t::userspace().clear(true);
+    auto stackregion = memmgr->findAndZeroPageRegion(process_t::gDefaultThreadStackSize, stackpermission);
+    self->thread.stack = stackregion.from;
+    LOG_INFO("stack is begin = 0x%p, end = 0x%p", stackregion.to, stackregion.from);
+
+    // enter the thread function as if it had been called with one argument; the return address is 0,
+    // so returning instead of exiting the thread faults rather than running off into the weeds
+    uint32_t* esp = (uint32_t*)((stackregion.to + 1) - 16);
+    esp[0] = 0;
+    esp[1] = self->thread.arg;
+
+    // a thread starts out with clean FPU state, not a copy of its creator's
+    cleartaskswitchflag();
+    fpinit();
+
+    BigKernelLock::get().unlock();
+    toring3(eip, (uintptr_t)esp);
+}
@@ -0,0 +1,55 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/synch/biglock.h>
+#include <kernel/process/cpu.h>
+#include <kernel/panic/panic.h>
+
+BigKernelLock& BigKernelLock::get() {
+    static BigKernelLock gLock;
+
+    return gLock;
+}
+
+BigKernelLock::BigKernelLock() : mOwner(0) {}
+
+bool BigKernelLock::held() const {
+    return mOwner == CPUs::currentIndex() + 1;
+}
+
+void BigKernelLock::lock() {
+    const uint32_t self = CPUs::currentIndex() + 1;
+    if (mOwner == self) {
+        PANIC("big kernel lock is not recursive");
+    }
+
+    if (!__sync_bool_compare_and_swap(&mOwner, 0, self)) {
+        auto& cpus(CPUs::get());
+        do {
+            // the holder may be waiting on this CPU to drop a TLB entry, and this CPU may well
+            // have IRQs disabled, so the request has to be served right here
+            cpus.serviceShootdown();
+            __asm__ volatile("pause");
+        } while (!__sync_bool_compare_and_swap(&mOwner, 0, self));
+    }
+    __sync_synchronize();
+}
+
+void BigKernelLock::unlock() {
+    if (!held()) {
+        PANIC("big kernel lock released by a CPU that does not hold it");
+    }
+    __sync_synchronize();
+    mOwner = 0;
+}
@@ -36,6 +36,7 @@ const char* Event::key() {
 void Event::raise(bool level) {
     if (level) mRaised = true;
     waitqueue()->wakeall();
+    notify();
 }
 void Event::lower() {
     mRaised = false;
@@ -45,6 +46,11 @@ bool Event::raised() const {
     return mRaised;
 }
 
+uint32_t Event::ready() {
+    if (mRaised) return POLL_IN;
+    return 0;
+}
+
 bool Event::wait(uint32_t timeout) {
     bool wait = true;
     while(true) {
@@ -0,0 +1,83 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/synch/futex.h>
+#include <kernel/mm/virt.h>
+#include <kernel/process/current.h>
+#include <kernel/process/manager.h>
+#include <kernel/process/process.h>
+#include <kernel/log/log.h>
+
+LOG_TAG(FUTEX, 2);
+
+Futexes& Futexes::get() {
+    static Futexes gFutexes;
+
+    return gFutexes;
+}
+
+Futexes::Futexes() : mFutexes(), mActive(0) {}
+
+// a word on a page that is still the shared zero page, or copy-on-write, would change its physical
+// address on the first write; an atomic add of zero is a write, so it settles the page for good
+uintptr_t Futexes::key(uint32_t* word) {
+    __atomic_fetch_add(word, 0, __ATOMIC_SEQ_CST);
+    return VirtualPageManager::get().mapping((uintptr_t)word);
+}
+
+Futexes::wait_result_t Futexes::wait(uint32_t* word, uint32_t expected, uint32_t timeout) {
+    auto k = key(word);
+    // nothing can wake this word between here and the yield, as waking needs the kernel too
+    if (__atomic_load_n(word, __ATOMIC_SEQ_CST) != expected) return wait_result_t::changed;
+
+    futex_t* futex = nullptr;
+    if (!mFutexes.find(k, &futex)) {
+        futex = new futex_t();
+        futex->key = k;
+        mFutexes.insert(k, futex);
+        ++mActive;
+    }
+
+    ++futex->waiters;
+    TAG_DEBUG(FUTEX, "process %u waiting on word 0x%p (key 0x%p)", gCurrentProcess->pid, word, k);
+    futex->wq.yield(gCurrentProcess, timeout);
+    --futex->waiters;
+
+    const bool woken = (gCurrentProcess->wakeReason.waitable == &futex->wq);
+    if (!woken) futex->wq.remove(gCurrentProcess);
+
+    if (futex->waiters == 0) {
+        mFutexes.erase(k);
+        --mActive;
+        delete futex;
+    }
+
+    return woken ? wait_result_t::woken : wait_result_t::timeout;
+}
+
+uint32_t Futexes::wake(uint32_t* word, uint32_t count) {
+    auto k = key(word);
+
+    futex_t* futex = nullptr;
+    if (!mFutexes.find(k, &futex)) return 0;
+
+    uint32_t n = 0;
+    while (n < count && futex->wq.wakeone()) ++n;
+    TAG_DEBUG(FUTEX, "process %u woke %u waiters on word 0x%p (key 0x%p)", gCurrentProcess->pid, n, word, k);
+    return n;
+}
+
+size_t Futexes::active() const {
+    return mActive;
+}
@@ -20,6 +20,7 @@
 #include <kernel/time/manager.h>
 #include <kernel/libc/string.h>
 #include <kernel/libc/memory.h>
+#include <kernel/mm/phys.h>
 #include <kernel/syscalls/types.h>
 
 LOG_TAG(MQ, 1);
@@ -55,6 +56,13 @@ size_t MessageQueueBuffer::size() const {
 }
 
 MessageQueueBuffer::~MessageQueueBuffer() {
+    // pages in flight were pinned by their senders, and nobody is left to receive them
+    for (auto i = mReadPointer, n = mTotalSize - mFreeSize; n > 0; --n) {
+        const auto& header(mBuffer[i].header);
+        if (header.flags & message_t::gPageTransfer) PhysicalPageManager::get().dealloc(header.page);
+        if (++i == mTotalSize) i = 0;
+    }
+
     auto& vmm(VirtualPageManager::get());
     vmm.delKernelRegion(mBufferRgn);
 
@@ -79,30 +87,67 @@ void MessageQueueBuffer::openReader() {
 
 void MessageQueueBuffer::closeWriter() {
     if (mNumWriters > 0) --mNumWriters;
+    notify();
 }
 void MessageQueueBuffer::closeReader() {
     if (mNumReaders > 0) -- mNumReaders;
+    notify();
+}
+
+uint32_t MessageQueueBuffer::ready() {
+    uint32_t events = 0;
+    if (mFreeSize < mTotalSize) events |= POLL_IN;
+    if (mFreeSize > 0) events |= POLL_OUT;
+    // a read with no writers left does not wait for one; writes are kept for a reader still to come
+    if (mNumWriters == 0) events |= POLL_HUP;
+    return events;
+}
+
+static message_t::header_t newHeader(size_t n, uint32_t flags, uintptr_t page) {
+    message_t::header_t header;
+    header.sender = gCurrentProcess->pid;
+    header.timestamp = TimeManager::get().UNIXtime();
+    header.payload_size = n;
+    header.flags = flags;
+    header.page = page;
+    return header;
 }
 
-bool MessageQueueBuffer::tryWrite(const message_t& msg) {
-    TAG_DEBUG(MQ, "writing message from %u of size %u into mq 0x%p", msg.header.sender, msg.header.payload_size, this);
-    if (mFreeSize == 0) return false;
+void MessageQueueBuffer::push(const message_t::header_t& header, const void* payload) {
+    TAG_DEBUG(MQ, "writing message from %u of size %u into mq 0x%p", header.sender, header.payload_size, this);
 
-    mBuffer[mWritePointer] = msg;
+    // only as much of the slot as the message needs is written, rather than all of a message_t
+    auto& slot(mBuffer[mWritePointer]);
+    slot.header = header;
+    if (payload) memcpy(slot.payload, payload, header.payload_size);
     if (++mWritePointer == mTotalSize) mWritePointer = 0;
     --mFreeSize;
-    return true;
+    notify();
 }
 bool MessageQueueBuffer::tryRead(message_t* msg) {
     if (mFreeSize == mTotalSize) return false;
 
-    *msg = mBuffer[mReadPointer];
+    const auto& slot(mBuffer[mReadPointer]);
+    msg->header = slot.header;
+    if (slot.header.flags & message_t::gPageTransfer) {
+        msg->header.page = receive(slot.header.page);
+    } else {
+        memcpy(msg->payload, slot.payload, slot.header.payload_size);
+    }
     TAG_DEBUG(MQ, "read message from %u of size %u from mq 0x%p", msg->header.sender, msg->header.payload_size, this);
     if (++mReadPointer == mTotalSize) mReadPointer = 0;
     ++mFreeSize;
     return true;
 }
 
+bool MessageQueueBuffer::waitForSpace(bool allowBlock) {
+    while (0 == mFreeSize) {
+        if (allowBlock) mFullWQ.yield(gCurrentProcess, 0);
+        else return false;
+    }
+    return true;
+}
+
 size_t MessageQueueBuffer::read(size_t n, char* dest, bool allowBlock) {
     if (n != sizeof(message_t)) {
         TAG_ERROR(MQ, "read of size %u not valid", n);
@@ -118,7 +163,8 @@ size_t MessageQueueBuffer::read(size_t n, char* dest, bool allowBlock) {
 
     const bool ok = tryRead((message_t*)dest);
     if (ok) {
-        mFullWQ.wakeall();
+        mFullWQ.wakeone();
+        notify();
         return n;
     } else return 0;
 }
@@ -128,24 +174,94 @@ size_t MessageQueueBuffer::write(size_t n, char* src, bool allowBlock) {
         return 0;
     }
 
-    message_t msg;
-    auto&& tmgr(TimeManager::get());
+    if (!waitForSpace(allowBlock)) return 0;
 
-    msg.header.sender = gCurrentProcess->pid;
-    msg.header.timestamp = tmgr.UNIXtime();
-    msg.header.payload_size = n;
-    memcpy(msg.payload, src, n);
+    push(newHeader(n, 0, 0), src);
 
-    while (0 == mFreeSize) {
-        if (allowBlock) mFullWQ.yield(gCurrentProcess, 0);
-        else return 0;
+    // one message is one reader's worth of work
+    mEmptyWQ.wakeone();
+    return n;
+}
+
+uintptr_t MessageQueueBuffer::transferable(uintptr_t address, MemoryManager::region_t* rgn) {
+    if (VirtualPageManager::offset(address) || VirtualPageManager::iskernel(address)) return 0;
+
+    // a page of a file mapping, or one shared copy-on-write, is not the sender's alone to give away
+    if (!gCurrentProcess->getMemoryManager()->isWithinRegion(address, rgn)) return 0;
+    if (rgn->isMmapRegion()) return 0;
+
+    auto& vmm(VirtualPageManager::get());
+    VirtualPageManager::map_options_t opts;
+    if (!vmm.mapped(address, &opts)) return 0;
+    if (!opts.user() || !opts.rw() || opts.cow() || !opts.frompmm()) return 0;
+
+    return vmm.mapping(address);
+}
+
+uintptr_t MessageQueueBuffer::receive(uintptr_t phys) {
+    auto opts = VirtualPageManager::map_options_t::userspace();
+    auto rgn = gCurrentProcess->getMemoryManager()->findAndZeroPageRegion(VirtualPageManager::gPageSize, opts);
+    if (rgn.from == 0) {
+        TAG_ERROR(MQ, "process %u has no room for a transferred page", gCurrentProcess->pid);
+        PhysicalPageManager::get().dealloc(phys);
+        return 0;
     }
 
-    const bool ok = tryWrite(msg);
-    if (ok) {
-        mEmptyWQ.wakeall();
-        return n;
-    } else return 0;
+    // the sender's reference to the page becomes this mapping's; map() warns about userspace pages
+    // that are not cleared, which this one must not be, so make it visible to userspace afterwards
+    auto& vmm(VirtualPageManager::get());
+    vmm.map(phys, rgn.from, VirtualPageManager::map_options_t::kernel().frompmm(true));
+    vmm.newoptions(rgn.from, opts.frompmm(true));
+    return rgn.from;
+}
+
+msgqueue_send_t::path_t MessageQueueBuffer::send(const void* data, size_t n, bool allowBlock) {
+    if (n > message_t::gBodySize && n != VirtualPageManager::gPageSize) return msgqueue_send_t::path_t::failed;
+
+    // wait first, so that a send that does not happen leaves the page where it was
+    if (!waitForSpace(allowBlock)) return msgqueue_send_t::path_t::failed;
+
+    auto& pmm(PhysicalPageManager::get());
+    auto& vmm(VirtualPageManager::get());
+
+    // only decided after waiting, since while this process slept another thread could have unmapped
+    // the page, or a clone could have made it copy-on-write
+    MemoryManager::region_t rgn;
+    uintptr_t phys = 0;
+    if (n == VirtualPageManager::gPageSize) phys = transferable((uintptr_t)data, &rgn);
+    if (phys != 0) {
+        // like mapOtherProcessPage(), hold on to the physical page with a reference of its own; the receiver
+        // is not known until it reads the message, and the sender may well be gone by then
+        pmm.alloc(phys);
+        vmm.unmap((uintptr_t)data);
+        vmm.mapZeroPage((uintptr_t)data, rgn.permission);
+
+        push(newHeader(n, message_t::gPageTransfer, phys), nullptr);
+        mEmptyWQ.wakeone();
+        return msgqueue_send_t::path_t::transferred;
+    }
+
+    if (n <= message_t::gBodySize) {
+        push(newHeader(n, 0, 0), data);
+        mEmptyWQ.wakeone();
+        return msgqueue_send_t::path_t::copied;
+    }
+
+    // a page that can't be given away does not fit in a message either; copy it to a page of its own,
+    // which then moves to the reader the same way
+    if (!pmm.alloc().result(&phys)) return msgqueue_send_t::path_t::failed;
+    {
+        auto sp = vmm.getScratchPage(phys, VirtualPageManager::map_options_t::kernel());
+        memcpy(sp.get<char>(), data, n);
+    }
+    // reading the sender's memory may have faulted in a page from disk, and let others at the queue
+    if (!waitForSpace(allowBlock)) {
+        pmm.dealloc(phys);
+        return msgqueue_send_t::path_t::failed;
+    }
+    push(newHeader(n, message_t::gPageTransfer, phys), nullptr);
+    mEmptyWQ.wakeone();
+    return msgqueue_send_t::path_t::copied;
 }
 
 MessageQueueFile::MessageQueueFile(MessageQueueBuffer* buf) : mBuffer(buf) {
@@ -196,6 +312,14 @@ size_t MessageQueueWriteFile::write(size_t n, char* dest) {
     return mBuffer->write(n, dest, mBlockIfFull);
 }
 
+uint32_t MessageQueueReadFile::ready() {
+    return mBuffer->ready() & (POLL_IN | POLL_HUP);
+}
+
+uint32_t MessageQueueWriteFile::ready() {
+    return mBuffer->ready() & POLL_OUT;
+}
+
 uintptr_t MessageQueueReadFile::ioctl(uintptr_t a, uintptr_t b) {
     if (a == (uintptr_t)msgqueue_ioctl_t::IOCTL_BLOCK_ON_EMPTY) {
         mBlockIfEmpty = (b != 0);
@@ -208,6 +332,11 @@ uintptr_t MessageQueueWriteFile::ioctl(uintptr_t a, uintptr_t b) {
         mBlockIfFull = (b != 0);
         return 1;
     }
+    if (a == (uintptr_t)msgqueue_ioctl_t::IOCTL_SEND_MESSAGE) {
+        auto msg = (msgqueue_send_t*)b;
+        msg->path = mBuffer->send(msg->data, msg->size, mBlockIfFull);
+        return (msg->path == msgqueue_send_t::path_t::failed) ? 0 : 1;
+    }
     return this->MessageQueueFile::ioctl(a,b);
 }
 
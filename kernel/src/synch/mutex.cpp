@@ -74,5 +74,11 @@ void Mutex::unlock() {
         mLocked = false;
         LOG_DEBUG("process %u unlocked this mutex", mPid);
         waitqueue()->wakeall();
+        notify();
     }
 }
+
+uint32_t Mutex::ready() {
+    if (mLocked) return 0;
+    return POLL_IN;
+}
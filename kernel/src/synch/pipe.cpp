@@ -15,17 +15,34 @@
 #include <kernel/synch/pipe.h>
 #include <kernel/process/manager.h>
 #include <kernel/panic/panic.h>
-
-PipeBuffer::PipeBuffer() {
-    bzero(&mBuffer[0], gBufferSize);
+#include <kernel/libc/math.h>
+#include <kernel/libc/memory.h>
+#include <kernel/libc/string.h>
+
+PipeBuffer::PipeBuffer(size_t capacity) {
+    if (capacity == 0) capacity = gBufferSize;
+    if (capacity > gMaxBufferSize) capacity = gMaxBufferSize;
+    mCapacity = (capacity + gBufferSize - 1) / gBufferSize * gBufferSize;
+    // nothing is ever read before it is written, so there is no need to clear the buffer
+    mBuffer = (char*)malloc(mCapacity);
     mReadPointer = mWritePointer = 0;
     mReadFileOpen = mWriteFileOpen = true;
-    mFreeSpace = gBufferSize;
+    mFreeSpace = mCapacity;
+    mLowWatermark = mCapacity / 4;
+}
+
+PipeBuffer::~PipeBuffer() {
+    free(mBuffer);
+}
+
+size_t PipeBuffer::capacity() const {
+    return mCapacity;
 }
 
 void PipeBuffer::closeReadFile() {
     mReadFileOpen = false;
     mFullWQ.wakeall(); // if anyone is waiting to write, let them try...
+    notify();
 }
 bool PipeBuffer::isReadFileOpen() const {
     return mReadFileOpen;
@@ -34,42 +51,33 @@ bool PipeBuffer::isReadFileOpen() const {
 void PipeBuffer::closeWriteFile() {
     mWriteFileOpen = false;
     mEmptyWQ.wakeall(); // if anyone is trying to read, let them try...
+    notify();
 }
 bool PipeBuffer::isWriteFileOpen() const {
     return mWriteFileOpen;
 }
 
-bool PipeBuffer::tryPutchar(char c) {
-    if (mFreeSpace == 0) return false;
-
-    mBuffer[mWritePointer] = c;
-    if (++mWritePointer == gBufferSize) mWritePointer = 0;
-    --mFreeSpace;
-    return true;
-}
-
-bool PipeBuffer::tryGetchar(char& c) {
-    if (mFreeSpace == gBufferSize) return false;
-
-    c = mBuffer[mReadPointer];
-    if (++mReadPointer == gBufferSize) mReadPointer = 0;
-    ++mFreeSpace;
-    return true;
-}
-
 size_t PipeBuffer::read(size_t n, char* data) {
-    while (gBufferSize == mFreeSpace) {
+    while (mCapacity == mFreeSpace) {
         // no point on waiting on a writer that is gone
         if (!isWriteFileOpen()) break;
         mEmptyWQ.yield(gCurrentProcess, 0);
     }
 
-    size_t count = 0;
-    while(count < n && tryGetchar(*data)) {
-        ++count; ++data;
-    }
+    const size_t count = min(n, mCapacity - mFreeSpace);
+    if (count == 0) return 0;
+
+    const size_t first = min(count, mCapacity - mReadPointer);
+    memcpy(data, &mBuffer[mReadPointer], first);
+    memcpy(data + first, &mBuffer[0], count - first);
+    mReadPointer = (mReadPointer + count) % mCapacity;
+    mFreeSpace += count;
 
-    if (count > 0) mFullWQ.wakeall(); // if anyone was waiting to write - space is free, go ahead!
+    // one writer is enough to use the space, as long as there is enough of it to be worth the switch;
+    // if this reader left data behind, another reader can take it without waiting for a new write
+    if (mFreeSpace >= mLowWatermark || mFreeSpace == mCapacity) mFullWQ.wakeone();
+    if (mFreeSpace < mCapacity) mEmptyWQ.wakeone();
+    notify();
 
     return count;
 }
@@ -81,16 +89,32 @@ size_t PipeBuffer::write(size_t n, char* data) {
         mFullWQ.yield(gCurrentProcess, 0);
     }
 
-    size_t count = 0;
-    while(count < n && tryPutchar(*data)) {
-        ++count; ++data;
-    }
+    const size_t count = min(n, mFreeSpace);
+    if (count == 0) return 0;
 
-    if (count > 0) mEmptyWQ.wakeall(); // if anyone was waiting to read - space is free, go ahead!
+    const size_t first = min(count, mCapacity - mWritePointer);
+    memcpy(&mBuffer[mWritePointer], data, first);
+    memcpy(&mBuffer[0], data + first, count - first);
+    mWritePointer = (mWritePointer + count) % mCapacity;
+    mFreeSpace -= count;
+
+    mEmptyWQ.wakeone();
+    // space left over after this write is for the next writer in line
+    if (mFreeSpace >= mLowWatermark) mFullWQ.wakeone();
+    notify();
 
     return count;
 }
 
+uint32_t PipeBuffer::ready() {
+    uint32_t events = 0;
+    if (mFreeSpace < mCapacity) events |= POLL_IN;
+    if (mFreeSpace > 0) events |= POLL_OUT;
+    if (!mWriteFileOpen) events |= POLL_HUP;
+    if (!mReadFileOpen) events |= POLL_ERR;
+    return events;
+}
+
 PipeManager* PipeManager::get() {
     static PipeManager gManager;
 
@@ -140,10 +164,18 @@ size_t PipeManager::WriteFile::write(size_t n, char* d) {
     return mBuffer->write(n, d);
 }
 
-pair<PipeManager::ReadFile*, PipeManager::WriteFile*> PipeManager::pipe() {
+uint32_t PipeManager::ReadFile::ready() {
+    return mBuffer->ready() & (POLL_IN | POLL_HUP);
+}
+
+uint32_t PipeManager::WriteFile::ready() {
+    return mBuffer->ready() & (POLL_OUT | POLL_ERR);
+}
+
+pair<PipeManager::ReadFile*, PipeManager::WriteFile*> PipeManager::pipe(size_t capacity) {
     pair<PipeManager::ReadFile*, PipeManager::WriteFile*> result;
 
-    PipeBuffer *buffer = new PipeBuffer();
+    PipeBuffer *buffer = new PipeBuffer(capacity);
     result.first = new PipeManager::ReadFile(buffer);
     result.second = new PipeManager::WriteFile(buffer);
 
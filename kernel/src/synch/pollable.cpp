@@ -0,0 +1,38 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/synch/pollable.h>
+
+Pollable::Pollable() : mWatchers(), mPollWQ() {}
+
+Pollable::~Pollable() = default;
+
+WaitQueue* Pollable::pollqueue() {
+    return &mPollWQ;
+}
+
+void Pollable::watch(PollWatcher* watcher, uintptr_t cookie) {
+    mWatchers.add({watcher, cookie});
+}
+
+void Pollable::unwatch(PollWatcher* watcher, uintptr_t cookie) {
+    mWatchers.remove(watcher_t{watcher, cookie});
+}
+
+void Pollable::notify() {
+    mPollWQ.wakeall();
+    for (auto& w : mWatchers) {
+        w.watcher->changed(w.cookie);
+    }
+}
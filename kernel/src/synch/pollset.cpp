@@ -0,0 +1,152 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/synch/pollset.h>
+#include <kernel/process/current.h>
+#include <kernel/time/manager.h>
+#include <kernel/panic/panic.h>
+
+// errors and hangups are always reported, whether they were asked for or not
+static constexpr uint32_t gAlwaysReported = POLL_ERR | POLL_HUP;
+
+PollSet::PollSet() {
+    kind(file_kind_t::pollset);
+}
+
+PollSet::~PollSet() {
+    while (!mEntries.empty()) forget(mEntries.top());
+}
+
+bool PollSet::doStat(stat_t&) { return false; }
+bool PollSet::seek(size_t) { return false; }
+bool PollSet::tell(size_t*) { return false; }
+
+size_t PollSet::read(size_t, char*) { return 0; }
+size_t PollSet::write(size_t, char*) { return 0; }
+
+PollSet::entry_t* PollSet::find(int32_t fd) {
+    for (auto entry : mEntries) {
+        if (entry->fd == fd) return entry;
+    }
+    return nullptr;
+}
+
+void PollSet::enqueue(entry_t* entry) {
+    if (entry->queued) return;
+    entry->queued = true;
+    mCandidates.add(entry);
+}
+
+void PollSet::forget(entry_t* entry) {
+    if (entry->source) entry->source->unwatch(this, (uintptr_t)entry);
+    if (entry->queued) mCandidates.remove(entry);
+    mEntries.remove(entry);
+    entry->handle.close();
+    delete entry;
+}
+
+void PollSet::changed(uintptr_t cookie) {
+    enqueue((entry_t*)cookie);
+    mWQ.wakeall();
+}
+
+bool PollSet::control(int32_t fd, uint32_t events) {
+    auto entry = find(fd);
+    if (events == 0) {
+        if (entry == nullptr) return false;
+        forget(entry);
+        return true;
+    }
+
+    if (entry) {
+        entry->events = events;
+        enqueue(entry);
+        return true;
+    }
+
+    VFS::filehandle_t handle;
+    if (fd < 0 || !gCurrentProcess->fds->is(fd, &handle) || !handle) return false;
+    auto file = handle.asFile();
+    // a poll set is never ready by itself, so watching one from another could only ever hang
+    if (file == nullptr || PollSet::classof(file)) return false;
+
+    // the set keeps the file open even if the process closes its descriptor
+    handle.object->incref();
+    entry = new entry_t{fd, events, handle, file, file->pollable(), false};
+    if (entry->source) entry->source->watch(this, (uintptr_t)entry);
+    mEntries.add(entry);
+    // whatever state the file is in now has not been seen by anyone yet
+    enqueue(entry);
+    return true;
+}
+
+size_t PollSet::wait(poll_entry_t* entries, size_t n, uint32_t timeout) {
+    auto& tmgr(TimeManager::get());
+    const uint64_t deadline = tmgr.millisUptime() + timeout;
+
+    while (true) {
+        size_t count = 0;
+        // every candidate is looked at once; ready ones stay queued, the others wait for their next change
+        for (auto i = mCandidates.count(); i > 0; --i) {
+            auto entry = mCandidates.pop();
+            uint32_t revents = 0;
+            if (count < n) {
+                revents = entry->file->ready() & (entry->events | gAlwaysReported);
+                if (revents == 0 && entry->source) {
+                    entry->queued = false;
+                    continue;
+                }
+            }
+            mCandidates.add(entry);
+            if (revents) entries[count++] = {entry->fd, entry->events, revents};
+        }
+
+        if (count > 0 || timeout == 0) return count;
+
+        if (timeout == poll_entry_t::gForever) {
+            mWQ.yield(gCurrentProcess, 0);
+        } else {
+            const uint64_t now = tmgr.millisUptime();
+            if (now >= deadline) return 0;
+            mWQ.yield(gCurrentProcess, deadline - now);
+            if (gCurrentProcess->wakeReason.waitable != &mWQ) mWQ.remove(gCurrentProcess);
+        }
+    }
+}
+
+bool PollSet::classof(const FilesystemObject* f) {
+    return (f != nullptr && f->kind() == file_kind_t::pollset);
+}
+
+PollSets* PollSets::get() {
+    static PollSets gManager;
+
+    return &gManager;
+}
+
+PollSets::PollSets() = default;
+
+PollSet* PollSets::make() {
+    auto set = new PollSet();
+    openObject();
+    return set;
+}
+
+void PollSets::doClose(FilesystemObject* object) {
+    if (!PollSet::classof(object)) {
+        PANIC("cannot close a non-pollset via PollSets");
+    }
+
+    delete (PollSet*)object;
+}
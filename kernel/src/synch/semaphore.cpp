@@ -61,6 +61,12 @@ void Semaphore::signal() {
         __atomic_store_n(&mValue, mMaxValue, __ATOMIC_SEQ_CST);
     }
     __sync_synchronize();
+    notify();
+}
+
+uint32_t Semaphore::ready() {
+    if (value() > 0) return POLL_IN;
+    return 0;
 }
 
 uint32_t Semaphore::value() const {
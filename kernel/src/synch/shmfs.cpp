@@ -0,0 +1,321 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/synch/shmfs.h>
+#include <kernel/boot/phase.h>
+#include <kernel/fs/devfs/devfs.h>
+#include <kernel/fs/memfs/memfs.h>
+#include <kernel/fs/vfs.h>
+#include <kernel/libc/math.h>
+#include <kernel/libc/memory.h>
+#include <kernel/libc/sprint.h>
+#include <kernel/libc/string.h>
+#include <kernel/log/log.h>
+#include <kernel/mm/phys.h>
+#include <kernel/mm/virt.h>
+#include <kernel/cpp/rtti.h>
+
+LOG_TAG(SHM, 1);
+
+namespace {
+    class ObjectsFile : public MemFS::File {
+        public:
+            ObjectsFile() : MemFS::File("objects") {
+                kind(file_kind_t::chardevice);
+            }
+
+            delete_ptr<MemFS::FileBuffer> content() override {
+                auto fs = ShmFS::get();
+                size_t n = fs->info(nullptr, 0);
+                shm_info_t *buffer = (shm_info_t*)calloc(n + 1, sizeof(shm_info_t));
+                n = min(n, fs->info(buffer, n));
+                return new MemFS::ExternalDataBuffer<true>((uint8_t*)buffer, n * sizeof(shm_info_t));
+            }
+    };
+}
+
+namespace boot::shmfs {
+    uint32_t init() {
+        bool ok = VFS::get().mount("shm", ShmFS::get());
+        if (ok) DevFS::get().getDeviceDirectory("shm")->add(new ObjectsFile());
+        return ok ? 0 : 0xFF;
+    }
+    bool fail(uint32_t) {
+        bootphase_t::printf("unable to mount /shm");
+        return bootphase_t::gPanic;
+    }
+}
+
+SharedMemory::SharedMemory(const char* name) : mName(name), mLinked(true), mSize(0), mPages(), mHandles(0) {}
+
+SharedMemory::~SharedMemory() {
+    resize(0);
+}
+
+const char* SharedMemory::name() const {
+    return mName.c_str();
+}
+
+bool SharedMemory::linked() const {
+    return mLinked;
+}
+
+void SharedMemory::unlink() {
+    mLinked = false;
+}
+
+size_t SharedMemory::size() const {
+    return mSize;
+}
+
+// shrinking only lets go of the object's own references; a process that has a page past the new end
+// mapped keeps it until it unmaps it, it just stops being shared with anyone else
+bool SharedMemory::resize(size_t size) {
+    if (size > gMaxSize) {
+        TAG_ERROR(SHM, "shared memory object %s cannot grow to %u bytes", name(), size);
+        return false;
+    }
+
+    auto& pmm(PhysicalPageManager::get());
+    const size_t npages = size / VirtualPageManager::gPageSize + (VirtualPageManager::offset(size) ? 1 : 0);
+
+    while (mPages.size() > npages) {
+        if (auto phys = mPages[mPages.size() - 1]) pmm.dealloc(phys);
+        mPages.pop_back();
+    }
+
+    // growing the object back must not bring back what used to be past the end of the last page
+    const size_t tail = VirtualPageManager::offset(size);
+    if (size < mSize && tail != 0 && mPages[npages - 1] != 0) {
+        auto sp = VirtualPageManager::get().getScratchPage(mPages[npages - 1], VirtualPageManager::map_options_t::kernel());
+        bzero(sp.get<uint8_t>() + tail, VirtualPageManager::gPageSize - tail);
+    }
+
+    while (mPages.size() < npages) mPages.push_back(0);
+    mSize = size;
+    return true;
+}
+
+uintptr_t SharedMemory::page(size_t offset) {
+    const size_t idx = offset / VirtualPageManager::gPageSize;
+    if (offset >= mSize || idx >= mPages.size()) return 0;
+
+    auto& slot(mPages[idx]);
+    if (slot == 0) {
+        uintptr_t phys;
+        if (!PhysicalPageManager::get().alloc().result(&phys)) {
+            TAG_ERROR(SHM, "no memory for a page of shared memory object %s", name());
+            return 0;
+        }
+        VirtualPageManager::get().getScratchPage(phys, VirtualPageManager::map_options_t::kernel().clear(true));
+        slot = phys;
+    }
+    return slot;
+}
+
+size_t SharedMemory::read(size_t offset, size_t n, char* dest) {
+    if (offset >= mSize) return 0;
+    if (n > mSize - offset) n = mSize - offset;
+
+    auto& vmm(VirtualPageManager::get());
+    size_t done = 0;
+    while (done < n) {
+        const auto inpage = VirtualPageManager::offset(offset + done);
+        const auto chunk = min(n - done, VirtualPageManager::gPageSize - inpage);
+        auto phys = page(offset + done);
+        if (phys == 0) break;
+        auto sp = vmm.getScratchPage(phys, VirtualPageManager::map_options_t::kernel());
+        memcpy(dest + done, sp.get<char>() + inpage, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+size_t SharedMemory::write(size_t offset, size_t n, const char* src) {
+    // offset + n must not wrap around to something that looks small enough
+    if (offset > gMaxSize || n > gMaxSize - offset) return 0;
+    if (offset + n > mSize && !resize(offset + n)) return 0;
+
+    auto& vmm(VirtualPageManager::get());
+    size_t done = 0;
+    while (done < n) {
+        const auto inpage = VirtualPageManager::offset(offset + done);
+        const auto chunk = min(n - done, VirtualPageManager::gPageSize - inpage);
+        auto phys = page(offset + done);
+        if (phys == 0) break;
+        auto sp = vmm.getScratchPage(phys, VirtualPageManager::map_options_t::kernel());
+        memcpy(sp.get<char>() + inpage, src + done, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+uint32_t SharedMemory::handles() const {
+    return mHandles;
+}
+
+uint32_t SharedMemory::incref() {
+    return ++mHandles;
+}
+
+uint32_t SharedMemory::decref() {
+    return --mHandles;
+}
+
+void SharedMemory::info(shm_info_t* info) {
+    auto& pmm(PhysicalPageManager::get());
+
+    sprint(info->name, sizeof(info->name), "%s", name());
+    info->linked = mLinked;
+    info->size = mSize;
+    info->pages = mPages.size();
+    info->resident = info->mappings = 0;
+    for (size_t i = 0; i < mPages.size(); ++i) {
+        if (auto phys = mPages[i]) {
+            ++info->resident;
+            // every reference but the object's own is a mapping
+            info->mappings += pmm.refcount(phys) - 1;
+        }
+    }
+    info->handles = mHandles;
+}
+
+class ShmFile : public Filesystem::File {
+public:
+    ShmFile(SharedMemory* shm) : mObject(shm), mPosition(0) {
+        kind(file_kind_t::shm);
+    }
+
+    bool doStat(stat_t& stat) override {
+        stat.kind = file_kind_t::shm;
+        stat.size = mObject->size();
+        stat.time = 0;
+        return true;
+    }
+
+    bool seek(size_t pos) override {
+        mPosition = pos;
+        return true;
+    }
+    bool tell(size_t* pos) override {
+        *pos = mPosition;
+        return true;
+    }
+    size_t read(size_t n, char* dest) override {
+        n = mObject->read(mPosition, n, dest);
+        mPosition += n;
+        return n;
+    }
+    size_t write(size_t n, char* src) override {
+        n = mObject->write(mPosition, n, src);
+        mPosition += n;
+        return n;
+    }
+
+    uintptr_t ioctl(uintptr_t a, uintptr_t b) override {
+        switch (a) {
+            case IOCTL_SHM_RESIZE:
+                return mObject->resize(b) ? 1 : 0;
+            case IOCTL_SHM_GET_SIZE:
+                return mObject->size();
+        }
+        return 0;
+    }
+
+    bool sharedMemory() const override {
+        return true;
+    }
+    uintptr_t sharedPage(size_t offset) override {
+        return mObject->page(offset);
+    }
+
+    static bool classof(const FilesystemObject* f) {
+        return (f != nullptr && f->kind() == file_kind_t::shm);
+    }
+
+    SharedMemory* object() { return mObject; }
+private:
+    SharedMemory *mObject;
+    size_t mPosition;
+};
+
+ShmFS::ShmFS() : mObjects() {}
+
+SharedMemory* ShmFS::find(const char* name) {
+    for (auto obj : mObjects) {
+        if (obj->linked() && 0 == strcmp(name, obj->name())) return obj;
+    }
+    return nullptr;
+}
+
+void ShmFS::release(SharedMemory* obj) {
+    if (obj->linked() || obj->handles() > 0) return;
+
+    LOG_INFO("shared memory object 0x%p (%s) has no more users; freeing it", obj, obj->name());
+    mObjects.remove(obj);
+    delete obj;
+}
+
+Filesystem::File* ShmFS::doOpen(const char* name, uint32_t mode) {
+    if (name == nullptr || *name == 0) return nullptr;
+
+    SharedMemory* obj = find(name);
+    if (obj == nullptr) {
+        obj = new SharedMemory(name);
+        mObjects.add(obj);
+    } else if (mode & FILE_OPEN_NEW) {
+        obj->resize(0);
+    }
+
+    obj->incref();
+    return new ShmFile(obj);
+}
+
+bool ShmFS::del(const char* name) {
+    SharedMemory* obj = find(name);
+    if (obj == nullptr) return false;
+
+    // whoever has it open or mapped keeps using it, but nobody new can find it
+    obj->unlink();
+    release(obj);
+    return true;
+}
+
+void ShmFS::doClose(FilesystemObject* file) {
+    if (file == nullptr) return;
+
+    auto sFile = rtti_cast<ShmFile>(file);
+    if (sFile == nullptr) return;
+
+    auto obj = sFile->object();
+    obj->decref();
+    release(obj);
+
+    delete sFile;
+}
+
+size_t ShmFS::info(shm_info_t* info, size_t n) {
+    size_t i = 0;
+    for (auto obj : mObjects) {
+        if (i < n) obj->info(&info[i]);
+        ++i;
+    }
+    return i;
+}
+
+ShmFS* ShmFS::get() {
+    static ShmFS gFS;
+
+    return &gFS;
+}
@@ -31,6 +31,14 @@ kernel_config_t::kernel_config_t() {
     logging.value = config_logging::gFullLogging;
     mainfs.value = nullptr;
     logsize.value = 64;
+    zeropool.low = 64;
+    zeropool.high = 256;
+    faultaround.value = 16;
+    pagecache.minfree = 256;
+    blockcache.blocks = 64;
+    blockcache.writeback = false;
+    blockcache.bypass = 16;
+    tickless.value = true;
 }
 
 namespace {
@@ -66,6 +74,26 @@ static void parseOption(kernel_config_t* kcfg, char* option) {
     } else if (matches(key, "logsize")) {
         kcfg->logsize.value = atoi(value);
         if (kcfg->logsize.value == 0) kcfg->logsize.value = 64;
+    } else if (matches(key, "zeropool_low")) {
+        kcfg->zeropool.low = atoi(value);
+    } else if (matches(key, "zeropool_high")) {
+        kcfg->zeropool.high = atoi(value);
+    } else if (matches(key, "pagecache_minfree")) {
+        kcfg->pagecache.minfree = atoi(value);
+    } else if (matches(key, "blockcache_blocks")) {
+        kcfg->blockcache.blocks = atoi(value);
+    } else if (matches(key, "blockcache_writeback")) {
+        kcfg->blockcache.writeback = (0 != atoi(value));
+    } else if (matches(key, "blockcache_bypass")) {
+        kcfg->blockcache.bypass = atoi(value);
+    } else if (matches(key, "tickless")) {
+        kcfg->tickless.value = (0 != atoi(value));
+    } else if (matches(key, "faultaround")) {
+        kcfg->faultaround.value = atoi(value);
+        if (kcfg->faultaround.value == 0) kcfg->faultaround.value = 1;
+        if (kcfg->faultaround.value > kernel_config_t::config_faultaround::gMaxWindow) {
+            kcfg->faultaround.value = kernel_config_t::config_faultaround::gMaxWindow;
+        }
     }
 }
 
@@ -15,6 +15,7 @@
  */
 
 #include <kernel/sys/features.h>
+#include <kernel/i386/sysenter.h>
 #define FEATURE(name, id) static constexpr feature_id_t gFeatureId ## name = id;
 #include <kernel/sys/features.tbl>
 #undef FEATURE
@@ -28,6 +29,8 @@ size_t gNumFeatures = sizeof(gEnabledFeatures) / sizeof(gEnabledFeatures[0]);
 
 bool hasFeature(feature_id_t f) {
     if (f == gFeatureIdInvalid) return false;
+    // depends on the processor, so it can not be in the list above
+    if (f == gFeatureIdSysenter) return Sysenter::supported();
 
     for (size_t i = 0; i < gNumFeatures; ++i) {
         if (gEnabledFeatures[i] == f) return true;
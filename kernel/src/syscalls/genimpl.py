@@ -69,6 +69,11 @@ class SystemCall(object):
             self.systemwhy = "/** %s */" % (node['system'])
         else:
             self.systemwhy = ""
+        self.unbatched = ('unbatched' in node)
+        if self.unbatched:
+            self.unbatchedwhy = "/** %s */" % (node['unbatched'])
+        else:
+            self.unbatchedwhy = ""
 
     def __str__(self):
         return "%d is %s : syscall%d" % (self.number, self.name, self.argc)
@@ -125,7 +130,10 @@ class SystemCall(object):
         return 'syscall_response_t %s_syscall(%s) {\n\treturn syscall%d(%s);\n}' % (self.name, self.argDecls(), self.argc, self.argUsage())
 
     def syscallHandlerSet(self):
-        return 'handle(%d, %s_syscall_helper, %s); %s' % (self.number, self.name, 'true' if self.system else 'false', self.systemwhy)
+        return 'handle(%d, "%s", %s_syscall_helper, %s); %s' % (self.number, self.name, self.name, 'true' if self.system else 'false', self.systemwhy)
+
+    def syscallUnbatchedSet(self):
+        return 'unbatched(%d); %s' % (self.number, self.unbatchedwhy)
 
     def syscallHandlerDecl(self):
         return 'extern syscall_response_t %s_syscall_handler(%s)' % (self.name, self.argDecls())
@@ -243,6 +251,7 @@ def genManagerInit(table):
 
         for syscall in table:
             f.write('\t%s\n' % (syscall.syscallHandlerSet()))
+            if syscall.unbatched: f.write('\t%s\n' % (syscall.syscallUnbatchedSet()))
 
         f.write("}\n")
         f.write("\n")
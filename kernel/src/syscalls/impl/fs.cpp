@@ -14,6 +14,7 @@
 
 #include <kernel/syscalls/handlers.h>
 #include <kernel/fs/vfs.h>
+#include <kernel/fs/pagecache.h>
 #include <kernel/process/current.h>
 #include <kernel/log/log.h>
 #include <kernel/syscalls/types.h>
@@ -52,7 +53,7 @@ syscall_response_t fopen_syscall_handler(const char* path, uint32_t mode) {
         return ERR(NO_SUCH_FILE);
     } else {
         size_t idx = 0;
-        if (gCurrentProcess->fds.set(file, idx)) {
+        if (gCurrentProcess->fds->set(file, idx)) {
             LOG_DEBUG("file %s opened as handle %u in process %u", path, idx, gCurrentProcess->pid);
             return OK | (idx << 1);
         }
@@ -69,7 +70,7 @@ syscall_response_t fdel_syscall_handler(const char* path) {
 HANDLER1(fclose,fid) {
     LOG_DEBUG("closing file handle %u for process %u", fid, gCurrentProcess->pid);
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (gCurrentProcess->fds.is(fid,&file)) {
+    if (gCurrentProcess->fds->is(fid,&file)) {
         if (file) {
             file.close();
         } else {
@@ -77,20 +78,20 @@ HANDLER1(fclose,fid) {
             return ERR(NO_SUCH_FILE);
         }
     }
-    gCurrentProcess->fds.clear(fid);
+    gCurrentProcess->fds->clear(fid);
     return OK;
 }
 
 HANDLER3(fread,fid,len,buf) {
     char* buffer = (char*)buf;
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) {
+    if (!gCurrentProcess->fds->is(fid,&file)) {
         return ERR(NO_SUCH_FILE);
     } else {
         if (file.object) {
             auto realFile = asFile(file.object);
             if (realFile == nullptr) return ERR(NOT_A_FILE);
-            auto sz = realFile->read(len, buffer);
+            auto sz = PageCache::get().read(realFile, len, buffer);
             TAG_DEBUG(FILEIO, "read %u bytes to handle %u", sz, fid);
             return OK | (sz << 1);
         } else {
@@ -102,13 +103,14 @@ HANDLER3(fread,fid,len,buf) {
 HANDLER3(fwrite,fid,len,buf) {
     char* buffer = (char*)buf;
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) {
+    if (!gCurrentProcess->fds->is(fid,&file)) {
         return ERR(NO_SUCH_FILE);
     } else {
         if (file.object) {
             auto realFile = asFile(file.object);
             if (realFile == nullptr) return ERR(NOT_A_FILE);
             auto sz = realFile->write(len, buffer);
+            PageCache::get().written(realFile);
             TAG_DEBUG(FILEIO, "written %u bytes to handle %u", sz, fid);
             return OK | (sz << 1);
         } else {
@@ -120,7 +122,7 @@ HANDLER3(fwrite,fid,len,buf) {
 HANDLER2(fstat,fid,dst) {
     auto stat = (Filesystem::File::stat_t*)dst;
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) {
+    if (!gCurrentProcess->fds->is(fid,&file)) {
         return ERR(NO_SUCH_FILE);
     } else {
         if (file.object) {
@@ -133,7 +135,7 @@ HANDLER2(fstat,fid,dst) {
 
 HANDLER2(fseek,fid,pos) {
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) {
+    if (!gCurrentProcess->fds->is(fid,&file)) {
         return ERR(NO_SUCH_FILE);
     } else {
         if (file.object) {
@@ -148,7 +150,7 @@ HANDLER2(fseek,fid,pos) {
 
 syscall_response_t ftell_syscall_handler(uint16_t fid, size_t* pos) {
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) {
+    if (!gCurrentProcess->fds->is(fid,&file)) {
         return ERR(NO_SUCH_FILE);
     } else {
         if (file.object) {
@@ -163,7 +165,7 @@ syscall_response_t ftell_syscall_handler(uint16_t fid, size_t* pos) {
 
 HANDLER3(fioctl,fid,a1,a2) {
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) {
+    if (!gCurrentProcess->fds->is(fid,&file)) {
         return ERR(NO_SUCH_FILE);
     } else {
         if (file.object) {
@@ -186,7 +188,7 @@ HANDLER1(fopendir,pth) {
         return ERR(NO_SUCH_FILE);
     } else {
         size_t idx = 0;
-        if (gCurrentProcess->fds.set(file, idx)) {
+        if (gCurrentProcess->fds->set(file, idx)) {
             LOG_DEBUG("directory %s opened as handle %u in process %u", path, idx, gCurrentProcess->pid);
             return OK | (idx << 1);
         }
@@ -197,7 +199,7 @@ HANDLER1(fopendir,pth) {
 syscall_response_t freaddir_syscall_handler(uint16_t fid, file_info_t* info) {
     Filesystem::Directory::fileinfo_t finfo;
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) {
+    if (!gCurrentProcess->fds->is(fid,&file)) {
         return ERR(NO_SUCH_FILE);
     } else {
         if (file.object) {
@@ -228,14 +230,14 @@ syscall_response_t mkdir_syscall_handler(const char* path) {
 
 syscall_response_t fdup_syscall_handler(uint32_t fid, uint32_t minNewFid) {
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) {
+    if (!gCurrentProcess->fds->is(fid,&file)) {
         return ERR(NO_SUCH_FILE);
     } else if (file.object == nullptr) {
         return ERR(NO_SUCH_FILE);
     } else {
         file.object->incref();
         size_t newfid = 0;
-        bool ok = gCurrentProcess->fds.set(file, newfid, minNewFid);
+        bool ok = gCurrentProcess->fds->set(file, newfid, minNewFid);
         if (ok) {
             LOG_DEBUG("file handle %u duplicated as handle %u in process %u", fid, newfid, gCurrentProcess->pid);
             return OK | (newfid << 1);
@@ -22,7 +22,7 @@ syscall_response_t mmap_syscall_handler(size_t size, int fd) {
     if (fd < 0) return ERR(NO_SUCH_FILE);
 
     VFS::filehandle_t file;
-    if (gCurrentProcess->fds.is(fd,&file)) {
+    if (gCurrentProcess->fds->is(fd,&file)) {
         if (file) {
             // do not allow multiple maps of the same file
             if (file.region) {
@@ -41,7 +41,7 @@ syscall_response_t mmap_syscall_handler(size_t size, int fd) {
             if (rgn.from) {
                 // update the file to know it is mapped to a region
                 file.region = (void*)rgn.from;
-                gCurrentProcess->fds.reset(fd, file);
+                gCurrentProcess->fds->reset(fd, file);
                 LOG_DEBUG("mmap of descriptor %u success: region at address 0x%p", fd, rgn.from);
                 return OK | (rgn.from << 1);
             }
@@ -33,7 +33,7 @@ syscall_response_t mount_syscall_handler(uint32_t fileid, const char* path) {
     auto& vfs(VFS::get());
 
     VFS::filehandle_t fh = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fileid, &fh)) {
+    if (!gCurrentProcess->fds->is(fileid, &fh)) {
         LOG_ERROR("no file found with id %u", fileid);
         return ERR(NO_SUCH_DEVICE);
     }
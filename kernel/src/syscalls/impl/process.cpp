@@ -32,6 +32,11 @@ HANDLER1(sleep, interval) {
     return OK;
 }
 
+HANDLER1(usleep, interval) {
+    ProcessManager::get().usleep(interval);
+    return OK;
+}
+
 syscall_response_t exit_syscall_handler(uint8_t code) {
     process_exit_status_t es(process_exit_status_t::reason_t::cleanExit, code);
     reaper(es.toWord());
@@ -57,6 +62,21 @@ syscall_response_t exec_syscall_handler(const char* path, char** args, char** en
     return OK | (newproc->pid << 1);
 }
 
+syscall_response_t threadcreate_syscall_handler(uintptr_t eip, uintptr_t arg) {
+    auto&& pmm = ProcessManager::get();
+
+    auto thread = pmm.cloneThread(eip, arg);
+
+    if (thread == nullptr) return ERR(NO_SUCH_PROCESS);
+
+    return OK | (thread->pid << 1);
+}
+
+syscall_response_t threadexit_syscall_handler(bool detached) {
+    ProcessManager::get().exitThread(detached);
+    return OK;
+}
+
 HANDLER1(kill,pid) {
     auto&& pmm = ProcessManager::get();
     return pmm.kill(pid) ? OK : ERR(NOT_ALLOWED);
@@ -83,6 +103,7 @@ static syscall_response_t prioritize_current(process_t* process, const exec_prio
         if (prio_in->scheduling != 0) {
             if (prio_in->scheduling > process->priority.scheduling.max) return ERR(NOT_ALLOWED);
             process->priority.scheduling.current = prio_in->scheduling;
+            ProcessManager::get().reprioritize(process);
         }
     }
 
@@ -107,8 +128,10 @@ static syscall_response_t prioritize_max(process_t* process, const exec_priority
             if (prio_in->scheduling <= process->priority.scheduling.max) {
                 process->priority.scheduling.max = prio_in->scheduling;
             } else return ERR(NOT_ALLOWED);
-            if (process->priority.scheduling.current > process->priority.scheduling.max)
+            if (process->priority.scheduling.current > process->priority.scheduling.max) {
                 process->priority.scheduling.current = process->priority.scheduling.max;
+                ProcessManager::get().reprioritize(process);
+            }
         }
     }
 
@@ -183,10 +206,16 @@ syscall_response_t proctable_syscall_handler(process_info_t *info, size_t count)
             // that's a good guesstimate at the total working set of the running OS image
             pi.vmspace = 1_GB;
             pi.pmspace = (addr_kernel_end() - addr_kernel_start() + 1) + (vmm.getheap() - vmm.getheapbegin() + 1);
+            pi.sharedpages = 0;
+            pi.privatepages = pi.pmspace / VirtualPageManager::gPageSize;
         }
         else {
             pi.vmspace = p->memstats.available;
             pi.pmspace = p->memstats.allocated;
+            // every page of a process is counted in pmspace, whether shared or not
+            const uint32_t allpages = p->memstats.allocated / VirtualPageManager::gPageSize;
+            pi.sharedpages = p->memstats.sharedpages;
+            pi.privatepages = allpages > pi.sharedpages ? allpages - pi.sharedpages : 0;
         }
 
         pi.runtime = p->runtimestats.runtime;
@@ -0,0 +1,55 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/syscalls/handlers.h>
+#include <kernel/syscalls/ring.h>
+#include <kernel/process/current.h>
+#include <kernel/process/process.h>
+#include <kernel/mm/virt.h>
+
+// a process has at most one ring, which stays registered until the memory it lives in is unmapped
+syscall_response_t ringsetup_syscall_handler(syscall_ring_t* ring, uint32_t flags) {
+    auto leader = gCurrentProcess->leader;
+    if (leader->sysring.ring) return ERR(ALREADY_LOCKED);
+    if ((uintptr_t)ring & 3) return ERR(NOT_ALLOWED);
+    if (VirtualPageManager::iskernel((uintptr_t)ring)) return ERR(NOT_ALLOWED);
+
+    MemoryManager::region_t rgn;
+    if (!leader->getMemoryManager()->isWithinRegion((uintptr_t)ring, &rgn)) return ERR(NO_SUCH_OBJECT);
+    if (!rgn.permission.user() || !rgn.permission.rw()) return ERR(NOT_ALLOWED);
+    if ((uintptr_t)ring + sizeof(syscall_ring_t) - 1 > rgn.to) return ERR(NOT_ALLOWED);
+
+    auto entries = ring->entries;
+    if (entries == 0 || entries > syscall_ring_t::gMaxEntries || (entries & (entries - 1))) return ERR(UNIMPLEMENTED);
+    if ((uintptr_t)ring + syscall_ring_t::size(entries) - 1 > rgn.to) return ERR(NOT_ALLOWED);
+
+    ring->flags = flags;
+    ring->sqhead = ring->sqtail = ring->cqhead = ring->cqtail = 0;
+    leader->sysring.ring = ring;
+    leader->sysring.entries = entries;
+
+    if (flags & syscall_ring_t::POLL) {
+        if (!SyscallRings::get().startPoller(leader)) {
+            leader->sysring.ring = nullptr;
+            return ERR(OUT_OF_MEMORY);
+        }
+    }
+
+    return OK;
+}
+
+syscall_response_t ringenter_syscall_handler(uint32_t max) {
+    auto count = SyscallRings::get().drain(gCurrentProcess->leader, max);
+    return OK | (count << 1);
+}
@@ -0,0 +1,46 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/syscalls/handlers.h>
+#include <kernel/synch/futex.h>
+#include <kernel/mm/virt.h>
+
+// the word has to be one the process could store to itself, or a futex could be used to write anywhere
+static bool isValidWord(uintptr_t address) {
+    if (address & 3) return false;
+    if (VirtualPageManager::iskernel(address)) return false;
+
+    auto&& vmm(VirtualPageManager::get());
+    auto pg = VirtualPageManager::page(address);
+    VirtualPageManager::map_options_t options;
+    if (vmm.mapped(pg, &options) || vmm.zeroPageMapped(pg, &options)) {
+        return options.user() && (options.rw() || options.cow());
+    }
+
+    return false;
+}
+
+// timing out, or finding the word already changed, are normal outcomes rather than errors
+syscall_response_t futexwait_syscall_handler(uint32_t* word, uint32_t expected, uint32_t timeout) {
+    if (!isValidWord((uintptr_t)word)) return ERR(NOT_ALLOWED);
+
+    auto result = Futexes::get().wait(word, expected, timeout);
+    return OK | ((uint32_t)result << 1);
+}
+
+syscall_response_t futexwake_syscall_handler(uint32_t* word, uint32_t count) {
+    if (!isValidWord((uintptr_t)word)) return ERR(NOT_ALLOWED);
+
+    return OK | (Futexes::get().wake(word, count) << 1);
+}
@@ -18,10 +18,10 @@
 #include <kernel/fs/filesystem.h>
 #include <kernel/process/current.h>
 
-syscall_response_t pipe_syscall_handler(size_t *read_fd, size_t *write_fd) {
+syscall_response_t pipe_syscall_handler(size_t *read_fd, size_t *write_fd, size_t capacity) {
     auto pipeManager(PipeManager::get());
 
-    auto pipe_files = pipeManager->pipe();
+    auto pipe_files = pipeManager->pipe(capacity);
     VFS::filehandle_t pipe_reader = {
         pipeManager,
         pipe_files.first
@@ -31,8 +31,8 @@ syscall_response_t pipe_syscall_handler(size_t *read_fd, size_t *write_fd) {
         pipe_files.second
     };
 
-    bool read_ok = gCurrentProcess->fds.set(pipe_reader, *read_fd);
-    bool write_ok = gCurrentProcess->fds.set(pipe_writer, *write_fd);
+    bool read_ok = gCurrentProcess->fds->set(pipe_reader, *read_fd);
+    bool write_ok = gCurrentProcess->fds->set(pipe_writer, *write_fd);
 
     bool ok = read_ok && write_ok;
     if (!ok) {
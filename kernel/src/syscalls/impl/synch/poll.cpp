@@ -0,0 +1,114 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/syscalls/handlers.h>
+#include <kernel/synch/pollset.h>
+#include <kernel/fs/vfs.h>
+#include <kernel/fs/filesystem.h>
+#include <kernel/process/current.h>
+#include <kernel/process/manager.h>
+#include <kernel/time/manager.h>
+
+static Filesystem::File* pollFile(int32_t fd) {
+    VFS::filehandle_t handle;
+    if (fd < 0 || !gCurrentProcess->fds->is(fd, &handle) || !handle) return nullptr;
+    return handle.asFile();
+}
+
+// negative descriptors are skipped, as POSIX allows for; invalid ones are ready, with POLL_NVAL
+static size_t scan(poll_entry_t* entries, size_t n) {
+    size_t count = 0;
+    for (auto i = 0u; i < n; ++i) {
+        auto& entry(entries[i]);
+        entry.revents = 0;
+        if (entry.fd < 0) continue;
+        if (auto file = pollFile(entry.fd)) {
+            entry.revents = file->ready() & (entry.events | POLL_ERR | POLL_HUP);
+        } else {
+            entry.revents = POLL_NVAL;
+        }
+        if (entry.revents) ++count;
+    }
+    return count;
+}
+
+// queues the process on (or, with enter == false, takes it off) the poll queue of every file that has one;
+// returns how many queues there were
+static size_t enqueue(poll_entry_t* entries, size_t n, bool enter) {
+    size_t queues = 0;
+    for (auto i = 0u; i < n; ++i) {
+        auto file = pollFile(entries[i].fd);
+        auto pollable = file ? file->pollable() : nullptr;
+        if (pollable == nullptr) continue;
+        if (enter) pollable->pollqueue()->wait(gCurrentProcess);
+        else pollable->pollqueue()->remove(gCurrentProcess);
+        ++queues;
+    }
+    return queues;
+}
+
+// the process sits in the poll queue of each file at once, so whichever file changes first wakes it;
+// every wakeup rescans the whole array, which is what the caller gave up by not using a poll set
+syscall_response_t poll_syscall_handler(poll_entry_t* entries, size_t n, uint32_t timeout) {
+    auto& pmm(ProcessManager::get());
+    auto& tmgr(TimeManager::get());
+    const uint64_t deadline = tmgr.millisUptime() + timeout;
+
+    while (true) {
+        auto count = scan(entries, n);
+        if (count > 0 || timeout == 0) return OK | (count << 1);
+
+        uint64_t now = tmgr.millisUptime();
+        if (timeout != poll_entry_t::gForever && now >= deadline) return OK;
+
+        if (enqueue(entries, n, true) == 0) {
+            // nothing could ever wake this process up but the clock
+            if (timeout == poll_entry_t::gForever) return OK;
+            pmm.sleep(deadline - now);
+            continue;
+        }
+        if (timeout == poll_entry_t::gForever) pmm.yield();
+        else pmm.sleep(deadline - now);
+        enqueue(entries, n, false);
+    }
+}
+
+syscall_response_t pollset_syscall_handler(size_t* fd) {
+    auto sets(PollSets::get());
+    VFS::filehandle_t handle = {sets, sets->make()};
+    if (!gCurrentProcess->fds->set(handle, *fd)) {
+        sets->close(handle.object);
+        return ERR(NO_SUCH_FILE);
+    }
+    return OK;
+}
+
+static PollSet* pollset(uint16_t fd) {
+    VFS::filehandle_t handle;
+    if (!gCurrentProcess->fds->is(fd, &handle) || !handle) return nullptr;
+    auto file = handle.asFile();
+    return PollSet::classof(file) ? (PollSet*)file : nullptr;
+}
+
+syscall_response_t pollsetctl_syscall_handler(uint16_t set, int32_t fd, uint32_t events) {
+    auto pset = pollset(set);
+    if (pset == nullptr) return ERR(NO_SUCH_FILE);
+    return pset->control(fd, events) ? OK : ERR(NO_SUCH_FILE);
+}
+
+syscall_response_t pollsetwait_syscall_handler(uint16_t set, poll_entry_t* entries, size_t n, uint32_t timeout) {
+    auto pset = pollset(set);
+    if (pset == nullptr) return ERR(NO_SUCH_FILE);
+    return OK | (pset->wait(entries, n, timeout) << 1);
+}
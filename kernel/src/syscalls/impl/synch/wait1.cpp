@@ -20,7 +20,7 @@
 
 syscall_response_t wait1_syscall_handler(uint16_t fid, uint32_t timeout) {
     VFS::filehandle_t file = {nullptr, nullptr};
-    if (!gCurrentProcess->fds.is(fid,&file)) return ERR(NO_SUCH_FILE);
+    if (!gCurrentProcess->fds->is(fid,&file)) return ERR(NO_SUCH_FILE);
     if (!file) return ERR(NO_SUCH_FILE);
     auto realFile = file.asFile();
     if (!realFile) return ERR(NO_SUCH_FILE);
@@ -17,19 +17,24 @@
 #include <kernel/drivers/rtc/rtc.h>
 #include <kernel/mm/phys.h>
 #include <kernel/process/current.h>
+#include <kernel/process/cpu.h>
 #include <kernel/syscalls/types.h>
+#include <muzzle/string.h>
 #include <kernel/libc/sprint.h>
 #include <kernel/log/log.h>
 #include <kernel/time/manager.h>
 #include <kernel/process/manager.h>
 #include <kernel/drivers/acpi/acpica/acpica.h>
+#include <kernel/fs/vol/diskmgr.h>
 
 HANDLER0(reboot) {
+    DiskManager::get().flush();
     reboot();
     return OK; // we should never return from here
 }
 
 HANDLER0(halt) {
+    DiskManager::get().flush();
     AcpiEnterSleepStatePrep(ACPI_STATE_S5);
     AcpiEnterSleepState(ACPI_STATE_S5);
     return OK; // we should never return from here
@@ -47,9 +52,28 @@ syscall_response_t sysinfo_syscall_handler(sysinfo_t* dest, uint32_t fill) {
         dest->local.runtime = gCurrentProcess->runtimestats.runtime;
         dest->local.committed = gCurrentProcess->memstats.allocated;
         dest->local.pagefaults = gCurrentProcess->memstats.pagefaults;
+        dest->local.demandfaults = gCurrentProcess->memstats.demandfaults;
+        dest->local.faultaround = gCurrentProcess->memstats.faultaround;
         dest->local.allocated = gCurrentProcess->getMemoryManager()->getTotalRegionsSize();
         dest->local.ctxswitches = gCurrentProcess->runtimestats.ctxswitches;
     }
+
+    if (fill & INCLUDE_CPU_INFO) {
+        auto& cpus(CPUs::get());
+        const auto now = TimeManager::get().millisUptime();
+        bzero(&dest->cpus, sizeof(dest->cpus));
+        for (auto i = 0u; i < cpus.count() && i < SYSINFO_MAX_CPUS; ++i) {
+            const auto& cpu(cpus.cpu(i));
+            if (!cpu.online) continue;
+            auto& info(dest->cpus.cpu[dest->cpus.count++]);
+            info.busy = cpu.stats.busy;
+            info.idle = cpu.stats.idle;
+            info.steals = cpu.stats.steals;
+            // time since the last charge has not been accounted for yet
+            if (cpu.current == cpu.idle) info.idle += now - cpu.lastcharge;
+            else info.busy += now - cpu.lastcharge;
+        }
+    }
     
     return OK;
 }
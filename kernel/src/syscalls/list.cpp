@@ -92,7 +92,7 @@ extern syscall_response_t vmcheckreadable_syscall_handler(uintptr_t arg1,size_t
 extern syscall_response_t vmcheckreadable_syscall_helper(SyscallManager::Request& req);
 extern syscall_response_t vmcheckwritable_syscall_handler(uintptr_t arg1,size_t arg2);
 extern syscall_response_t vmcheckwritable_syscall_helper(SyscallManager::Request& req);
-extern syscall_response_t pipe_syscall_handler(size_t* arg1,size_t* arg2);
+extern syscall_response_t pipe_syscall_handler(size_t* arg1,size_t* arg2,size_t arg3);
 extern syscall_response_t pipe_syscall_helper(SyscallManager::Request& req);
 extern syscall_response_t mmap_syscall_handler(size_t arg1,int arg2);
 extern syscall_response_t mmap_syscall_helper(SyscallManager::Request& req);
@@ -102,50 +102,90 @@ extern syscall_response_t fsinfo_syscall_handler(const char* arg1,filesystem_inf
 extern syscall_response_t fsinfo_syscall_helper(SyscallManager::Request& req);
 extern syscall_response_t checkfeatures_syscall_handler(feature_id_t* arg1);
 extern syscall_response_t checkfeatures_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t usleep_syscall_handler(uint32_t arg1);
+extern syscall_response_t usleep_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t threadcreate_syscall_handler(uintptr_t arg1,uintptr_t arg2);
+extern syscall_response_t threadcreate_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t threadexit_syscall_handler(bool arg1);
+extern syscall_response_t threadexit_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t futexwait_syscall_handler(uint32_t* arg1,uint32_t arg2,uint32_t arg3);
+extern syscall_response_t futexwait_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t futexwake_syscall_handler(uint32_t* arg1,uint32_t arg2);
+extern syscall_response_t futexwake_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t ringsetup_syscall_handler(syscall_ring_t* arg1,uint32_t arg2);
+extern syscall_response_t ringsetup_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t ringenter_syscall_handler(uint32_t arg1);
+extern syscall_response_t ringenter_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t poll_syscall_handler(poll_entry_t* arg1,size_t arg2,uint32_t arg3);
+extern syscall_response_t poll_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t pollset_syscall_handler(size_t* arg1);
+extern syscall_response_t pollset_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t pollsetctl_syscall_handler(uint16_t arg1,int32_t arg2,uint32_t arg3);
+extern syscall_response_t pollsetctl_syscall_helper(SyscallManager::Request& req);
+extern syscall_response_t pollsetwait_syscall_handler(uint16_t arg1,poll_entry_t* arg2,size_t arg3,uint32_t arg4);
+extern syscall_response_t pollsetwait_syscall_helper(SyscallManager::Request& req);
 
 void SyscallManager::sethandlers() {
-	handle(1, yield_syscall_helper, false); 
-	handle(2, sleep_syscall_helper, false); 
-	handle(3, exit_syscall_helper, false); 
-	handle(4, halt_syscall_helper, false); 
-	handle(5, reboot_syscall_helper, false); 
-	handle(6, sysinfo_syscall_helper, false); 
-	handle(7, getcurdir_syscall_helper, false); 
-	handle(8, setcurdir_syscall_helper, false); 
-	handle(9, getpid_syscall_helper, false); 
-	handle(10, fopen_syscall_helper, false); 
-	handle(11, fclose_syscall_helper, false); 
-	handle(12, fdup_syscall_helper, false); 
-	handle(13, fread_syscall_helper, false); 
-	handle(14, exec_syscall_helper, false); 
-	handle(15, kill_syscall_helper, false); 
-	handle(16, fstat_syscall_helper, false); 
-	handle(17, fseek_syscall_helper, false); 
-	handle(18, ftell_syscall_helper, false); 
-	handle(19, fopendir_syscall_helper, false); 
-	handle(20, freaddir_syscall_helper, false); 
-	handle(21, getppid_syscall_helper, false); 
-	handle(22, collect_syscall_helper, false); 
-	handle(23, fioctl_syscall_helper, false); 
-	handle(24, fwrite_syscall_helper, false); 
-	handle(25, prioritize_syscall_helper, false); 
-	handle(26, mapregion_syscall_helper, false); 
-	handle(27, unmapregion_syscall_helper, false); 
-	handle(28, setregionperms_syscall_helper, false); 
-	handle(29, mount_syscall_helper, false); 
-	handle(30, unmount_syscall_helper, false); 
-	handle(31, collectany_syscall_helper, false); 
-	handle(32, clone_syscall_helper, false); 
-	handle(33, fdel_syscall_helper, false); 
-	handle(34, mkdir_syscall_helper, false); 
-	handle(35, proctable_syscall_helper, false); 
-	handle(36, vmcheckreadable_syscall_helper, false); 
-	handle(37, vmcheckwritable_syscall_helper, false); 
-	handle(38, pipe_syscall_helper, false); 
-	handle(39, mmap_syscall_helper, false); 
-	handle(40, wait1_syscall_helper, false); 
-	handle(41, fsinfo_syscall_helper, false); 
-	handle(42, checkfeatures_syscall_helper, false); 
+	handle(1, "yield", yield_syscall_helper, false); 
+	handle(2, "sleep", sleep_syscall_helper, false); 
+	handle(3, "exit", exit_syscall_helper, false); 
+	unbatched(3); /** a ring poller must not exit in place of the process that queued this */
+	handle(4, "halt", halt_syscall_helper, false); 
+	handle(5, "reboot", reboot_syscall_helper, false); 
+	handle(6, "sysinfo", sysinfo_syscall_helper, false); 
+	handle(7, "getcurdir", getcurdir_syscall_helper, false); 
+	handle(8, "setcurdir", setcurdir_syscall_helper, false); 
+	handle(9, "getpid", getpid_syscall_helper, false); 
+	handle(10, "fopen", fopen_syscall_helper, false); 
+	handle(11, "fclose", fclose_syscall_helper, false); 
+	handle(12, "fdup", fdup_syscall_helper, false); 
+	handle(13, "fread", fread_syscall_helper, false); 
+	handle(14, "exec", exec_syscall_helper, false); 
+	unbatched(14); /** a ring poller must not replace its image in place of the process that queued this */
+	handle(15, "kill", kill_syscall_helper, false); 
+	unbatched(15); /** a process killing itself would kill the ring poller instead */
+	handle(16, "fstat", fstat_syscall_helper, false); 
+	handle(17, "fseek", fseek_syscall_helper, false); 
+	handle(18, "ftell", ftell_syscall_helper, false); 
+	handle(19, "fopendir", fopendir_syscall_helper, false); 
+	handle(20, "freaddir", freaddir_syscall_helper, false); 
+	handle(21, "getppid", getppid_syscall_helper, false); 
+	handle(22, "collect", collect_syscall_helper, false); 
+	handle(23, "fioctl", fioctl_syscall_helper, false); 
+	handle(24, "fwrite", fwrite_syscall_helper, false); 
+	handle(25, "prioritize", prioritize_syscall_helper, false); 
+	handle(26, "mapregion", mapregion_syscall_helper, false); 
+	handle(27, "unmapregion", unmapregion_syscall_helper, false); 
+	handle(28, "setregionperms", setregionperms_syscall_helper, false); 
+	handle(29, "mount", mount_syscall_helper, false); 
+	handle(30, "unmount", unmount_syscall_helper, false); 
+	handle(31, "collectany", collectany_syscall_helper, false); 
+	handle(32, "clone", clone_syscall_helper, false); 
+	unbatched(32); /** the child would be a copy of the ring poller, not of the thread that queued this */
+	handle(33, "fdel", fdel_syscall_helper, false); 
+	handle(34, "mkdir", mkdir_syscall_helper, false); 
+	handle(35, "proctable", proctable_syscall_helper, false); 
+	handle(36, "vmcheckreadable", vmcheckreadable_syscall_helper, false); 
+	handle(37, "vmcheckwritable", vmcheckwritable_syscall_helper, false); 
+	handle(38, "pipe", pipe_syscall_helper, false); 
+	handle(39, "mmap", mmap_syscall_helper, false); 
+	handle(40, "wait1", wait1_syscall_helper, false); 
+	handle(41, "fsinfo", fsinfo_syscall_helper, false); 
+	handle(42, "checkfeatures", checkfeatures_syscall_helper, false); 
+	handle(43, "usleep", usleep_syscall_helper, false); 
+	handle(44, "threadcreate", threadcreate_syscall_helper, false); 
+	handle(45, "threadexit", threadexit_syscall_helper, false); 
+	unbatched(45); /** a ring poller must not exit in place of the thread that queued this */
+	handle(46, "futexwait", futexwait_syscall_helper, false); 
+	handle(47, "futexwake", futexwake_syscall_helper, false); 
+	handle(48, "ringsetup", ringsetup_syscall_helper, false); 
+	unbatched(48); /** a ring cannot set itself up */
+	handle(49, "ringenter", ringenter_syscall_helper, false); 
+	unbatched(49); /** a ring cannot drain itself */
+	handle(50, "poll", poll_syscall_helper, false); 
+	handle(51, "pollset", pollset_syscall_helper, false); 
+	handle(52, "pollsetctl", pollsetctl_syscall_helper, false); 
+	handle(53, "pollsetwait", pollsetwait_syscall_helper, false); 
 }
 
 syscall_response_t yield_syscall_helper(SyscallManager::Request&) {
@@ -365,10 +405,11 @@ static_assert(sizeof(uintptr_t) <= sizeof(uint32_t), "type is not safe to pass i
 static_assert(sizeof(size_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
 
 syscall_response_t pipe_syscall_helper(SyscallManager::Request& req) {
-	return pipe_syscall_handler((size_t*)req.arg1,(size_t*)req.arg2);
+	return pipe_syscall_handler((size_t*)req.arg1,(size_t*)req.arg2,(size_t)req.arg3);
 }
 static_assert(sizeof(size_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
 static_assert(sizeof(size_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(size_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
 
 syscall_response_t mmap_syscall_helper(SyscallManager::Request& req) {
 	return mmap_syscall_handler((size_t)req.arg1,(int)req.arg2);
@@ -393,3 +434,70 @@ syscall_response_t checkfeatures_syscall_helper(SyscallManager::Request& req) {
 }
 static_assert(sizeof(feature_id_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
 
+syscall_response_t usleep_syscall_helper(SyscallManager::Request& req) {
+	return usleep_syscall_handler((uint32_t)req.arg1);
+}
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t threadcreate_syscall_helper(SyscallManager::Request& req) {
+	return threadcreate_syscall_handler((uintptr_t)req.arg1,(uintptr_t)req.arg2);
+}
+static_assert(sizeof(uintptr_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(uintptr_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t threadexit_syscall_helper(SyscallManager::Request& req) {
+	return threadexit_syscall_handler((bool)req.arg1);
+}
+static_assert(sizeof(bool) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t futexwait_syscall_helper(SyscallManager::Request& req) {
+	return futexwait_syscall_handler((uint32_t*)req.arg1,(uint32_t)req.arg2,(uint32_t)req.arg3);
+}
+static_assert(sizeof(uint32_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t futexwake_syscall_helper(SyscallManager::Request& req) {
+	return futexwake_syscall_handler((uint32_t*)req.arg1,(uint32_t)req.arg2);
+}
+static_assert(sizeof(uint32_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t ringsetup_syscall_helper(SyscallManager::Request& req) {
+	return ringsetup_syscall_handler((syscall_ring_t*)req.arg1,(uint32_t)req.arg2);
+}
+static_assert(sizeof(syscall_ring_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t ringenter_syscall_helper(SyscallManager::Request& req) {
+	return ringenter_syscall_handler((uint32_t)req.arg1);
+}
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t poll_syscall_helper(SyscallManager::Request& req) {
+	return poll_syscall_handler((poll_entry_t*)req.arg1,(size_t)req.arg2,(uint32_t)req.arg3);
+}
+static_assert(sizeof(poll_entry_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(size_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t pollset_syscall_helper(SyscallManager::Request& req) {
+	return pollset_syscall_handler((size_t*)req.arg1);
+}
+static_assert(sizeof(size_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t pollsetctl_syscall_helper(SyscallManager::Request& req) {
+	return pollsetctl_syscall_handler((uint16_t)req.arg1,(int32_t)req.arg2,(uint32_t)req.arg3);
+}
+static_assert(sizeof(uint16_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(int32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
+syscall_response_t pollsetwait_syscall_helper(SyscallManager::Request& req) {
+	return pollsetwait_syscall_handler((uint16_t)req.arg1,(poll_entry_t*)req.arg2,(size_t)req.arg3,(uint32_t)req.arg4);
+}
+static_assert(sizeof(uint16_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(poll_entry_t*) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(size_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+static_assert(sizeof(uint32_t) <= sizeof(uint32_t), "type is not safe to pass in a register");
+
@@ -14,7 +14,12 @@
 
 #include <kernel/syscalls/manager.h>
 #include <kernel/libc/string.h>
+#include <kernel/libc/memory.h>
+#include <kernel/libc/sprint.h>
 #include <kernel/i386/idt.h>
+#include <kernel/i386/primitives.h>
+#include <kernel/i386/sysenter.h>
+#include <kernel/mm/virt.h>
 #include <kernel/process/manager.h>
 #include <kernel/process/process.h>
 #include <kernel/boot/phase.h>
@@ -45,21 +50,51 @@ SyscallManager& SyscallManager::get() {
 }
 
 namespace {
+    struct latency_t {
+        uint64_t calls;
+        uint64_t cycles;
+        uint64_t maxcycles;
+        uint64_t buckets[syscall_stats_t::gNumBuckets];
+
+        void record(uint64_t c) {
+            ++calls;
+            cycles += c;
+            if (c > maxcycles) maxcycles = c;
+            auto b = (c == 0) ? 0 : 63 - __builtin_clzll(c);
+            if (b >= (int)syscall_stats_t::gNumBuckets) b = syscall_stats_t::gNumBuckets - 1;
+            ++buckets[b];
+        }
+
+        void fill(syscall_stats_t* stats) const {
+            stats->cycles = cycles;
+            stats->maxcycles = maxcycles;
+            memcpy(stats->buckets, buckets, sizeof(buckets));
+        }
+    };
+
     struct syscall_handler_info_t {
         SyscallManager::Handler impl;
+        const char* name;
         // TODO: long-term, the idea is for processes to have capability flags and tie system calls to those
         // (e.g. reboot would be tied to having a CAN_REBOOT_SYSTEM flag); for now keep this simple and just allow
         // making certain system-calls reserved to system processes
         bool system;
+        bool batchable; /** can this system call be queued on a syscall ring */
 
         uint64_t numCalls; /** number of times this system call was invoked */
         uint64_t numInsecureCalls; /** number of times this system call was invoked, but the call failed for security reasons */
+        latency_t latency; /** of the calls that made it to the handler */
 
-        syscall_handler_info_t() : impl(nullptr), system(false), numCalls(0), numInsecureCalls(0) {}
-        void reset(SyscallManager::Handler i, bool s) {
+        syscall_handler_info_t() : impl(nullptr), name(nullptr), system(false), batchable(true), numCalls(0), numInsecureCalls(0) {
+            bzero(&latency, sizeof(latency));
+        }
+        void reset(const char* n, SyscallManager::Handler i, bool s) {
             impl = i;
+            name = n;
             system = s;
+            batchable = true;
             numCalls = numInsecureCalls = 0;
+            bzero(&latency, sizeof(latency));
         }
 
         explicit operator bool() { return impl != nullptr; }
@@ -71,9 +106,28 @@ namespace {
 
 static syscall_handler_info_t gHandlers[256];
 
+// one process at a time can have its system calls accounted for separately; the table is only
+// allocated the first time some process is tracked
+static struct {
+    kpid_t pid;
+    latency_t* table;
+    uint64_t insecure[256];
+} gTracked;
+
 static uint32_t syscall_irq_handler(GPR& gpr, InterruptStack& stack, void*) {
     auto irq_ret = IRQ_RESPONSE_NONE;
 
+    if (stack.error == Sysenter::gFrameMarker) {
+        // the sysenter stub pushed its return address and pointed ebp (the user esp) at it;
+        // a kernel address there can only be an attempt to read kernel memory, so the process
+        // is left to fault on its way back to eip 0
+        if (VirtualPageManager::iskernel(gpr.ebp) || VirtualPageManager::iskernel(gpr.ebp + sizeof(uint32_t) - 1)) {
+            gpr.eax = ERR(NOT_ALLOWED);
+            return irq_ret;
+        }
+        stack.eip = *(uint32_t*)gpr.ebp;
+    }
+
     SyscallManager::Request req = {
         .code = (uint8_t)(gpr.eax & 0xFF),
         .arg1 = gpr.ebx,
@@ -85,23 +139,9 @@ static uint32_t syscall_irq_handler(GPR& gpr, InterruptStack& stack, void*) {
         .eflags = stack.eflags,
         .eip = stack.eip
     };
-    if (auto& handler = gHandlers[req.code]) {
-        ++handler.numCalls;
-        LOG_DEBUG("syscall from pid %u; eax = 0x%x, handler = 0x%p", gCurrentProcess->pid, gpr.eax, handler.impl);
-
-        if (handler.system && !gCurrentProcess->flags.system) {
-            LOG_ERROR("process %u attempted to exec system call %u which is reserved to the system", gCurrentProcess->pid, req.code);
-            gpr.eax = ERR(NOT_ALLOWED);
-            ++handler.numInsecureCalls;
-        } else {
-            auto res = handler.impl(req);
-            gpr.eax = res;
-            stack.eip = req.eip;
-            stack.eflags = req.eflags;
-        }
-    } else {
-        gpr.eax = ERR(NO_SUCH_SYSCALL);
-    }
+    gpr.eax = SyscallManager::get().execute(req);
+    stack.eip = req.eip;
+    stack.eflags = req.eflags;
 
     if (gpr.eax == ACT(YIELD)) {
         TAG_DEBUG(RESCHEDULE, "process %u will yield by syscall decision", gCurrentProcess->pid);
@@ -124,6 +164,89 @@ SyscallManager::SyscallManager() {
     Interrupts::get().sethandler(gSyscallIRQ, "syscall", syscall_irq_handler);
 }
 
-void SyscallManager::handle(uint8_t code, SyscallManager::Handler handler, bool systemOnly) {
-    gHandlers[code].reset(handler, systemOnly);
+syscall_response_t SyscallManager::execute(Request& req, bool batched) {
+    if (auto& handler = gHandlers[req.code]) {
+        if (batched && !handler.batchable) return ERR(NOT_ALLOWED);
+        ++handler.numCalls;
+        LOG_DEBUG("syscall from pid %u; code = %u, handler = 0x%p", gCurrentProcess->pid, req.code, handler.impl);
+
+        const bool tracked = gTracked.pid != 0 && gTracked.pid == gCurrentProcess->leader->pid;
+
+        if (handler.system && !gCurrentProcess->flags.system) {
+            LOG_ERROR("process %u attempted to exec system call %u which is reserved to the system", gCurrentProcess->pid, req.code);
+            ++handler.numInsecureCalls;
+            if (tracked) ++gTracked.insecure[req.code];
+            return ERR(NOT_ALLOWED);
+        }
+
+        // a handler that does not return (e.g. exit) is simply not counted
+        auto start = readtsc();
+        auto result = handler.impl(req);
+        auto cycles = readtsc() - start;
+        handler.latency.record(cycles);
+        if (tracked) gTracked.table[req.code].record(cycles);
+        return result;
+    }
+
+    return ERR(NO_SUCH_SYSCALL);
+}
+
+void SyscallManager::handle(uint8_t code, const char* name, SyscallManager::Handler handler, bool systemOnly) {
+    gHandlers[code].reset(name, handler, systemOnly);
+}
+
+void SyscallManager::unbatched(uint8_t code) {
+    gHandlers[code].batchable = false;
+}
+
+bool SyscallManager::stats(uint8_t code, syscall_stats_t* stats) {
+    auto& handler(gHandlers[code]);
+    if (!handler) return false;
+
+    bzero(stats, sizeof(*stats));
+    stats->id = code;
+    sprint(stats->name, sizeof(stats->name), "%s", handler.name);
+    stats->calls = handler.numCalls;
+    stats->insecure = handler.numInsecureCalls;
+    handler.latency.fill(stats);
+    return true;
+}
+
+bool SyscallManager::processStats(uint8_t code, syscall_stats_t* stats) {
+    if (!this->stats(code, stats)) return false;
+
+    if (gTracked.table == nullptr) {
+        stats->calls = stats->insecure = stats->cycles = stats->maxcycles = 0;
+        bzero(stats->buckets, sizeof(stats->buckets));
+        return true;
+    }
+
+    const auto& latency(gTracked.table[code]);
+    stats->insecure = gTracked.insecure[code];
+    stats->calls = latency.calls + stats->insecure;
+    latency.fill(stats);
+    return true;
+}
+
+bool SyscallManager::track(kpid_t pid) {
+    if (pid != 0 && gTracked.table == nullptr) {
+        gTracked.table = (latency_t*)calloc(256, sizeof(latency_t));
+        if (gTracked.table == nullptr) {
+            gTracked.pid = 0;
+            return false;
+        }
+    } else if (gTracked.table) {
+        bzero(gTracked.table, 256 * sizeof(latency_t));
+    }
+    bzero(gTracked.insecure, sizeof(gTracked.insecure));
+    gTracked.pid = pid;
+    return true;
+}
+
+kpid_t SyscallManager::tracked() const {
+    return gTracked.pid;
+}
+
+void SyscallManager::untrack(kpid_t pid) {
+    if (gTracked.pid == pid) gTracked.pid = 0;
 }
@@ -0,0 +1,161 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/syscalls/ring.h>
+#include <kernel/syscalls/manager.h>
+#include <kernel/syscalls/handlers.h>
+#include <kernel/process/current.h>
+#include <kernel/process/manager.h>
+#include <kernel/process/process.h>
+#include <kernel/libc/string.h>
+
+#define LOG_LEVEL 2
+#include <kernel/log/log.h>
+
+LOG_TAG(SYSRING, 1);
+
+// how long the poller sleeps after finding nothing to do
+static constexpr uint32_t gPollerIdleMs = 1;
+
+SyscallRings& SyscallRings::get() {
+    static SyscallRings gRings;
+
+    return gRings;
+}
+
+SyscallRings::SyscallRings() {
+    bzero(&mStats, sizeof(mStats));
+}
+
+bool SyscallRings::mapped(process_t* leader) {
+    auto ring = leader->sysring.ring;
+    MemoryManager::region_t rgn;
+    if (!leader->getMemoryManager()->isWithinRegion((uintptr_t)ring, &rgn)) return false;
+    if (!rgn.permission.user() || !rgn.permission.rw()) return false;
+    return (uintptr_t)ring + syscall_ring_t::size(leader->sysring.entries) - 1 <= rgn.to;
+}
+
+uint32_t SyscallRings::drain(process_t* leader, uint32_t max) {
+    auto ring = leader->sysring.ring;
+    if (ring == nullptr || leader->sysring.draining) return 0;
+    if (!mapped(leader)) {
+        TAG_ERROR(SYSRING, "process %u unmapped its syscall ring at 0x%p", leader->pid, ring);
+        leader->sysring.ring = nullptr;
+        return 0;
+    }
+
+    // a handler may block, and let another thread of this process try to drain the same ring
+    leader->sysring.draining = true;
+
+    // entries was checked at setup, but it lives in user memory and must not be trusted afterwards
+    const auto mask = leader->sysring.entries - 1;
+    auto sq = ring->submissions();
+    auto cq = (syscall_ring_t::completion_t*)(sq + leader->sysring.entries);
+
+    uint32_t count = 0;
+    while (count < max) {
+        auto head = ring->sqhead;
+        if (head == __atomic_load_n(&ring->sqtail, __ATOMIC_ACQUIRE)) break;
+        auto tail = ring->cqtail;
+        if (tail - __atomic_load_n(&ring->cqhead, __ATOMIC_ACQUIRE) > mask) break;
+
+        auto& sub(sq[head & mask]);
+        SyscallManager::Request req = {
+            .code = sub.code,
+            .arg1 = sub.args[0],
+            .arg2 = sub.args[1],
+            .arg3 = sub.args[2],
+            .arg4 = sub.args[3],
+            .arg5 = sub.args[4],
+
+            .eflags = 0,
+            .eip = 0
+        };
+        auto userdata = sub.userdata;
+        // the entry is only read before the call, so userspace may reuse it as soon as the head moves past it
+        __atomic_store_n(&ring->sqhead, head + 1, __ATOMIC_RELEASE);
+
+        auto result = SyscallManager::get().execute(req, true);
+        // there is no trap to return from, so a yield has already happened by the time the next entry runs
+        if (result == ACT(YIELD)) result = OK;
+
+        auto& cqe(cq[tail & mask]);
+        cqe.userdata = userdata;
+        cqe.result = result;
+        __atomic_store_n(&ring->cqtail, tail + 1, __ATOMIC_RELEASE);
+
+        ++count;
+    }
+
+    leader->sysring.draining = false;
+    if (count) {
+        ++mStats.batches;
+        mStats.submissions += count;
+        TAG_DEBUG(SYSRING, "process %u ran %u system calls off its ring", leader->pid, count);
+    }
+    return count;
+}
+
+void SyscallRings::poll(uintptr_t arg) {
+    auto leader = (process_t*)arg;
+    auto& pmm(ProcessManager::get());
+
+    TAG_INFO(SYSRING, "thread %u polling the syscall ring of process %u", gCurrentProcess->pid, leader->pid);
+    while (!leader->sysring.stopping && leader->sysring.ring) {
+        if (0 == get().drain(leader, syscall_ring_t::gMaxEntries)) {
+            pmm.sleep(gPollerIdleMs);
+        } else {
+            pmm.yield();
+        }
+    }
+
+    leader->sysring.poller = nullptr;
+    pmm.exitThread(false);
+}
+
+bool SyscallRings::startPoller(process_t* leader) {
+    if (leader->flags.exiting) return false;
+
+    ProcessManager::spawninfo_t si {
+        cr3 : leader->ctx.cr3,
+        eip : (uintptr_t)&SyscallRings::poll,
+        max_priority : exec_priority_t {
+            quantum : gCurrentProcess->priority.quantum.max,
+            scheduling : gCurrentProcess->priority.scheduling.max,
+        },
+        current_priority : exec_priority_t {
+            quantum : gCurrentProcess->priority.quantum.current,
+            scheduling : gCurrentProcess->priority.scheduling.current,
+        },
+        argument : (uintptr_t)leader,
+        environment : nullptr,
+        name : gCurrentProcess->path,
+        cwd : gCurrentProcess->cwd,
+        fileops : nullptr,
+        schedulable : true,
+        system : gCurrentProcess->flags.system,
+        clone : false,
+        thread : true
+    };
+
+    // unlike a thread made by threadcreate, this one never leaves the kernel
+    auto poller = ProcessManager::get().spawn(si);
+    if (poller == nullptr) return false;
+    leader->sysring.poller = poller;
+    return true;
+}
+
+SyscallRings::stats_t SyscallRings::stats() const {
+    return mStats;
+}
@@ -0,0 +1,66 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/syscalls/manager.h>
+#include <kernel/boot/phase.h>
+#include <kernel/fs/devfs/devfs.h>
+#include <kernel/fs/memfs/memfs.h>
+#include <kernel/libc/memory.h>
+#include <kernel/syscalls/types.h>
+
+namespace {
+    class TableFile : public MemFS::File {
+        public:
+            TableFile(const char* name, bool process) : MemFS::File(name), mProcess(process) {
+                kind(file_kind_t::chardevice);
+            }
+
+            delete_ptr<MemFS::FileBuffer> content() override {
+                auto& mgr(SyscallManager::get());
+                syscall_stats_t *buffer = (syscall_stats_t*)calloc(256, sizeof(syscall_stats_t));
+                size_t n = 0;
+                for (size_t i = 0; i < 256; ++i) {
+                    if (mProcess ? mgr.processStats(i, &buffer[n]) : mgr.stats(i, &buffer[n])) ++n;
+                }
+                return new MemFS::ExternalDataBuffer<true>((uint8_t*)buffer, n * sizeof(syscall_stats_t));
+            }
+
+            uintptr_t ioctl(uintptr_t a, uintptr_t b) override {
+                if (!mProcess) return 0;
+                switch (a) {
+                    case syscall_stats_t::IOCTL_TRACK_PROCESS:
+                        return SyscallManager::get().track((kpid_t)b) ? 1 : 0;
+                    case syscall_stats_t::IOCTL_TRACKED_PROCESS:
+                        return SyscallManager::get().tracked();
+                }
+                return 0;
+            }
+
+        private:
+            bool mProcess;
+    };
+}
+
+namespace boot::syscallstats {
+    uint32_t init() {
+        auto dir = DevFS::get().getDeviceDirectory("syscalls");
+        dir->add(new TableFile("all", false));
+        dir->add(new TableFile("process", true));
+        return 0;
+    }
+
+    bool fail(uint32_t) {
+        return bootphase_t::gPanic;
+    }
+}
@@ -16,6 +16,7 @@
 #include <kernel/process/manager.h>
 #include <kernel/process/current.h>
 #include <kernel/time/manager.h>
+#include <kernel/i386/idt.h>
 
 #define LOG_LEVEL 2
 #include <kernel/log/log.h>
@@ -31,34 +32,33 @@ KERNEL_TASK_NAMESPACE_OPEN(awaker) {
         auto& sq(ProcessManager::gSleepQueue());
         auto& pmm(ProcessManager::get());
         gCurrentProcess->priority.scheduling.current = 5;
+        pmm.reprioritize(gCurrentProcess);
         while(true) {
-            /* if there's a process waiting to be woken up, yield and continue
-               until that has happened - and only then go back to waiting;
-               if one sets a process to sleep for - say - an hour then this
-               is highly suboptimal, but if no processes are sleeping or all sleeps
-               are short and sporadic, then this is almost good..
-            */
-            while(!sq.empty()) {
-                auto now = TimeManager::get().millisUptime();
-                auto top = sq.top();
-                if (top.process->state == process_t::State::EXITED) {
-                    pmm.enqueueForDeath(sq.pop().process);
-                    continue;
-                }
-                if (top.process->sleeptill <= now) {
+            {
+                // the scheduler wakes this task whenever it sees a sleeper come due, which may be
+                // from an IRQ; the check and going back to waiting must not be split by one
+                Interrupts::ScopedDisabler sd;
+                auto now = TimeManager::get().microsUptime();
+                while(!sq.empty()) {
+                    auto top = sq.top();
+                    if (top.process->state == process_t::State::EXITED) {
+                        // exit() has already put this process on the exited list
+                        sq.pop();
+                        continue;
+                    }
+                    if (top.process->sleeptill > now) break;
+                    sq.pop();
                     if (top.process->waitToken == top.token) {
-                        LOG_DEBUG("awakening process %u - it asked to sleep till %u", top.process->pid, top.process->sleeptill);
-                        top = sq.pop();
+                        LOG_DEBUG("awakening process %u - it asked to sleep till %llu", top.process->pid, top.process->sleeptill);
                         pmm.wake(top.process);
                     } else {
                         LOG_ERROR("process %u in sleep queue; queue token is %llu, but process has token %llu; ignoring wake",
                             top.process->pid, top.token, top.process->waitToken);
                     }
-                } else {
-                    pmm.yield();
                 }
+                queue().wait(gCurrentProcess);
             }
-            queue().yield(gCurrentProcess, 0);
+            pmm.yield();
         }
     }
 }
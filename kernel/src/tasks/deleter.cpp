@@ -17,7 +17,6 @@
 #include <kernel/process/current.h>
 #include <kernel/mm/phys.h>
 #include <kernel/mm/virt.h>
-#include <kernel/sys/globals.h>
 
 #include <kernel/log/log.h>
 
@@ -45,7 +44,6 @@ KERNEL_TASK_NAMESPACE_OPEN(deleter) {
         auto&& vmm(VirtualPageManager::get());
         auto& col(ProcessManager::gCollectedProcessList());
         auto& pidBitmap(ProcessManager::gPidBitmap());
-        auto& gdtBitmap(ProcessManager::gGDTBitmap());
         auto& procTable(ProcessManager::gProcessTable());
         while(true) {
             while (!col.empty()) {
@@ -57,14 +55,10 @@ KERNEL_TASK_NAMESPACE_OPEN(deleter) {
                 if (proc->args) freeStringArray(proc->args);
                 if (proc->environ) freeStringArray(proc->environ);
 
-                auto dtbl = addr_gdt<uint64_t*>();
-                dtbl[proc->pid + val_numsysgdtentries<uint32_t>()] = 0;
-
                 pidBitmap.free(proc->pid);
-                gdtBitmap.free(proc->gdtidx);
                 procTable.free(proc);
 
-                pmm.dealloc((uintptr_t)proc->tss.cr3);
+                pmm.dealloc((uintptr_t)proc->ctx.cr3);
                 if (proc->esp0start) vmm.unmap(proc->esp0start);
                 if (proc->espstart) vmm.unmap(proc->espstart);
                 proc->~process_t();
@@ -21,6 +21,7 @@
 #include <kernel/drivers/ps2/keyboard.h>
 #include <kernel/i386/idt.h>
 #include <kernel/libc/queue.h>
+#include <kernel/syscalls/types.h>
 
 #define LOG_LEVEL 1
 #include <kernel/log/log.h>
@@ -31,6 +32,18 @@ namespace tasks::keybqueue {
     static PS2Keyboard *gKeyboard;
     static WaitQueue gEventQueue;
 
+    static class : public Pollable {
+        public:
+            uint32_t ready() override {
+                if (gKeyEvents.empty()) return 0;
+                return POLL_IN;
+            }
+    } gKeyEventsPollable;
+
+    Pollable* pollable() {
+        return &gKeyEventsPollable;
+    }
+
     void prepare() {
         gKeyIRQQueue = nullptr;
         gKeyboard = nullptr;
@@ -83,6 +96,7 @@ namespace tasks::keybqueue {
                 }
                 if (any) gEventQueue.wakeall();
             }
+            if (any) gKeyEventsPollable.notify();
             gKeyIRQQueue->yield(gCurrentProcess, 0);
         }
     }
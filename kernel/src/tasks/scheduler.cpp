@@ -33,88 +33,44 @@ static Rng& getRandomNumberGenerator() {
 
 namespace tasks::scheduler {
     namespace lottery {
+        // every process in the ready queue is AVAILABLE (exit() and deschedule() take processes
+        // out as soon as they stop being runnable), so a draw is a single O(log n) lookup
         process_t *next() {
             auto& ready = ProcessManager::gReadyQueue();
-            auto&& pmm(ProcessManager::get());
-
             auto& rng(getRandomNumberGenerator());
 
-            process_t *next_task = nullptr;
-            uint64_t totalTickets;
-
-loop_all:
-            totalTickets = 0;
-            for(size_t i = 0; i < ready.size(); ++i) {
-                process_t *p = ready.at(i);
-                switch(p->state) {
-                    case process_t::State::EXITED:
-                        pmm.enqueueForDeath(p);
-                        ready.erase(p);
-                        goto loop_all;
-                        break;
-                    default:
-                        break;
-                    case process_t::State::AVAILABLE:
-                        totalTickets += p->priority.scheduling.current;
-                        break;
-                }
+            uint64_t totalTickets = ready.tickets();
+            if (totalTickets == 0) {
+                PANIC("no tickets in the ready queue - scheduler aborted");
             }
 
             uint64_t currentWinner = (uint64_t)rng.next() | (((uint64_t)rng.next()) << 32);
             currentWinner %= totalTickets;
 
-            TAG_DEBUG(LOTTERY, "lottery has total %llu tickets - winner is %llu", totalTickets, currentWinner);
-
-            uint64_t countedTickets = 0;
-            for(size_t i = 0; i < ready.size(); ++i) {
-                process_t* p = ready.at(i);
-                countedTickets += p->priority.scheduling.current;
-                if ((countedTickets >= currentWinner) && (p->state == process_t::State::AVAILABLE)) {
-                    next_task = p;
-                    TAG_DEBUG(LOTTERY, "with %llu tickets counted the winner process is %u",
-                        countedTickets, p->pid);
-                    break;
-                }
-            }
+            process_t *next_task = ready.find(currentWinner);
 
             if (next_task == nullptr) {
                 PANIC("lottery did not select a winner - scheduler aborted");
-            } else return next_task;
+            }
+
+            TAG_DEBUG(LOTTERY, "lottery has total %llu tickets - winner is %llu, held by process %u",
+                totalTickets, currentWinner, next_task->pid);
+            return next_task;
         }
     }
 
     namespace rr {
         process_t *next() {
             auto&& ready = ProcessManager::gReadyQueue();
-            auto&& pmm(ProcessManager::get());
 
-            process_t *next_task = nullptr;
-
-            // in theory this could cause an endless loop, but in practice at least the "dummy process" will always be ready to run
-            while(true) {
-                next_task = ready.front();
-                ready.erase(ready.begin());
-
-                switch(next_task->state) {
-                    case process_t::State::AVAILABLE:
-                        ready.push_back(next_task);
-                        return next_task;
-                    case process_t::State::EXITED:
-                        pmm.enqueueForDeath(next_task);
-                        /* fallthrough */
-                    default:
-                        continue;
-                }
-
-            }
+            // yield() falls back to the dummy process itself when the ready queue is empty
+            process_t *next_task = ready.front();
+            ready.rotate(next_task);
+            return next_task;
         }
     }
 
-    void task() {
-        while(true) {
-            auto next_task = lottery::next();
-            next_task->flags.due_for_reschedule = false;
-            ProcessManager::ctxswitch(next_task);
-        }
+    process_t *next() {
+        return lottery::next();
     }
 }
@@ -0,0 +1,48 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <kernel/tasks/zeroer.h>
+#include <kernel/process/manager.h>
+#include <kernel/process/current.h>
+#include <kernel/mm/zeropool.h>
+
+#define LOG_LEVEL 2
+#include <kernel/log/log.h>
+
+KERNEL_TASK_NAMESPACE_OPEN(zeroer) {
+    WaitQueue& queue() {
+        static WaitQueue gQueue;
+
+        return gQueue;
+    }
+
+    void task() {
+        auto& pool(ZeroPagePool::get());
+        auto& pmm(ProcessManager::get());
+        pool.configure();
+        while(true) {
+            /* zero one page at a time, and give up the CPU in between, so that
+               this task only really runs when nothing else wants to;
+               once the pool is at its high watermark, sleep until a consumer
+               takes it below the low watermark
+            */
+            while (pool.belowHighWatermark()) {
+                if (!pool.fillOne()) break;
+                pmm.yield();
+            }
+            LOG_DEBUG("zero page pool has %u pages", pool.size());
+            queue().yield(gCurrentProcess, 0);
+        }
+    }
+}
@@ -20,6 +20,8 @@
 #include <kernel/panic/panic.h>
 #include <kernel/fs/devfs/devfs.h>
 #include <kernel/libc/sprint.h>
+#include <kernel/i386/primitives.h>
+#include <kernel/process/datapages.h>
 
 namespace {
     class TimeFile : public MemFS::File {
@@ -51,6 +53,8 @@ namespace {
 namespace boot::time {
     uint32_t init() {
         TimeManager::get();
+        // set up before any timer interrupt gets to publish the time there
+        DataPages::get();
         return 0;
     }
 }
@@ -80,17 +84,61 @@ uint64_t TimeManager::millisPerTick() {
     return mTimeSource.millisPerTick;
 }
 
-time_tick_callback_t::yield_vote_t TimeManager::tick(InterruptStack& stack) {
+void TimeManager::registerTSC(uint64_t ticksPerMs) {
+    if (ticksPerMs == 0) return;
+    mTSC.baseMicros = microsUptime();
+    mTSC.base = readtsc();
+    mTSC.ticksPerMs = ticksPerMs;
+    DataPages::get().publishTSC(mTSC.ticksPerMs, mTSC.base, mTSC.baseMicros);
+    LOG_INFO("TSC runs at %llu ticks per ms - using it as the system clock", ticksPerMs);
+}
+
+uint64_t TimeManager::tscTicksPerMs() const {
+    return mTSC.ticksPerMs;
+}
+
+void TimeManager::registerClockEvent(const char* name, clockevent_f arm) {
+    if (mTSC.ticksPerMs == 0) {
+        PANIC("tickless operation requires a TSC clock");
+    }
+    mClockEvent.name = name;
+    mClockEvent.arm = arm;
+    LOG_INFO("%s is the clock event device - no more periodic ticks", name);
+}
+
+bool TimeManager::tickless() const {
+    return mClockEvent.arm != nullptr;
+}
+
+void TimeManager::setDeadline(uint64_t micros) {
+    if (mClockEvent.arm == nullptr) return;
+
+    if (micros == 0) {
+        mClockEvent.arm(0);
+    } else {
+        auto now = microsUptime();
+        // a deadline that has already passed still needs an interrupt, as soon as possible
+        mClockEvent.arm(micros > now ? micros - now : 1);
+    }
+}
+
+time_tick_callback_t::yield_vote_t TimeManager::tick(InterruptStack& stack, bool advance) {
     time_tick_callback_t::yield_vote_t want_yield = time_tick_callback_t::no_yield;
 
     if (mTimeSource.millisPerTick == 0) {
         PANIC("TimeManager asked to tick without a known time source");
     }
-    uint64_t new_count = __sync_add_and_fetch(&mMillisecondsSinceBoot, mTimeSource.millisPerTick);
+    // in tickless mode interrupts only come at deadlines someone asked for, so there
+    // is no tick to count and every handler gets to run on every interrupt
+    const bool periodic = (mClockEvent.arm == nullptr);
+    if (periodic && advance) __sync_add_and_fetch(&mMillisecondsSinceBoot, mTimeSource.millisPerTick);
+    uint64_t new_count = millisUptime();
+    if (advance) DataPages::get().publishUptime(new_count);
+
     for (auto i = 0u; i < gMaxTickFunctions; ++i) {
         auto& ti = mTickHandlers.funcs[i];
         if (ti) {
-            if (0 == ti.every_countdown) {
+            if (!periodic || 0 == ti.every_countdown) {
                 if (time_tick_callback_t::yield == ti.callback.run(stack, new_count)) {
                     want_yield = time_tick_callback_t::yield;
                 }
@@ -105,12 +153,25 @@ time_tick_callback_t::yield_vote_t TimeManager::tick(InterruptStack& stack) {
 }
 
 uint64_t TimeManager::millisUptime() {
-    return __sync_add_and_fetch(&mMillisecondsSinceBoot, 0);
+    if (mTSC.ticksPerMs == 0) return __sync_add_and_fetch(&mMillisecondsSinceBoot, 0);
+    return microsUptime() / 1000;
+}
+
+uint64_t TimeManager::microsUptime() {
+    if (mTSC.ticksPerMs == 0) return 1000 * __sync_add_and_fetch(&mMillisecondsSinceBoot, 0);
+
+    // split the conversion so that the multiplication cannot overflow however long the system is up
+    auto delta = readtsc() - mTSC.base;
+    auto ms = delta / mTSC.ticksPerMs;
+    auto rest = delta % mTSC.ticksPerMs;
+    return mTSC.baseMicros + 1000 * ms + (1000 * rest) / mTSC.ticksPerMs;
 }
 
 TimeManager::TimeManager() : mMillisecondsSinceBoot(0), mBootDurationMillis(0), mUNIXTimestamp(0) {
     bzero(&mTickHandlers, sizeof(mTickHandlers));
     bzero(&mTimeSource, sizeof(mTimeSource));
+    bzero(&mTSC, sizeof(mTSC));
+    bzero(&mClockEvent, sizeof(mClockEvent));
 }
 
 size_t TimeManager::registerTickHandler(time_tick_callback_t::func_f f, void* baton, uint32_t every_N) {
@@ -139,11 +200,13 @@ uint64_t TimeManager::UNIXtime() {
 }
 
 void TimeManager::UNIXtimeIncrement(uint64_t seconds) {
-    __sync_add_and_fetch(&mUNIXTimestamp, seconds);
+    if (seconds == 0) return;
+    auto now = __sync_add_and_fetch(&mUNIXTimestamp, seconds);
+    DataPages::get().publishUNIXtime(now, microsUptime());
 }
 
 void TimeManager::bootCompleted() {
-    mBootDurationMillis = mMillisecondsSinceBoot;
+    mBootDurationMillis = millisUptime();
 }
 
 uint64_t TimeManager::millisBootTime() const {
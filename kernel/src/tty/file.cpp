@@ -19,6 +19,7 @@
 #include <kernel/panic/panic.h>
 #include <kernel/drivers/ps2/keyboard.h>
 #include <kernel/process/current.h>
+#include <kernel/tasks/keybqueue.h>
 
 LOG_TAG(RAWTTY, 2);
 LOG_TAG(TTYFILE, 2);
@@ -259,6 +260,15 @@ void TTYFile::processOne_Raw(key_event_t evt) {
 
 #undef RAW_COMBO
 
+Pollable* TTYFile::pollable() {
+    return tasks::keybqueue::pollable();
+}
+
+uint32_t TTYFile::ready() {
+    if (mMode != mode_t::READ_FROM_IRQ) return POLL_IN | POLL_OUT;
+    return tasks::keybqueue::pollable()->ready() | POLL_OUT;
+}
+
 size_t TTYFile::read(size_t n, char* b) {
 entry:
     TAG_DEBUG(TTYFILE, "trying to consume up to %u bytes from the TTY - mode is 0x%x", n, mMode);
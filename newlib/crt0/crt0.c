@@ -22,6 +22,7 @@ extern void exit(int code);
 extern int main (int, char**);
 
 extern void  __sinit (struct _reent *);
+extern void __syscall_init(void);
 
 extern char** environ;
 
@@ -59,6 +60,7 @@ static size_t findArgc(char** argp) {
 }
 
 void _start(char** argp, char** envp) {
+    __syscall_init();
     environ = envp;
     __sinit(_global_impure_ptr);
     stdin->_flags |= __SLBF;
@@ -0,0 +1,32 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef NEWLIB_KERNELDATA
+#define NEWLIB_KERNELDATA
+
+#include <stdint.h>
+
+// reads the pages the kernel maps in every process (see kernel_data_t), without a system call
+namespace newlib::puppy::impl {
+    uint64_t microsUptime();
+
+    struct unixtime_t {
+        uint64_t seconds;
+        uint32_t micros;
+    };
+    unixtime_t unixtime();
+
+    uint32_t pid();
+}
+
+#endif
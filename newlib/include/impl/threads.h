@@ -0,0 +1,35 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NEWLIB_THREADS
+#define NEWLIB_THREADS
+
+#include <stdint.h>
+
+namespace newlib::puppy::impl {
+    // true once the process has started its first thread; until then, there is nobody to lock against
+    bool multithreaded();
+    void setMultithreaded();
+
+    // a lock that the thread holding it can take again, spinning and yielding while contended
+    struct recursive_lock_t {
+        uint32_t owner;
+        uint32_t count;
+
+        void lock();
+        void unlock();
+    };
+}
+
+#endif
@@ -0,0 +1,40 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef NEWLIB_POLL
+#define NEWLIB_POLL
+
+#include <newlib/impl/cenv.h>
+
+typedef unsigned int nfds_t;
+
+struct pollfd {
+    int fd;
+    short events;
+    short revents;
+};
+
+// these are the same bits as poll_event_t in the kernel; POLLPRI is accepted but never reported
+#define POLLIN     0x01
+#define POLLPRI    0x02
+#define POLLOUT    0x04
+#define POLLERR    0x08
+#define POLLHUP    0x10
+#define POLLNVAL   0x20
+#define POLLRDNORM POLLIN
+#define POLLWRNORM POLLOUT
+
+// timeout is in milliseconds; a negative timeout waits forever, 0 does not wait at all
+NEWLIB_IMPL_REQUIREMENT int poll(struct pollfd* fds, nfds_t n, int timeout);
+
+#endif
@@ -0,0 +1,30 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NEWLIB_FASTCALL
+#define NEWLIB_FASTCALL
+
+#include <newlib/impl/cenv.h>
+
+// system calls enter the kernel with sysenter when the kernel reports support for it, and with
+// int 0x80 otherwise; both reach the same handlers, and only differ in how long the round trip takes
+
+// whether system calls from this process currently use sysenter
+NEWLIB_IMPL_REQUIREMENT bool syscall_fastpath();
+
+// asks for system calls to use sysenter, or int 0x80; returns whether sysenter is in use
+// afterwards, which is false if the kernel does not support it
+NEWLIB_IMPL_REQUIREMENT bool syscall_set_fastpath(bool);
+
+#endif
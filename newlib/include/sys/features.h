@@ -392,6 +392,14 @@ extern "C" {
 
 #endif
 
+/* Puppy provides threads on top of its threadcreate and threadexit system calls */
+#ifdef __puppy__
+#define _POSIX_THREADS				1
+#define _UNIX98_THREAD_MUTEX_ATTRIBUTES         1
+#define _POSIX_TIMERS				1
+#define _POSIX_MONOTONIC_CLOCK			200112L
+#endif
+
 /* XMK loosely adheres to POSIX -- 1003.1 */
 #ifdef __XMK__
 #define _POSIX_THREADS				1
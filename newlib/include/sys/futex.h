@@ -0,0 +1,66 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef NEWLIB_FUTEX
+#define NEWLIB_FUTEX
+
+#include <newlib/impl/cenv.h>
+#include <stdint.h>
+
+// locks that live in the caller's memory, and only enter the kernel to sleep when contended or to
+// wake a sleeper; usable between threads, or between processes that share the memory they are in
+
+// 0 = unlocked, 1 = locked, 2 = locked and some other thread may be sleeping on it
+typedef struct {
+    uint32_t word;
+} futex_mutex_t;
+
+// a sequence number that changes every time the condition is signalled
+typedef struct {
+    uint32_t seq;
+} futex_cond_t;
+
+typedef struct {
+    uint32_t value;
+    uint32_t sleepers;
+} futex_sem_t;
+
+#define FUTEX_MUTEX_INITIALIZER { 0 }
+#define FUTEX_COND_INITIALIZER { 0 }
+#define FUTEX_SEM_INITIALIZER(v) { (v), 0 }
+
+// sleeps if *word == expected, until woken or timeout milliseconds (0 == forever) have passed;
+// returns 0 when woken, EAGAIN if the word had already changed, ETIMEDOUT or EFAULT
+NEWLIB_IMPL_REQUIREMENT int futex_wait(uint32_t* word, uint32_t expected, uint32_t timeout);
+// wakes at most count sleepers on word, and returns how many were woken
+NEWLIB_IMPL_REQUIREMENT uint32_t futex_wake(uint32_t* word, uint32_t count);
+
+NEWLIB_IMPL_REQUIREMENT void futex_mutex_init(futex_mutex_t*);
+NEWLIB_IMPL_REQUIREMENT void futex_mutex_lock(futex_mutex_t*);
+NEWLIB_IMPL_REQUIREMENT bool futex_mutex_trylock(futex_mutex_t*);
+NEWLIB_IMPL_REQUIREMENT void futex_mutex_unlock(futex_mutex_t*);
+
+NEWLIB_IMPL_REQUIREMENT void futex_cond_init(futex_cond_t*);
+// the mutex must be held, and is held again on return; like any condition variable, wakeups can be spurious
+NEWLIB_IMPL_REQUIREMENT void futex_cond_wait(futex_cond_t*, futex_mutex_t*);
+NEWLIB_IMPL_REQUIREMENT void futex_cond_signal(futex_cond_t*);
+NEWLIB_IMPL_REQUIREMENT void futex_cond_broadcast(futex_cond_t*);
+
+NEWLIB_IMPL_REQUIREMENT void futex_sem_init(futex_sem_t*, uint32_t value);
+NEWLIB_IMPL_REQUIREMENT void futex_sem_wait(futex_sem_t*);
+NEWLIB_IMPL_REQUIREMENT bool futex_sem_trywait(futex_sem_t*);
+// returns false if timeout milliseconds passed without the semaphore becoming available
+NEWLIB_IMPL_REQUIREMENT bool futex_sem_timedwait(futex_sem_t*, uint32_t timeout);
+NEWLIB_IMPL_REQUIREMENT void futex_sem_post(futex_sem_t*);
+
+#endif
@@ -54,6 +54,11 @@ extern "C" {
 void *mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset);
 int munmap(void *addr, size_t length);
 
+// shared memory objects live under /shm; mapping one with MAP_SHARED and PROT_WRITE lets every process
+// that maps it see the same memory, and ftruncate() sets its size
+int shm_open(const char *name, int oflag, mode_t mode);
+int shm_unlink(const char *name);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,27 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef NEWLIB_MSGQUEUE
+#define NEWLIB_MSGQUEUE
+
+#include <newlib/impl/cenv.h>
+#include <newlib/syscalls.h>
+#include <stddef.h>
+
+// sends size bytes at data on the message queue open for writing at fd, and returns how it went.
+// A page-aligned page of the caller's private memory is given to the reader rather than copied (and
+// reads back as zeros afterwards); any other page-sized payload, e.g. one in a file's data, is copied
+// to a new page instead. Either way, the reader finds the page at header.page of the message it reads
+NEWLIB_IMPL_REQUIREMENT msgqueue_send_t::path_t msgqueue_send(int fd, const void* data, size_t size);
+
+#endif
@@ -7,5 +7,6 @@
 # 21 "/home/egranata/puppy/out/mnt/include/kernel/sys/features.tbl"
 static constexpr feature_id_t gFeatureIdPuppy = 0x0000000000000000;
 static constexpr feature_id_t gFeatureIdExecInheritsSystem = 0x0000000000000EEC;
+static constexpr feature_id_t gFeatureIdSysenter = 0x00000000000005E5;
 static constexpr feature_id_t gFeatureIdInvalid = 0xFEAFEAFEAFEAFEA0;
 # 16 "/home/egranata/puppy/newlib/include/sys/osfeatures.h.in" 2
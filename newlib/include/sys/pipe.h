@@ -0,0 +1,24 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef NEWLIB_PIPE
+#define NEWLIB_PIPE
+
+#include <newlib/impl/cenv.h>
+#include <stdlib.h>
+
+// like pipe(), but with room for capacity bytes in flight rather than one page; the kernel rounds
+// capacity up to a whole number of pages, up to a limit of 256KB
+NEWLIB_IMPL_REQUIREMENT int pipe_with_capacity(int fd[2], size_t capacity);
+
+#endif
@@ -0,0 +1,32 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef NEWLIB_POLLSET
+#define NEWLIB_POLLSET
+
+#include <newlib/impl/cenv.h>
+#include <newlib/poll.h>
+
+// a poll set remembers which files it watches, so that waiting on it only costs as much as the number
+// of files that changed, rather than the number of files in it; it is itself a file, closed with close().
+// Readiness is level-triggered, and a watched file stays open until it is removed from the set (or the
+// set is closed), even if its descriptor is closed first
+
+// returns a descriptor for a new, empty, poll set
+NEWLIB_IMPL_REQUIREMENT int pollset_create();
+// watches fd for events (POLLIN, POLLOUT); events == 0 stops watching it
+NEWLIB_IMPL_REQUIREMENT int pollset_ctl(int set, int fd, short events);
+// fills in up to n ready files, and returns how many there were; timeout is as for poll()
+NEWLIB_IMPL_REQUIREMENT int pollset_wait(int set, struct pollfd* ready, nfds_t n, int timeout);
+
+#endif
@@ -81,6 +81,7 @@ struct	stat
 #define		_IFSEMAPHORE	  0240000	/* semaphore */
 #define		_IFMUTEX	      0270000	/* mutex */
 #define		_IFEVENT	      0300000	/* event */
+#define		_IFSHM	        0330000	/* shared memory */
 
 #define 	S_BLKSIZE  1024 /* size of a block */
 
@@ -107,6 +108,7 @@ struct	stat
 #define S_IFSEMAPHORE  _IFSEMAPHORE
 #define S_IFMUTEX      _IFMUTEX
 #define S_IFEVENT      _IFEVENT
+#define S_IFSHM        _IFSHM
 
 #define	S_IRWXU 	(S_IRUSR | S_IWUSR | S_IXUSR)
 #define		S_IRUSR	0000400	/* read permission, owner */
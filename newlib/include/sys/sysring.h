@@ -0,0 +1,38 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef NEWLIB_SYSRING
+#define NEWLIB_SYSRING
+
+#include <newlib/impl/cenv.h>
+#include <newlib/syscalls.h>
+#include <stdint.h>
+
+// a syscall ring lets a process queue many system calls and have the kernel run them all on one trip
+// into it (or on none, with a poller thread); results come back in the order the calls ran, tagged
+// with the userdata each was submitted with. A process has at most one ring
+
+// maps and registers a ring with room for entries calls in flight, a power of two up to
+// syscall_ring_t::gMaxEntries; with poll set, the kernel runs submissions without sysring_enter
+NEWLIB_IMPL_REQUIREMENT syscall_ring_t* sysring_create(uint32_t entries, bool poll);
+
+// queues system call code with argc arguments; returns false if the submission queue is full
+NEWLIB_IMPL_REQUIREMENT bool sysring_submit(syscall_ring_t*, uint32_t userdata, uint8_t code, uint32_t argc, const uint32_t* args);
+
+// has the kernel run up to max queued calls right now, and returns how many ran
+NEWLIB_IMPL_REQUIREMENT uint32_t sysring_enter(syscall_ring_t*, uint32_t max);
+
+// takes the oldest completion off the ring; returns false if there is none
+NEWLIB_IMPL_REQUIREMENT bool sysring_reap(syscall_ring_t*, uint32_t* userdata, syscall_response_t* result);
+
+#endif
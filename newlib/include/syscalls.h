@@ -93,7 +93,7 @@ syscall_response_t vmcheckreadable_syscall(uintptr_t arg1,size_t arg2);
 constexpr uint8_t vmcheckreadable_syscall_id = 0x24;
 syscall_response_t vmcheckwritable_syscall(uintptr_t arg1,size_t arg2);
 constexpr uint8_t vmcheckwritable_syscall_id = 0x25;
-syscall_response_t pipe_syscall(size_t* arg1,size_t* arg2);
+syscall_response_t pipe_syscall(size_t* arg1,size_t* arg2,size_t arg3);
 constexpr uint8_t pipe_syscall_id = 0x26;
 syscall_response_t mmap_syscall(size_t arg1,int arg2);
 constexpr uint8_t mmap_syscall_id = 0x27;
@@ -103,5 +103,27 @@ syscall_response_t fsinfo_syscall(const char* arg1,filesystem_info_t* arg2);
 constexpr uint8_t fsinfo_syscall_id = 0x29;
 syscall_response_t checkfeatures_syscall(feature_id_t* arg1);
 constexpr uint8_t checkfeatures_syscall_id = 0x2a;
+syscall_response_t usleep_syscall(uint32_t arg1);
+constexpr uint8_t usleep_syscall_id = 0x2b;
+syscall_response_t threadcreate_syscall(uintptr_t arg1,uintptr_t arg2);
+constexpr uint8_t threadcreate_syscall_id = 0x2c;
+syscall_response_t threadexit_syscall(bool arg1);
+constexpr uint8_t threadexit_syscall_id = 0x2d;
+syscall_response_t futexwait_syscall(uint32_t* arg1,uint32_t arg2,uint32_t arg3);
+constexpr uint8_t futexwait_syscall_id = 0x2e;
+syscall_response_t futexwake_syscall(uint32_t* arg1,uint32_t arg2);
+constexpr uint8_t futexwake_syscall_id = 0x2f;
+syscall_response_t ringsetup_syscall(syscall_ring_t* arg1,uint32_t arg2);
+constexpr uint8_t ringsetup_syscall_id = 0x30;
+syscall_response_t ringenter_syscall(uint32_t arg1);
+constexpr uint8_t ringenter_syscall_id = 0x31;
+syscall_response_t poll_syscall(poll_entry_t* arg1,size_t arg2,uint32_t arg3);
+constexpr uint8_t poll_syscall_id = 0x32;
+syscall_response_t pollset_syscall(size_t* arg1);
+constexpr uint8_t pollset_syscall_id = 0x33;
+syscall_response_t pollsetctl_syscall(uint16_t arg1,int32_t arg2,uint32_t arg3);
+constexpr uint8_t pollsetctl_syscall_id = 0x34;
+syscall_response_t pollsetwait_syscall(uint16_t arg1,poll_entry_t* arg2,size_t arg3,uint32_t arg4);
+constexpr uint8_t pollsetwait_syscall_id = 0x35;
 
 #endif
\ No newline at end of file
@@ -159,6 +159,22 @@ static scoped_ptr_t<char> doRealpath(const char *__restrict path) {
     return resolved_path;
 }
 
+// would doRealpath() give back the same path? It is if there are no . or .. components, no empty
+// ones and no trailing /
+static bool isNormalPath(const char* path) {
+    if (path == nullptr || path[0] != '/') return false;
+    const char* component = path + 1;
+    while (true) {
+        auto end = strchr(component, '/');
+        size_t len = end ? end - component : strlen(component);
+        // an empty component is either the root itself, or comes from a // or a trailing /
+        if (len == 0) return end == nullptr && component == path + 1;
+        if (component[0] == '.' && (len == 1 || (len == 2 && component[1] == '.'))) return false;
+        if (end == nullptr) return true;
+        component = end + 1;
+    }
+}
+
 // is this a path relative to the home folder?
 static bool isHomePath(const char* path) {
     if (path == nullptr) return false;
@@ -183,6 +199,8 @@ scoped_ptr_t<char> newlib::puppy::impl::makeAbsolutePath(const char* path) {
     }
 
     scoped_ptr_t<char> concat = concatPaths(base.ptr, path);
+    // most relative paths are plain names below the current directory; those need no more copies
+    if (isNormalPath(concat.ptr)) return concat;
     scoped_ptr_t<char> rp = doRealpath(concat.ptr);
 
     return rp;
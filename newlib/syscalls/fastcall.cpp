@@ -0,0 +1,39 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <newlib/sys/fastcall.h>
+#include <newlib/syscalls.h>
+#include <newlib/sys/osfeatures.h>
+
+// see syscalls.s
+NEWLIB_IMPL_REQUIREMENT uint8_t syscall_use_sysenter;
+
+static bool kernelHasSysenter() {
+    feature_id_t features[] = {gFeatureIdSysenter, 0};
+    return 0 == checkfeatures_syscall(features);
+}
+
+// called by crt0 before anything else gets to make a system call
+NEWLIB_IMPL_REQUIREMENT void __syscall_init() {
+    syscall_use_sysenter = kernelHasSysenter() ? 1 : 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT bool syscall_fastpath() {
+    return syscall_use_sysenter != 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT bool syscall_set_fastpath(bool fast) {
+    syscall_use_sysenter = (fast && kernelHasSysenter()) ? 1 : 0;
+    return syscall_fastpath();
+}
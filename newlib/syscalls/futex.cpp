@@ -0,0 +1,120 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <newlib/sys/futex.h>
+#include <newlib/syscalls.h>
+#include <newlib/sys/errno.h>
+
+NEWLIB_IMPL_REQUIREMENT int futex_wait(uint32_t* word, uint32_t expected, uint32_t timeout) {
+    auto ok = futexwait_syscall(word, expected, timeout);
+    if (ok & 1) return EFAULT;
+    switch (ok >> 1) {
+        case 0: return 0;
+        case 1: return EAGAIN;
+        default: return ETIMEDOUT;
+    }
+}
+
+NEWLIB_IMPL_REQUIREMENT uint32_t futex_wake(uint32_t* word, uint32_t count) {
+    auto ok = futexwake_syscall(word, count);
+    if (ok & 1) return 0;
+    return ok >> 1;
+}
+
+// the mutex follows "Futexes Are Tricky" (Drepper): an unlock only calls into the kernel if the
+// word says there may be a sleeper, and a thread that has slept always relocks in that state
+NEWLIB_IMPL_REQUIREMENT void futex_mutex_init(futex_mutex_t* m) {
+    __atomic_store_n(&m->word, 0, __ATOMIC_RELEASE);
+}
+
+NEWLIB_IMPL_REQUIREMENT bool futex_mutex_trylock(futex_mutex_t* m) {
+    uint32_t c = 0;
+    return __atomic_compare_exchange_n(&m->word, &c, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_mutex_lock(futex_mutex_t* m) {
+    uint32_t c = 0;
+    if (__atomic_compare_exchange_n(&m->word, &c, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return;
+
+    if (c != 2) c = __atomic_exchange_n(&m->word, 2, __ATOMIC_ACQUIRE);
+    while (c != 0) {
+        futex_wait(&m->word, 2, 0);
+        c = __atomic_exchange_n(&m->word, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_mutex_unlock(futex_mutex_t* m) {
+    if (__atomic_fetch_sub(&m->word, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(&m->word, 0, __ATOMIC_RELEASE);
+        futex_wake(&m->word, 1);
+    }
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_cond_init(futex_cond_t* c) {
+    __atomic_store_n(&c->seq, 0, __ATOMIC_RELEASE);
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_cond_wait(futex_cond_t* c, futex_mutex_t* m) {
+    auto seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+    futex_mutex_unlock(m);
+    // a signal that comes in after the unlock changes seq, and the kernel will then refuse to sleep
+    futex_wait(&c->seq, seq, 0);
+
+    // other threads may have been woken along with this one, so take the mutex as contended
+    while (__atomic_exchange_n(&m->word, 2, __ATOMIC_ACQUIRE) != 0) {
+        futex_wait(&m->word, 2, 0);
+    }
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_cond_signal(futex_cond_t* c) {
+    __atomic_add_fetch(&c->seq, 1, __ATOMIC_ACQ_REL);
+    futex_wake(&c->seq, 1);
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_cond_broadcast(futex_cond_t* c) {
+    __atomic_add_fetch(&c->seq, 1, __ATOMIC_ACQ_REL);
+    futex_wake(&c->seq, UINT32_MAX);
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_sem_init(futex_sem_t* s, uint32_t value) {
+    __atomic_store_n(&s->sleepers, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&s->value, value, __ATOMIC_RELEASE);
+}
+
+NEWLIB_IMPL_REQUIREMENT bool futex_sem_trywait(futex_sem_t* s) {
+    auto v = __atomic_load_n(&s->value, __ATOMIC_ACQUIRE);
+    while (v > 0) {
+        if (__atomic_compare_exchange_n(&s->value, &v, v - 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return true;
+    }
+    return false;
+}
+
+NEWLIB_IMPL_REQUIREMENT bool futex_sem_timedwait(futex_sem_t* s, uint32_t timeout) {
+    while (!futex_sem_trywait(s)) {
+        __atomic_add_fetch(&s->sleepers, 1, __ATOMIC_ACQ_REL);
+        auto ok = futex_wait(&s->value, 0, timeout);
+        __atomic_sub_fetch(&s->sleepers, 1, __ATOMIC_ACQ_REL);
+        if (ok == ETIMEDOUT || ok == EFAULT) return false;
+    }
+    return true;
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_sem_wait(futex_sem_t* s) {
+    futex_sem_timedwait(s, 0);
+}
+
+NEWLIB_IMPL_REQUIREMENT void futex_sem_post(futex_sem_t* s) {
+    __atomic_add_fetch(&s->value, 1, __ATOMIC_ACQ_REL);
+    if (__atomic_load_n(&s->sleepers, __ATOMIC_ACQUIRE)) futex_wake(&s->value, 1);
+}
@@ -23,6 +23,7 @@ extern "C" char **environ;
 #include <newlib/sys/fcntl.h>
 #include <newlib/sys/times.h>
 #include <newlib/sys/time.h>
+#include <newlib/time.h>
 #include <newlib/stdio.h>
 #include <newlib/syscalls.h>
 #include <newlib/stdlib.h>
@@ -33,7 +34,9 @@ extern "C" char **environ;
 #include <newlib/impl/scoped_ptr.h>
 #include <newlib/impl/cenv.h>
 #include <newlib/impl/klog.h>
+#include <newlib/impl/kerneldata.h>
 #include <newlib/sys/process.h>
+#include <newlib/sys/pipe.h>
 #include <kernel/syscalls/types.h>
 
 #define ERR_EXIT(ev) { \
@@ -73,8 +76,13 @@ NEWLIB_IMPL_REQUIREMENT int fork() {
   return -1;
 }
 
+NEWLIB_IMPL_REQUIREMENT int sched_yield() {
+    yield_syscall();
+    return 0;
+}
+
 NEWLIB_IMPL_REQUIREMENT int getpid() {
-    return getpid_syscall() >> 1;
+    return newlib::puppy::impl::pid();
 }
 
 NEWLIB_IMPL_REQUIREMENT int getppid() {
@@ -115,6 +123,7 @@ NEWLIB_IMPL_REQUIREMENT int fstat(int fd, struct stat* st) {
             MATCH(semaphore,   S_IFSEMAPHORE);
             MATCH(mutex,       S_IFMUTEX);
             MATCH(event,       S_IFEVENT);
+            MATCH(shm,         S_IFSHM);
         }
         st->st_size = fs.size;
         st->st_atime = fs.time;
@@ -291,17 +300,32 @@ NEWLIB_IMPL_REQUIREMENT int write(int file, char *ptr, int len) {
 }
 
 NEWLIB_IMPL_REQUIREMENT int gettimeofday (struct timeval *__restrict __p, void *__restrict /**__tz: no timezone support */) {
-    char* buf = nullptr;
-    size_t n = 0;
-    FILE *f = fopen("/devices/time/now", "r");
-    if (f == nullptr) return -1;
-    __getline(&buf, &n, f);
-    fclose(f);
-    __p->tv_sec = atoll(buf);
-    free(buf);
+    auto now = newlib::puppy::impl::unixtime();
+    __p->tv_sec = now.seconds;
+    __p->tv_usec = now.micros;
     return 0;
 }
 
+NEWLIB_IMPL_REQUIREMENT int clock_gettime(clockid_t clock_id, struct timespec *tp) {
+    if (tp == nullptr) ERR_EXIT(EFAULT);
+    switch (clock_id) {
+        case CLOCK_REALTIME: {
+            auto now = newlib::puppy::impl::unixtime();
+            tp->tv_sec = now.seconds;
+            tp->tv_nsec = 1000 * now.micros;
+            return 0;
+        }
+        case CLOCK_MONOTONIC: {
+            auto micros = newlib::puppy::impl::microsUptime();
+            tp->tv_sec = micros / 1000000;
+            tp->tv_nsec = 1000 * (micros % 1000000);
+            return 0;
+        }
+        default:
+            ERR_EXIT(EINVAL);
+    }
+}
+
 NEWLIB_IMPL_REQUIREMENT int mkdir(const char *path, mode_t /**mode: no mode support*/) {
     if (path == nullptr || path[0] == 0) ERR_EXIT(ENOENT);
     auto rp = newlib::puppy::impl::makeAbsolutePath(path);
@@ -329,6 +353,15 @@ NEWLIB_IMPL_REQUIREMENT int ioctl(int fd, int a, int b) {
     return io >> 1;
 }
 
+// only shared memory objects can change size in place
+NEWLIB_IMPL_REQUIREMENT int ftruncate(int fd, off_t length) {
+    struct stat st;
+    if (0 != fstat(fd, &st)) ERR_EXIT(EBADF);
+    if (st.st_mode != S_IFSHM || length < 0) ERR_EXIT(EINVAL);
+    if (1 != ioctl(fd, IOCTL_SHM_RESIZE, length)) ERR_EXIT(EFBIG);
+    return 0;
+}
+
 static int newProcessImpl(const char* path, char** args, char** env, int flags, exec_fileop_t* fops) {
     if (path == nullptr || path[0] == 0) ERR_EXIT(ENOENT);
     auto rp = newlib::puppy::impl::makeAbsolutePath(path);
@@ -359,6 +392,25 @@ NEWLIB_IMPL_REQUIREMENT unsigned int sleep(unsigned int seconds) {
     return 0;
 }
 
+NEWLIB_IMPL_REQUIREMENT int usleep(useconds_t usec) {
+    usleep_syscall(usec);
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int nanosleep(const struct timespec *rqtp, struct timespec *rmtp) {
+    if (rqtp == nullptr || rqtp->tv_nsec < 0 || rqtp->tv_nsec >= 1000000000) ERR_EXIT(EINVAL);
+
+    // round up, so that the sleep is never shorter than requested
+    uint64_t usec = 1000000ull * rqtp->tv_sec + (rqtp->tv_nsec + 999) / 1000;
+    while (usec > 0) {
+        uint32_t chunk = usec > 0xFFFFFFFFull ? 0xFFFFFFFF : (uint32_t)usec;
+        usleep_syscall(chunk);
+        usec -= chunk;
+    }
+    if (rmtp) rmtp->tv_sec = rmtp->tv_nsec = 0;
+    return 0;
+}
+
 NEWLIB_IMPL_REQUIREMENT int chdir(const char *path) {
     if (path == nullptr || path[0] == 0) ERR_EXIT(EFAULT);
     auto rp = newlib::puppy::impl::makeAbsolutePath(path);
@@ -370,7 +422,11 @@ NEWLIB_IMPL_REQUIREMENT int chdir(const char *path) {
 }
 
 NEWLIB_IMPL_REQUIREMENT int pipe (int fd[2]) {
-    size_t pipe_ok = pipe_syscall((size_t*)&fd[0], (size_t*)&fd[1]);
+    return pipe_with_capacity(fd, 0);
+}
+
+NEWLIB_IMPL_REQUIREMENT int pipe_with_capacity(int fd[2], size_t capacity) {
+    size_t pipe_ok = pipe_syscall((size_t*)&fd[0], (size_t*)&fd[1], capacity);
     if (pipe_ok & 1) ERR_EXIT(EMFILE);
     return 0;
 }
@@ -0,0 +1,66 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <newlib/impl/kerneldata.h>
+#include <kernel/syscalls/types.h>
+
+namespace {
+    uint64_t readtsc() {
+        uint32_t lo, hi;
+        __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+        return ((uint64_t)hi << 32) | lo;
+    }
+
+    // a consistent copy of the page, taken while the kernel was not in the middle of updating it
+    kernel_data_t snapshot() {
+        auto page = (const kernel_data_t*)kernel_data_t::gAddress;
+        kernel_data_t copy;
+        uint32_t seq;
+        do {
+            seq = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+            copy = *page;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while ((seq & 1) || seq != __atomic_load_n(&page->seq, __ATOMIC_RELAXED));
+        return copy;
+    }
+
+    // same as TimeManager::microsUptime()
+    uint64_t microsUptime(const kernel_data_t& kd) {
+        if (kd.tsc.ticksPerMs == 0) return 1000 * kd.uptime;
+
+        auto delta = readtsc() - kd.tsc.base;
+        auto ms = delta / kd.tsc.ticksPerMs;
+        auto rest = delta % kd.tsc.ticksPerMs;
+        return kd.tsc.baseMicros + 1000 * ms + (1000 * rest) / kd.tsc.ticksPerMs;
+    }
+}
+
+uint64_t newlib::puppy::impl::microsUptime() {
+    return ::microsUptime(snapshot());
+}
+
+newlib::puppy::impl::unixtime_t newlib::puppy::impl::unixtime() {
+    auto kd = snapshot();
+    auto micros = ::microsUptime(kd);
+    // the clock only publishes whole seconds; the TSC fills in the time since the last one
+    auto elapsed = micros > kd.nowMicros ? micros - kd.nowMicros : 0;
+    return unixtime_t{
+        kd.now + elapsed / 1000000,
+        (uint32_t)(elapsed % 1000000)
+    };
+}
+
+uint32_t newlib::puppy::impl::pid() {
+    return ((const process_data_t*)process_data_t::gAddress)->pid;
+}
@@ -44,6 +44,9 @@ INLIB = "newlib/lib/libc.a"
 
 copy(INLIB, OUTFILE)
 
+# newlib's own malloc lock does nothing; mlock.cpp provides one that works with threads
+shell("i686-elf-ar d %s lib_a-mlock.o" % (OUTFILE))
+
 print("INFILES = %s" % (INFILES))
 
 shell("i686-elf-ar qs %s %s" % (OUTFILE, ' '.join(INFILES)))
@@ -0,0 +1,28 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <newlib/impl/cenv.h>
+#include <newlib/impl/threads.h>
+
+// these replace the no-op versions in the prebuilt libc.a (see linker.py); a single-threaded
+// process does not pay for the lock, and once there are threads malloc() may recurse into itself
+static newlib::puppy::impl::recursive_lock_t gMallocLock;
+
+NEWLIB_IMPL_REQUIREMENT void __malloc_lock(struct _reent*) {
+    if (newlib::puppy::impl::multithreaded()) gMallocLock.lock();
+}
+
+NEWLIB_IMPL_REQUIREMENT void __malloc_unlock(struct _reent*) {
+    if (newlib::puppy::impl::multithreaded()) gMallocLock.unlock();
+}
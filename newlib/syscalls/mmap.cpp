@@ -17,6 +17,10 @@
 #include <newlib/syscalls.h>
 #include <newlib/sys/vm.h>
 #include <newlib/sys/errno.h>
+#include <newlib/sys/stat.h>
+#include <newlib/fcntl.h>
+#include <newlib/stdio.h>
+#include <newlib/unistd.h>
 
 #define ERR_EXIT(ev) { \
     errno = ev; \
@@ -31,8 +35,12 @@ static uint8_t prefetch(uint8_t* addr, size_t length) {
 }
 
 NEWLIB_IMPL_REQUIREMENT void *mmap(void* /*addr*/, size_t length, int prot, int flags, int fd, off_t offset) {
-    if (prot & 2) ERR_EXIT(EINVAL);
-    if (flags & 2) ERR_EXIT(EINVAL);
+    // only shared memory can be written through a mapping, or shared by it
+    if ((prot & 2) || (flags & 2)) {
+        struct stat st;
+        if (flags & MAP_ANONYMOUS) ERR_EXIT(EINVAL);
+        if (0 != fstat(fd, &st) || st.st_mode != S_IFSHM) ERR_EXIT(EINVAL);
+    }
 
     if (offset != 0) ERR_EXIT(EINVAL);
 
@@ -53,3 +61,28 @@ NEWLIB_IMPL_REQUIREMENT void *mmap(void* /*addr*/, size_t length, int prot, int
 NEWLIB_IMPL_REQUIREMENT int munmap(void *addr, size_t /*length*/) {
     return unmapregion(addr);
 }
+
+static bool shm_path(const char* name, char* path, size_t size) {
+    if (name == nullptr) return false;
+    while (*name == '/') ++name;
+    if (*name == 0) return false;
+    return snprintf(path, size, "/shm/%s", name) < (int)size;
+}
+
+NEWLIB_IMPL_REQUIREMENT int shm_open(const char* name, int oflag, mode_t mode) {
+    char path[gMaxPathSize + 1];
+    if (!shm_path(name, path, sizeof(path))) {
+        errno = EINVAL;
+        return -1;
+    }
+    return open(path, oflag, mode);
+}
+
+NEWLIB_IMPL_REQUIREMENT int shm_unlink(const char* name) {
+    char path[gMaxPathSize + 1];
+    if (!shm_path(name, path, sizeof(path))) {
+        errno = EINVAL;
+        return -1;
+    }
+    return unlink(path);
+}
@@ -0,0 +1,26 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <newlib/sys/msgqueue.h>
+#include <newlib/sys/ioctl.h>
+
+NEWLIB_IMPL_REQUIREMENT msgqueue_send_t::path_t msgqueue_send(int fd, const void* data, size_t size) {
+    msgqueue_send_t msg;
+    msg.data = data;
+    msg.size = size;
+    msg.path = msgqueue_send_t::path_t::failed;
+    // ioctl() has already set errno if the queue was not there to send to
+    ioctl(fd, IOCTL_SEND_MESSAGE, (int)&msg);
+    return msg.path;
+}
@@ -0,0 +1,165 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <newlib/poll.h>
+#include <newlib/sys/pollset.h>
+#include <newlib/sys/select.h>
+#include <newlib/sys/errno.h>
+#include <newlib/malloc.h>
+#include <newlib/syscalls.h>
+#include <kernel/syscalls/types.h>
+
+// the kernel wants its own layout for the entries, so small calls convert on the stack and large ones on the heap
+static constexpr nfds_t gStackEntries = 16;
+
+namespace {
+    class entries_t {
+        public:
+            explicit entries_t(nfds_t n) : mEntries(n > gStackEntries ? (poll_entry_t*)calloc(n, sizeof(poll_entry_t)) : mLocal) {}
+            ~entries_t() {
+                if (mEntries != mLocal) free(mEntries);
+            }
+
+            poll_entry_t* get() { return mEntries; }
+            poll_entry_t& operator[](nfds_t i) { return mEntries[i]; }
+
+        private:
+            poll_entry_t mLocal[gStackEntries];
+            poll_entry_t* mEntries;
+    };
+}
+
+static uint32_t toKernelTimeout(int timeout) {
+    return timeout < 0 ? poll_entry_t::gForever : (uint32_t)timeout;
+}
+
+NEWLIB_IMPL_REQUIREMENT int poll(struct pollfd* fds, nfds_t n, int timeout) {
+    entries_t entries(n);
+    if (entries.get() == nullptr) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    for (auto i = 0u; i < n; ++i) {
+        entries[i] = {fds[i].fd, (uint16_t)fds[i].events, 0};
+    }
+    auto ok = poll_syscall(entries.get(), n, toKernelTimeout(timeout));
+    if (ok & 1) {
+        errno = EFAULT;
+        return -1;
+    }
+    for (auto i = 0u; i < n; ++i) {
+        fds[i].revents = (short)entries[i].revents;
+    }
+    return ok >> 1;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pollset_create() {
+    size_t fd;
+    if (pollset_syscall(&fd) & 1) {
+        errno = EMFILE;
+        return -1;
+    }
+    return fd;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pollset_ctl(int set, int fd, short events) {
+    if (pollsetctl_syscall(set, fd, (uint16_t)events) & 1) {
+        errno = EBADF;
+        return -1;
+    }
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pollset_wait(int set, struct pollfd* ready, nfds_t n, int timeout) {
+    entries_t entries(n);
+    if (entries.get() == nullptr) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    auto ok = pollsetwait_syscall(set, entries.get(), n, toKernelTimeout(timeout));
+    if (ok & 1) {
+        errno = EBADF;
+        return -1;
+    }
+    int count = ok >> 1;
+    for (auto i = 0; i < count; ++i) {
+        ready[i] = {entries[i].fd, (short)entries[i].events, (short)entries[i].revents};
+    }
+    return count;
+}
+
+// select() is poll() on every descriptor that is in any of the sets; an error or hangup makes a
+// descriptor readable (and writable, if it was asked about), as the next read or write will not block
+NEWLIB_IMPL_REQUIREMENT int select(int n, fd_set* readfds, fd_set* writefds, fd_set* exceptfds, struct timeval* timeout) {
+    auto isin = [] (fd_set* set, int fd) -> bool {
+        return set && FD_ISSET(fd, set);
+    };
+
+    nfds_t count = 0;
+    for (auto fd = 0; fd < n; ++fd) {
+        if (isin(readfds, fd) || isin(writefds, fd) || isin(exceptfds, fd)) ++count;
+    }
+
+    entries_t entries(count);
+    if (entries.get() == nullptr) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    count = 0;
+    for (auto fd = 0; fd < n; ++fd) {
+        uint32_t events = 0;
+        if (isin(readfds, fd)) events |= POLL_IN;
+        if (isin(writefds, fd)) events |= POLL_OUT;
+        if (events || isin(exceptfds, fd)) entries[count++] = {fd, events, 0};
+    }
+
+    uint32_t ms = poll_entry_t::gForever;
+    if (timeout) ms = timeout->tv_sec * 1000 + (timeout->tv_usec + 999) / 1000;
+
+    auto ok = poll_syscall(entries.get(), count, ms);
+    if (ok & 1) {
+        errno = EFAULT;
+        return -1;
+    }
+
+    if (readfds) FD_ZERO(readfds);
+    if (writefds) FD_ZERO(writefds);
+    if (exceptfds) FD_ZERO(exceptfds);
+
+    int result = 0;
+    for (auto i = 0u; i < count; ++i) {
+        auto& entry(entries[i]);
+        if (entry.revents & POLL_NVAL) {
+            errno = EBADF;
+            return -1;
+        }
+        const bool failed = entry.revents & (POLL_ERR | POLL_HUP);
+        if (readfds && (entry.events & POLL_IN) && (failed || (entry.revents & POLL_IN))) {
+            FD_SET(entry.fd, readfds);
+            ++result;
+        }
+        if (writefds && (entry.events & POLL_OUT) && (failed || (entry.revents & POLL_OUT))) {
+            FD_SET(entry.fd, writefds);
+            ++result;
+        }
+        if (exceptfds && failed) {
+            FD_SET(entry.fd, exceptfds);
+            ++result;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,438 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <newlib/impl/cenv.h>
+#include <newlib/impl/threads.h>
+#include <newlib/pthread.h>
+#include <newlib/sched.h>
+#include <newlib/stdlib.h>
+#include <newlib/string.h>
+#include <newlib/sys/errno.h>
+#include <newlib/sys/collect.h>
+#include <newlib/sys/futex.h>
+#include <newlib/syscalls.h>
+
+// threads are kernel processes sharing an address space, so a pthread_t is simply the pid of its thread;
+// mutexes and condition variables live in userspace, and only call into the kernel to sleep on a futex when contended
+
+// getpid() names the process as a whole, but every thread has a pid of its own in the kernel
+static uint32_t gettid() {
+    return getpid_syscall() >> 1;
+}
+
+namespace {
+    constexpr size_t gMaxKeys = 32;
+
+    struct thread_t {
+        thread_t* next;
+        pthread_t tid;
+        void* (*fn)(void*);
+        void* arg;
+        void* retval;
+        bool detached;
+        bool exited;
+        void* specific[gMaxKeys];
+    };
+
+    struct tskey_t {
+        bool used;
+        void (*destructor)(void*);
+    };
+
+    bool gMultithreaded = false;
+    newlib::puppy::impl::recursive_lock_t gThreadsLock;
+    thread_t* gThreads = nullptr;
+    tskey_t gKeys[gMaxKeys];
+
+    // must be called with gThreadsLock held
+    thread_t* find(pthread_t tid) {
+        for (auto t = gThreads; t; t = t->next) {
+            if (t->tid == tid) return t;
+        }
+        return nullptr;
+    }
+
+    // must be called with gThreadsLock held
+    void unlink(thread_t* thread) {
+        for (auto t = &gThreads; *t; t = &(*t)->next) {
+            if (*t == thread) {
+                *t = thread->next;
+                return;
+            }
+        }
+    }
+
+    // the main thread did not come from pthread_create(), so its record is made the first time it is needed
+    thread_t* self() {
+        pthread_t tid = gettid();
+        gThreadsLock.lock();
+        auto t = find(tid);
+        if (t == nullptr) {
+            t = (thread_t*)calloc(1, sizeof(thread_t));
+            t->tid = tid;
+            t->next = gThreads;
+            gThreads = t;
+        }
+        gThreadsLock.unlock();
+        return t;
+    }
+
+    void trampoline(thread_t* t) {
+        t->tid = gettid();
+        pthread_exit(t->fn(t->arg));
+    }
+
+    // mutex word: owner tid in bits 16-31, recursive flag in bit 15, sleepers flag in bit 14, lock count in bits 0-13
+    constexpr uint32_t gMutexRecursive = 0x8000;
+    constexpr uint32_t gMutexSleepers = 0x4000;
+    constexpr uint32_t gMutexCountMask = 0x3FFF;
+
+    uint32_t* mutexword(pthread_mutex_t* mutex) {
+        uint32_t expected = _PTHREAD_MUTEX_INITIALIZER;
+        __atomic_compare_exchange_n(mutex, &expected, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+        return (uint32_t*)mutex;
+    }
+}
+
+bool newlib::puppy::impl::multithreaded() {
+    return __atomic_load_n(&gMultithreaded, __ATOMIC_ACQUIRE);
+}
+
+void newlib::puppy::impl::setMultithreaded() {
+    __atomic_store_n(&gMultithreaded, true, __ATOMIC_RELEASE);
+}
+
+void newlib::puppy::impl::recursive_lock_t::lock() {
+    uint32_t tid = gettid();
+    if (__atomic_load_n(&owner, __ATOMIC_ACQUIRE) == tid) {
+        ++count;
+        return;
+    }
+    while (true) {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&owner, &expected, tid, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) break;
+        sched_yield();
+    }
+    count = 1;
+}
+
+void newlib::puppy::impl::recursive_lock_t::unlock() {
+    if (--count == 0) __atomic_store_n(&owner, 0, __ATOMIC_RELEASE);
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_attr_init(pthread_attr_t* attr) {
+    bzero(attr, sizeof(*attr));
+    attr->is_initialized = 1;
+    attr->detachstate = PTHREAD_CREATE_JOINABLE;
+    attr->stacksize = 1024 * 1024;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_attr_destroy(pthread_attr_t* attr) {
+    attr->is_initialized = 0;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_attr_setdetachstate(pthread_attr_t* attr, int state) {
+    if (state != PTHREAD_CREATE_JOINABLE && state != PTHREAD_CREATE_DETACHED) return EINVAL;
+    attr->detachstate = state;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_attr_getdetachstate(const pthread_attr_t* attr, int* state) {
+    *state = attr->detachstate;
+    return 0;
+}
+
+// the kernel gives every thread a stack of the same fixed size, so this is only recorded
+NEWLIB_IMPL_REQUIREMENT int pthread_attr_setstacksize(pthread_attr_t* attr, size_t size) {
+    attr->stacksize = size;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_attr_getstacksize(const pthread_attr_t* attr, size_t* size) {
+    *size = attr->stacksize;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*fn)(void*), void* arg) {
+    auto t = (thread_t*)calloc(1, sizeof(thread_t));
+    if (t == nullptr) return EAGAIN;
+    t->fn = fn;
+    t->arg = arg;
+    t->detached = (attr != nullptr) && (attr->detachstate == PTHREAD_CREATE_DETACHED);
+
+    // the new thread may allocate memory as soon as it exists, so locking has to start now
+    newlib::puppy::impl::setMultithreaded();
+
+    gThreadsLock.lock();
+    t->next = gThreads;
+    gThreads = t;
+    auto ok = threadcreate_syscall((uintptr_t)trampoline, (uintptr_t)t);
+    if (ok & 1) {
+        unlink(t);
+        gThreadsLock.unlock();
+        free(t);
+        return EAGAIN;
+    }
+    t->tid = ok >> 1;
+    gThreadsLock.unlock();
+
+    *thread = t->tid;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT void pthread_exit(void* value) {
+    auto t = self();
+    t->retval = value;
+
+    for (auto i = 0u; i < gMaxKeys; ++i) {
+        auto v = t->specific[i];
+        if (v && gKeys[i].used && gKeys[i].destructor) {
+            t->specific[i] = nullptr;
+            gKeys[i].destructor(v);
+        }
+    }
+
+    gThreadsLock.lock();
+    t->exited = true;
+    const bool detached = t->detached;
+    if (detached) unlink(t);
+    gThreadsLock.unlock();
+
+    // nobody is going to join a detached thread, so its record can go right away
+    if (detached) free(t);
+    threadexit_syscall(detached);
+    while(true);
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_join(pthread_t thread, void** value) {
+    if (thread == pthread_self()) return EDEADLK;
+
+    gThreadsLock.lock();
+    auto t = find(thread);
+    const bool joinable = t && !t->detached;
+    gThreadsLock.unlock();
+    if (t == nullptr) return ESRCH;
+    if (!joinable) return EINVAL;
+
+    collect(thread);
+
+    gThreadsLock.lock();
+    if (value) *value = t->retval;
+    unlink(t);
+    gThreadsLock.unlock();
+    free(t);
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_detach(pthread_t thread) {
+    gThreadsLock.lock();
+    auto t = find(thread);
+    if (t == nullptr) {
+        gThreadsLock.unlock();
+        return ESRCH;
+    }
+    if (t->detached) {
+        gThreadsLock.unlock();
+        return EINVAL;
+    }
+    t->detached = true;
+    // too late for the thread to hand itself over to the kernel's collector, so collect it here
+    const bool exited = t->exited;
+    if (exited) unlink(t);
+    gThreadsLock.unlock();
+
+    if (exited) {
+        collect(thread);
+        free(t);
+    }
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT pthread_t pthread_self() {
+    return gettid();
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_equal(pthread_t t1, pthread_t t2) {
+    return t1 == t2;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_once(pthread_once_t* once, void (*fn)(void)) {
+    // init_executed: 0 = not run, 2 = running, 1 = done
+    int expected = 0;
+    if (__atomic_compare_exchange_n(&once->init_executed, &expected, 2, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        fn();
+        __atomic_store_n(&once->init_executed, 1, __ATOMIC_RELEASE);
+        return 0;
+    }
+    while (__atomic_load_n(&once->init_executed, __ATOMIC_ACQUIRE) != 1) sched_yield();
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutexattr_init(pthread_mutexattr_t* attr) {
+    bzero(attr, sizeof(*attr));
+    attr->is_initialized = 1;
+    attr->type = PTHREAD_MUTEX_DEFAULT;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutexattr_destroy(pthread_mutexattr_t* attr) {
+    attr->is_initialized = 0;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutexattr_settype(pthread_mutexattr_t* attr, int type) {
+    if (type < PTHREAD_MUTEX_NORMAL || type > PTHREAD_MUTEX_DEFAULT) return EINVAL;
+    attr->type = type;
+    attr->recursive = (type == PTHREAD_MUTEX_RECURSIVE);
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutexattr_gettype(const pthread_mutexattr_t* attr, int* type) {
+    *type = attr->type;
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutex_init(pthread_mutex_t* mutex, const pthread_mutexattr_t* attr) {
+    const bool recursive = attr && attr->recursive;
+    __atomic_store_n(mutex, recursive ? gMutexRecursive : 0, __ATOMIC_RELEASE);
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutex_destroy(pthread_mutex_t* mutex) {
+    if (*mutexword(mutex) & gMutexCountMask) return EBUSY;
+    return 0;
+}
+
+// takes an unlocked mutex; a thread that had to sleep for it leaves the sleepers flag set, as it cannot
+// know whether it was the only one sleeping
+static int acquire(uint32_t* word, uint32_t tid, uint32_t flags) {
+    uint32_t current = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+    while (true) {
+        if (current & gMutexCountMask) {
+            // only the owner of a recursive mutex gets to lock it again
+            if ((current >> 16) != tid || 0 == (current & gMutexRecursive)) return EBUSY;
+            if ((current & gMutexCountMask) == gMutexCountMask) return EAGAIN;
+        }
+        uint32_t desired = (current & gMutexCountMask) ? current + 1 : (tid << 16) | (current & gMutexRecursive) | flags | 1;
+        if (__atomic_compare_exchange_n(word, &current, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return 0;
+    }
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutex_trylock(pthread_mutex_t* mutex) {
+    return acquire(mutexword(mutex), gettid(), 0);
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    auto word = mutexword(mutex);
+    const uint32_t tid = gettid();
+
+    auto ok = acquire(word, tid, 0);
+    while (ok == EBUSY) {
+        // flag the mutex as having a sleeper, and sleep for as long as it stays locked
+        uint32_t current = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+        if (current & gMutexCountMask) {
+            uint32_t desired = current | gMutexSleepers;
+            if (current == desired || __atomic_compare_exchange_n(word, &current, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                futex_wait(word, desired, 0);
+            }
+        }
+        ok = acquire(word, tid, gMutexSleepers);
+    }
+    return ok;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_mutex_unlock(pthread_mutex_t* mutex) {
+    auto word = mutexword(mutex);
+    uint32_t current = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+    uint32_t desired;
+    do {
+        if ((current & gMutexCountMask) == 0) return EPERM;
+        if ((current >> 16) != (uint32_t)gettid()) return EPERM;
+        desired = current - 1;
+        if ((desired & gMutexCountMask) == 0) desired &= gMutexRecursive;
+    } while (!__atomic_compare_exchange_n(word, &current, desired, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+
+    // the kernel only gets involved when somebody could be sleeping on the mutex
+    if ((desired & gMutexCountMask) == 0 && (current & gMutexSleepers)) futex_wake(word, 1);
+    return 0;
+}
+
+// a condition variable is a sequence number; signalling bumps it, and waiters sleep until it changes
+NEWLIB_IMPL_REQUIREMENT int pthread_cond_init(pthread_cond_t* cond, const pthread_condattr_t*) {
+    __atomic_store_n(cond, 0, __ATOMIC_RELEASE);
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_cond_destroy(pthread_cond_t*) {
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    auto seq = __atomic_load_n(cond, __ATOMIC_ACQUIRE);
+    auto ok = pthread_mutex_unlock(mutex);
+    if (ok) return ok;
+    // a signal that comes in after the unlock changes the sequence number, and then the kernel does not sleep
+    futex_wait((uint32_t*)cond, seq, 0);
+    return pthread_mutex_lock(mutex);
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_cond_signal(pthread_cond_t* cond) {
+    __atomic_add_fetch(cond, 1, __ATOMIC_ACQ_REL);
+    futex_wake((uint32_t*)cond, 1);
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_cond_broadcast(pthread_cond_t* cond) {
+    __atomic_add_fetch(cond, 1, __ATOMIC_ACQ_REL);
+    futex_wake((uint32_t*)cond, UINT32_MAX);
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_key_create(pthread_key_t* key, void (*destructor)(void*)) {
+    gThreadsLock.lock();
+    for (auto i = 0u; i < gMaxKeys; ++i) {
+        if (!gKeys[i].used) {
+            gKeys[i].used = true;
+            gKeys[i].destructor = destructor;
+            gThreadsLock.unlock();
+            *key = i;
+            return 0;
+        }
+    }
+    gThreadsLock.unlock();
+    return EAGAIN;
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_key_delete(pthread_key_t key) {
+    if (key >= gMaxKeys) return EINVAL;
+    gThreadsLock.lock();
+    gKeys[key].used = false;
+    gKeys[key].destructor = nullptr;
+    for (auto t = gThreads; t; t = t->next) t->specific[key] = nullptr;
+    gThreadsLock.unlock();
+    return 0;
+}
+
+NEWLIB_IMPL_REQUIREMENT void* pthread_getspecific(pthread_key_t key) {
+    if (key >= gMaxKeys) return nullptr;
+    return self()->specific[key];
+}
+
+NEWLIB_IMPL_REQUIREMENT int pthread_setspecific(pthread_key_t key, const void* value) {
+    if (key >= gMaxKeys || !gKeys[key].used) return EINVAL;
+    self()->specific[key] = (void*)value;
+    return 0;
+}
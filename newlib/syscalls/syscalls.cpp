@@ -145,8 +145,8 @@ syscall_response_t vmcheckreadable_syscall(uintptr_t arg1,size_t arg2) {
 syscall_response_t vmcheckwritable_syscall(uintptr_t arg1,size_t arg2) {
 	return syscall2(vmcheckwritable_syscall_id,(uint32_t)arg1,(uint32_t)arg2);
 }
-syscall_response_t pipe_syscall(size_t* arg1,size_t* arg2) {
-	return syscall2(pipe_syscall_id,(uint32_t)arg1,(uint32_t)arg2);
+syscall_response_t pipe_syscall(size_t* arg1,size_t* arg2,size_t arg3) {
+	return syscall3(pipe_syscall_id,(uint32_t)arg1,(uint32_t)arg2,(uint32_t)arg3);
 }
 syscall_response_t mmap_syscall(size_t arg1,int arg2) {
 	return syscall2(mmap_syscall_id,(uint32_t)arg1,(uint32_t)arg2);
@@ -160,3 +160,36 @@ syscall_response_t fsinfo_syscall(const char* arg1,filesystem_info_t* arg2) {
 syscall_response_t checkfeatures_syscall(feature_id_t* arg1) {
 	return syscall1(checkfeatures_syscall_id,(uint32_t)arg1);
 }
+syscall_response_t usleep_syscall(uint32_t arg1) {
+	return syscall1(usleep_syscall_id,(uint32_t)arg1);
+}
+syscall_response_t threadcreate_syscall(uintptr_t arg1,uintptr_t arg2) {
+	return syscall2(threadcreate_syscall_id,(uint32_t)arg1,(uint32_t)arg2);
+}
+syscall_response_t threadexit_syscall(bool arg1) {
+	return syscall1(threadexit_syscall_id,(uint32_t)arg1);
+}
+syscall_response_t futexwait_syscall(uint32_t* arg1,uint32_t arg2,uint32_t arg3) {
+	return syscall3(futexwait_syscall_id,(uint32_t)arg1,(uint32_t)arg2,(uint32_t)arg3);
+}
+syscall_response_t futexwake_syscall(uint32_t* arg1,uint32_t arg2) {
+	return syscall2(futexwake_syscall_id,(uint32_t)arg1,(uint32_t)arg2);
+}
+syscall_response_t ringsetup_syscall(syscall_ring_t* arg1,uint32_t arg2) {
+	return syscall2(ringsetup_syscall_id,(uint32_t)arg1,(uint32_t)arg2);
+}
+syscall_response_t ringenter_syscall(uint32_t arg1) {
+	return syscall1(ringenter_syscall_id,(uint32_t)arg1);
+}
+syscall_response_t poll_syscall(poll_entry_t* arg1,size_t arg2,uint32_t arg3) {
+	return syscall3(poll_syscall_id,(uint32_t)arg1,(uint32_t)arg2,(uint32_t)arg3);
+}
+syscall_response_t pollset_syscall(size_t* arg1) {
+	return syscall1(pollset_syscall_id,(uint32_t)arg1);
+}
+syscall_response_t pollsetctl_syscall(uint16_t arg1,int32_t arg2,uint32_t arg3) {
+	return syscall3(pollsetctl_syscall_id,(uint32_t)arg1,(uint32_t)arg2,(uint32_t)arg3);
+}
+syscall_response_t pollsetwait_syscall(uint16_t arg1,poll_entry_t* arg2,size_t arg3,uint32_t arg4) {
+	return syscall4(pollsetwait_syscall_id,(uint32_t)arg1,(uint32_t)arg2,(uint32_t)arg3,(uint32_t)arg4);
+}
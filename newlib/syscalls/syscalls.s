@@ -12,11 +12,38 @@
 ; See the License for the specific language governing permissions and
 ; limitations under the License.
 
+; set at startup if the kernel supports sysenter - see fastcall.cpp
+global syscall_use_sysenter
+section .data
+syscall_use_sysenter:
+    db 0
+
+section .text
+
+; the system call number and arguments are already in their registers; sysenter does not
+; save a return address, so push one and point ebp at it, and the kernel resumes there with
+; esp == ebp. On the way back, sysexit clobbers ecx and edx
+%macro enter_kernel 0
+    cmp byte [syscall_use_sysenter], 0
+    je %%slow
+    push ebp
+    push dword %%resume
+    mov ebp, esp
+    sysenter
+%%resume:
+    add esp, 4
+    pop ebp
+    jmp %%done
+%%slow:
+    int 0x80
+%%done:
+%endmacro
+
 ; uint32_t syscall0(uint8_t n);
 global syscall0:
 syscall0:
     mov eax, [esp + 4]
-    int 0x80
+    enter_kernel
     ret
 
 ; uint32_t syscall1(uint8_t n, uint32_t arg0);
@@ -26,7 +53,7 @@ syscall1:
     xor eax, eax
     mov ebx, [esp + 12]
     mov al, [esp + 8]
-    int 0x80
+    enter_kernel
     pop ebx
     ret
 
@@ -39,7 +66,7 @@ syscall2:
     mov ecx, [esp + 20]
     mov ebx, [esp + 16]
     mov al, [esp + 12]
-    int 0x80
+    enter_kernel
     pop ecx
     pop ebx
     ret
@@ -55,7 +82,7 @@ syscall3:
     mov ecx, [esp + 24]
     mov ebx, [esp + 20]
     mov al, [esp + 16]
-    int 0x80
+    enter_kernel
     pop edx
     pop ecx
     pop ebx
@@ -74,7 +101,7 @@ syscall4:
     mov ecx, [esp + 28]
     mov ebx, [esp + 24]
     mov al, [esp + 20]
-    int 0x80
+    enter_kernel
     pop edi
     pop edx
     pop ecx
@@ -96,7 +123,7 @@ syscall5:
     mov ecx, [esp + 32]
     mov ebx, [esp + 28]
     mov al, [esp + 24]
-    int 0x80
+    enter_kernel
     pop esi
     pop edi
     pop edx
@@ -0,0 +1,70 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <newlib/sys/sysring.h>
+#include <newlib/sys/vm.h>
+#include <newlib/sys/errno.h>
+
+static constexpr uint32_t gPageSize = 4096;
+
+NEWLIB_IMPL_REQUIREMENT syscall_ring_t* sysring_create(uint32_t entries, bool poll) {
+    auto size = syscall_ring_t::size(entries);
+    size = (size + gPageSize - 1) & ~(gPageSize - 1);
+    auto ring = (syscall_ring_t*)mapregion(size, VM_REGION_READWRITE);
+    if (ring == nullptr) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+
+    ring->entries = entries;
+    if (ringsetup_syscall(ring, poll ? syscall_ring_t::POLL : 0) & 1) {
+        unmapregion(ring);
+        errno = EINVAL;
+        return nullptr;
+    }
+    return ring;
+}
+
+// only this side writes sqtail and cqhead, so they need no atomicity beyond publishing them
+// after the entries they cover
+NEWLIB_IMPL_REQUIREMENT bool sysring_submit(syscall_ring_t* ring, uint32_t userdata, uint8_t code, uint32_t argc, const uint32_t* args) {
+    auto tail = ring->sqtail;
+    if (tail - __atomic_load_n(&ring->sqhead, __ATOMIC_ACQUIRE) >= ring->entries) return false;
+
+    auto& sub(ring->submissions()[tail & (ring->entries - 1)]);
+    sub.userdata = userdata;
+    sub.code = code;
+    for (uint32_t i = 0; i < 5; ++i) {
+        sub.args[i] = (i < argc) ? args[i] : 0;
+    }
+    __atomic_store_n(&ring->sqtail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+NEWLIB_IMPL_REQUIREMENT uint32_t sysring_enter(syscall_ring_t*, uint32_t max) {
+    auto ok = ringenter_syscall(max);
+    if (ok & 1) return 0;
+    return ok >> 1;
+}
+
+NEWLIB_IMPL_REQUIREMENT bool sysring_reap(syscall_ring_t* ring, uint32_t* userdata, syscall_response_t* result) {
+    auto head = ring->cqhead;
+    if (head == __atomic_load_n(&ring->cqtail, __ATOMIC_ACQUIRE)) return false;
+
+    auto& cqe(ring->completions()[head & (ring->entries - 1)]);
+    *userdata = cqe.userdata;
+    *result = cqe.result;
+    __atomic_store_n(&ring->cqhead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <sys/collect.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+static constexpr uint32_t gNumYields = 20000;
+
+// the monotonic clock is read off the kernel data page, without a system call to skew the timing
+static uint64_t nanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void pingpong() {
+    for (auto i = 0u; i < gNumYields; ++i) yield_syscall();
+    exit(0);
+}
+
+static uint16_t clone(void (*func)()) {
+    auto ok = clone_syscall( (uintptr_t)func, nullptr );
+    if (ok & 1) return 0;
+    return ok >> 1;
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            auto child = clone(pingpong);
+            CHECK_NOT_EQ(child, 0);
+
+            sysinfo_t sy0;
+            CHECK_EQ(0, sysinfo_syscall(&sy0, INCLUDE_GLOBAL_INFO));
+            auto t0 = nanos();
+
+            for (auto i = 0u; i < gNumYields; ++i) yield_syscall();
+
+            auto t1 = nanos();
+            sysinfo_t sy1;
+            CHECK_EQ(0, sysinfo_syscall(&sy1, INCLUDE_GLOBAL_INFO));
+
+            auto s = collect(child);
+            CHECK_EQ(s.reason, process_exit_status_t::reason_t::cleanExit);
+
+            auto switches = sy1.global.ctxswitches - sy0.global.ctxswitches;
+            CHECK_TRUE(switches > 0);
+
+            printf("%u yields, %llu context switches, %llu ns per yield, %llu ns per switch\n",
+                gNumYields, switches, (t1 - t0) / gNumYields, (t1 - t0) / switches);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
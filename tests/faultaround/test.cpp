@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <sys/vm.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            uint8_t* region = (uint8_t*)mapregion(gNumPages * gPageSize, VM_REGION_READWRITE);
+            CHECK_NOT_NULL(region);
+
+            sysinfo_t sy0;
+            CHECK_EQ(0, sysinfo_syscall(&sy0, INCLUDE_LOCAL_INFO));
+
+            for (size_t i = 0; i < gNumPages; ++i) {
+                region[i * gPageSize] = (uint8_t)i;
+            }
+
+            sysinfo_t sy1;
+            CHECK_EQ(0, sysinfo_syscall(&sy1, INCLUDE_LOCAL_INFO));
+
+            auto demand = sy1.local.demandfaults - sy0.local.demandfaults;
+            auto around = sy1.local.faultaround - sy0.local.faultaround;
+
+            // every page is either faulted in on its own, or populated by a neighbour's fault
+            CHECK_EQ(gNumPages, demand + around);
+            CHECK_TRUE(demand < gNumPages);
+            CHECK_TRUE(sy1.local.pagefaults - sy0.local.pagefaults >= demand);
+
+            for (size_t i = 0; i < gNumPages; ++i) {
+                CHECK_EQ(region[i * gPageSize], (uint8_t)i);
+            }
+        }
+
+    private:
+        static constexpr size_t gPageSize = 4096;
+        static constexpr size_t gNumPages = 256;
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
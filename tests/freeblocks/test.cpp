@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FILE_PATH "/devices/memory/freeblocks"
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            FILE* f = fopen(FILE_PATH, "r");
+            CHECK_NOT_NULL(f);
+            char content[512] = {0};
+            CHECK_NOT_EQ(0, fread(content, 1, sizeof(content) - 1, f));
+            fclose(f);
+            printf("%s\n", content);
+
+            unsigned long long free_pages = 0;
+            unsigned int order = 0;
+            const char* line = content;
+            while (line && *line) {
+                unsigned int read_order, count;
+                CHECK_EQ(2, sscanf(line, "order %u: %u", &read_order, &count));
+                CHECK_EQ(order, read_order);
+                free_pages += (unsigned long long)count << read_order;
+                ++order;
+                line = strchr(line, '\n');
+                if (line) ++line;
+            }
+
+            CHECK_NOT_EQ(0, order);
+            // the system must have some free memory if this test is running
+            CHECK_NOT_EQ(0, free_pages);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
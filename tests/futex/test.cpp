@@ -0,0 +1,159 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/futex.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+static constexpr uint32_t gNumIterations = 20000;
+static constexpr uint32_t gNumThreads = 4;
+
+#define MUTEX_NAME "/mutexes/futextest"
+
+// the monotonic clock is read off the kernel data page, without a system call to skew the timing
+static uint64_t nanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static futex_mutex_t gMutex = FUTEX_MUTEX_INITIALIZER;
+static uint32_t gCounter = 0;
+
+static void* contender(void*) {
+    for (auto i = 0u; i < gNumIterations; ++i) {
+        futex_mutex_lock(&gMutex);
+        ++gCounter;
+        futex_mutex_unlock(&gMutex);
+    }
+    return nullptr;
+}
+
+static futex_sem_t gItems = FUTEX_SEM_INITIALIZER(0);
+static futex_sem_t gSlots = FUTEX_SEM_INITIALIZER(1);
+static uint32_t gSlot = 0;
+
+static void* producer(void*) {
+    for (auto i = 1u; i <= gNumIterations; ++i) {
+        futex_sem_wait(&gSlots);
+        gSlot = i;
+        futex_sem_post(&gItems);
+    }
+    return nullptr;
+}
+
+static futex_cond_t gCond = FUTEX_COND_INITIALIZER;
+static bool gReady = false;
+
+static void* signaller(void*) {
+    futex_mutex_lock(&gMutex);
+    gReady = true;
+    futex_cond_signal(&gCond);
+    futex_mutex_unlock(&gMutex);
+    return nullptr;
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void uncontended() {
+            auto t0 = nanos();
+            for (auto i = 0u; i < gNumIterations; ++i) {
+                futex_mutex_lock(&gMutex);
+                futex_mutex_unlock(&gMutex);
+            }
+            auto t1 = nanos();
+            CHECK_EQ(0, gMutex.word);
+
+            FILE* fmutex = fopen(MUTEX_NAME, "r");
+            CHECK_NOT_NULL(fmutex);
+            int fdmutex = fileno(fmutex);
+            auto t2 = nanos();
+            for (auto i = 0u; i < gNumIterations; ++i) {
+                ioctl(fdmutex, IOCTL_MUTEX_LOCK, 0);
+                ioctl(fdmutex, IOCTL_MUTEX_UNLOCK, 0);
+            }
+            auto t3 = nanos();
+            fclose(fmutex);
+
+            printf("uncontended lock+unlock: futex %llu ns, mutexfs %llu ns\n",
+                (t1 - t0) / gNumIterations, (t3 - t2) / gNumIterations);
+        }
+
+        void contended() {
+            pthread_t threads[gNumThreads];
+            auto t0 = nanos();
+            for (auto i = 0u; i < gNumThreads; ++i) {
+                CHECK_EQ(0, pthread_create(&threads[i], nullptr, contender, nullptr));
+            }
+            for (auto i = 0u; i < gNumThreads; ++i) {
+                CHECK_EQ(0, pthread_join(threads[i], nullptr));
+            }
+            auto t1 = nanos();
+            CHECK_EQ(gNumThreads * gNumIterations, gCounter);
+
+            printf("contended lock+unlock, %u threads: %llu ns\n",
+                gNumThreads, (t1 - t0) / (gNumThreads * gNumIterations));
+        }
+
+        void semaphore() {
+            pthread_t thread;
+            CHECK_EQ(0, pthread_create(&thread, nullptr, producer, nullptr));
+            uint32_t sum = 0;
+            for (auto i = 1u; i <= gNumIterations; ++i) {
+                futex_sem_wait(&gItems);
+                CHECK_EQ(i, gSlot);
+                sum += gSlot;
+                futex_sem_post(&gSlots);
+            }
+            CHECK_EQ(0, pthread_join(thread, nullptr));
+            CHECK_EQ(gNumIterations * (gNumIterations + 1) / 2, sum);
+
+            CHECK_FALSE(futex_sem_trywait(&gItems));
+            CHECK_FALSE(futex_sem_timedwait(&gItems, 50));
+        }
+
+        void condition() {
+            pthread_t thread;
+            futex_mutex_lock(&gMutex);
+            CHECK_EQ(0, pthread_create(&thread, nullptr, signaller, nullptr));
+            while (!gReady) futex_cond_wait(&gCond, &gMutex);
+            futex_mutex_unlock(&gMutex);
+            CHECK_EQ(0, pthread_join(thread, nullptr));
+        }
+
+        void run() override {
+            uncontended();
+            contended();
+            semaphore();
+            condition();
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <syscalls.h>
+
+#define FILE_PATH "/tmp/idedma.bin"
+
+static constexpr size_t gChunkSize = 64 * 1024;
+static constexpr size_t gFileSize = 32 * gChunkSize;
+
+static volatile bool gDone = false;
+static volatile uint32_t gTicks = 0;
+
+// every system call needs the kernel, so this only gets anywhere while the reader is asleep
+static void* ticker(void*) {
+    while (!gDone) {
+        getppid_syscall();
+        gTicks = gTicks + 1;
+    }
+    return nullptr;
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            auto buffer = (unsigned char*)malloc(gFileSize);
+            CHECK_NOT_NULL(buffer);
+            for (auto i = 0u; i < gFileSize; ++i) buffer[i] = (unsigned char)(i * 7);
+
+            // writes this large go around the block cache, so reading the file back has to hit the disk
+            int fd = open(FILE_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0);
+            CHECK_NOT_EQ(fd, -1);
+            for (auto done = 0u; done < gFileSize; done += gChunkSize) {
+                CHECK_EQ((ssize_t)gChunkSize, write(fd, buffer + done, gChunkSize));
+            }
+            close(fd);
+
+            pthread_t thread;
+            CHECK_EQ(0, pthread_create(&thread, nullptr, ticker, nullptr));
+            while (gTicks == 0) yield_syscall();
+
+            fd = open(FILE_PATH, O_RDONLY);
+            CHECK_NOT_EQ(fd, -1);
+            for (auto i = 0u; i < gFileSize; ++i) buffer[i] = 0;
+            auto t0 = gTicks;
+            CHECK_EQ((ssize_t)gFileSize, read(fd, buffer, gFileSize));
+            auto t1 = gTicks;
+            close(fd);
+
+            gDone = true;
+            CHECK_EQ(0, pthread_join(thread, nullptr));
+
+            bool same = true;
+            for (auto i = 0u; same && i < gFileSize; ++i) same = (buffer[i] == (unsigned char)(i * 7));
+            CHECK_TRUE(same);
+            free(buffer);
+            unlink(FILE_PATH);
+
+            printf("%u system calls ran elsewhere during a %u KB read\n", t1 - t0, gFileSize / 1024);
+            CHECK_TRUE(t1 > t0);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+static constexpr uint32_t gNumCalls = 100000;
+
+static uint64_t uptime() {
+    sysinfo_t si;
+    sysinfo_syscall(&si, INCLUDE_GLOBAL_INFO);
+    return si.global.uptime;
+}
+
+static uint64_t readNow() {
+    FILE* f = fopen("/devices/time/now", "r");
+    if (f == nullptr) return 0;
+    char c[24] = {0};
+    fread(c, 1, sizeof(c), f);
+    fclose(f);
+    return strtoull(c, nullptr, 0);
+}
+
+static void* threadpid(void*) {
+    return (void*)(uintptr_t)getpid();
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            CHECK_EQ(getpid(), (int)(getpid_syscall() >> 1));
+
+            // threads are separate kernel processes, but getpid() is the same for all of them
+            pthread_t thread;
+            CHECK_EQ(0, pthread_create(&thread, nullptr, threadpid, nullptr));
+            void* result = nullptr;
+            CHECK_EQ(0, pthread_join(thread, &result));
+            CHECK_EQ(getpid(), (int)(uintptr_t)result);
+            CHECK_NOT_EQ(getpid(), (int)thread);
+
+            // the page and the kernel agree on the time, give or take the second it may have ticked over
+            struct timeval tv;
+            CHECK_EQ(0, gettimeofday(&tv, nullptr));
+            auto now = readNow();
+            CHECK_TRUE(tv.tv_sec <= (time_t)now && tv.tv_sec + 1 >= (time_t)now);
+            CHECK_TRUE(tv.tv_usec >= 0 && tv.tv_usec < 1000000);
+            CHECK_TRUE(time(nullptr) >= tv.tv_sec);
+
+            struct timespec ts0, ts1;
+            CHECK_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts0));
+            auto ms = uptime();
+            CHECK_TRUE((uint64_t)ts0.tv_sec * 1000 + ts0.tv_nsec / 1000000 <= ms + 1);
+            usleep(20000);
+            CHECK_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts1));
+            auto elapsed = (ts1.tv_sec - ts0.tv_sec) * 1000000000ll + (ts1.tv_nsec - ts0.tv_nsec);
+            CHECK_TRUE(elapsed >= 20000000ll);
+            CHECK_EQ(-1, clock_gettime((clockid_t)1234, &ts1));
+
+            auto t0 = uptime();
+            for (auto i = 0u; i < gNumCalls; ++i) gettimeofday(&tv, nullptr);
+            auto t1 = uptime();
+            for (auto i = 0u; i < gNumCalls; ++i) getpid();
+            auto t2 = uptime();
+            for (auto i = 0u; i < gNumCalls; ++i) getpid_syscall();
+            auto t3 = uptime();
+            printf("%u calls: gettimeofday %llu ns, getpid %llu ns, getpid syscall %llu ns per call\n", gNumCalls,
+                (t1 - t0) * 1000000 / gNumCalls, (t2 - t1) * 1000000 / gNumCalls, (t3 - t2) * 1000000 / gNumCalls);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
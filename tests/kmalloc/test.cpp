@@ -0,0 +1,59 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FILE_PATH "/devices/memory/kmalloc/64"
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    private:
+        unsigned int readField(const char* content, const char* field) {
+            const char* where = strstr(content, field);
+            CHECK_NOT_NULL(where);
+            return (unsigned int)strtoul(where + strlen(field), nullptr, 10);
+        }
+
+    protected:
+        void run() override {
+            FILE* f = fopen(FILE_PATH, "r");
+            CHECK_NOT_NULL(f);
+            char content[512] = {0};
+            CHECK_NOT_EQ(0, fread(content, 1, sizeof(content) - 1, f));
+            fclose(f);
+            printf("%s\n", content);
+
+            CHECK_EQ(64, readField(content, "objsize: "));
+            auto capacity = readField(content, "capacity: ");
+            auto inuse = readField(content, "in use: ");
+            // the kernel has been allocating small objects since boot
+            CHECK_NOT_EQ(0, capacity);
+            CHECK_TRUE(inuse <= capacity);
+            CHECK_TRUE(readField(content, "fragmentation: ") <= 100);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
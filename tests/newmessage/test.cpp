@@ -24,6 +24,8 @@
 #include <kernel/syscalls/types.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/msgqueue.h>
+#include <sys/vm.h>
 
 static kpid_t clone(void (*func)()) {
     auto ok = clone_syscall( (uintptr_t)func, nullptr );
@@ -208,13 +210,79 @@ class NonBlockingReadTest : public Test {
         }
 };
 
+static void PageTransferTest_sender() {
+    FILE* f = fopen("/queues/newmessage/PageTransfer", "w");
+    if (f == nullptr) exit(1);
+    uint32_t* page = (uint32_t*)mapregion(message_t::gTotalSize, VM_REGION_READWRITE);
+    if (page == nullptr) exit(2);
+    for (auto i = 0u; i < message_t::gTotalSize / sizeof(uint32_t); ++i) page[i] = 0xF00D0000 + i;
+    if (msgqueue_send(fileno(f), page, message_t::gTotalSize) != msgqueue_send_t::path_t::transferred) exit(3);
+    // the page is gone, and a fresh one took its place
+    if (page[0] != 0 || page[1023] != 0) exit(4);
+
+    uint32_t small = 0xC0FFEE;
+    if (msgqueue_send(fileno(f), &small, sizeof(small)) != msgqueue_send_t::path_t::copied) exit(5);
+
+    // a page's worth of memory that is not a page of its own can't be given away, so it is copied
+    uint8_t* pages = (uint8_t*)mapregion(2 * message_t::gTotalSize, VM_REGION_READWRITE);
+    if (pages == nullptr) exit(6);
+    for (auto i = 0u; i < message_t::gTotalSize; ++i) pages[16 + i] = (uint8_t)i;
+    if (msgqueue_send(fileno(f), pages + 16, message_t::gTotalSize) != msgqueue_send_t::path_t::copied) exit(7);
+    if (pages[16] != 0 || pages[17] != 1) exit(8);
+    fclose(f);
+    exit(0);
+}
+class PageTransferTest : public Test {
+    public:
+        PageTransferTest() : Test("newmessage.PageTransfer") {}
+
+    protected:
+        void run() override {
+            FILE* f = fopen("/queues/newmessage/PageTransfer", "r");
+            CHECK_NOT_EQ(f, nullptr);
+            kpid_t spid = clone(PageTransferTest_sender);
+            CHECK_NOT_EQ(spid, 0);
+            auto sexit = collect(spid);
+            CHECK_EQ(sexit.reason, process_exit_status_t::reason_t::cleanExit);
+            CHECK_EQ(sexit.status, 0);
+
+            message_t msg;
+            CHECK_EQ(sizeof(msg), read(fileno(f), &msg, sizeof(msg)));
+            CHECK_EQ(msg.header.sender, spid);
+            CHECK_EQ(msg.header.payload_size, message_t::gTotalSize);
+            CHECK_EQ(msg.header.flags & message_t::gPageTransfer, message_t::gPageTransfer);
+            uint32_t* page = (uint32_t*)msg.header.page;
+            CHECK_NOT_NULL(page);
+            CHECK_EQ(page[0], 0xF00D0000);
+            CHECK_EQ(page[1023], 0xF00D0000 + 1023);
+            CHECK_EQ(1, unmapregion(page));
+
+            CHECK_EQ(sizeof(msg), read(fileno(f), &msg, sizeof(msg)));
+            CHECK_EQ(msg.header.flags & message_t::gPageTransfer, 0);
+            CHECK_EQ(msg.header.payload_size, sizeof(uint32_t));
+            CHECK_EQ(*(uint32_t*)&msg.payload[0], 0xC0FFEE);
+
+            CHECK_EQ(sizeof(msg), read(fileno(f), &msg, sizeof(msg)));
+            CHECK_EQ(msg.header.payload_size, message_t::gTotalSize);
+            CHECK_EQ(msg.header.flags & message_t::gPageTransfer, message_t::gPageTransfer);
+            uint8_t* copy = (uint8_t*)msg.header.page;
+            CHECK_NOT_NULL(copy);
+            CHECK_EQ(copy[0], 0);
+            CHECK_EQ(copy[message_t::gTotalSize - 1], (uint8_t)(message_t::gTotalSize - 1));
+            CHECK_EQ(1, unmapregion(copy));
+
+            fclose(f);
+        }
+};
+
 int main() {
     auto& testPlan = TestPlan::defaultPlan(TEST_NAME);
 
     testPlan.add<ReceiveMessageTest>()
             .add<MessageOrderTest>()
             .add<TwoSendersTest>()
-            .add<NonBlockingReadTest>();
+            .add<NonBlockingReadTest>()
+            .add<PageTransferTest>();
 
     testPlan.test();
     return 0;
@@ -21,14 +21,36 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <syscalls.h>
+#include <sys/pipe.h>
 
 #define TEST_MESSAGE "I am going to write some text to my stdout and then exit\n"
 
+static constexpr size_t gBenchmarkBytes = 8 * 1024 * 1024;
+static constexpr size_t gBenchmarkChunk = 16 * 1024;
+
+static char gChunk[gBenchmarkChunk];
+
 static void writeTask() {
     printf(TEST_MESSAGE);
     exit(0);
 }
 
+static void floodTask() {
+    size_t sent = 0;
+    while (sent < gBenchmarkBytes) {
+        auto n = write(STDOUT_FILENO, gChunk, gBenchmarkChunk);
+        if (n <= 0) exit(1);
+        sent += n;
+    }
+    exit(0);
+}
+
+static uint64_t uptime() {
+    sysinfo_t si;
+    sysinfo_syscall(&si, INCLUDE_GLOBAL_INFO);
+    return si.global.uptime;
+}
+
 static uint16_t clone(void (*func)(), exec_fileop_t* fops) {
     auto ok = clone_syscall( (uintptr_t)func, fops );
     if (ok & 1) return 0;
@@ -80,6 +102,59 @@ class TheTest : public Test {
 
             auto s = collect(wrPid);
             CHECK_EQ(s.reason, process_exit_status_t::reason_t::cleanExit);
+
+            benchmark(0);
+            benchmark(64 * 1024);
+        }
+
+    private:
+        // how fast bytes go from one process to another, through a pipe of the given capacity
+        void benchmark(size_t capacity) {
+            int pipefd[2] = {0,0};
+            CHECK_EQ(0, pipe_with_capacity(pipefd, capacity));
+
+            exec_fileop_t fops[] = {
+                exec_fileop_t{
+                    .op = exec_fileop_t::operation::CLOSE_CHILD_FD,
+                    .param1 = STDOUT_FILENO,
+                    .param2 = 0,
+                    .param3 = nullptr
+                },
+                exec_fileop_t{
+                    .op = exec_fileop_t::operation::DUP_PARENT_FD,
+                    .param1 = (size_t)pipefd[1],
+                    .param2 = 0,
+                    .param3 = nullptr,
+                },
+                exec_fileop_t{
+                    .op = exec_fileop_t::operation::END_OF_LIST,
+                    .param1 = 0,
+                    .param2 = 0,
+                    .param3 = nullptr
+                },
+            };
+
+            auto t0 = uptime();
+            auto wrPid = clone(floodTask, fops);
+            CHECK_NOT_EQ(0, wrPid);
+            fclose_syscall(pipefd[1]);
+
+            size_t received = 0;
+            while (true) {
+                auto n = read(pipefd[0], gChunk, gBenchmarkChunk);
+                if (n <= 0) break;
+                received += n;
+            }
+            auto t1 = uptime();
+            fclose_syscall(pipefd[0]);
+
+            auto s = collect(wrPid);
+            CHECK_EQ(s.reason, process_exit_status_t::reason_t::cleanExit);
+            CHECK_EQ(gBenchmarkBytes, received);
+
+            auto ms = (t1 > t0) ? (t1 - t0) : 1;
+            printf("pipe of capacity %u: %u bytes in %llu ms, %llu KB/s\n", capacity ? capacity : 4096,
+                received, t1 - t0, (uint64_t)received * 1000 / 1024 / ms);
         }
 };
 
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/testplan.h>
+#include <libcheckup/assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <poll.h>
+#include <syscalls.h>
+#include <sys/collect.h>
+#include <sys/pollset.h>
+#include <sys/select.h>
+#include <kernel/syscalls/types.h>
+
+static uint64_t uptime() {
+    sysinfo_t si;
+    sysinfo_syscall(&si, INCLUDE_GLOBAL_INFO);
+    return si.global.uptime;
+}
+
+// the child's stdout is the write end of the given pipe
+static kpid_t clone(void (*func)(), int writefd) {
+    exec_fileop_t fops[] = {
+        exec_fileop_t{
+            .op = exec_fileop_t::operation::CLOSE_CHILD_FD,
+            .param1 = STDOUT_FILENO,
+            .param2 = 0,
+            .param3 = nullptr
+        },
+        exec_fileop_t{
+            .op = exec_fileop_t::operation::DUP_PARENT_FD,
+            .param1 = (size_t)writefd,
+            .param2 = 0,
+            .param3 = nullptr,
+        },
+        exec_fileop_t{
+            .op = exec_fileop_t::operation::END_OF_LIST,
+            .param1 = 0,
+            .param2 = 0,
+            .param3 = nullptr
+        },
+    };
+
+    auto ok = clone_syscall( (uintptr_t)func, fops );
+    if (ok & 1) return 0;
+    return ok >> 1;
+}
+
+static void lateWriter() {
+    usleep(100000);
+    write(STDOUT_FILENO, "x", 1);
+    exit(0);
+}
+
+class PollTest : public Test {
+    public:
+        PollTest() : Test("poll.Poll") {}
+
+    protected:
+        void run() override {
+            int a[2] = {0,0};
+            int b[2] = {0,0};
+            CHECK_EQ(0, pipe(a));
+            CHECK_EQ(0, pipe(b));
+
+            pollfd fds[] = {
+                {a[0], POLLIN, 0},
+                {b[0], POLLIN, 0},
+                {b[1], POLLOUT, 0},
+                {-1, POLLIN, 0},
+            };
+            // only the write end has anything to report
+            CHECK_EQ(1, poll(fds, 4, 0));
+            CHECK_EQ(0, fds[0].revents);
+            CHECK_EQ(0, fds[1].revents);
+            CHECK_EQ(POLLOUT, fds[2].revents);
+            CHECK_EQ(0, fds[3].revents);
+
+            CHECK_EQ(1, write(b[1], "y", 1));
+            CHECK_EQ(2, poll(fds, 3, 0));
+            CHECK_EQ(POLLIN, fds[1].revents);
+
+            // nothing becomes ready, so this has to run for the whole timeout
+            auto t0 = uptime();
+            CHECK_EQ(0, poll(fds, 1, 50));
+            CHECK_TRUE(uptime() - t0 >= 50);
+
+            auto pid = clone(lateWriter, a[1]);
+            CHECK_NOT_EQ(0, pid);
+            CHECK_EQ(1, poll(fds, 1, -1));
+            CHECK_EQ(POLLIN, fds[0].revents);
+            collect(pid);
+
+            close(a[1]);
+            char c;
+            CHECK_EQ(1, read(a[0], &c, 1));
+            CHECK_EQ(1, poll(fds, 1, 0));
+            CHECK_EQ(POLLHUP, fds[0].revents & POLLHUP);
+
+            close(b[0]);
+            close(b[1]);
+            CHECK_EQ(1, poll(&fds[2], 1, 0));
+            CHECK_EQ(POLLNVAL, fds[2].revents);
+            close(a[0]);
+        }
+};
+
+class SelectTest : public Test {
+    public:
+        SelectTest() : Test("poll.Select") {}
+
+    protected:
+        void run() override {
+            int p[2] = {0,0};
+            CHECK_EQ(0, pipe(p));
+
+            fd_set rd, wr;
+            FD_ZERO(&rd);
+            FD_ZERO(&wr);
+            FD_SET(p[0], &rd);
+            FD_SET(p[1], &wr);
+            timeval tv = {0, 0};
+            auto n = (p[0] > p[1] ? p[0] : p[1]) + 1;
+            CHECK_EQ(1, select(n, &rd, &wr, nullptr, &tv));
+            CHECK_FALSE(FD_ISSET(p[0], &rd));
+            CHECK_TRUE(FD_ISSET(p[1], &wr));
+
+            CHECK_EQ(1, write(p[1], "z", 1));
+            FD_SET(p[0], &rd);
+            CHECK_EQ(1, select(n, &rd, nullptr, nullptr, nullptr));
+            CHECK_TRUE(FD_ISSET(p[0], &rd));
+
+            close(p[0]);
+            close(p[1]);
+        }
+};
+
+class PollSetTest : public Test {
+    public:
+        PollSetTest() : Test("poll.PollSet") {}
+
+    protected:
+        void run() override {
+            int a[2] = {0,0};
+            int b[2] = {0,0};
+            CHECK_EQ(0, pipe(a));
+            CHECK_EQ(0, pipe(b));
+
+            auto set = pollset_create();
+            CHECK_TRUE(set >= 0);
+            CHECK_EQ(0, pollset_ctl(set, a[0], POLLIN));
+            CHECK_EQ(0, pollset_ctl(set, b[0], POLLIN));
+            // a set cannot watch itself, nor a descriptor that is not open
+            CHECK_EQ(-1, pollset_ctl(set, set, POLLIN));
+            CHECK_EQ(-1, pollset_ctl(set, 1000, POLLIN));
+
+            pollfd ready[2];
+            CHECK_EQ(0, pollset_wait(set, ready, 2, 0));
+
+            CHECK_EQ(1, write(b[1], "w", 1));
+            CHECK_EQ(1, pollset_wait(set, ready, 2, 0));
+            CHECK_EQ(b[0], ready[0].fd);
+            CHECK_EQ(POLLIN, ready[0].revents);
+
+            // level-triggered: still there until it is read
+            CHECK_EQ(1, pollset_wait(set, ready, 2, 0));
+            char c;
+            CHECK_EQ(1, read(b[0], &c, 1));
+            CHECK_EQ(0, pollset_wait(set, ready, 2, 0));
+
+            auto pid = clone(lateWriter, a[1]);
+            CHECK_NOT_EQ(0, pid);
+            CHECK_EQ(1, pollset_wait(set, ready, 2, -1));
+            CHECK_EQ(a[0], ready[0].fd);
+            collect(pid);
+            CHECK_EQ(1, read(a[0], &c, 1));
+
+            // once removed, a file is not reported any more
+            CHECK_EQ(0, pollset_ctl(set, b[0], 0));
+            CHECK_EQ(1, write(b[1], "w", 1));
+            CHECK_EQ(0, pollset_wait(set, ready, 2, 0));
+
+            // the set keeps the read end open, and sees the hangup after the writer goes away
+            close(a[1]);
+            close(a[0]);
+            CHECK_EQ(1, pollset_wait(set, ready, 2, 0));
+            CHECK_EQ(POLLHUP, ready[0].revents & POLLHUP);
+
+            close(set);
+            close(b[0]);
+            close(b[1]);
+        }
+};
+
+int main() {
+    auto& testPlan = TestPlan::defaultPlan(TEST_NAME);
+
+    testPlan.add<PollTest>()
+            .add<SelectTest>()
+            .add<PollSetTest>();
+
+    testPlan.test();
+    return 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <unistd.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            auto sz = proctable_syscall(nullptr, 0);
+            sz >>= 1;
+            process_info_t* ptable = new process_info_t[sz];
+            proctable_syscall(ptable, sz);
+
+            const process_info_t* self = nullptr;
+            for (auto i = 0u; i < sz; ++i) {
+                if (ptable[i].pid == getpid()) self = &ptable[i];
+            }
+            CHECK_NOT_NULL(self);
+
+            // the text of this test was read through the page cache, so at least some of it is shared
+            CHECK_TRUE(self->sharedpages > 0);
+            CHECK_EQ(self->pmspace / 4096, self->sharedpages + self->privatepages);
+
+            delete[] ptable;
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
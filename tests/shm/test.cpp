@@ -0,0 +1,184 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/testplan.h>
+#include <libcheckup/assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <syscalls.h>
+#include <sys/collect.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <kernel/syscalls/types.h>
+
+static constexpr size_t gSize = 8192;
+
+static kpid_t clone(void (*func)()) {
+    auto ok = clone_syscall( (uintptr_t)func, nullptr );
+    if (ok & 1) return 0;
+    return ok >> 1;
+}
+
+static uint32_t* mapObject(const char* name, int* fd) {
+    *fd = shm_open(name, O_RDWR | O_CREAT, 0);
+    if (*fd < 0) return nullptr;
+    void* p = mmap(nullptr, gSize, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+    return (p == (void*)-1) ? nullptr : (uint32_t*)p;
+}
+
+static bool findObject(const char* name, shm_info_t* info) {
+    FILE* f = fopen("/devices/shm/objects", "r");
+    if (f == nullptr) return false;
+    bool found = false;
+    while (!found && 1 == fread(info, sizeof(shm_info_t), 1, f)) {
+        found = info->linked && 0 == strcmp(info->name, name);
+    }
+    fclose(f);
+    return found;
+}
+
+static uint32_t* gSharedWrite;
+static void SharedWriteTest_child() {
+    // the mapping came along with the clone, and must still point at the same memory
+    if (gSharedWrite[0] != 0x5EED) exit(1);
+    gSharedWrite[1] = 0xC41D;
+
+    int fd;
+    uint32_t* other = mapObject("SharedWrite", &fd);
+    if (other == nullptr) exit(2);
+    if (other[0] != 0x5EED) exit(3);
+    other[1024] = 0xF00D;
+    exit(0);
+}
+class SharedWriteTest : public Test {
+    public:
+        SharedWriteTest() : Test("shm.SharedWrite") {}
+
+    protected:
+        void run() override {
+            int fd;
+            gSharedWrite = mapObject("SharedWrite", &fd);
+            CHECK_NOT_NULL(gSharedWrite);
+            CHECK_EQ(0, ftruncate(fd, gSize));
+            gSharedWrite[0] = 0x5EED;
+
+            kpid_t cpid = clone(SharedWriteTest_child);
+            CHECK_NOT_EQ(cpid, 0);
+            auto cexit = collect(cpid);
+            CHECK_EQ(cexit.reason, process_exit_status_t::reason_t::cleanExit);
+            CHECK_EQ(cexit.status, 0);
+
+            CHECK_EQ(gSharedWrite[1], 0xC41D);
+            CHECK_EQ(gSharedWrite[1024], 0xF00D);
+
+            shm_info_t info;
+            CHECK_TRUE(findObject("SharedWrite", &info));
+            CHECK_EQ(info.size, gSize);
+            CHECK_EQ(info.pages, 2);
+            CHECK_EQ(info.resident, 2);
+            CHECK_TRUE(info.mappings >= 2);
+
+            munmap(gSharedWrite, gSize);
+            close(fd);
+            CHECK_EQ(0, shm_unlink("SharedWrite"));
+        }
+};
+
+class UnlinkWhileMappedTest : public Test {
+    public:
+        UnlinkWhileMappedTest() : Test("shm.UnlinkWhileMapped") {}
+
+    protected:
+        void run() override {
+            int fd;
+            uint32_t* p = mapObject("UnlinkWhileMapped", &fd);
+            CHECK_NOT_NULL(p);
+            CHECK_EQ(0, ftruncate(fd, gSize));
+            p[0] = 0xAB1E;
+            CHECK_EQ(0, shm_unlink("UnlinkWhileMapped"));
+            shm_info_t info;
+            CHECK_FALSE(findObject("UnlinkWhileMapped", &info));
+
+            // the name is free for a new object, while the old one lives on for whoever still has it
+            int fd2 = shm_open("UnlinkWhileMapped", O_RDWR | O_CREAT, 0);
+            CHECK_TRUE(fd2 >= 0);
+            struct stat st;
+            CHECK_EQ(0, fstat(fd2, &st));
+            CHECK_EQ(st.st_mode, S_IFSHM);
+            CHECK_EQ(st.st_size, 0);
+
+            CHECK_EQ(p[0], 0xAB1E);
+            p[1] = 0xAB1F;
+            CHECK_EQ(p[1], 0xAB1F);
+
+            close(fd2);
+            CHECK_EQ(0, shm_unlink("UnlinkWhileMapped"));
+            munmap(p, gSize);
+            close(fd);
+        }
+};
+
+class ResizeTest : public Test {
+    public:
+        ResizeTest() : Test("shm.Resize") {}
+
+    protected:
+        void run() override {
+            int fd = shm_open("Resize", O_RDWR | O_CREAT, 0);
+            CHECK_TRUE(fd >= 0);
+            CHECK_EQ(0, ftruncate(fd, gSize));
+            uint32_t value = 0x12345678;
+            CHECK_EQ(100, lseek(fd, 100, SEEK_SET));
+            CHECK_EQ(sizeof(value), write(fd, &value, sizeof(value)));
+
+            // shrinking and growing again must not bring back what was cut off
+            CHECK_EQ(0, ftruncate(fd, 50));
+            CHECK_EQ(0, ftruncate(fd, gSize));
+            value = 0;
+            CHECK_EQ(100, lseek(fd, 100, SEEK_SET));
+            CHECK_EQ(sizeof(value), read(fd, &value, sizeof(value)));
+            CHECK_EQ(value, 0);
+
+            shm_info_t info;
+            CHECK_TRUE(findObject("Resize", &info));
+            CHECK_EQ(info.pages, 2);
+            CHECK_EQ(info.resident, 1);
+            CHECK_EQ(info.mappings, 0);
+
+            // a size that wraps around when rounded up to pages must be refused, not turned into 0 pages
+            CHECK_EQ(0, ioctl(fd, IOCTL_SHM_RESIZE, (int)0xFFFFF001));
+            CHECK_EQ(gSize, (size_t)ioctl(fd, IOCTL_SHM_GET_SIZE, 0));
+
+            close(fd);
+            CHECK_EQ(0, shm_unlink("Resize"));
+        }
+};
+
+int main() {
+    auto& testPlan = TestPlan::defaultPlan(TEST_NAME);
+
+    testPlan.add<SharedWriteTest>()
+            .add<UnlinkWhileMappedTest>()
+            .add<ResizeTest>();
+
+    testPlan.test();
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <sys/collect.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+static constexpr uint32_t gNumSpinners = 4;
+static constexpr uint64_t gSpinMillis = 300;
+
+static uint64_t uptime() {
+    sysinfo_t si;
+    sysinfo_syscall(&si, INCLUDE_GLOBAL_INFO);
+    return si.global.uptime;
+}
+
+static void spinner() {
+    auto end = uptime() + gSpinMillis;
+    while (uptime() < end);
+    exit(0);
+}
+
+static uint16_t clone(void (*func)()) {
+    auto ok = clone_syscall( (uintptr_t)func, nullptr );
+    if (ok & 1) return 0;
+    return ok >> 1;
+}
+
+static uint64_t totalBusy(const sysinfo_t& si) {
+    uint64_t busy = 0;
+    for (auto i = 0u; i < si.cpus.count; ++i) busy += si.cpus.cpu[i].busy;
+    return busy;
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            sysinfo_t before;
+            sysinfo_syscall(&before, INCLUDE_CPU_INFO);
+            // the test runner boots a multiprocessor machine, so a single CPU means bringup failed
+            CHECK_TRUE(before.cpus.count > 1);
+            CHECK_TRUE(before.cpus.count <= SYSINFO_MAX_CPUS);
+
+            uint16_t children[gNumSpinners];
+            for (auto i = 0u; i < gNumSpinners; ++i) {
+                children[i] = clone(spinner);
+                CHECK_NOT_EQ(children[i], 0);
+            }
+
+            auto t0 = uptime();
+            for (auto i = 0u; i < gNumSpinners; ++i) {
+                auto exs = collect(children[i]);
+                CHECK_EQ(exs.reason, process_exit_status_t::reason_t::cleanExit);
+            }
+            auto elapsed = uptime() - t0;
+
+            sysinfo_t after;
+            sysinfo_syscall(&after, INCLUDE_CPU_INFO);
+            CHECK_EQ(before.cpus.count, after.cpus.count);
+            // the spinners run for as long as the slowest one of them, on however many CPUs there are
+            CHECK_TRUE(totalBusy(after) - totalBusy(before) >= gSpinMillis);
+
+            printf("%u CPUs online; %u spinners of %llu ms took %llu ms\n", after.cpus.count, gNumSpinners, gSpinMillis, elapsed);
+            for (auto i = 0u; i < after.cpus.count; ++i) {
+                const auto& cpu(after.cpus.cpu[i]);
+                printf("CPU %u: busy %llu ms, idle %llu ms, %llu steals\n", i, cpu.busy, cpu.idle, cpu.steals);
+            }
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <sys/collect.h>
+#include <sys/sysring.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+static constexpr uint32_t gEntries = 64;
+static constexpr uint32_t gNumRounds = 2000;
+
+static uint64_t uptime() {
+    sysinfo_t si;
+    sysinfo_syscall(&si, INCLUDE_GLOBAL_INFO);
+    return si.global.uptime;
+}
+
+// a process only gets one ring, so the polling one is set up by a child of the test
+static void poller() {
+    auto ring = sysring_create(gEntries, true);
+    if (ring == nullptr) exit(1);
+
+    for (auto i = 0u; i < gEntries; ++i) {
+        if (!sysring_submit(ring, i, getpid_syscall_id, 0, nullptr)) exit(2);
+    }
+
+    // nothing here enters the kernel on the ring's behalf
+    uint32_t userdata;
+    syscall_response_t result;
+    for (auto i = 0u; i < gEntries; ++i) {
+        while (!sysring_reap(ring, &userdata, &result)) sched_yield();
+        if (userdata != i) exit(3);
+        if (result != getpid_syscall()) exit(4);
+    }
+    exit(0);
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            auto ring = sysring_create(gEntries, false);
+            CHECK_NOT_NULL(ring);
+            CHECK_NULL(sysring_create(gEntries, false));
+
+            for (auto i = 0u; i < gEntries; ++i) {
+                CHECK_TRUE(sysring_submit(ring, i, getpid_syscall_id, 0, nullptr));
+            }
+            CHECK_FALSE(sysring_submit(ring, gEntries, getpid_syscall_id, 0, nullptr));
+            CHECK_EQ(gEntries, sysring_enter(ring, gEntries));
+            CHECK_EQ(0, sysring_enter(ring, gEntries));
+
+            uint32_t userdata;
+            syscall_response_t result;
+            for (auto i = 0u; i < gEntries; ++i) {
+                CHECK_TRUE(sysring_reap(ring, &userdata, &result));
+                CHECK_EQ(i, userdata);
+                CHECK_EQ(getpid_syscall(), result);
+            }
+            CHECK_FALSE(sysring_reap(ring, &userdata, &result));
+
+            // calls with pointer arguments see the same memory as if they had been made directly
+            const char* path = "/devices/time/now";
+            uint32_t args[] = {(uint32_t)path, 0};
+            CHECK_TRUE(sysring_submit(ring, 1, fopen_syscall_id, 2, args));
+            CHECK_TRUE(sysring_submit(ring, 2, ringenter_syscall_id, 1, args));
+            CHECK_EQ(2, sysring_enter(ring, gEntries));
+            CHECK_TRUE(sysring_reap(ring, &userdata, &result));
+            CHECK_EQ(1, userdata);
+            CHECK_EQ(0, result & 1);
+            CHECK_EQ(0, fclose_syscall(result >> 1) & 1);
+            CHECK_TRUE(sysring_reap(ring, &userdata, &result));
+            CHECK_EQ(2, userdata);
+            CHECK_EQ(1, result & 1);
+
+            auto child = clone_syscall((uintptr_t)poller, nullptr);
+            CHECK_EQ(0, child & 1);
+            auto status = collect(child >> 1);
+            CHECK_EQ(status.reason, process_exit_status_t::reason_t::cleanExit);
+            CHECK_EQ(status.status, 0);
+
+            auto t0 = uptime();
+            for (auto r = 0u; r < gNumRounds; ++r) {
+                for (auto i = 0u; i < gEntries; ++i) getpid_syscall();
+            }
+            auto t1 = uptime();
+            for (auto r = 0u; r < gNumRounds; ++r) {
+                for (auto i = 0u; i < gEntries; ++i) sysring_submit(ring, i, getpid_syscall_id, 0, nullptr);
+                sysring_enter(ring, gEntries);
+                while (sysring_reap(ring, &userdata, &result));
+            }
+            auto t2 = uptime();
+            printf("%u calls: %llu ns per call made directly, %llu ns per call in batches of %u\n", gNumRounds * gEntries,
+                (t1 - t0) * 1000000 / (gNumRounds * gEntries), (t2 - t1) * 1000000 / (gNumRounds * gEntries), gEntries);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+static constexpr uint32_t gNumCalls = 1000;
+
+static syscall_stats_t gTable[256];
+
+static bool find(const char* path, const char* name, syscall_stats_t* stats) {
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) return false;
+    size_t n = fread(gTable, sizeof(syscall_stats_t), 256, f);
+    fclose(f);
+    for (size_t i = 0; i < n; ++i) {
+        if (0 == strcmp(name, gTable[i].name)) {
+            *stats = gTable[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            FILE* f = fopen("/devices/syscalls/process", "r");
+            CHECK_NOT_NULL(f);
+            CHECK_EQ(1, ioctl(fileno(f), syscall_stats_t::IOCTL_TRACK_PROCESS, getpid()));
+            CHECK_EQ(getpid(), ioctl(fileno(f), syscall_stats_t::IOCTL_TRACKED_PROCESS, 0));
+
+            syscall_stats_t before, after, mine;
+            CHECK_TRUE(find("/devices/syscalls/all", "getpid", &before));
+            CHECK_EQ(getpid_syscall_id, before.id);
+            for (auto i = 0u; i < gNumCalls; ++i) getpid_syscall();
+            CHECK_TRUE(find("/devices/syscalls/all", "getpid", &after));
+            CHECK_TRUE(find("/devices/syscalls/process", "getpid", &mine));
+
+            CHECK_TRUE(after.calls >= before.calls + gNumCalls);
+            CHECK_TRUE(after.cycles > before.cycles);
+            CHECK_TRUE(after.maxcycles >= before.maxcycles);
+
+            // only this process has been counted since tracking began
+            CHECK_EQ(gNumCalls, mine.calls);
+            uint64_t bucketed = 0;
+            for (auto i = 0u; i < syscall_stats_t::gNumBuckets; ++i) bucketed += mine.buckets[i];
+            CHECK_EQ(gNumCalls, bucketed);
+            CHECK_TRUE(mine.cycles >= mine.maxcycles);
+
+            CHECK_EQ(1, ioctl(fileno(f), syscall_stats_t::IOCTL_TRACK_PROCESS, 0));
+            CHECK_EQ(0, ioctl(fileno(f), syscall_stats_t::IOCTL_TRACKED_PROCESS, 0));
+            fclose(f);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/fastcall.h>
+#include <time.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+#include <sys/osfeatures.h>
+
+static constexpr uint32_t gNumCalls = 200000;
+
+// the monotonic clock is read off the kernel data page, without a system call to skew the timing
+static uint64_t nanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// getpid does next to no work in the kernel, so this is mostly the cost of getting there and back
+static uint64_t roundtrip() {
+    auto t0 = nanos();
+    for (auto i = 0u; i < gNumCalls; ++i) getpid_syscall();
+    auto t1 = nanos();
+    return (t1 - t0) / gNumCalls;
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            feature_id_t features[] = {gFeatureIdSysenter, 0};
+            const bool supported = (0 == checkfeatures_syscall(features));
+            CHECK_EQ(supported, syscall_fastpath());
+
+            CHECK_FALSE(syscall_set_fastpath(false));
+            auto pid = getpid_syscall();
+            auto slow = roundtrip();
+
+            CHECK_EQ(supported, syscall_set_fastpath(true));
+            if (!supported) {
+                printf("sysenter not supported; int 0x80 takes %llu ns per call\n", slow);
+                return;
+            }
+
+            // results, errors, and syscalls that reschedule come back the same way
+            CHECK_EQ(pid, getpid_syscall());
+            CHECK_NOT_EQ(0, fopen_syscall("/this/file/does/not/exist", 0) & 1);
+            CHECK_EQ(0, yield_syscall());
+            CHECK_EQ(pid, getpid_syscall());
+
+            auto fast = roundtrip();
+            printf("%u calls: int 0x80 takes %llu ns per call, sysenter takes %llu ns per call\n",
+                gNumCalls, slow, fast);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
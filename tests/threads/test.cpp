@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static constexpr uint32_t gNumThreads = 4;
+static constexpr uint32_t gIncrements = 10000;
+
+static pthread_mutex_t gMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t gCounter = 0;
+
+static void* incrementer(void* arg) {
+    for (auto i = 0u; i < gIncrements; ++i) {
+        pthread_mutex_lock(&gMutex);
+        ++gCounter;
+        pthread_mutex_unlock(&gMutex);
+    }
+    // threads share the heap, so memory allocated here is good for the joiner to use
+    auto result = (uint32_t*)malloc(sizeof(uint32_t));
+    *result = (uint32_t)(uintptr_t)arg;
+    return result;
+}
+
+static volatile bool gDetachedRan = false;
+
+static void* detached(void*) {
+    gDetachedRan = true;
+    return nullptr;
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            pthread_t threads[gNumThreads];
+            for (auto i = 0u; i < gNumThreads; ++i) {
+                CHECK_EQ(0, pthread_create(&threads[i], nullptr, incrementer, (void*)(uintptr_t)i));
+                CHECK_NOT_EQ(threads[i], pthread_self());
+            }
+
+            for (auto i = 0u; i < gNumThreads; ++i) {
+                void* result = nullptr;
+                CHECK_EQ(0, pthread_join(threads[i], &result));
+                CHECK_NOT_NULL(result);
+                CHECK_EQ(i, *(uint32_t*)result);
+                free(result);
+            }
+            CHECK_EQ(gNumThreads * gIncrements, gCounter);
+
+            pthread_attr_t attr;
+            pthread_attr_init(&attr);
+            pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+            pthread_t thread;
+            CHECK_EQ(0, pthread_create(&thread, &attr, detached, nullptr));
+            pthread_attr_destroy(&attr);
+            CHECK_NOT_EQ(0, pthread_join(thread, nullptr));
+            while (!gDetachedRan) sched_yield();
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/assert.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <syscalls.h>
+#include <kernel/syscalls/types.h>
+
+static uint64_t uptime() {
+    sysinfo_t si;
+    sysinfo_syscall(&si, INCLUDE_GLOBAL_INFO);
+    return si.global.uptime;
+}
+
+class TheTest : public Test {
+    public:
+        TheTest() : Test(TEST_NAME) {}
+
+    protected:
+        void run() override {
+            auto t0 = uptime();
+            for (auto i = 0; i < 20; ++i) CHECK_EQ(0, usleep(500));
+            auto t1 = uptime();
+            CHECK_TRUE(t1 - t0 >= 10);
+
+            timespec ts{0, 2500000};
+            CHECK_EQ(0, nanosleep(&ts, nullptr));
+            auto t2 = uptime();
+            CHECK_TRUE(t2 - t1 >= 2);
+
+            ts.tv_nsec = 1000000000;
+            CHECK_EQ(-1, nanosleep(&ts, nullptr));
+
+            printf("20 x usleep(500) took %llu ms, nanosleep(2.5ms) took %llu ms\n", t1 - t0, t2 - t1);
+        }
+};
+
+int main() {
+    Test* test = new TheTest();
+    test->test();
+    return 0;
+}
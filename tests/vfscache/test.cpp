@@ -0,0 +1,147 @@
+/*
+ * Copyright 2018 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libcheckup/test.h>
+#include <libcheckup/testplan.h>
+#include <libcheckup/assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <kernel/syscalls/types.h>
+
+#define FILE_PATH "/tmp/vfscache.txt"
+#define DIR_PATH "/tmp/vfscachedir"
+
+static bool cacheStats(vfs_cache_stats_t* stats) {
+    FILE* f = fopen("/devices/vfs/cache", "r");
+    if (f == nullptr) return false;
+    bool ok = (1 == fread(stats, sizeof(vfs_cache_stats_t), 1, f));
+    fclose(f);
+    return ok;
+}
+
+static bool exists(const char* path) {
+    struct stat st;
+    return 0 == stat(path, &st);
+}
+
+class HitTest : public Test {
+    public:
+        HitTest() : Test("vfscache.Hit") {}
+
+    protected:
+        void run() override {
+            vfs_cache_stats_t before, after;
+            CHECK_TRUE(cacheStats(&before));
+            CHECK_NOT_EQ(0, before.mounts);
+            CHECK_TRUE(before.entries <= before.capacity);
+
+            for (auto i = 0; i < 10; ++i) {
+                CHECK_TRUE(exists("/system/apps/ls"));
+                CHECK_FALSE(exists("/system/not/a/real/path"));
+            }
+
+            CHECK_TRUE(cacheStats(&after));
+            CHECK_TRUE(after.hits >= before.hits + 18);
+        }
+};
+
+class CreateFileTest : public Test {
+    public:
+        CreateFileTest() : Test("vfscache.CreateFile") {}
+
+    protected:
+        void run() override {
+            unlink(FILE_PATH);
+            // a path found not to exist has to show up as soon as it is created
+            CHECK_FALSE(exists(FILE_PATH));
+            CHECK_FALSE(exists(FILE_PATH));
+
+            FILE* f = fopen(FILE_PATH, "w");
+            CHECK_NOT_NULL(f);
+            fprintf(f, "hello");
+            fclose(f);
+            CHECK_TRUE(exists(FILE_PATH));
+
+            CHECK_EQ(0, unlink(FILE_PATH));
+            CHECK_FALSE(exists(FILE_PATH));
+        }
+};
+
+class MakeDirectoryTest : public Test {
+    public:
+        MakeDirectoryTest() : Test("vfscache.MakeDirectory") {}
+
+    protected:
+        void run() override {
+            rmdir(DIR_PATH);
+            CHECK_NULL(opendir(DIR_PATH));
+            CHECK_NULL(opendir(DIR_PATH));
+
+            CHECK_EQ(0, mkdir(DIR_PATH, 0777));
+            DIR* dir = opendir(DIR_PATH);
+            CHECK_NOT_NULL(dir);
+            closedir(dir);
+
+            CHECK_EQ(0, rmdir(DIR_PATH));
+            CHECK_NULL(opendir(DIR_PATH));
+        }
+};
+
+class RelativePathTest : public Test {
+    public:
+        RelativePathTest() : Test("vfscache.RelativePath") {}
+
+    protected:
+        void run() override {
+            char cwd[256];
+            CHECK_NOT_NULL(getcwd(cwd, sizeof(cwd)));
+
+            // . and .. must be resolved before the path ever gets to the cache
+            CHECK_EQ(0, chdir("/system/apps"));
+            CHECK_TRUE(exists("ls"));
+            CHECK_TRUE(exists("./ls"));
+            CHECK_TRUE(exists("../apps/ls"));
+            CHECK_FALSE(exists("../ls"));
+
+            char* rp = realpath("..", nullptr);
+            CHECK_NOT_NULL(rp);
+            CHECK_EQ(0, strcmp(rp, "/system"));
+            free(rp);
+
+            CHECK_EQ(0, chdir(".."));
+            char here[256];
+            CHECK_NOT_NULL(getcwd(here, sizeof(here)));
+            CHECK_EQ(0, strcmp(here, "/system"));
+
+            CHECK_EQ(0, chdir(cwd));
+        }
+};
+
+int main() {
+    auto& testPlan = TestPlan::defaultPlan(TEST_NAME);
+
+    testPlan.add<HitTest>()
+            .add<CreateFileTest>()
+            .add<MakeDirectoryTest>()
+            .add<RelativePathTest>();
+
+    testPlan.test();
+    return 0;
+}